@@ -4,6 +4,7 @@ GLIDE_SOURCES = \
 	$(GLIDE_SRC_DIR)/GlideSettings.cpp \
 	$(GLIDE_SRC_DIR)/GlideState.cpp \
 	$(GLIDE_SRC_DIR)/GlidePolar.cpp \
+	$(GLIDE_SRC_DIR)/GlideSpeedTable.cpp \
 	$(GLIDE_SRC_DIR)/PolarCoefficients.cpp \
 	$(GLIDE_SRC_DIR)/GlideResult.cpp \
 	$(GLIDE_SRC_DIR)/MacCready.cpp
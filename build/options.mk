@@ -29,6 +29,12 @@ ifeq ($(STOP_WATCH),y)
 TARGET_CPPFLAGS += -DSTOP_WATCH
 endif
 
+# spatial index of the airspace database: "rtree" or "kdtree"
+AIRSPACE_TREE ?= rtree
+ifeq ($(AIRSPACE_TREE),kdtree)
+TARGET_CPPFLAGS += -DAIRSPACE_KDTREE
+endif
+
 # this option must not be used if TESTING=y
 ifeq ($(NO_HORIZON),y)
 TARGET_CPPFLAGS += -DNO_HORIZON
@@ -22,36 +22,17 @@ Copyright_License {
 */
 
 #include "Airspace/AirspaceGlue.hpp"
-#include "Airspace/AirspaceParser.hpp"
+#include "Airspace/ParseAirspaceFiles.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Profile/ProfileKeys.hpp"
 #include "Terrain/RasterTerrain.hpp"
 #include "Operation/Operation.hpp"
 #include "Language/Language.hpp"
 #include "LogFile.hpp"
-#include "IO/TextFile.hpp"
+#include "Util/Macros.hpp"
 #include "Profile/Profile.hpp"
 
 #include <windef.h> /* for MAX_PATH */
-#include <memory>
-
-static bool
-ParseAirspaceFile(AirspaceParser &parser, const TCHAR *path,
-                  OperationEnvironment &operation)
-{
-  std::unique_ptr<TLineReader> reader(OpenTextFile(path, ConvertLineReader::AUTO));
-  if (!reader) {
-    LogStartUp(_T("Failed to open airspace file: %s"), path);
-    return false;
-  }
-
-  if (!parser.Parse(*reader, operation)) {
-    LogStartUp(_T("Failed to parse airspace file: %s"), path);
-    return false;
-  }
-
-  return true;
-}
 
 void
 ReadAirspace(Airspaces &airspaces,
@@ -62,23 +43,31 @@ ReadAirspace(Airspaces &airspaces,
   LogFormat("ReadAirspace");
   operation.SetText(_("Loading Airspace File..."));
 
-  bool airspace_ok = false;
-
-  AirspaceParser parser(airspaces);
-
   // Read the airspace filenames from the registry
-  TCHAR path[MAX_PATH];
-  if (Profile::GetPath(ProfileKeys::AirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+  TCHAR buffers[3][MAX_PATH];
+  const TCHAR *paths[ARRAY_SIZE(buffers)];
+  unsigned n_paths = 0;
+
+  if (Profile::GetPath(ProfileKeys::AirspaceFile, buffers[n_paths])) {
+    paths[n_paths] = buffers[n_paths];
+    ++n_paths;
+  }
 
-  if (Profile::GetPath(ProfileKeys::AdditionalAirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+  if (Profile::GetPath(ProfileKeys::AdditionalAirspaceFile,
+                       buffers[n_paths])) {
+    paths[n_paths] = buffers[n_paths];
+    ++n_paths;
+  }
 
-  if (Profile::GetPath(ProfileKeys::MapFile, path)) {
-    _tcscat(path, _T("/airspace.txt"));
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+  if (Profile::GetPath(ProfileKeys::MapFile, buffers[n_paths])) {
+    _tcscat(buffers[n_paths], _T("/airspace.txt"));
+    paths[n_paths] = buffers[n_paths];
+    ++n_paths;
   }
 
+  const bool airspace_ok =
+    ParseAirspaceFiles(airspaces, paths, n_paths, operation);
+
   if (airspace_ok) {
     airspaces.Optimise();
     airspaces.SetFlightLevels(press);
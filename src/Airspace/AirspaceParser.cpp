@@ -213,6 +213,8 @@ struct TempAirspaceType
     // Determine end bearing
     Angle end_bearing = center.Bearing(end);
 
+    const RadialLocator locator(center, radius);
+
     if (rotation > 0) {
       while (end_bearing < start_bearing)
         end_bearing += Angle::FullCircle();
@@ -227,7 +229,7 @@ struct TempAirspaceType
     // Add intermediate polygon points
     while ((end_bearing - start_bearing).AbsoluteDegrees() > threshold) {
       start_bearing += step;
-      points.push_back(FindLatitudeLongitude(center, start_bearing, radius));
+      points.push_back(locator.At(start_bearing));
     }
 
     // Add last polygon point
@@ -242,6 +244,8 @@ struct TempAirspaceType
     const Angle step = Angle::Degrees(rotation * _step);
     const fixed threshold = _step * fixed(1.5);
 
+    const RadialLocator locator(center, radius);
+
     if (rotation > 0) {
       while (end < start)
         end += Angle::FullCircle();
@@ -251,16 +255,16 @@ struct TempAirspaceType
     }
 
     // Add first polygon point
-    points.push_back(FindLatitudeLongitude(center, start, radius));
+    points.push_back(locator.At(start));
 
     // Add intermediate polygon points
     while ((end - start).AbsoluteDegrees() > threshold) {
       start += step;
-      points.push_back(FindLatitudeLongitude(center, start, radius));
+      points.push_back(locator.At(start));
     }
 
     // Add last polygon point
-    points.push_back(FindLatitudeLongitude(center, end, radius));
+    points.push_back(locator.At(end));
   }
 };
 
@@ -904,12 +908,12 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
     // Parse the line
     if (filetype == AFT_OPENAIR)
       if (!ParseLine(airspaces, line, temp_area) &&
-          !ShowParseWarning(line_num, line))
+          (!interactive || !ShowParseWarning(line_num, line)))
         return false;
 
     if (filetype == AFT_TNP)
       if (!ParseLineTNP(airspaces, line, temp_area, ignore) &&
-          !ShowParseWarning(line_num, line))
+          (!interactive || !ShowParseWarning(line_num, line)))
         return false;
 
     // Update the ProgressDialog
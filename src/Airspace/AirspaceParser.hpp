@@ -32,8 +32,16 @@ class AirspaceParser
 {
   Airspaces &airspaces;
 
+  /**
+   * Ask the user whether malformed lines shall be skipped?  If
+   * false, Parse() fails on the first malformed line, which allows
+   * parsing in a thread other than the main thread.
+   */
+  bool interactive;
+
 public:
-  AirspaceParser(Airspaces &_airspaces): airspaces(_airspaces) {}
+  AirspaceParser(Airspaces &_airspaces, bool _interactive=true)
+    :airspaces(_airspaces), interactive(_interactive) {}
 
   bool Parse(TLineReader &reader, OperationEnvironment &operation);
 };
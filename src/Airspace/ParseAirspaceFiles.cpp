@@ -0,0 +1,115 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/ParseAirspaceFiles.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Operation/Operation.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "IO/TextFile.hpp"
+#include "IO/LineReader.hpp"
+#include "LogFile.hpp"
+
+#include <algorithm>
+#include <memory>
+
+static bool
+ParseAirspaceFile(Airspaces &airspaces, const TCHAR *path,
+                  OperationEnvironment &operation, bool interactive)
+{
+  std::unique_ptr<TLineReader> reader(OpenTextFile(path, ConvertLineReader::AUTO));
+  if (!reader) {
+    if (interactive)
+      LogStartUp(_T("Failed to open airspace file: %s"), path);
+    return false;
+  }
+
+  AirspaceParser parser(airspaces, interactive);
+  if (!parser.Parse(*reader, operation)) {
+    if (interactive)
+      LogStartUp(_T("Failed to parse airspace file: %s"), path);
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Parses each file into its own #Airspaces object, without user
+ * interaction.
+ */
+class ParseAirspaceFilesJob final : public WorkerPool::Job {
+  const TCHAR *const*paths;
+  Airspaces *results;
+  bool *success;
+
+public:
+  ParseAirspaceFilesJob(const TCHAR *const*_paths, Airspaces *_results,
+                        bool *_success)
+    :paths(_paths), results(_results), success(_success) {}
+
+  virtual void Process(unsigned i) override {
+    NullOperationEnvironment operation;
+    success[i] = ParseAirspaceFile(results[i], paths[i], operation, false);
+  }
+};
+
+bool
+ParseAirspaceFiles(Airspaces &airspaces,
+                   const TCHAR *const*paths, unsigned n_paths,
+                   OperationEnvironment &operation)
+{
+  bool result = false;
+
+  const unsigned concurrency =
+    std::min(n_paths, WorkerPool::GetProcessorCount());
+  if (concurrency <= 1) {
+    for (unsigned i = 0; i < n_paths; ++i)
+      result |= ParseAirspaceFile(airspaces, paths[i], operation, true);
+
+    return result;
+  }
+
+  std::unique_ptr<Airspaces[]> results(new Airspaces[n_paths]);
+  std::unique_ptr<bool[]> success(new bool[n_paths]);
+
+  {
+    WorkerPool pool(concurrency);
+    ParseAirspaceFilesJob job(paths, results.get(), success.get());
+    pool.Run(job, n_paths);
+  }
+
+  for (unsigned i = 0; i < n_paths; ++i) {
+    if (!success[i]) {
+      /* try again in this thread, to report the error and to let
+         the user decide about malformed lines */
+      results[i].clear();
+      success[i] = ParseAirspaceFile(results[i], paths[i], operation, true);
+    }
+
+    airspaces.Merge(results[i]);
+    result |= success[i];
+  }
+
+  return result;
+}
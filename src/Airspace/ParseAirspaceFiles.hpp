@@ -0,0 +1,48 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PARSE_AIRSPACE_FILES_HPP
+#define XCSOAR_PARSE_AIRSPACE_FILES_HPP
+
+#include <tchar.h>
+
+class Airspaces;
+class OperationEnvironment;
+
+/**
+ * Parse the specified airspace files and add their contents to
+ * #airspaces, in the given order.  On a multi-core system, the files
+ * are parsed concurrently; files which fail to parse are parsed
+ * again in the calling thread, so the user gets asked about
+ * malformed lines as usual.
+ *
+ * Must be called from the main thread.
+ *
+ * @return true if at least one file was parsed successfully
+ */
+bool
+ParseAirspaceFiles(Airspaces &airspaces,
+                   const TCHAR *const*paths, unsigned n_paths,
+                   OperationEnvironment &operation);
+
+#endif
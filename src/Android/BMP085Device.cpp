@@ -99,7 +99,7 @@ void
 BMP085Device::onBMP085Values(fixed temperature,
                              AtmosphericPressure pressure)
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   basic.UpdateClock();
   basic.alive.Update(basic.clock);
@@ -121,7 +121,7 @@ BMP085Device::onBMP085Values(fixed temperature,
 void
 BMP085Device::onBMP085Error()
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
 
 #ifdef USE_TEMPERATURE
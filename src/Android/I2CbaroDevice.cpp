@@ -100,7 +100,7 @@ static fixed static_p = fixed(0);
 void
 I2CbaroDevice::onI2CbaroValues(unsigned sensor, AtmosphericPressure pressure)
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   basic.UpdateClock();
   basic.alive.Update(basic.clock);
@@ -160,7 +160,7 @@ I2CbaroDevice::onI2CbaroValues(unsigned sensor, AtmosphericPressure pressure)
 void
 I2CbaroDevice::onI2CbaroError()
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
 
   basic.static_pressure_available.Clear();
@@ -180,7 +180,7 @@ Java_org_xcsoar_InternalGPS_setConnected(JNIEnv *env, jobject obj,
 {
   unsigned index = getDeviceIndex(env, obj);
 
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
 
   switch (connected) {
@@ -217,7 +217,7 @@ Java_org_xcsoar_InternalGPS_setLocation(JNIEnv *env, jobject obj,
 {
   unsigned index = getDeviceIndex(env, obj);
 
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   basic.UpdateClock();
   basic.alive.Update(basic.clock);
@@ -283,7 +283,7 @@ Java_org_xcsoar_NonGPSSensors_setAcceleration(
   // TODO
   /*
   const unsigned int index = getDeviceIndex(env, obj);
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   */
 }
@@ -296,7 +296,7 @@ Java_org_xcsoar_NonGPSSensors_setRotation(
   // TODO
   /*
   const unsigned int index = getDeviceIndex(env, obj);
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   */
 }
@@ -308,7 +308,7 @@ Java_org_xcsoar_NonGPSSensors_setMagneticField(
   // TODO
   /*
   const unsigned int index = getDeviceIndex(env, obj);
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   */
 }
@@ -360,11 +360,11 @@ Java_org_xcsoar_NonGPSSensors_setBarometricPressure(
   static SelfTimingKalmanFilter1d kalman_filter(KF_MAX_DT, KF_VAR_ACCEL);
 
   const unsigned int index = getDeviceIndex(env, obj);
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
 
-  /* Kalman filter updates are also protected by the blackboard
-     mutex. These should not take long; we won't hog the mutex
-     unduly. */
+  /* Kalman filter updates are also protected by the device's
+     mutex (there is only one internal sensor device). These should
+     not take long; we won't hog the mutex unduly. */
   kalman_filter.Update(fixed(pressure), fixed(sensor_noise_variance));
 
   NMEAInfo &basic = device_blackboard->SetRealState(index);
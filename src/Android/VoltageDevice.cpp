@@ -84,7 +84,7 @@ VoltageDevice::~VoltageDevice()
 void
 VoltageDevice::onVoltageValues(int temp_adc, int voltage_index, int volt_adc)
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   basic.UpdateClock();
   basic.alive.Update(basic.clock);
@@ -121,7 +121,7 @@ VoltageDevice::onVoltageValues(int temp_adc, int voltage_index, int volt_adc)
 void
 VoltageDevice::onVoltageError()
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
 
   basic.temperature_available = false;
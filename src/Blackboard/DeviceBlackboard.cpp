@@ -51,8 +51,12 @@ DeviceBlackboard::DeviceBlackboard()
   gps_info.date_time_utc = BrokenDateTime::NowUTC();
   gps_info.time = fixed(gps_info.date_time_utc.GetSecondOfDay());
 
-  for (unsigned i = 0; i < NUMDEV; ++i)
+  for (unsigned i = 0; i < NUMDEV; ++i) {
     per_device_data[i] = gps_info;
+    modified_serial[i] = 1;
+    merged_serial[i] = 0;
+    merged_valid[i] = false;
+  }
 
   real_data = simulator_data = replay_data = gps_info;
 
@@ -74,10 +78,16 @@ DeviceBlackboard::SetStartupLocation(const GeoPoint &loc, const fixed alt)
   if (Calculated().flight.flying)
     return;
 
-  for (unsigned i = 0; i < NUMDEV; ++i)
+  for (unsigned i = 0; i < NUMDEV; ++i) {
+    ScopeLock protect_device(device_mutex[i]);
     if (!per_device_data[i].location_available)
       per_device_data[i].SetFakeLocation(loc, alt);
 
+    /* real_data is modified below; the next Merge() must start
+       over */
+    ++modified_serial[i];
+  }
+
   if (!real_data.location_available)
     real_data.SetFakeLocation(loc, alt);
 
@@ -197,11 +207,13 @@ DeviceBlackboard::ExpireWallClock()
 
   bool modified = false;
   for (unsigned i = 0; i < NUMDEV; ++i) {
+    ScopeLock protect_device(device_mutex[i]);
     NMEAInfo &basic = per_device_data[i];
     if (!basic.alive)
       continue;
 
     basic.ExpireWallClock();
+    ++modified_serial[i];
     if (!basic.alive)
       modified = true;
   }
@@ -219,16 +231,60 @@ DeviceBlackboard::ScheduleMerge()
 void
 DeviceBlackboard::Merge()
 {
-  real_data.Reset();
+  /* read the clock only once for all devices, see
+     NMEAInfo::UpdateClock() */
+  const fixed clock = fixed(MonotonicClockMS()) / 1000;
+
+  /* expire the per-device data, and find the first device which was
+     modified since the last merge */
+
+  unsigned first = NUMDEV;
   for (unsigned i = 0; i < NUMDEV; ++i) {
-    if (!per_device_data[i].alive)
-      continue;
+    ScopeLock protect_device(device_mutex[i]);
+    NMEAInfo &basic = per_device_data[i];
+    if (basic.alive) {
+      basic.clock = clock;
+      if (basic.Expire())
+        ++modified_serial[i];
+    }
+
+    if (first == NUMDEV && modified_serial[i] != merged_serial[i])
+      first = i;
+  }
 
-    per_device_data[i].UpdateClock();
-    per_device_data[i].Expire();
-    real_data.Complement(per_device_data[i]);
+  if (first < NUMDEV) {
+    /* the devices before it contribute the same data as last time:
+       resume from their merged data if available, and merge the
+       rest again */
+
+    unsigned i = first;
+    while (i > 0 && !merged_valid[i - 1])
+      --i;
+
+    if (i > 0)
+      real_data = merged_data[i - 1];
+    else
+      real_data.Reset();
+
+    for (; i < NUMDEV; ++i) {
+      ScopeLock protect_device(device_mutex[i]);
+      const NMEAInfo &basic = per_device_data[i];
+      merged_serial[i] = modified_serial[i];
+
+      if (basic.alive)
+        real_data.Complement(basic);
+
+      /* remember the merged data before the first modified device;
+         the next merge can resume from there if the same device is
+         modified again */
+      merged_valid[i] = i + 1 == first;
+      if (merged_valid[i])
+        merged_data[i] = real_data;
+    }
   }
 
+  real_data.clock = clock;
+
   if (replay_data.alive) {
     /* the replay may run at a higher speed; use NMEA_INFO::Time as a
        "fake wallclock" to prevent them from expiring too quickly */
@@ -237,7 +293,7 @@ DeviceBlackboard::Merge()
     replay_data.Expire();
     SetBasic() = replay_data;
   } else if (simulator_data.alive) {
-    simulator_data.UpdateClock();
+    simulator_data.clock = clock;
     simulator_data.Expire();
     SetBasic() = simulator_data;
   } else {
@@ -51,10 +51,40 @@ class DeviceBlackboard:
   Simulator simulator;
 
   /**
-   * Data from each physical device.
+   * Data from each physical device.  Each one is protected by its
+   * own mutex (#device_mutex), not by #mutex, so device drivers
+   * parsing new data don't have to wait for the calculation threads.
    */
   NMEAInfo per_device_data[NUMDEV];
 
+  /**
+   * Protects the according #per_device_data element.  It may be
+   * locked while holding #mutex, but not the other way round.
+   */
+  Mutex device_mutex[NUMDEV];
+
+  /**
+   * Incremented each time the according #per_device_data element
+   * may have been modified.  Protected by #device_mutex.
+   */
+  unsigned modified_serial[NUMDEV];
+
+  /**
+   * The #modified_serial values which were merged by the last
+   * Merge().
+   */
+  unsigned merged_serial[NUMDEV];
+
+  /**
+   * merged_data[i] is the merged data of the devices up to and
+   * including i, which allows Merge() to reuse the contributions of
+   * the devices before the first modified one.  Only elements whose
+   * #merged_valid flag is set are up to date; Merge() keeps the one
+   * before the first modified device.
+   */
+  NMEAInfo merged_data[NUMDEV];
+  bool merged_valid[NUMDEV];
+
   /**
    * Merged data from the physical devices.
    */
@@ -83,13 +113,30 @@ protected:
   MoreData &SetMoreData() { return gps_info; }
 
 public:
+  /**
+   * Returns the mutex which protects the data of the specified
+   * device.  The caller must not lock #mutex while holding it.
+   */
+  Mutex &GetDeviceMutex(unsigned i) {
+    assert(i < NUMDEV);
+    return device_mutex[i];
+  }
+
+  /**
+   * Caller must lock GetDeviceMutex(i).
+   */
   const NMEAInfo &RealState(unsigned i) const {
     assert(i < NUMDEV);
     return per_device_data[i];
   }
 
+  /**
+   * Caller must lock GetDeviceMutex(i).  The data is assumed to be
+   * modified, i.e. the next Merge() will take it into account.
+   */
   NMEAInfo &SetRealState(unsigned i) {
     assert(i < NUMDEV);
+    ++modified_serial[i];
     return per_device_data[i];
   }
 
@@ -142,7 +189,10 @@ public:
 
   /**
    * Copy real_data or simulator_data or replay_data to gps_info.
-   * Caller must lock the blackboard.
+   * Caller must lock the blackboard.  The per-device data is merged
+   * while holding each device's mutex, so each device contributes a
+   * consistent snapshot.  Only the devices from the first one which
+   * was modified since the last call are merged again.
    */
   void Merge();
 };
@@ -25,11 +25,15 @@ Copyright_License {
 #include "Engine/Contest/Settings.hpp"
 #include "NMEA/Derived.hpp"
 
+#include <algorithm>
+
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_sprint)
-  :contest_manager(Contest::OLC_SPRINT, trace_full, trace_sprint, true)
+  :executor(std::min(WorkerPool::GetProcessorCount(), 2u)),
+   contest_manager(Contest::OLC_SPRINT, trace_full, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+  contest_manager.SetExecutor(&executor);
 }
 
 void
@@ -25,12 +25,21 @@ Copyright_License {
 #define XCSOAR_CONTEST_COMPUTER_HPP
 
 #include "Engine/Contest/ContestManager.hpp"
+#include "ContestExecutor.hpp"
 
 struct ContestSettings;
 struct ContestStatistics;
 class Trace;
 
 class ContestComputer {
+  /**
+   * Runs independent solvers (e.g. OLC Classic and FAI for OLC Plus)
+   * in parallel on multi-core systems, so the idle processing
+   * doesn't take the sum of their run times.  No contest has more
+   * than two of them.
+   */
+  ContestExecutor executor;
+
   ContestManager contest_manager;
 
 public:
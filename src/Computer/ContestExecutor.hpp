@@ -0,0 +1,65 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CONTEST_EXECUTOR_HPP
+#define XCSOAR_CONTEST_EXECUTOR_HPP
+
+#include "Engine/Contest/ContestManager.hpp"
+#include "Thread/WorkerPool.hpp"
+
+/**
+ * Runs the independent solvers of a #ContestManager on a
+ * #WorkerPool.
+ */
+class ContestExecutor final : public ContestManager::Executor {
+  class Adapter final : public WorkerPool::Job {
+    ContestManager::Executor::Job &job;
+
+  public:
+    explicit Adapter(ContestManager::Executor::Job &_job):job(_job) {}
+
+    virtual void Process(unsigned i) override {
+      job.Process(i);
+    }
+  };
+
+  WorkerPool pool;
+
+public:
+  /**
+   * @param concurrency the number of solvers which may run at a time
+   */
+  explicit ContestExecutor(unsigned concurrency):pool(concurrency) {}
+
+  unsigned GetConcurrency() const {
+    return pool.GetConcurrency();
+  }
+
+  virtual void Run(ContestManager::Executor::Job &job,
+                   unsigned n) override {
+    Adapter adapter(job);
+    pool.Run(adapter, n);
+  }
+};
+
+#endif
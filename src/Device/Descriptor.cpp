@@ -199,10 +199,10 @@ DeviceDescriptor::Open(Port &_port, OperationEnvironment &env)
 
   reopen_clock.Update();
 
-  device_blackboard->mutex.Lock();
+  device_blackboard->GetDeviceMutex(index).Lock();
   device_blackboard->SetRealState(index).Reset();
   device_blackboard->ScheduleMerge();
-  device_blackboard->mutex.Unlock();
+  device_blackboard->GetDeviceMutex(index).Unlock();
 
   settings_sent.Clear();
   settings_received.Clear();
@@ -486,10 +486,10 @@ DeviceDescriptor::Close()
 
   ticker = false;
 
-  device_blackboard->mutex.Lock();
+  device_blackboard->GetDeviceMutex(index).Lock();
   device_blackboard->SetRealState(index).Reset();
   device_blackboard->ScheduleMerge();
-  device_blackboard->mutex.Unlock();
+  device_blackboard->GetDeviceMutex(index).Unlock();
 
   settings_sent.Clear();
   settings_received.Clear();
@@ -622,7 +622,7 @@ DeviceDescriptor::Return()
 bool
 DeviceDescriptor::IsAlive() const
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   return device_blackboard->RealState(index).alive;
 }
 
@@ -669,10 +669,8 @@ DeviceDescriptor::ForwardLine(const char *line)
   /* XXX make this method thread-safe; this method can be called from
      any thread, and if the Port gets closed, bad things happen */
 
-  if (IsNMEAOut() && port != NULL) {
-    port->Write(line);
-    port->Write("\r\n");
-  }
+  if (IsNMEAOut() && port != NULL)
+    port->WriteLine(line);
 }
 
 bool
@@ -718,7 +716,7 @@ DeviceDescriptor::PutMacCready(fixed value, OperationEnvironment &env)
   if (!device->PutMacCready(value, env))
     return false;
 
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   settings_sent.mac_cready = value;
   settings_sent.mac_cready_available.Update(basic.clock);
@@ -743,7 +741,7 @@ DeviceDescriptor::PutBugs(fixed value, OperationEnvironment &env)
   if (!device->PutBugs(value, env))
     return false;
 
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   settings_sent.bugs = value;
   settings_sent.bugs_available.Update(basic.clock);
@@ -770,7 +768,7 @@ DeviceDescriptor::PutBallast(fixed fraction, fixed overload,
   if (!device->PutBallast(fraction, overload, env))
     return false;
 
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   settings_sent.ballast_fraction = fraction;
   settings_sent.ballast_fraction_available.Update(basic.clock);
@@ -848,7 +846,7 @@ DeviceDescriptor::PutQNH(const AtmosphericPressure &value,
   if (!device->PutQNH(value, env))
     return false;
 
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   settings_sent.qnh = value;
   settings_sent.qnh_available.Update(basic.clock);
@@ -1008,7 +1006,7 @@ DeviceDescriptor::OnCalculatedUpdate(const MoreData &basic,
 bool
 DeviceDescriptor::ParseLine(const char *line)
 {
-  ScopeLock protect(device_blackboard->mutex);
+  ScopeLock protect(device_blackboard->GetDeviceMutex(index));
   NMEAInfo &basic = device_blackboard->SetRealState(index);
   basic.UpdateClock();
   return ParseNMEA(line, basic);
@@ -1036,7 +1034,7 @@ DeviceDescriptor::DataReceived(const void *data, size_t length)
 
   // Pass data directly to drivers that use binary data protocols
   if (driver != NULL && device != NULL && driver->UsesRawData()) {
-    ScopeLock protect(device_blackboard->mutex);
+    ScopeLock protect(device_blackboard->GetDeviceMutex(index));
     NMEAInfo &basic = device_blackboard->SetRealState(index);
     basic.UpdateClock();
 
@@ -25,6 +25,7 @@ Copyright_License {
 #include "Units/System.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTag.hpp"
 #include "NMEA/Checksum.hpp"
 
 static bool
@@ -149,14 +150,17 @@ CAI302Device::ParseNMEA(const char *String, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$PCAIB"))
+  switch (NMEASentenceTag(type)) {
+  case NMEASentenceTag("$PCAIB"):
     return cai_PCAIB(line, info);
 
-  if (StringIsEqual(type, "$PCAID"))
+  case NMEASentenceTag("$PCAID"):
     return cai_PCAID(line, info);
 
-  if (StringIsEqual(type, "!w"))
+  case NMEASentenceTag("!w"):
     return cai_w(line, info);
 
-  return false;
+  default:
+    return false;
+  }
 }
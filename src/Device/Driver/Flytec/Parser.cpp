@@ -25,6 +25,7 @@ Copyright_License {
 #include "Device/Parser.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTag.hpp"
 #include "NMEA/Checksum.hpp"
 #include "Units/System.hpp"
 #include "Atmosphere/Temperature.hpp"
@@ -256,12 +257,17 @@ FlytecDevice::ParseNMEA(const char *_line, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$BRSF"))
+  switch (NMEASentenceTag(type)) {
+  case NMEASentenceTag("$BRSF"):
     return FlytecParseBRSF(line, info);
-  else if (StringIsEqual(type, "$VMVABD"))
+
+  case NMEASentenceTag("$VMVABD"):
     return FlytecParseVMVABD(line, info);
-  else if (StringIsEqual(type, "$FLYSEN"))
+
+  case NMEASentenceTag("$FLYSEN"):
     return ParseFLYSEN(line, info);
-  else
+
+  default:
     return false;
+  }
 }
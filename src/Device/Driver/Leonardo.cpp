@@ -26,6 +26,7 @@ Copyright_License {
 #include "Device/Driver.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTag.hpp"
 #include "Units/System.hpp"
 #include "Atmosphere/Temperature.hpp"
 
@@ -211,19 +212,22 @@ LeonardoDevice::ParseNMEA(const char *_line, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$C") ||
-      StringIsEqual(type, "$c"))
+  switch (NMEASentenceTag(type)) {
+  case NMEASentenceTag("$C"):
+  case NMEASentenceTag("$c"):
     return LeonardoParseC(line, info);
 
-  else if (StringIsEqual(type, "$D") ||
-           StringIsEqual(type, "$d"))
+  case NMEASentenceTag("$D"):
+  case NMEASentenceTag("$d"):
     return LeonardoParseD(line, info);
 
-  else if (StringIsEqual(type, "$PDGFTL1") ||
-           StringIsEqual(type, "$PDGFTTL"))
+  case NMEASentenceTag("$PDGFTL1"):
+  case NMEASentenceTag("$PDGFTTL"):
     return PDGFTL1(line, info);
 
-  return false;
+  default:
+    return false;
+  }
 }
 
 static Device *
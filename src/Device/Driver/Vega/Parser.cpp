@@ -25,6 +25,7 @@ Copyright_License {
 #include "Message.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTag.hpp"
 #include "Compiler.h"
 #include "Util/Macros.hpp"
 
@@ -226,26 +227,37 @@ VegaDevice::ParseNMEA(const char *String, NMEAInfo &info)
   if (memcmp(type, "$PD", 3) == 0)
     detected = true;
 
-  if (strcmp(type, "$PDSWC") == 0)
+  switch (NMEASentenceTag(type)) {
+  case NMEASentenceTag("$PDSWC"):
     return PDSWC(line, info, volatile_data);
-  else if (strcmp(type, "$PDAAV") == 0)
+
+  case NMEASentenceTag("$PDAAV"):
     return PDAAV(line, info);
-  else if (strcmp(type, "$PDVSC") == 0)
+
+  case NMEASentenceTag("$PDVSC"):
     return PDVSC(line, info);
-  else if (strcmp(type, "$PDVDV") == 0)
+
+  case NMEASentenceTag("$PDVDV"):
     return PDVDV(line, info);
-  else if (strcmp(type, "$PDVDS") == 0)
+
+  case NMEASentenceTag("$PDVDS"):
     return PDVDS(line, info);
-  else if (strcmp(type, "$PDVVT") == 0)
+
+  case NMEASentenceTag("$PDVVT"):
     return PDVVT(line, info);
-  else if (strcmp(type, "$PDVSD") == 0) {
+
+  case NMEASentenceTag("$PDVSD"): {
     const auto message = line.Rest();
     StaticString<256> buffer;
     buffer.SetASCII(message.begin(), message.end());
     Message::AddMessage(buffer);
     return true;
-  } else if (strcmp(type, "$PDTSM") == 0)
+  }
+
+  case NMEASentenceTag("$PDTSM"):
     return PDTSM(line, info);
-  else
+
+  default:
     return false;
+  }
 }
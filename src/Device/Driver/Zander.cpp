@@ -25,6 +25,7 @@ Copyright_License {
 #include "Device/Driver.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTag.hpp"
 #include "NMEA/Checksum.hpp"
 #include "Units/System.hpp"
 
@@ -135,22 +136,25 @@ ZanderDevice::ParseNMEA(const char *String, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$PZAN1"))
+  switch (NMEASentenceTag(type)) {
+  case NMEASentenceTag("$PZAN1"):
     return PZAN1(line, info);
 
-  if (StringIsEqual(type, "$PZAN2"))
+  case NMEASentenceTag("$PZAN2"):
     return PZAN2(line, info);
 
-  if (StringIsEqual(type, "$PZAN3"))
+  case NMEASentenceTag("$PZAN3"):
     return PZAN3(line, info);
 
-  if (StringIsEqual(type, "$PZAN4"))
+  case NMEASentenceTag("$PZAN4"):
     return PZAN4(line, info);
 
-  if (StringIsEqual(type, "$PZAN5"))
+  case NMEASentenceTag("$PZAN5"):
     return PZAN5(line, info);
 
-  return false;
+  default:
+    return false;
+  }
 }
 
 static Device *
@@ -30,6 +30,7 @@ Copyright_License {
 #include "NMEA/Info.hpp"
 #include "NMEA/Checksum.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTag.hpp"
 #include "Util/StringUtil.hpp"
 #include "Units/System.hpp"
 #include "OS/Clock.hpp"
@@ -78,49 +79,50 @@ NMEAParser::ParseLine(const char *string, NMEAInfo &info)
   line.Read(type, 16);
 
   if (IsAlphaASCII(type[1]) && IsAlphaASCII(type[2])) {
-    if (StringIsEqual(type + 3, "GSA"))
+    /* a standard sentence; the talker id is ignored */
+    switch (NMEASentenceTag(type + 3)) {
+    case NMEASentenceTag("GSA"):
       return GSA(line, info);
 
-    if (StringIsEqual(type + 3, "GLL"))
+    case NMEASentenceTag("GLL"):
       return GLL(line, info);
 
-    if (StringIsEqual(type + 3, "RMC"))
+    case NMEASentenceTag("RMC"):
       return RMC(line, info);
 
-    if (StringIsEqual(type + 3, "GGA"))
+    case NMEASentenceTag("GGA"):
       return GGA(line, info);
+    }
   }
 
   // if (proprietary sentence) ...
   if (type[1] == 'P') {
+    switch (NMEASentenceTag(type + 1)) {
     // Airspeed and vario sentence
-    if (StringIsEqual(type + 1, "PTAS1"))
+    case NMEASentenceTag("PTAS1"):
       return PTAS1(line, info);
 
     // FLARM sentences
-    if (StringIsEqual(type + 1, "PFLAE")) {
+    case NMEASentenceTag("PFLAE"):
       ParsePFLAE(line, info.flarm.error, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAV")) {
+    case NMEASentenceTag("PFLAV"):
       ParsePFLAV(line, info.flarm.version, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAA")) {
+    case NMEASentenceTag("PFLAA"):
       ParsePFLAA(line, info.flarm.traffic, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAU")) {
+    case NMEASentenceTag("PFLAU"):
       ParsePFLAU(line, info.flarm.status, info.clock);
       return true;
-    }
 
     // Garmin altitude sentence
-    if (StringIsEqual(type + 1, "PGRMZ"))
+    case NMEASentenceTag("PGRMZ"):
       return RMZ(line, info);
+    }
 
     return false;
   }
@@ -40,6 +40,25 @@ Port::Write(const char *s)
   return Write(s, strlen(s));
 }
 
+bool
+Port::WriteLine(const char *line)
+{
+  const size_t length = strlen(line);
+
+  char buffer[512];
+  if (length + 2 > sizeof(buffer))
+    /* too long for the buffer; this is not going to be a valid NMEA
+       sentence anyway */
+    return Write(line, length) == length && Write("\r\n", 2) == 2;
+
+  /* copy the line to append CR/LF, so it can be sent with a single
+     write() system call */
+  memcpy(buffer, line, length);
+  buffer[length] = '\r';
+  buffer[length + 1] = '\n';
+  return Write(buffer, length + 2) == length + 2;
+}
+
 bool
 Port::FullWrite(const void *buffer, size_t length,
                 OperationEnvironment &env, unsigned timeout_ms)
@@ -94,6 +94,16 @@ public:
   gcc_nonnull_all
   size_t Write(const char *s);
 
+  /**
+   * Writes a null-terminated string followed by CR/LF to the serial
+   * port, with only one call to Write().
+   *
+   * @param line the line without the line terminator
+   * @return true if the whole line has been written
+   */
+  gcc_nonnull_all
+  bool WriteLine(const char *line);
+
   /**
    * Writes a single byte to the serial port
    * @param ch Byte to write
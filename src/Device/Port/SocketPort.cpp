@@ -73,7 +73,7 @@ SocketPort::Set(SocketDescriptor &&_socket)
 
   /* register the socket in then IOThread or the SocketThread */
 #ifdef HAVE_POSIX
-  io_thread->LockAdd(socket.Get(), Poll::READ, *this);
+  io_thread->LockAdd(socket.Get(), IOThread::READ, *this);
 #else
   thread.Start();
 #endif
@@ -52,7 +52,7 @@ TCPPort::Open(unsigned port)
 
   /* register the socket in then IOThread or the SocketThread */
 #ifdef HAVE_POSIX
-  io_thread->LockAdd(listener.Get(), Poll::READ, *this);
+  io_thread->LockAdd(listener.Get(), IOThread::READ, *this);
 #else
   thread.Start();
 #endif
@@ -116,7 +116,7 @@ TCPPort::OnFileEvent(int fd, unsigned mask)
       /* close the connection, unregister the event, and reinstate the
          listener socket */
       SocketPort::Close();
-      io_thread->Add(listener.Get(), Poll::READ, *this);
+      io_thread->Add(listener.Get(), IOThread::READ, *this);
 #else
       /* we must not call SocketPort::Close() here because it may
          deadlock, waiting forever for this thread to finish; instead,
@@ -76,7 +76,7 @@ TTYPort::Open(const TCHAR *path, unsigned _baud_rate)
     return false;
 
   valid.store(true, std::memory_order_relaxed);
-  io_thread->LockAdd(tty.Get(), Poll::READ, *this);
+  io_thread->LockAdd(tty.Get(), IOThread::READ, *this);
   return true;
 }
 
@@ -87,7 +87,7 @@ TTYPort::OpenPseudo()
     return NULL;
 
   valid.store(true, std::memory_order_relaxed);
-  io_thread->LockAdd(tty.Get(), Poll::READ, *this);
+  io_thread->LockAdd(tty.Get(), IOThread::READ, *this);
   return tty.GetSlaveName();
 }
 
@@ -222,7 +222,10 @@ DeviceListWidget::RefreshList()
     Item &item = items[i];
 
     Item n;
-    n.Set(*device_list[i], device_blackboard->RealState(i));
+    {
+      ScopeLock protect(device_blackboard->GetDeviceMutex(i));
+      n.Set(*device_list[i], device_blackboard->RealState(i));
+    }
 
     if (n != item) {
       item = n;
@@ -482,18 +485,18 @@ DeviceListWidget::ManageCurrent()
   if (descriptor.IsDriver(_T("CAI 302")))
     ManageCAI302Dialog(UIGlobals::GetMainWindow(), look, *device);
   else if (descriptor.IsDriver(_T("FLARM"))) {
-    device_blackboard->mutex.Lock();
+    device_blackboard->GetDeviceMutex(current).Lock();
     const NMEAInfo &basic = device_blackboard->RealState(current);
     const FlarmVersion version = basic.flarm.version;
-    device_blackboard->mutex.Unlock();
+    device_blackboard->GetDeviceMutex(current).Unlock();
 
     ManageFlarmDialog(*device, version);
   } else if (descriptor.IsDriver(_T("LX"))) {
-    device_blackboard->mutex.Lock();
+    device_blackboard->GetDeviceMutex(current).Lock();
     const NMEAInfo &basic = device_blackboard->RealState(current);
     const DeviceInfo info = basic.device;
     const DeviceInfo secondary_info = basic.secondary_device;
-    device_blackboard->mutex.Unlock();
+    device_blackboard->GetDeviceMutex(current).Unlock();
 
     LXDevice &lx_device = *(LXDevice *)device;
     if (lx_device.IsV7())
@@ -61,6 +61,10 @@ protected:
   /** Airspace class */
   AirspaceClass type;
 
+  /**
+   * Is the border known to be convex?  If not, GetClearance() prunes
+   * the interior points, which does nothing for a convex border.
+   */
   bool m_is_convex;
   mutable bool active;
 
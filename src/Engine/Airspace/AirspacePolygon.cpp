@@ -23,6 +23,7 @@
 #include "AirspacePolygon.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Geo/Flat/FlatRay.hpp"
+#include "Geo/ConvexHull/PolygonInteriorGrid.hpp"
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
 
@@ -30,7 +31,7 @@
 
 AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
                                  const bool prune)
-  :AbstractAirspace(Shape::POLYGON)
+  :AbstractAirspace(Shape::POLYGON), inside_grid(nullptr)
 {
   if (pts.size() < 2) {
     m_is_convex = true;
@@ -52,7 +53,9 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
       m_border.PruneInterior();
       m_is_convex = true;
     } else {
-      m_is_convex = m_border.IsConvex();
+      /* checking convexity is as expensive as pruning, so leave it
+         to GetClearance(), which is only needed by a few users */
+      m_is_convex = false;
     }
   }
 }
@@ -66,10 +69,46 @@ AirspacePolygon::GetCenter() const
   return m_border[0].GetLocation();
 }
 
+AirspacePolygon::~AirspacePolygon()
+{
+  delete inside_grid.load();
+}
+
+const PolygonInteriorGrid *
+AirspacePolygon::GetInsideGrid() const
+{
+  PolygonInteriorGrid *grid = inside_grid.load(std::memory_order_acquire);
+  if (grid != nullptr || m_border.size() < PolygonInteriorGrid::MIN_VERTICES)
+    return grid;
+
+  grid = new PolygonInteriorGrid(m_border.data(),
+                                 m_border.data() + m_border.size());
+
+  /* another thread may have been faster */
+  PolygonInteriorGrid *expected = nullptr;
+  if (!inside_grid.compare_exchange_strong(expected, grid,
+                                           std::memory_order_acq_rel)) {
+    delete grid;
+    grid = expected;
+  }
+
+  return grid;
+}
+
 bool 
 AirspacePolygon::Inside(const GeoPoint &loc) const
 {
-  return m_border.IsInside(loc);
+  const PolygonInteriorGrid *grid = GetInsideGrid();
+  return grid != nullptr
+    ? grid->IsInside(loc, m_border.data())
+    : m_border.IsInside(loc);
+}
+
+size_t
+AirspacePolygon::GetInsideGridMemoryUsage() const
+{
+  const PolygonInteriorGrid *grid = inside_grid.load();
+  return grid != nullptr ? grid->GetMemoryUsage() : 0;
 }
 
 AirspaceIntersectionVector
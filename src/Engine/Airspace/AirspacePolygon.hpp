@@ -25,15 +25,25 @@
 
 #include "AbstractAirspace.hpp"
 #include <vector>
+#include <atomic>
 
 #ifdef DO_PRINT
 #include <iostream>
 #endif
 
+class PolygonInteriorGrid;
+
 /** General polygon form airspace */
 class AirspacePolygon: 
   public AbstractAirspace 
 {
+  /**
+   * Acceleration structure for Inside(), built on the first call for
+   * polygons with many vertices.  This is atomic because several
+   * readers may call Inside() at the same time.
+   */
+  mutable std::atomic<PolygonInteriorGrid *> inside_grid;
+
 public:
   /** 
    * Constructor.  For testing, pts vector is a cloud of points,
@@ -46,6 +56,8 @@ public:
    */
   AirspacePolygon(const std::vector<GeoPoint> &pts, const bool prune = false);
 
+  virtual ~AirspacePolygon();
+
   /**
    * Get arbitrary center or reference point for use in determining
    * overall center location of all airspaces
@@ -79,6 +91,17 @@ public:
   virtual GeoPoint ClosestPoint(const GeoPoint &loc,
                                 const TaskProjection &projection) const;
 
+  /**
+   * Returns the number of bytes used by the Inside() acceleration
+   * structure (0 if it has not been built).
+   */
+  gcc_pure
+  size_t GetInsideGridMemoryUsage() const;
+
+private:
+  gcc_pure
+  const PolygonInteriorGrid *GetInsideGrid() const;
+
 public:
 #ifdef DO_PRINT
   friend std::ostream& operator<< (std::ostream& f, 
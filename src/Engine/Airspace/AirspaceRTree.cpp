@@ -0,0 +1,132 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#include "AirspaceRTree.hpp"
+
+#include <algorithm>
+
+/* the comparisons use the sum of both corners, which is twice the
+   center of the box */
+
+struct CompareCenterLongitude {
+  gcc_pure
+  bool operator()(const FlatBoundingBox &a, const FlatBoundingBox &b) const {
+    return a.GetLowerLeft().longitude + a.GetUpperRight().longitude <
+      b.GetLowerLeft().longitude + b.GetUpperRight().longitude;
+  }
+};
+
+struct CompareCenterLatitude {
+  gcc_pure
+  bool operator()(const FlatBoundingBox &a, const FlatBoundingBox &b) const {
+    return a.GetLowerLeft().latitude + a.GetUpperRight().latitude <
+      b.GetLowerLeft().latitude + b.GetUpperRight().latitude;
+  }
+};
+
+/**
+ * Sort the boxes in "Sort-Tile-Recursive" order: the range is sorted
+ * by longitude and cut into vertical slices of #group_size *
+ * #n_slices boxes, and each slice is sorted by latitude.  Groups of
+ * #group_size consecutive boxes then form compact tiles.
+ */
+template<typename Iterator>
+static void
+SortTiles(Iterator begin, Iterator end, unsigned group_size)
+{
+  const unsigned n = end - begin;
+  const unsigned n_groups = (n + group_size - 1) / group_size;
+
+  unsigned n_slices = 1;
+  while (n_slices * n_slices < n_groups)
+    ++n_slices;
+
+  std::sort(begin, end, CompareCenterLongitude());
+
+  const unsigned slice_size = n_slices * group_size;
+  for (unsigned i = 0; i < n; i += slice_size)
+    std::sort(begin + i, begin + std::min(i + slice_size, n),
+              CompareCenterLatitude());
+}
+
+template<typename T>
+void
+AirspaceRTree::AppendParents(const std::vector<T> &children,
+                             unsigned begin, unsigned end)
+{
+  for (unsigned i = begin; i < end; i += MAX_CHILDREN) {
+    const unsigned n = std::min(end - i, unsigned(MAX_CHILDREN));
+
+    /* copy the box before appending; #children may be the same
+       vector as #nodes */
+    FlatBoundingBox box = children[i];
+    for (unsigned j = i + 1; j < i + n; ++j)
+      box.Merge(children[j]);
+
+    nodes.emplace_back(box, i, n);
+  }
+}
+
+void
+AirspaceRTree::optimise()
+{
+  Invalidate();
+
+  if (items.empty())
+    return;
+
+  SortTiles(items.begin(), items.end(), MAX_CHILDREN);
+  AppendParents(items, 0, items.size());
+  height = 1;
+
+  unsigned level_begin = 0;
+  while (nodes.size() - level_begin > 1) {
+    const unsigned level_end = nodes.size();
+
+    SortTiles(nodes.begin() + level_begin, nodes.end(), MAX_CHILDREN);
+    AppendParents(nodes, level_begin, level_end);
+
+    level_begin = level_end;
+    ++height;
+  }
+}
+
+void
+AirspaceRTree::erase_exact(const Airspace &airspace)
+{
+  /* like kdtree++'s find_exact(), match the location and the
+     airspace */
+  auto i = items.begin();
+  while (i != items.end() &&
+         !(*i == airspace &&
+           i->GetLowerLeft() == airspace.GetLowerLeft() &&
+           i->GetUpperRight() == airspace.GetUpperRight()))
+    ++i;
+
+  assert(i != items.end());
+
+  /* the order is irrelevant until the next optimise() call */
+  *i = items.back();
+  items.pop_back();
+
+  Invalidate();
+}
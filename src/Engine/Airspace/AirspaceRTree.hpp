@@ -0,0 +1,346 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#ifndef XCSOAR_AIRSPACE_RTREE_HPP
+#define XCSOAR_AIRSPACE_RTREE_HPP
+
+#include "Airspace.hpp"
+#include "Geo/Flat/BoundingBoxDistance.hpp"
+#include "Util/Clamp.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <utility>
+
+#include <assert.h>
+
+/**
+ * A packed R-tree of #Airspace envelopes, bulk-loaded with the
+ * Sort-Tile-Recursive algorithm.  All nodes live in one contiguous
+ * array, and the leaves refer to ranges of the (sorted) airspace
+ * array, so a query touches only a few cache lines per level.
+ *
+ * Unlike a k-d tree over the four box coordinates, the R-tree prunes
+ * on the actual extent of the airspaces, which works much better for
+ * long thin airways and huge FIR polygons.
+ *
+ * The tree cannot be updated incrementally: insert() and
+ * erase_exact() only modify the airspace array, and optimise() must
+ * be called to rebuild the nodes.  Until then, queries fall back to
+ * a linear scan.
+ *
+ * The query methods are modelled after the subset of the kdtree++
+ * API used by #Airspaces, with the "bounding box" semantics of a
+ * non-positive range: a query returns all airspaces whose bounding
+ * box overlaps the target box expanded by the given range.
+ */
+class AirspaceRTree {
+public:
+  typedef Airspace value_type;
+  typedef const Airspace &const_reference;
+  typedef std::vector<Airspace>::const_iterator const_iterator;
+  typedef std::vector<Airspace>::size_type size_type;
+  typedef BBDist distance_type;
+
+  /**
+   * The maximum number of children of a node.
+   */
+  static constexpr unsigned MAX_CHILDREN = 16;
+
+private:
+  struct Node : FlatBoundingBox {
+    /**
+     * Index of the first child; this refers to #nodes for inner
+     * nodes and to #items for leaves.
+     */
+    unsigned first;
+
+    unsigned count;
+
+    Node(const FlatBoundingBox &box, unsigned _first, unsigned _count)
+      :FlatBoundingBox(box), first(_first), count(_count) {}
+  };
+
+  /**
+   * The airspaces; after optimise(), they are sorted so each leaf
+   * refers to a contiguous range.
+   */
+  std::vector<Airspace> items;
+
+  /**
+   * All nodes, level by level starting with the leaves; the root is
+   * the last element.  Empty if the tree needs to be rebuilt.
+   */
+  std::vector<Node> nodes;
+
+  /**
+   * The number of levels in #nodes.
+   */
+  unsigned height;
+
+public:
+  AirspaceRTree():height(0) {}
+
+  gcc_pure
+  const_iterator begin() const {
+    return items.begin();
+  }
+
+  gcc_pure
+  const_iterator end() const {
+    return items.end();
+  }
+
+  gcc_pure
+  size_type size() const {
+    return items.size();
+  }
+
+  gcc_pure
+  bool empty() const {
+    return items.empty();
+  }
+
+  void clear() {
+    items.clear();
+    nodes.clear();
+    height = 0;
+  }
+
+  /**
+   * Add an airspace.  The nodes are invalidated, call optimise()
+   * after inserting a batch of airspaces.
+   */
+  void insert(const Airspace &airspace) {
+    items.push_back(airspace);
+    Invalidate();
+  }
+
+  /**
+   * Remove the airspace which compares equal to the given one.  The
+   * nodes are invalidated, call optimise() after removing a batch of
+   * airspaces.
+   */
+  void erase_exact(const Airspace &airspace);
+
+  /**
+   * Bulk-load the nodes from the airspace array.
+   */
+  void optimise();
+
+  /**
+   * Call the visitor with all airspaces whose bounding box overlaps
+   * the target box expanded by the (non-positive) range.
+   */
+  template<typename Visitor>
+  void visit_within_range(const FlatBoundingBox &target, int range,
+                          Visitor &visitor) const {
+    const FlatBoundingBox box = ExpandTarget(target, range);
+
+    if (nodes.empty()) {
+      for (const auto &i : items)
+        if (IsOverlapping(i, box))
+          visitor(i);
+      return;
+    }
+
+    VisitOverlapping(nodes.size() - 1, height - 1, box, visitor);
+  }
+
+  /**
+   * Like visit_within_range(), but copy the matching airspaces to
+   * the output iterator.
+   */
+  template<typename OutputIterator>
+  OutputIterator find_within_range(const FlatBoundingBox &target, int range,
+                                   OutputIterator out) const {
+    OutputCopier<OutputIterator> copier(out);
+    visit_within_range(target, range, copier);
+    return copier.out;
+  }
+
+  /**
+   * Find the airspace matching the predicate whose bounding box is
+   * nearest to the target box, but not farther than #max.
+   *
+   * @return an iterator to the airspace (end() if none was found)
+   * and its distance
+   */
+  template<typename Predicate>
+  std::pair<const_iterator, distance_type>
+  find_nearest_if(const FlatBoundingBox &target, distance_type max,
+                  const Predicate &predicate) const {
+    NearestSearch<Predicate> search(target, max, predicate, items.end());
+
+    if (nodes.empty()) {
+      for (auto i = items.begin(), e = items.end(); i != e; ++i)
+        search.Check(i);
+    } else
+      SearchNearest(nodes.size() - 1, height - 1, search);
+
+    return std::make_pair(search.best, search.best_distance);
+  }
+
+private:
+  /**
+   * Append one parent node for each #MAX_CHILDREN consecutive
+   * elements of the specified range to #nodes.
+   */
+  template<typename T>
+  void AppendParents(const std::vector<T> &children,
+                     unsigned begin, unsigned end);
+
+  void Invalidate() {
+    nodes.clear();
+    height = 0;
+  }
+
+  gcc_pure
+  static FlatBoundingBox ExpandTarget(const FlatBoundingBox &target,
+                                      int range) {
+    assert(range <= 0);
+
+    const FlatGeoPoint &ll = target.GetLowerLeft();
+    const FlatGeoPoint &ur = target.GetUpperRight();
+    return FlatBoundingBox(FlatGeoPoint(ll.longitude + range,
+                                        ll.latitude + range),
+                           FlatGeoPoint(ur.longitude - range,
+                                        ur.latitude - range));
+  }
+
+  /**
+   * Inline version of FlatBoundingBox::Overlaps(), which is the
+   * innermost loop of all queries.
+   */
+  gcc_pure
+  static bool IsOverlapping(const FlatBoundingBox &a,
+                            const FlatBoundingBox &b) {
+    return a.GetLowerLeft().longitude <= b.GetUpperRight().longitude &&
+      a.GetUpperRight().longitude >= b.GetLowerLeft().longitude &&
+      a.GetLowerLeft().latitude <= b.GetUpperRight().latitude &&
+      a.GetUpperRight().latitude >= b.GetLowerLeft().latitude;
+  }
+
+  /**
+   * The distance between two boxes in the metric used by the kd-tree
+   * (squared Euclidean distance of the gaps).  The gaps are clipped
+   * so the square cannot overflow; this is far beyond any sensible
+   * search range.
+   */
+  gcc_pure
+  static distance_type BoxDistance(const FlatBoundingBox &a,
+                                   const FlatBoundingBox &b) {
+    const int dx = std::max(a.GetLowerLeft().longitude -
+                            b.GetUpperRight().longitude,
+                            b.GetLowerLeft().longitude -
+                            a.GetUpperRight().longitude);
+    const int dy = std::max(a.GetLowerLeft().latitude -
+                            b.GetUpperRight().latitude,
+                            b.GetLowerLeft().latitude -
+                            a.GetUpperRight().latitude);
+
+    distance_type d(0, Clamp(dx, 0, 0x7fff));
+    d += distance_type(1, Clamp(dy, 0, 0x7fff));
+    return d;
+  }
+
+  template<typename Visitor>
+  void VisitOverlapping(unsigned i, unsigned level, const FlatBoundingBox &box,
+                        Visitor &visitor) const {
+    const Node &node = nodes[i];
+    const unsigned end = node.first + node.count;
+
+    if (level == 0) {
+      for (unsigned j = node.first; j != end; ++j)
+        if (IsOverlapping(items[j], box))
+          visitor(items[j]);
+    } else {
+      for (unsigned j = node.first; j != end; ++j)
+        if (IsOverlapping(nodes[j], box))
+          VisitOverlapping(j, level - 1, box, visitor);
+    }
+  }
+
+  template<typename OutputIterator>
+  struct OutputCopier {
+    OutputIterator out;
+
+    explicit OutputCopier(OutputIterator _out):out(_out) {}
+
+    void operator()(const Airspace &airspace) {
+      *out++ = airspace;
+    }
+  };
+
+  template<typename Predicate>
+  struct NearestSearch {
+    const FlatBoundingBox &target;
+    const Predicate &predicate;
+
+    const_iterator best;
+    distance_type best_distance;
+    bool found;
+
+    NearestSearch(const FlatBoundingBox &_target, distance_type max,
+                  const Predicate &_predicate, const_iterator end)
+      :target(_target), predicate(_predicate),
+       best(end), best_distance(max), found(false) {}
+
+    /**
+     * Can the specified box contain a better candidate?
+     */
+    gcc_pure
+    bool IsCandidate(const FlatBoundingBox &box) const {
+      return BoxDistance(box, target) <= best_distance;
+    }
+
+    void Check(const_iterator i) {
+      const distance_type d = BoxDistance(*i, target);
+      if (found ? !(best_distance <= d) : d <= best_distance) {
+        if (!predicate(*i))
+          return;
+
+        best = i;
+        best_distance = d;
+        found = true;
+      }
+    }
+  };
+
+  template<typename Predicate>
+  void SearchNearest(unsigned i, unsigned level,
+                     NearestSearch<Predicate> &search) const {
+    const Node &node = nodes[i];
+    const unsigned end = node.first + node.count;
+
+    if (level == 0) {
+      for (unsigned j = node.first; j != end; ++j)
+        search.Check(items.begin() + j);
+    } else {
+      for (unsigned j = node.first; j != end; ++j)
+        if (search.IsCandidate(nodes[j]))
+          SearchNearest(j, level - 1, search);
+    }
+  }
+};
+
+#endif
@@ -22,6 +22,9 @@
 
 #include "AirspaceWarningManager.hpp"
 #include "Geo/GeoVector.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Geo/Math.hpp"
+#include "Geo/Flat/FlatRay.hpp"
 #include "Airspaces.hpp"
 #include "AirspaceCircle.hpp"
 #include "AirspacePolygon.hpp"
@@ -32,11 +35,33 @@
 
 #define CRUISE_FILTER_FACT fixed(0.5)
 
+/**
+ * An upper bound for the speed of the predicted paths [m/s].  The
+ * corridor is big enough for flying at this speed during the
+ * configured warning time, so a new prediction vector rarely leaves
+ * it.
+ */
+static constexpr unsigned CORRIDOR_SPEED = 100;
+
+/**
+ * The distance [m] the aircraft may fly before the candidate list
+ * needs to be rebuilt.
+ */
+static constexpr unsigned CORRIDOR_MARGIN = 5000;
+
+/**
+ * Corridors larger than this [m] are not worth a spatial query;
+ * all airspaces become candidates.
+ */
+static constexpr unsigned CORRIDOR_MAX_RADIUS = 200000;
+
 AirspaceWarningManager::AirspaceWarningManager(const Airspaces &_airspaces)
-  :airspaces(_airspaces)
+  :airspaces(_airspaces), corridor_radius(-1)
 {
   /* force filter initialisation in the first SetConfig() call */
   config.warning_time = -1;
+
+  statistics.Clear();
 }
 
 const TaskProjection &
@@ -56,6 +81,9 @@ AirspaceWarningManager::SetConfig(const AirspaceWarningConfig &_config)
   if (modified_warning_time) {
     SetPredictionTimeGlide(fixed(config.warning_time));
     SetPredictionTimeFilter(fixed(config.warning_time));
+
+    /* the corridor size depends on the warning time */
+    InvalidateCorridor();
   }
 }
 
@@ -63,6 +91,7 @@ void
 AirspaceWarningManager::Reset(const AircraftState &state)
 {
   warnings.clear();
+  InvalidateCorridor();
   cruise_filter.Reset(state);
   circling_filter.Reset(state);
 }
@@ -121,6 +150,9 @@ AirspaceWarningManager::Update(const AircraftState& state,
     return false;
   }
 
+  ++statistics.updates;
+  statistics.tests = 0;
+
   // save old state
   for (auto &w : warnings)
     w.SaveState();
@@ -149,6 +181,73 @@ AirspaceWarningManager::Update(const AircraftState& state,
   return changed;
 }
 
+void
+AirspaceWarningManager::UpdateCorridor(const GeoPoint &location,
+                                       const GeoPoint &end)
+{
+  if (!negative(corridor_radius) &&
+      airspaces_serial == airspaces.GetSerial() &&
+      corridor_center.Distance(location) <= corridor_radius &&
+      corridor_center.Distance(end) <= corridor_radius)
+    /* all candidates for this path are already known */
+    return;
+
+  corridor_center = location;
+  corridor_radius = std::max(location.Distance(end),
+                             fixed(config.warning_time) * CORRIDOR_SPEED)
+    + fixed(CORRIDOR_MARGIN);
+
+  if (corridor_radius > fixed(CORRIDOR_MAX_RADIUS)) {
+    candidates.assign(airspaces.begin(), airspaces.end());
+  } else {
+    GeoBounds bounds(location);
+    for (unsigned i = 0; i < 4; ++i)
+      bounds.Extend(FindLatitudeLongitude(location,
+                                          Angle::QuarterCircle() * i,
+                                          corridor_radius));
+
+    /* the flat projection is only exact at its center; widen the
+       query to be sure the whole circle is covered */
+    candidates = airspaces.FindOverlapping(bounds.Scale(fixed(1.25)));
+  }
+
+  airspaces_serial = airspaces.GetSerial();
+  ++statistics.refreshes;
+  statistics.candidates = candidates.size();
+}
+
+void
+AirspaceWarningManager::VisitIntersecting(const GeoPoint &location,
+                                          const GeoPoint &end,
+                                          AirspaceIntersectionVisitor &visitor)
+{
+  UpdateCorridor(location, end);
+  statistics.tests += candidates.size();
+
+  const TaskProjection &projection = GetProjection();
+  const FlatRay ray(projection.ProjectInteger(location),
+                    projection.ProjectInteger(end));
+
+  for (const auto &i : candidates)
+    if (i.Intersects(ray) &&
+        visitor.SetIntersections(i.Intersects(location, end, projection)))
+      visitor.Visit(i);
+}
+
+void
+AirspaceWarningManager::VisitInside(const GeoPoint &location,
+                                    AirspaceVisitor &visitor)
+{
+  UpdateCorridor(location, location);
+  statistics.tests += candidates.size();
+
+  const Airspace bb_target(location, GetProjection());
+
+  for (const auto &i : candidates)
+    if (i.Overlaps(bb_target) && i.IsInside(location))
+      visitor.Visit(i);
+}
+
 /**
  * Class used temporarily to check intersections with warning system
  */
@@ -287,10 +386,10 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
                                              warning_state, max_time_limit,
                                              ceiling);
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+  VisitIntersecting(state.location, location_predicted, visitor);
 
   visitor.SetMode(true);
-  airspaces.VisitInside(state.location, visitor);
+  VisitInside(state.location, visitor);
 
   return visitor.Found();
 }
@@ -381,10 +480,20 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   AirspacePredicateAircraftInside condition(state);
 
-  Airspaces::AirspaceVector results = airspaces.FindInside(state, condition);
-  for (const auto &i : results) {
+  UpdateCorridor(state.location, state.location);
+  statistics.tests += candidates.size();
+
+  const Airspace bb_target(state.location, GetProjection());
+
+  for (const auto &i : candidates) {
+    if (!i.Overlaps(bb_target))
+      continue;
+
     const AbstractAirspace& airspace = *i.GetAirspace();
 
+    if (!condition(airspace) || !i.IsInside(state))
+      continue;
+
     if (!airspace.IsActive())
       continue; // ignore inactive airspaces
 
@@ -25,16 +25,22 @@
 #include "Util/NonCopyable.hpp"
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
+#include "Airspace.hpp"
 #include "Util/AircraftStateFilter.hpp"
+#include "Util/Serial.hpp"
+#include "Geo/GeoPoint.hpp"
 #include "Compiler.h"
 
 #include <list>
+#include <vector>
 
 class TaskStats;
 class GlidePolar;
 class Airspaces;
 class TaskProjection;
 class AirspaceAircraftPerformance;
+class AirspaceVisitor;
+class AirspaceIntersectionVisitor;
 
 /**
  * Class to detect and track airspace warnings
@@ -46,6 +52,12 @@ class AirspaceAircraftPerformance;
  * - Climb Filter (longer range predicted warning based on low pass filtered state)
  * - Task (longer range predicted warning based on current leg of task)
  *
+ * All checks are performed on a cached list of candidate airspaces
+ * near the aircraft (the "corridor"), which is only rebuilt from the
+ * #Airspaces tree when a predicted path leaves the corridor, when the
+ * #Airspaces object is modified or when the warning time changes.
+ * In steady flight, the cost of an update therefore depends on the
+ * number of nearby airspaces, not on the size of the database.
  */
 class AirspaceWarningManager: 
   public NonCopyable
@@ -64,9 +76,66 @@ class AirspaceWarningManager:
 
   AirspaceWarningList warnings;
 
+  /**
+   * All airspaces whose bounding box overlaps the corridor.
+   */
+  std::vector<Airspace> candidates;
+
+  /**
+   * The center of the circle enclosing all locations the candidate
+   * list is valid for.
+   */
+  GeoPoint corridor_center;
+
+  /**
+   * The radius of the corridor [m].  Negative if the candidate list
+   * is invalid.
+   */
+  fixed corridor_radius;
+
+  /**
+   * The Airspaces::GetSerial() value the candidate list was built
+   * with.
+   */
+  Serial airspaces_serial;
+
 public:
   typedef AirspaceWarningList::const_iterator const_iterator;
 
+  /**
+   * Counters for checking the cost of Update().
+   */
+  struct Statistics {
+    /**
+     * The number of Update() calls.
+     */
+    unsigned updates;
+
+    /**
+     * The number of times the candidate list was rebuilt.
+     */
+    unsigned refreshes;
+
+    /**
+     * The number of airspaces in the candidate list.
+     */
+    unsigned candidates;
+
+    /**
+     * The number of candidates visited by the last Update() call.
+     */
+    unsigned tests;
+
+    void Clear() {
+      updates = refreshes = candidates = tests = 0;
+    }
+  };
+
+private:
+  Statistics statistics;
+
+public:
+
   /** 
    * Default constructor
    * 
@@ -85,6 +154,10 @@ public:
 
   void SetConfig(const AirspaceWarningConfig &_config);
 
+  const Statistics &GetStatistics() const {
+    return statistics;
+  }
+
   /**
    * Reset warning list and filter (as in new flight)
    *
@@ -221,6 +294,34 @@ public:
   bool GetAckDay(const AbstractAirspace& airspace) const;
 
 private:
+  /**
+   * Discard the candidate list; it will be rebuilt by the next
+   * Update() call.
+   */
+  void InvalidateCorridor() {
+    corridor_radius = fixed(-1);
+  }
+
+  /**
+   * Ensure that the candidate list covers the path from the current
+   * location to the specified predicted location, and rebuild it if
+   * not.
+   */
+  void UpdateCorridor(const GeoPoint &location, const GeoPoint &end);
+
+  /**
+   * Visit all candidates which intersect the line from #location to
+   * #end, like Airspaces::VisitIntersecting().
+   */
+  void VisitIntersecting(const GeoPoint &location, const GeoPoint &end,
+                         AirspaceIntersectionVisitor &visitor);
+
+  /**
+   * Visit all candidates which contain the location, like
+   * Airspaces::VisitInside().
+   */
+  void VisitInside(const GeoPoint &location, AirspaceVisitor &visitor);
+
   bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
                   const TaskStats &task_stats);
   bool UpdateFilter(const AircraftState& state, const bool circling);
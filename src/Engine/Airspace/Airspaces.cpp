@@ -28,6 +28,9 @@
 #include "Navigation/Aircraft.hpp"
 #include "Geo/Flat/FlatRay.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
+#include "Geo/GeoBounds.hpp"
+
+#include <assert.h>
 
 #ifdef INSTRUMENT_TASK
 extern unsigned n_queries;
@@ -176,6 +179,24 @@ Airspaces::ScanRange(const GeoPoint &location, fixed range,
   return res;
 }
 
+const Airspaces::AirspaceVector
+Airspaces::FindOverlapping(const GeoBounds &bounds) const
+{
+  AirspaceVector vectors;
+  if (empty())
+    return vectors;
+
+  const Airspace bb_target(bounds.GetSouthWest(), bounds.GetNorthEast(),
+                           task_projection);
+  airspace_tree.find_within_range(bb_target, 0, std::back_inserter(vectors));
+
+#ifdef INSTRUMENT_TASK
+  n_queries++;
+#endif
+
+  return vectors;
+}
+
 const Airspaces::AirspaceVector
 Airspaces::FindInside(const AircraftState &state,
                       const AirspacePredicate &condition) const
@@ -227,6 +248,8 @@ Airspaces::Optimise()
     }
     airspace_tree.optimise();
   }
+
+  ++serial;
 }
 
 void 
@@ -254,6 +277,18 @@ Airspaces::Add(AbstractAirspace *airspace)
   tmp_as.push_back(airspace);
 }
 
+void
+Airspaces::Merge(Airspaces &other)
+{
+  assert(owns_children == other.owns_children);
+  assert(other.airspace_tree.empty());
+
+  for (AbstractAirspace *airspace : other.tmp_as)
+    Add(airspace);
+
+  other.tmp_as.clear();
+}
+
 void
 Airspaces::clear()
 {
@@ -276,6 +311,8 @@ Airspaces::clear()
 
   // then delete the tree
   airspace_tree.clear();
+
+  ++serial;
 }
 
 unsigned
@@ -303,6 +340,8 @@ Airspaces::SetFlightLevels(const AtmosphericPressure &press)
 
     for (auto &v : airspace_tree)
       v.SetFlightLevel(press);
+
+    ++serial;
   }
 }
 
@@ -314,6 +353,8 @@ Airspaces::SetActivity(const AirspaceActivity mask)
 
     for (auto &v : airspace_tree)
       v.SetActivity(mask);
+
+    ++serial;
   }
 }
 
@@ -371,19 +412,8 @@ Airspaces::SynchroniseInRange(const Airspaces& master,
   // anything left in the self list are items that were not in the query,
   // so delete them --- including the clearances!
   for (auto v = contents_self.begin(); v != contents_self.end();) {
-    gcc_unused bool found = false;
-    for (auto t = airspace_tree.begin(); t != airspace_tree.end(); ) {
-      if (t->GetAirspace() == v->GetAirspace()) {
-        AirspaceTree::const_iterator new_t = t;
-        ++new_t;
-        airspace_tree.erase_exact(*t);
-        t = new_t;
-        found = true;
-      } else {
-        ++t;
-      }
-    }
-    assert(found);
+    /* this is a copy of the tree item, with the same bounding box */
+    airspace_tree.erase_exact(*v);
     v->ClearClearance();
     v = contents_self.erase(v);
     changed = true;
@@ -28,17 +28,27 @@
 #include "Util/NonCopyable.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Atmosphere/Pressure.hpp"
+#include "Util/Serial.hpp"
 #include "Compiler.h"
 
 #include <deque>
 
 class RasterTerrain;
+class GeoBounds;
 class AirspaceVisitor;
 class AirspaceIntersectionVisitor;
 
 /**
- * Container for airspaces using kd-tree representation internally for fast 
- * geospatial lookups.
+ * Container for airspaces using a packed R-tree (or optionally a
+ * kd-tree) internally for fast geospatial lookups.
+ *
+ * Complexity analysis (with R-tree, k airspaces found):
+ *
+ *    Find within range, intersecting, nearest:
+ *     O(log(n) + k) for well-separated airspaces
+ *
+ *    Optimise (bulk load):
+ *     O(n log(n))
  *
  * Complexity analysis (with kdtree):
  *   
@@ -70,6 +80,11 @@ class Airspaces:
 
   bool owns_children;
 
+  /**
+   * This gets incremented each time the object is modified.
+   */
+  Serial serial;
+
   AirspaceTree airspace_tree;
   TaskProjection task_projection;
 
@@ -92,6 +107,10 @@ public:
    */
   Airspaces(const Airspaces &master, bool owns_children);
 
+  const Serial &GetSerial() const {
+    return serial;
+  }
+
   /**
    * Destructor.
    * This also destroys Airspace objects contained in the tree or temporary buffer
@@ -107,6 +126,13 @@ public:
    */
   void Add(AbstractAirspace *asp);
 
+  /**
+   * Move all airspaces which were added to another object (and not
+   * yet optimised there) to this one.  This allows loading several
+   * files into separate objects concurrently.
+   */
+  void Merge(Airspaces &other);
+
   /** 
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
@@ -213,6 +239,13 @@ public:
                                  const AirspacePredicate &condition =
                                        AirspacePredicate::always_true) const;
 
+  /**
+   * Find all airspaces whose bounding box overlaps the specified
+   * geographic bounds.
+   */
+  gcc_pure
+  const AirspaceVector FindOverlapping(const GeoBounds &bounds) const;
+
   /** 
    * Find airspaces the aircraft is inside (taking altitude into account)
    * 
@@ -24,6 +24,7 @@
 
 #include "Util/SliceAllocator.hpp"
 #include "Airspace.hpp"
+#include "AirspaceRTree.hpp"
 #include "Geo/Flat/BoundingBoxDistance.hpp"
 
 #include <kdtree++/kdtree.hpp>
@@ -98,7 +99,18 @@ public:
                          kd_get_bounds, kd_distance,
                          std::less<kd_get_bounds::result_type>,
                          SliceAllocator<KDTree::_Node<Airspace>, 256>
-                         > AirspaceTree;
+                         > AirspaceKDTree;
+
+  /**
+   * The spatial index used by the airspace container; the R-tree
+   * unless the kd-tree was selected at build time with
+   * AIRSPACE_TREE=kdtree.
+   */
+#ifdef AIRSPACE_KDTREE
+  typedef AirspaceKDTree AirspaceTree;
+#else
+  typedef AirspaceRTree AirspaceTree;
+#endif
 };
 
 #endif
@@ -37,5 +37,7 @@ Airspaces::SetGroundLevels(const RasterTerrain &terrain)
     if (!RasterBuffer::IsSpecial(h))
       v.SetGroundLevel((fixed)h);
   }
+
+  ++serial;
 }
 
@@ -23,11 +23,13 @@
 #include "ContestManager.hpp"
 #include "Trace/Trace.hpp"
 
+#include <assert.h>
+
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
                                const Trace &trace_sprint,
                                bool predict_triangle)
-  :contest(_contest),
+  :contest(_contest), executor(NULL),
    olc_sprint(trace_sprint),
    olc_fai(trace_full, predict_triangle),
    olc_classic(trace_full),
@@ -116,6 +118,52 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+class ContestManager::SolveJob final : public Executor::Job {
+  AbstractContest *const *solvers;
+  const unsigned *slots;
+  ContestStatistics &stats;
+  bool *updated;
+  const bool exhaustive;
+
+public:
+  SolveJob(AbstractContest *const *_solvers, const unsigned *_slots,
+           ContestStatistics &_stats, bool *_updated, bool _exhaustive)
+    :solvers(_solvers), slots(_slots), stats(_stats),
+     updated(_updated), exhaustive(_exhaustive) {}
+
+  virtual void Process(unsigned i) override {
+    updated[i] = RunContest(*solvers[i], stats.result[slots[i]],
+                            stats.solution[slots[i]], exhaustive);
+  }
+};
+
+bool
+ContestManager::RunContests(AbstractContest &a, unsigned a_slot,
+                            AbstractContest &b, unsigned b_slot,
+                            bool exhaustive)
+{
+  assert(a_slot != b_slot);
+
+  if (executor == NULL) {
+    bool retval = RunContest(a, stats.result[a_slot],
+                             stats.solution[a_slot], exhaustive);
+    retval |= RunContest(b, stats.result[b_slot],
+                         stats.solution[b_slot], exhaustive);
+    return retval;
+  }
+
+  /* each solver has its own state and writes its own result slot;
+     the traces are shared, but only read */
+  AbstractContest *const solvers[2] = { &a, &b };
+  const unsigned slots[2] = { a_slot, b_slot };
+  bool updated[2];
+
+  SolveJob job(solvers, slots, stats, updated, exhaustive);
+  executor->Run(job, 2);
+
+  return updated[0] || updated[1];
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive)
 {
@@ -148,11 +196,7 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(olc_classic, 0, olc_fai, 1, exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -170,17 +214,11 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(xcontest_free, 0, xcontest_triangle, 1, exhaustive);
     break;
 
   case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(dhv_xc_free, 0, dhv_xc_triangle, 1, exhaustive);
     break;
 
   case Contest::SIS_AT:
@@ -45,8 +45,41 @@ class ContestManager
 {
   friend class PrintHelper;
 
+public:
+  /**
+   * Runs a batch of independent solvers, possibly in parallel.  This
+   * allows plugging a thread pool into the engine, which doesn't
+   * know about threads.
+   */
+  class Executor {
+  public:
+    class Job {
+    public:
+      /**
+       * Run one solver.  This may be called from any thread,
+       * concurrently with the other items of the batch.
+       */
+      virtual void Process(unsigned i) = 0;
+    };
+
+    /**
+     * Call Job::Process() for all items [0, n), and return after all
+     * of them are finished.
+     */
+    virtual void Run(Job &job, unsigned n) = 0;
+  };
+
+private:
+  class SolveJob;
+
   Contest contest;
 
+  /**
+   * Runs the independent solvers of a contest; NULL runs them one
+   * after another.
+   */
+  Executor *executor;
+
   ContestStatistics stats;
 
   OLCSprint olc_sprint;
@@ -80,6 +113,18 @@ public:
 
   void SetIncremental(bool incremental);
 
+  /**
+   * Run the independent solvers of a contest (e.g. OLC Classic and
+   * FAI for OLC Plus) with the specified #Executor from now on.
+   * They only read the traces, which must not be modified until
+   * UpdateIdle() returns.
+   *
+   * @param executor the executor, or NULL to run them sequentially
+   */
+  void SetExecutor(Executor *_executor) {
+    executor = _executor;
+  }
+
   /**
    * @see ContestDijkstra::SetPredicted()
    */
@@ -101,6 +146,19 @@ public:
    */
   bool UpdateIdle(bool exhaustive = false);
 
+private:
+  /**
+   * Run two independent solvers with the #Executor, writing to the
+   * specified #stats slots.
+   *
+   * @return true if one of the results has changed
+   */
+  bool RunContests(AbstractContest &a, unsigned a_slot,
+                   AbstractContest &b, unsigned b_slot,
+                   bool exhaustive);
+
+public:
+
   bool SolveExhaustive() {
     return UpdateIdle(true);
   }
@@ -27,6 +27,7 @@ Copyright_License {
 #include "Cast.hpp"
 
 #include <algorithm>
+#include <iterator>
 #include <assert.h>
 #include <limits.h>
 
@@ -42,6 +43,7 @@ ContestDijkstra::ContestDijkstra(const Trace &_trace,
    trace_master(_trace),
    continuous(_continuous),
    incremental(false),
+   n_full_solves(0), n_incremental_solves(0),
    predicted(TracePoint::Invalid())
 {
   assert(num_stages <= MAX_STAGES);
@@ -75,12 +77,18 @@ ContestDijkstra::SetPredicted(const TracePoint &_predicted)
   return result;
 }
 
+bool
+ContestDijkstra::IsMasterModified() const
+{
+  return modify_serial != trace_master.GetModifySerial();
+}
+
 bool
 ContestDijkstra::IsMasterUpdated() const
 {
   assert(num_stages <= MAX_STAGES);
 
-  if (modify_serial != trace_master.GetModifySerial())
+  if (IsMasterModified())
     return true;
 
   if (continuous)
@@ -109,9 +117,22 @@ ContestDijkstra::ClearTrace()
   trace_dirty = true;
   finished = false;
   trace.clear();
+  trace_times.clear();
   n_points = 0;
 }
 
+/**
+ * Copy the time stamps of the specified #TracePointerVector range.
+ */
+static void
+AppendTimes(std::vector<unsigned> &times,
+            TracePointerVector::const_iterator begin,
+            TracePointerVector::const_iterator end)
+{
+  for (auto i = begin; i != end; ++i)
+    times.push_back((*i)->GetTime());
+}
+
 void
 ContestDijkstra::UpdateTraceFull()
 {
@@ -119,6 +140,10 @@ ContestDijkstra::UpdateTraceFull()
   trace_master.GetPoints(trace);
   n_points = trace.size();
 
+  trace_times.clear();
+  trace_times.reserve(trace.capacity());
+  AppendTimes(trace_times, trace.begin(), trace.end());
+
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
 
@@ -139,6 +164,7 @@ ContestDijkstra::UpdateTraceTail()
     /* no new points */
     return false;
 
+  AppendTimes(trace_times, std::next(trace.begin(), n_points), trace.end());
   n_points = trace.size();
 
   if (n_points > 0 && predicted.IsDefined())
@@ -156,7 +182,17 @@ ContestDijkstra::UpdateTrace(bool force)
     return;
 
   if (IsMasterUpdated()) {
-    UpdateTraceFull();
+    if (incremental && continuous && !trace_dirty) {
+      /* the master Trace has been thinned; attempt to keep the
+         Dijkstra state */
+      std::vector<unsigned> old_times;
+      old_times.swap(trace_times);
+
+      UpdateTraceFull();
+      if (RemapTrace(old_times))
+        return;
+    } else
+      UpdateTraceFull();
 
     trace_dirty = true;
     finished = false;
@@ -218,6 +254,7 @@ ContestDijkstra::Solve(bool exhaustive)
   if (trace_dirty) {
     trace_dirty = false;
     finished = false;
+    ++n_full_solves;
 
     dijkstra.Clear();
     dijkstra.Reserve(CONTEST_QUEUE_SIZE);
@@ -383,10 +420,10 @@ ContestDijkstra::AddIncrementalEdges(unsigned first_point)
   assert(first_point < n_points);
   assert(continuous);
   assert(incremental);
-  assert(finished);
 
   finished = false;
   first_finish_candidate = first_point;
+  ++n_incremental_solves;
 
   /* we need a copy of the current edge map, because the following
      loop will modify it, invalidating the iterator */
@@ -414,6 +451,154 @@ ContestDijkstra::AddIncrementalEdges(unsigned first_point)
   AddStartEdges();
 }
 
+/**
+ * Marks a point which was removed from the trace.
+ */
+static constexpr unsigned REMOVED_POINT = 0 - 1;
+
+/**
+ * Renumbers the Dijkstra nodes after points were removed from the
+ * trace.
+ */
+class TraceRemapper {
+  const std::vector<unsigned> &index_map;
+
+  /**
+   * Like #index_map, but for the start stage; it also drops start
+   * points which are too high for the current finish.
+   */
+  const std::vector<unsigned> &start_map;
+
+  const unsigned predicted_index;
+  const unsigned final_stage, dirty_stage;
+
+public:
+  TraceRemapper(const std::vector<unsigned> &_index_map,
+                const std::vector<unsigned> &_start_map,
+                unsigned _predicted_index,
+                unsigned _final_stage, unsigned _dirty_stage)
+    :index_map(_index_map), start_map(_start_map),
+     predicted_index(_predicted_index),
+     final_stage(_final_stage), dirty_stage(_dirty_stage) {}
+
+  gcc_pure
+  unsigned Map(ScanTaskPoint p) const {
+    const unsigned i = p.GetPointIndex();
+    if (i == predicted_index)
+      return i;
+
+    assert(i < index_map.size());
+    return p.GetStageNumber() == 0 ? start_map[i] : index_map[i];
+  }
+
+  template<typename Edge>
+  bool operator()(ScanTaskPoint &node, Edge &edge) const {
+    /* all nodes from the dirty stage on will be searched again; only
+       finish nodes are kept if their parent is still valid */
+    const unsigned stage = node.GetStageNumber();
+    if (stage >= dirty_stage &&
+        (stage != final_stage ||
+         edge.parent.GetStageNumber() >= dirty_stage))
+      return false;
+
+    const unsigned point = Map(node);
+    const unsigned parent = Map(edge.parent);
+    if (point == REMOVED_POINT || parent == REMOVED_POINT)
+      return false;
+
+    node.SetPointIndex(point);
+    edge.parent.SetPointIndex(parent);
+    return true;
+  }
+};
+
+bool
+ContestDijkstra::RemapTrace(const std::vector<unsigned> &old_times)
+{
+  assert(continuous);
+  assert(incremental);
+  assert(trace_times.size() == n_points);
+
+  if (old_times.empty() || n_points < num_stages ||
+      dijkstra.GetEdgeMap().empty())
+    return false;
+
+  /* the new trace must consist of a subset of the old points,
+     followed by new points */
+  std::vector<unsigned> index_map(old_times.size(), REMOVED_POINT);
+  unsigned n_kept = 0;
+  for (unsigned i = 0; i < old_times.size() && n_kept < n_points; ++i) {
+    if (old_times[i] == trace_times[n_kept])
+      index_map[i] = n_kept++;
+    else if (old_times[i] > trace_times[n_kept])
+      /* a point which was not in the old trace */
+      return false;
+  }
+
+  if (n_kept < n_points && trace_times[n_kept] <= old_times.back())
+    return false;
+
+  /* drop the start points which AddStartEdges() would not accept
+     for the current finish */
+  std::vector<unsigned> start_map(index_map);
+  const int max_altitude = GetMaximumStartAltitude(GetPoint(n_points - 1));
+  for (auto &i : start_map)
+    if (i != REMOVED_POINT && GetPoint(i).GetIntegerAltitude() > max_altitude)
+      i = REMOVED_POINT;
+
+  /* find the first stage which contains a node whose parent was
+     removed; all paths ending before it are still optimal, because
+     removing points cannot improve them */
+  const unsigned final_stage = num_stages - 1;
+  const TraceRemapper probe(index_map, start_map, predicted_index,
+                            final_stage, num_stages);
+  unsigned dirty_stage = num_stages;
+  for (const auto &i : dijkstra.GetEdgeMap()) {
+    const unsigned stage = i.first.GetStageNumber();
+    if (stage < dirty_stage && stage != final_stage &&
+        probe.Map(i.first) != REMOVED_POINT &&
+        probe.Map(i.second.parent) == REMOVED_POINT)
+      dirty_stage = stage;
+  }
+
+  TraceRemapper remapper(index_map, start_map, predicted_index,
+                         final_stage, dirty_stage);
+  dijkstra.Remap(remapper);
+
+  bool requeued = false;
+  if (dirty_stage < num_stages) {
+    /* expand the last intact stage again to rebuild the dirty ones */
+    assert(dirty_stage > 0);
+
+    for (const auto &i : dijkstra.GetEdgeMap())
+      if (i.first.GetStageNumber() + 1 == dirty_stage)
+        requeued |= dijkstra.Enqueue(i.first);
+  }
+
+  /* the first finish candidate which is still in the trace */
+  unsigned finish_candidate = n_kept;
+  for (unsigned i = first_finish_candidate; i < old_times.size(); ++i) {
+    if (index_map[i] != REMOVED_POINT) {
+      finish_candidate = index_map[i];
+      break;
+    }
+  }
+
+  const bool was_finished = finished;
+  if (n_kept < n_points)
+    AddIncrementalEdges(n_kept);
+  else if (requeued) {
+    finished = false;
+    ++n_incremental_solves;
+  }
+
+  if (!was_finished || n_kept == n_points)
+    /* the search for the old finish candidates is not over yet */
+    first_finish_candidate = std::min(finish_candidate, n_points - 1);
+
+  return true;
+}
+
 void
 ContestDijkstra::CopySolution(ContestTraceVector &result) const
 {
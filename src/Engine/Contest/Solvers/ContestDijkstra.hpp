@@ -29,6 +29,7 @@ Copyright_License {
 #include "PathSolvers/NavDijkstra.hpp"
 #include "Trace/Vector.hpp"
 
+#include <vector>
 #include <assert.h>
 
 class Trace;
@@ -89,6 +90,24 @@ private:
    */
   TracePointerVector trace;
 
+  /**
+   * The time stamps of all #trace elements.  When the master Trace
+   * gets thinned, the pointers in #trace become invalid, and these
+   * are used to find out which points were removed.
+   */
+  std::vector<unsigned> trace_times;
+
+  /**
+   * The number of searches which were started from scratch.
+   */
+  unsigned n_full_solves;
+
+  /**
+   * The number of searches which were resumed with the existing
+   * Dijkstra state after the trace was extended or thinned.
+   */
+  unsigned n_incremental_solves;
+
   /**
    * The last solution.  Use only if Solve() has returned VALID.
    */
@@ -138,6 +157,14 @@ public:
    */
   bool SetPredicted(const TracePoint &_predicted);
 
+  unsigned GetFullSolveCount() const {
+    return n_full_solves;
+  }
+
+  unsigned GetIncrementalSolveCount() const {
+    return n_incremental_solves;
+  }
+
 protected:
   bool IsIncremental() const {
     return incremental;
@@ -157,6 +184,28 @@ protected:
 
   void ClearTrace();
 
+  /**
+   * Has the trace changed since the last call?  This is for solvers
+   * which implement their own search instead of the Dijkstra search;
+   * if it returns true, they start from scratch, and this is counted
+   * as a full solve.
+   */
+  bool CheckTraceDirty() {
+    const bool result = trace_dirty;
+    trace_dirty = false;
+    if (result)
+      ++n_full_solves;
+    return result;
+  }
+
+  /**
+   * Has the master #Trace been thinned since the copy was obtained?
+   * Then the points of the copy are invalid, and it must be updated
+   * before they are used again.
+   */
+  gcc_pure
+  bool IsMasterModified() const;
+
   /**
    * Obtain a new #Trace copy.
    */
@@ -169,11 +218,24 @@ protected:
    */
   bool UpdateTraceTail();
 
+  /**
+   * Adapt the Dijkstra state to a new copy of the master Trace, after
+   * it has been thinned.  Nodes which refer to a removed point are
+   * dropped, and only the stages whose best paths went through such a
+   * node are searched again.
+   *
+   * @param old_times the time stamps of the previous trace copy
+   * @return false if the new trace is not a thinned version of the
+   * old one, and the search must be restarted
+   */
+  bool RemapTrace(const std::vector<unsigned> &old_times);
+
   void AddEdges(ScanTaskPoint origin, unsigned first_point);
 
   /**
    * Restart the solver with the new points added by
-   * UpdateTraceTail().
+   * UpdateTraceTail() or RemapTrace().  This may also be called while
+   * a search is still in progress.
    *
    * @param first_point the first point that was added
    */
@@ -23,24 +23,27 @@
 #include "OLCTriangle.hpp"
 #include "Cast.hpp"
 #include "Trace/Trace.hpp"
+#include "Math/FastMath.h"
 
-/*
- @todo potential to use 3d convex hull to speed search
+#include <algorithm>
 
- 2nd point inclusion rules:
-   if min leg length is 25%, max is 45%
-   pmin = 0.25
-   pmax = 0.45
-   ptot = 2*pmin+pmax+0.05
-   with 2 legs:
-      ptot = pmin+pmax
+/*
+ The search works on triples of trace point index ranges, one for
+ each turn point.  The bounding boxes of the ranges give an upper
+ bound for the perimeter of all triangles within a triple, and
+ triples which can't beat the best triangle found so far are
+ dropped.  The others are split in halves, most promising triple
+ first, until they are small enough to check each triangle.
 
+ The triangle must be flown between a start and a finish point which
+ are close to each other.  The start may be any point before the
+ first turn point, and the finish any point after the third one.
 
   0: start
-  1: first leg start
-  2: second leg start
-  3: third leg start
-  4: end
+  1: first turn point
+  2: second turn point
+  3: third turn point
+  4: finish
 */
 
 /**
@@ -54,13 +57,24 @@
  */
 static constexpr fixed max_distance(5000);
 
+/**
+ * Triples with no more than this number of triangles are checked
+ * one by one.
+ */
+static constexpr uint64_t SCAN_TRIANGLES = 64;
+
+/**
+ * The number of triples which are split or scanned in one
+ * non-exhaustive Solve() call.
+ */
+static constexpr unsigned SEARCH_STEPS = 1000;
+
 OLCTriangle::OLCTriangle(const Trace &_trace,
                          const bool _is_fai, bool _predict)
   :ContestDijkstra(_trace, false, 3, 1000),
    is_fai(_is_fai), predict(_predict),
-   is_closed(false),
    is_complete(false),
-   first_tp(0)
+   fai_45_limit(0), best_distance(0)
 {
 }
 
@@ -68,10 +82,9 @@ void
 OLCTriangle::Reset()
 {
   ContestDijkstra::Reset();
+  ClearSearch();
   is_complete = false;
-  is_closed = false;
-  first_tp = 0;
-  best_d = 0;
+  triangle.clear();
 }
 
 gcc_pure
@@ -82,105 +95,45 @@ CalcLegDistance(const ContestTraceVector &solution, const unsigned index)
   // leg 1: 2-3
   // leg 2: 3-1
 
-  const GeoPoint &p_start = solution[index].GetLocation();
-  const GeoPoint &p_dest = solution[index < 2 ? index + 1 : 0].GetLocation();
+  const GeoPoint &p_start = solution[index + 1].GetLocation();
+  const GeoPoint &p_dest = solution[index < 2 ? index + 2 : 1].GetLocation();
 
   return p_start.Distance(p_dest);
 }
 
-bool
-OLCTriangle::IsPathClosed() const
-{
-
-  // RESERVED FOR FUTURE USE: DO NOT DELETE
-
-  // note this may fail if resolution of sampled trace is too low
-  assert(n_points > 0);
-
-  const GeoPoint end_location = GetPoint(n_points - 1).GetLocation();
-
-  fixed d_min(-1);
-
-  assert(first_tp < n_points);
-
-  for (unsigned start_index = 0; start_index <= first_tp; ++start_index) {
-    const fixed d_this =
-      GetPoint(start_index).GetLocation().Distance(end_location);
-
-    if (!positive(d_min) || d_this < d_min)
-      d_min = d_this;
-
-    if (d_this <= max_distance)
-      return true;
-  }
-
-  return false;
-}
-
-class TriangleSecondLeg {
-  const bool is_fai;
-  const SearchPoint a, b;
-  const unsigned df_1;
-
-public:
-  TriangleSecondLeg(bool _fai, const SearchPoint &_a, const SearchPoint &_b)
-    :is_fai(_fai), a(_a), b(_b), df_1(a.FlatDistanceTo(b)) {}
-
-  struct Result {
-    unsigned leg_distance, total_distance;
-
-    Result(unsigned _leg, unsigned _total)
-      :leg_distance(_leg), total_distance(_total) {}
-  };
-
-  gcc_pure
-  Result Calculate(const SearchPoint &c, unsigned best) const;
-};
-
-TriangleSecondLeg::Result
-TriangleSecondLeg::Calculate(const SearchPoint &c, unsigned best) const
+unsigned
+OLCTriangle::CheckTriangle(bool is_fai, const SearchPoint &a,
+                           const SearchPoint &b, const SearchPoint &c,
+                           unsigned df_1, unsigned df_2, unsigned df_3)
 {
-  // this is a heuristic to remove invalid triangles
-  // we do as much of this in flat projection for speed
-
-  const unsigned df_2 = b.FlatDistanceTo(c);
-  const unsigned df_3 = c.FlatDistanceTo(a);
-  const unsigned df_total = df_1+df_2+df_3;
+  const unsigned df_total = df_1 + df_2 + df_3;
 
   // require some distance!
-  if (df_total<20) {
-    return Result(0, 0);
-  }
-
-  // no point scanning if worst than best
-  if (df_total<= best) {
-    return Result(0, 0);
-  }
+  if (df_total < 20)
+    return 0;
 
   const unsigned shortest = std::min({df_1, df_2, df_3});
 
   // require all legs to have distance
   if (!shortest)
-    return Result(0, 0);
-
-  if (is_fai && (shortest*4<df_total))
-    // fails min < 25% worst-case rule!
-    return Result(0, 0);
-
-  const unsigned d = df_3 + df_2;
+    return 0;
 
   // without FAI rules, allow any triangle
   if (!is_fai)
-    return Result(d, df_total);
+    return df_total;
+
+  if (shortest * 4 < df_total)
+    // fails min < 25% worst-case rule!
+    return 0;
 
   if (shortest * 25 >= df_total * 7)
     // passes min > 28% rule,
     // this automatically means we pass max > 45% worst-case
-    return Result(d, df_total);
+    return df_total;
 
   const unsigned longest = std::max({df_1, df_2, df_3});
   if (longest * 20 > df_total * 9) // fails max > 45% worst-case rule!
-    return Result(0, 0);
+    return 0;
 
   // passed basic tests, now detailed ones
 
@@ -190,130 +143,397 @@ TriangleSecondLeg::Calculate(const SearchPoint &c, unsigned best) const
     leg = a.GetLocation().Distance(b.GetLocation());
   else if (df_2 == shortest)
     leg = b.GetLocation().Distance(c.GetLocation());
-  else if (df_3 == shortest)
+  else
     leg = c.GetLocation().Distance(a.GetLocation());
 
   // estimate total distance by scaling.
   // this is a slight approximation, but saves having to do
   // three accurate distance calculations.
 
-  const fixed d_total(df_total* leg / shortest);
-  if (d_total >= fixed(500000)) {
+  const fixed d_total(df_total * leg / shortest);
+  if (d_total >= fixed(500000))
     // long distance, ok that it failed 28% rule
-    return Result(d, df_total);
-  }
+    return df_total;
+
+  return 0;
+}
+
+/**
+ * The largest flat distance between a point in one box and a point
+ * in the other.
+ */
+gcc_pure
+static unsigned
+MaxDistance(const FlatBoundingBox &a, const FlatBoundingBox &b)
+{
+  const int dx =
+    std::max(a.GetUpperRight().longitude - b.GetLowerLeft().longitude,
+             b.GetUpperRight().longitude - a.GetLowerLeft().longitude);
+  const int dy =
+    std::max(a.GetUpperRight().latitude - b.GetLowerLeft().latitude,
+             b.GetUpperRight().latitude - a.GetLowerLeft().latitude);
+  return ihypot(dx, dy);
+}
+
+/**
+ * The smallest flat distance between a point in one box and a point
+ * in the other.
+ */
+gcc_pure
+static unsigned
+MinDistance(const FlatBoundingBox &a, const FlatBoundingBox &b)
+{
+  const int dx =
+    std::max({0, b.GetLowerLeft().longitude - a.GetUpperRight().longitude,
+              a.GetLowerLeft().longitude - b.GetUpperRight().longitude});
+  const int dy =
+    std::max({0, b.GetLowerLeft().latitude - a.GetUpperRight().latitude,
+              a.GetLowerLeft().latitude - b.GetUpperRight().latitude});
+  return ihypot(dx, dy);
+}
+
+/**
+ * Can a triangle with these legs be longer than 45% of the total?
+ * For FAI triangles shorter than 500 km, that is not allowed.
+ */
+gcc_const
+static bool
+IsLegTooLong(unsigned min_leg, unsigned max_other1, unsigned max_other2)
+{
+  /* leg > 0.45 * (leg + other1 + other2) */
+  return 11 * min_leg > 9 * (max_other1 + max_other2);
+}
 
-  return Result(0, 0);
+/**
+ * Must a triangle with these legs have one shorter than 25% of the
+ * total?  That is not allowed for FAI triangles.
+ */
+gcc_const
+static bool
+IsLegTooShort(unsigned max_leg, unsigned min_other1, unsigned min_other2)
+{
+  /* leg < 0.25 * (leg + other1 + other2) */
+  return 3 * max_leg < min_other1 + min_other2;
 }
 
+gcc_pure
+static unsigned
+GetExtent(const FlatBoundingBox &box)
+{
+  return std::max(box.GetUpperRight().longitude - box.GetLowerLeft().longitude,
+                  box.GetUpperRight().latitude - box.GetLowerLeft().latitude);
+}
+
+gcc_const
+static unsigned
+Log2(unsigned x)
+{
+  unsigned result = 0;
+  while (x >>= 1)
+    ++result;
+  return result;
+}
 
 void
-OLCTriangle::AddStartEdges()
+OLCTriangle::FindClosingPairs()
 {
-  // use last point as single start,
-  // this is out of order but required
+  last_finish.GrowDiscard(n_points);
+  first_start.GrowDiscard(n_points);
+
+  unsigned reach = 0, reach_start = 0;
+  for (unsigned start = 0; start < n_points; ++start) {
+    if (reach < start) {
+      reach = start;
+      reach_start = start;
+    }
+
+    const TracePoint &start_point = GetPoint(start);
+    const unsigned max_range =
+      trace_master.ProjectRange(start_point.GetLocation(), max_distance);
+
+    /* find the last point which is close enough to this start; only
+       points after the previous maximum are interesting, because the
+       turn points may follow any earlier start */
+    for (unsigned i = n_points - 1; i > reach; --i) {
+      const TracePoint &point = GetPoint(i);
+      if (start_point.FlatDistanceTo(point) <= max_range &&
+          start_point.GetLocation().Distance(point.GetLocation()) < max_distance) {
+        reach = i;
+        reach_start = start;
+        break;
+      }
+    }
 
-  ScanTaskPoint destination(0, n_points - 1);
-  LinkStart(destination);
+    last_finish[start] = reach;
+    first_start[start] = reach_start;
+  }
 }
 
 void
-OLCTriangle::AddTurn1Edges(const ScanTaskPoint origin)
+OLCTriangle::FillBoxes()
 {
-  // add points up to finish
+  const unsigned n_levels = Log2(n_points) + 1;
+  boxes.GrowDiscard(n_levels * n_points);
 
-  const ScanTaskPoint begin(origin.GetStageNumber() + 1, 0);
-  const ScanTaskPoint end(origin.GetStageNumber() + 1, origin.GetPointIndex());
+  for (unsigned i = 0; i < n_points; ++i)
+    boxes[i] = FlatBoundingBox(GetPoint(i).GetFlatLocation());
 
-  for (ScanTaskPoint i = begin; i != end; i.IncrementPointIndex()) {
-    const unsigned d = CalcEdgeDistance(origin, i);
+  for (unsigned k = 1, size = 2; k < n_levels; ++k, size *= 2) {
+    const FlatBoundingBox *const previous = &boxes[(k - 1) * n_points];
+    FlatBoundingBox *const level = &boxes[k * n_points];
 
-    if (!is_fai || 4 * d >= best_d)
-      /* no reason to add candidate if worse than 25% rule for FAI
-         tasks */
-      Link(i, origin, GetStageWeight(origin.GetStageNumber()) * d);
+    for (unsigned i = 0; i + size <= n_points; ++i) {
+      level[i] = previous[i];
+      level[i].Merge(previous[i + size / 2]);
+    }
   }
 }
 
-void
-OLCTriangle::AddTurn2Edges(const ScanTaskPoint origin)
+FlatBoundingBox
+OLCTriangle::GetBox(const Range &range) const
+{
+  assert(range.begin < range.end);
+
+  const unsigned k = Log2(range.GetSize());
+  const FlatBoundingBox *const level = &boxes[k * n_points];
+
+  FlatBoundingBox box = level[range.begin];
+  box.Merge(level[range.end - (1u << k)]);
+  return box;
+}
+
+bool
+OLCTriangle::Prepare(Candidates &c) const
 {
-  ScanTaskPoint previous = dijkstra.GetPredecessor(origin);
+  Range *const r = c.ranges;
+
+  /* the third turn point must be before the last finish of the
+     latest first turn point */
+  r[2].end = std::min(r[2].end, GetLastFinish(r[0].end - 1) + 1);
+
+  /* the turn points must be in chronological order */
+  r[1].begin = std::max(r[1].begin, r[0].begin + 1);
+  r[2].begin = std::max(r[2].begin, r[1].begin + 1);
+  r[1].end = std::min(r[1].end, r[2].end - 1);
+  r[0].end = std::min(r[0].end, r[1].end - 1);
+
+  for (unsigned i = 0; i < 3; ++i)
+    if (r[i].begin >= r[i].end)
+      return false;
+
+  FlatBoundingBox box[3];
+  c.split = 3;
+  unsigned max_extent = 0;
+  for (unsigned i = 0; i < 3; ++i) {
+    box[i] = GetBox(r[i]);
+
+    if (r[i].GetSize() > 1) {
+      const unsigned extent = GetExtent(box[i]);
+      if (c.split == 3 || extent > max_extent) {
+        c.split = i;
+        max_extent = extent;
+      }
+    }
+  }
+
+  const unsigned d_01 = MaxDistance(box[0], box[1]);
+  const unsigned d_12 = MaxDistance(box[1], box[2]);
+  const unsigned d_20 = MaxDistance(box[2], box[0]);
+
+  c.bound = d_01 + d_12 + d_20;
+  if (!is_fai)
+    return c.bound > best_distance;
+
+  /* the shortest leg must have at least 25% */
+  c.bound = std::min(c.bound, 4 * std::min({d_01, d_12, d_20}));
+  if (c.bound <= best_distance)
+    return false;
+
+  const unsigned min_01 = MinDistance(box[0], box[1]);
+  const unsigned min_12 = MinDistance(box[1], box[2]);
+  const unsigned min_20 = MinDistance(box[2], box[0]);
+
+  if (IsLegTooShort(d_01, min_12, min_20) ||
+      IsLegTooShort(d_12, min_20, min_01) ||
+      IsLegTooShort(d_20, min_01, min_12))
+    return false;
+
+  if (c.bound < fai_45_limit) {
+    /* no leg may be longer than 45%, i.e. the total is at most
+       20/11 of the two shorter legs */
+    const unsigned longest = std::max({d_01, d_12, d_20});
+    c.bound = std::min(c.bound, 20 * (d_01 + d_12 + d_20 - longest) / 11);
+    if (c.bound <= best_distance)
+      return false;
+
+    if (IsLegTooLong(min_01, d_12, d_20) ||
+        IsLegTooLong(min_12, d_20, d_01) ||
+        IsLegTooLong(min_20, d_01, d_12))
+      return false;
+  }
 
-  // give first leg points to penultimate node
-  TriangleSecondLeg sl(is_fai, GetPoint(previous), GetPoint(origin));
+  return true;
+}
 
-  const ScanTaskPoint begin(origin.GetStageNumber() + 1,
-                            origin.GetPointIndex() + 1);
-  const ScanTaskPoint end(origin.GetStageNumber() + 1, n_points - 1);
+void
+OLCTriangle::Split(const Candidates &c)
+{
+  const unsigned split = c.split;
+  assert(split < 3);
 
-  for (ScanTaskPoint i = begin; i != end; i.IncrementPointIndex()) {
-    TriangleSecondLeg::Result result = sl.Calculate(GetPoint(i), best_d);
-    const unsigned d = result.leg_distance;
-    if (d > 0) {
-      best_d = result.total_distance;
+  const Range &range = c.ranges[split];
+  const unsigned middle = range.begin + range.GetSize() / 2;
 
-      Link(i, origin, GetStageWeight(origin.GetStageNumber()) * d);
+  Candidates first = c;
+  first.ranges[split].end = middle;
+  Push(first);
 
-      // we have an improved solution
-      is_complete = true;
+  Candidates second = c;
+  second.ranges[split].begin = middle;
+  Push(second);
+}
 
-      // need to scan again whether path is closed
-      is_closed = false;
-      first_tp = origin.GetPointIndex();
+void
+OLCTriangle::Scan(const Candidates &c)
+{
+  const Range *const r = c.ranges;
+
+  for (unsigned i = r[0].begin; i < r[0].end; ++i) {
+    const TracePoint &a = GetPoint(i);
+    const unsigned k_end = std::min(r[2].end, GetLastFinish(i) + 1);
+
+    for (unsigned j = std::max(r[1].begin, i + 1); j < r[1].end; ++j) {
+      const TracePoint &b = GetPoint(j);
+      const unsigned df_1 = a.FlatDistanceTo(b);
+
+      if (is_fai && 4 * df_1 <= best_distance)
+        /* the shortest leg must have at least 25% */
+        continue;
+
+      for (unsigned k = std::max(r[2].begin, j + 1); k < k_end; ++k) {
+        const TracePoint &p = GetPoint(k);
+        const unsigned df_2 = b.FlatDistanceTo(p);
+        const unsigned df_3 = p.FlatDistanceTo(a);
+
+        if (df_1 + df_2 + df_3 <= best_distance)
+          continue;
+
+        const unsigned d = CheckTriangle(is_fai, a, b, p, df_1, df_2, df_3);
+        if (d > best_distance) {
+          best_distance = d;
+          best[0] = i;
+          best[1] = j;
+          best[2] = k;
+        }
+      }
     }
   }
 }
 
 void
-OLCTriangle::AddFinishEdges(const ScanTaskPoint origin)
+OLCTriangle::StartSearch()
 {
-  assert(IsFinal(origin.GetStageNumber() + 1));
+  ClearSearch();
+  best_distance = 0;
 
-  if (predict) {
-    // dummy just to close the triangle
-    Link(ScanTaskPoint(origin.GetStageNumber() + 1, n_points - 1), origin, 0);
-  } else {
-    const ScanTaskPoint start = FindStart(origin);
-    const TracePoint &start_point = GetPoint(start);
-    const TracePoint &origin_point = GetPoint(origin);
+  if (!predict)
+    FindClosingPairs();
 
-    const unsigned max_range =
-      trace_master.ProjectRange(origin_point.GetLocation(), max_distance);
-
-    /* check all remaining points, see which ones match the
-       conditions */
-    const ScanTaskPoint begin(origin.GetStageNumber() + 1, 0);
-    const ScanTaskPoint end(origin.GetStageNumber() + 1,
-                            origin.GetPointIndex());
-    for (ScanTaskPoint i = begin; i != end; i.IncrementPointIndex())
-      if (CalcEdgeDistance(start, i) <= max_range &&
-          start_point.GetLocation().Distance(GetPoint(i).GetLocation()) < max_distance)
-        Link(i, origin, CalcEdgeDistance(origin, i));
+  FillBoxes();
+
+  fai_45_limit =
+    trace_master.ProjectRange(GetPoint(0).GetLocation(), fixed(450000));
+
+  Candidates all;
+  for (unsigned i = 0; i < 3; ++i) {
+    all.ranges[i].begin = 0;
+    all.ranges[i].end = n_points;
+  }
+
+  Push(all);
+}
+
+bool
+OLCTriangle::RunSearch(unsigned max_steps)
+{
+  for (unsigned i = 0; i < max_steps && !queue.empty(); ++i) {
+    const Candidates c = queue.top();
+    queue.pop();
+
+    if (c.bound <= best_distance) {
+      /* this is the most promising one; nothing left to be found */
+      ClearSearch();
+      break;
+    }
+
+    if (c.GetNumTriangles() <= SCAN_TRIANGLES)
+      Scan(c);
+    else
+      Split(c);
   }
+
+  return queue.empty();
 }
 
 void
-OLCTriangle::AddEdges(const ScanTaskPoint origin)
+OLCTriangle::ClearSearch()
 {
-  assert(origin.GetPointIndex() < n_points);
+  while (!queue.empty())
+    queue.pop();
+}
 
-  switch (origin.GetStageNumber()) {
-  case 0:
-    AddTurn1Edges(origin);
-    break;
+SolverResult
+OLCTriangle::Solve(bool exhaustive)
+{
+  if (trace_master.size() < num_stages) {
+    /* not enough data in master trace */
+    ClearSearch();
+    ClearTrace();
+    return SolverResult::FAILED;
+  }
 
-  case 1:
-    AddTurn2Edges(origin);
-    break;
+  /* a search in progress works on the trace copy and is resumed
+     without updating it, unless the master trace has been thinned,
+     which invalidates the copy */
+  if (queue.empty() || exhaustive || IsMasterModified()) {
+    UpdateTrace(exhaustive);
 
-  case 2:
-    AddFinishEdges(origin);
-    break;
+    if (n_points < num_stages) {
+      ClearSearch();
+      return SolverResult::FAILED;
+    }
 
-  default:
-    gcc_unreachable();
+    if (CheckTraceDirty())
+      StartSearch();
+    else if (queue.empty())
+      // don't re-start search unless we have had new data appear
+      return SolverResult::FAILED;
   }
+
+  if (!RunSearch(exhaustive ? 0 - 1 : SEARCH_STEPS))
+    return SolverResult::INCOMPLETE;
+
+  if (best_distance == 0)
+    return SolverResult::FAILED;
+
+  const unsigned first_tp = best[0];
+
+  /* with prediction, assume the pilot returns to the first turn
+     point */
+  const unsigned start = predict ? first_tp : first_start[first_tp];
+  const unsigned finish = predict ? first_tp : last_finish[first_tp];
+
+  triangle.resize(5);
+  triangle[0] = GetPoint(start);
+  for (unsigned i = 0; i < 3; ++i)
+    triangle[i + 1] = GetPoint(best[i]);
+  triangle[4] = GetPoint(finish);
+
+  is_complete = true;
+
+  return AbstractContest::SaveSolution()
+    ? SolverResult::VALID
+    : SolverResult::FAILED;
 }
 
 ContestResult
@@ -330,36 +550,14 @@ OLCTriangle::CalculateResult(const ContestTraceVector &solution) const
   return result;
 }
 
-void
-OLCTriangle::StartSearch()
-{
-}
-
-bool
-OLCTriangle::UpdateScore()
+ContestResult
+OLCTriangle::CalculateResult() const
 {
-  // RESERVED FOR FUTURE USE: DO NOT DELETE
-  /*
-  if (positive(get_best_score()) && !is_closed) {
-    if (IsPathClosed()) {
-      std::cout << "complete, closed\n";
-      is_closed = true;
-    } else {
-      std::cout << "complete, not closed\n";
-      return true;
-    }
-  }
-  */
-  return false;
+  return CalculateResult(triangle);
 }
 
 void
 OLCTriangle::CopySolution(ContestTraceVector &result) const
 {
-  assert(num_stages <= MAX_STAGES);
-
-  ContestDijkstra::CopySolution(result);
-  assert(result.size() == 4);
-  std::swap(result[0], result[3]);
-  std::swap(result[1], result[2]);
+  result = triangle;
 }
@@ -24,9 +24,22 @@
 #define OLC_TRIANGLE_HPP
 
 #include "ContestDijkstra.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "Util/ReservablePriorityQueue.hpp"
+
+#include <functional>
+
+#include <stdint.h>
 
 /**
- * Specialisation of OLC Dijkstra for OLC Triangle (triangle) rules
+ * Specialisation of OLC Dijkstra for OLC Triangle (triangle) rules.
+ *
+ * This class uses only the trace management of #ContestDijkstra.
+ * The triangle is found by a branch-and-bound search over ranges of
+ * trace points, which returns the largest triangle that passes the
+ * rules.  Like the Dijkstra search, it may be spread over several
+ * Solve() calls.
  */
 class OLCTriangle : public ContestDijkstra {
 protected:
@@ -42,39 +55,179 @@ private:
    */
   const bool predict;
 
-  bool is_closed;
   bool is_complete;
-  unsigned first_tp;
 
-protected:
-  unsigned best_d;
+  /**
+   * The best triangle: the start point, the three turn points and
+   * the finish point.
+   */
+  ContestTraceVector triangle;
+
+  /**
+   * A range of trace point indices for one turn point.
+   */
+  struct Range {
+    unsigned begin, end;
+
+    unsigned GetSize() const {
+      return end - begin;
+    }
+  };
+
+  /**
+   * A triple of #Range objects, which describes all triangles with
+   * the first turn point in the first range, and so on.
+   */
+  struct Candidates {
+    Range ranges[3];
+
+    /**
+     * An upper bound for the flat perimeter of these triangles.
+     */
+    unsigned bound;
+
+    /**
+     * The range which shall be split next: the one with the largest
+     * bounding box.
+     */
+    unsigned split;
+
+    uint64_t GetNumTriangles() const {
+      return uint64_t(ranges[0].GetSize()) * ranges[1].GetSize()
+        * ranges[2].GetSize();
+    }
+
+    /**
+     * Comparison for the priority queue, most promising first.
+     */
+    bool operator<(const Candidates &other) const {
+      return bound < other.bound;
+    }
+  };
+
+  /**
+   * For each trace point index, the index of the last point which
+   * may be the finish when this point is the first turn point, i.e.
+   * the last point which is close enough to a start point at or
+   * before it.  Only used if #predict is false.
+   */
+  AllocatedArray<unsigned> last_finish;
+
+  /**
+   * For each trace point index, the start point which belongs to
+   * #last_finish.
+   */
+  AllocatedArray<unsigned> first_start;
+
+  /**
+   * The bounding boxes of all ranges [i, i + 2^k), at index
+   * k * #n_points + i.  Any range is covered by two of them.
+   */
+  AllocatedArray<FlatBoundingBox> boxes;
+
+  /**
+   * The triples which have not been checked yet.  If this is not
+   * empty, a search is in progress.
+   */
+  reservable_priority_queue<Candidates, std::vector<Candidates>,
+                            std::less<Candidates>> queue;
+
+  /**
+   * Below this flat perimeter, the FAI rules don't allow legs longer
+   * than 45%.  This has a safety margin, because it is only an
+   * estimate of 500 km.
+   */
+  unsigned fai_45_limit;
+
+  /**
+   * The flat perimeter of the best triangle found by the current
+   * search, and its turn points.
+   */
+  unsigned best_distance;
+  unsigned best[3];
 
 public:
   OLCTriangle(const Trace &_trace, bool is_fai, bool predict);
 
-protected:
+  /**
+   * Check the triangle against the rules.  This is a heuristic; we do
+   * as much of this in flat projection for speed.
+   *
+   * @param df_1 the flat distance a-b
+   * @param df_2 the flat distance b-c
+   * @param df_3 the flat distance c-a
+   * @return the flat perimeter, or 0 if the triangle is not valid
+   */
+  gcc_pure
+  static unsigned CheckTriangle(bool is_fai, const SearchPoint &a,
+                                const SearchPoint &b, const SearchPoint &c,
+                                unsigned df_1, unsigned df_2, unsigned df_3);
+
+private:
+  /**
+   * Fill #last_finish and #first_start.
+   */
+  void FindClosingPairs();
+
+  /**
+   * Fill #boxes.
+   */
+  void FillBoxes();
+
+  /**
+   * The last trace point which may be the finish (and the third turn
+   * point) when the specified point is the first turn point.
+   */
+  gcc_pure
+  unsigned GetLastFinish(unsigned first_tp) const {
+    return predict ? n_points - 1 : last_finish[first_tp];
+  }
+
   gcc_pure
-  bool IsPathClosed() const;
+  FlatBoundingBox GetBox(const Range &range) const;
+
+  /**
+   * Shrink the ranges to the triangles which may be valid, and
+   * calculate the bound.
+   *
+   * @return false if none of the triangles can beat the best one
+   */
+  bool Prepare(Candidates &c) const;
+
+  void Push(Candidates &c) {
+    if (Prepare(c))
+      queue.push(c);
+  }
 
-  void AddTurn1Edges(const ScanTaskPoint origin);
-  void AddTurn2Edges(const ScanTaskPoint origin);
-  void AddFinishEdges(const ScanTaskPoint origin);
+  void Split(const Candidates &c);
+  void Scan(const Candidates &c);
+
+  /**
+   * Continue the search.
+   *
+   * @param max_steps the maximum number of triples to be split or
+   * scanned
+   * @return true if the search is finished
+   */
+  bool RunSearch(unsigned max_steps);
+
+  /**
+   * Abort the search which is in progress.
+   */
+  void ClearSearch();
 
 public:
   /* virtual methods from AbstractContest */
-  virtual void Reset();
+  virtual void Reset() override;
+  virtual SolverResult Solve(bool exhaustive) override;
 
 protected:
   /* virtual methods from AbstractContest */
-  virtual bool UpdateScore() override;
+  virtual ContestResult CalculateResult() const override;
   virtual void CopySolution(ContestTraceVector &vec) const override;
 
-  /* virtual methods from NavDijkstra */
-  virtual void AddEdges(ScanTaskPoint curNode) override;
-
   /* virtual methods from ContestDijkstra */
   virtual void StartSearch() override;
-  virtual void AddStartEdges() override;
   virtual ContestResult CalculateResult(const ContestTraceVector &solution) const override;
 };
 
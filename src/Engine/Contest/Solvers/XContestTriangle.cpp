@@ -22,6 +22,8 @@
 
 #include "XContestTriangle.hpp"
 
+#include <assert.h>
+
 XContestTriangle::XContestTriangle(const Trace &_trace,
                                    bool predict, bool _is_dhv)
   :OLCTriangle(_trace, true, predict),
@@ -33,9 +35,10 @@ XContestTriangle::CalculateResult(const ContestTraceVector &solution) const
   ContestResult result = OLCTriangle::CalculateResult(solution);
 
   if (positive(result.distance)) {
-    // approximation for now: gap is distance from start to finish
-    const fixed d_gap = GetPoint(0).GetLocation()
-      .Distance(GetPoint(n_points - 1).GetLocation());
+    // the gap is the distance between the start and the finish
+    assert(solution.size() == 5);
+    const fixed d_gap = solution[0].GetLocation()
+      .Distance(solution[4].GetLocation());
 
     // award no points if gap is >20% of triangle
 
@@ -56,13 +59,3 @@ XContestTriangle::CalculateResult(const ContestTraceVector &solution) const
   result.score = ApplyHandicap(result.distance * score_factor);
   return result;
 }
-
-SolverResult
-XContestTriangle::Solve(bool exhaustive)
-{
-  SolverResult result = ContestDijkstra::Solve(exhaustive);
-  if (result != SolverResult::FAILED)
-    best_d = 0; // reset heuristic
-
-  return result;
-}
@@ -37,8 +37,7 @@ public:
   XContestTriangle(const Trace &_trace, bool predict, bool _is_dhv);
 
 protected:
-  /* virtual methods from AbstractContest */
-  virtual SolverResult Solve(bool exhaustive) override;
+  /* virtual methods from ContestDijkstra */
   virtual ContestResult CalculateResult(const ContestTraceVector &solution) const override;
 };
 
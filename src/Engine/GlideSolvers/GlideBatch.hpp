@@ -0,0 +1,150 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+#ifndef GLIDE_BATCH_HPP
+#define GLIDE_BATCH_HPP
+
+#include "GlideState.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <assert.h>
+
+/**
+ * A set of glide tasks which all start at the aircraft and share its
+ * altitude and the wind, for example the glides to all landable
+ * waypoints.  The destinations are stored as a structure of arrays,
+ * which allows MacCready::SolveBatch() to share the polar and wind
+ * setup and to calculate the ground speeds of all destinations in
+ * loops the compiler can vectorise.
+ */
+class GlideBatch {
+  friend class MacCready;
+
+  SpeedVector wind;
+
+  /** the direction the wind blows to */
+  Angle wind_reciprocal;
+
+  /** altitude of the aircraft (m above MSL) */
+  fixed altitude;
+
+  std::vector<GeoVector> vectors;
+  std::vector<fixed> min_arrival_altitudes;
+
+  /** see GlideState::effective_wind_angle */
+  std::vector<Angle> effective_wind_angles;
+
+  /** see GlideState::head_wind */
+  std::vector<fixed> head_winds;
+
+  /**
+   * Scratch buffers for MacCready::SolveBatch().  They live here so
+   * solving the same batch object repeatedly does not allocate.
+   */
+  std::vector<fixed> speeds, ground_speeds, cruise_speeds, lds;
+
+public:
+  GlideBatch():wind(SpeedVector::Zero()), wind_reciprocal(Angle::Zero()),
+               altitude(fixed(0)) {}
+
+  /**
+   * Remove all destinations and set up a new batch.
+   *
+   * @param altitude the altitude of the aircraft
+   * @param wind the wind vector
+   */
+  void Reset(fixed _altitude, const SpeedVector _wind) {
+    altitude = _altitude;
+
+    /* same as GlideState::CalcSpeedups() */
+    wind = _wind.IsNonZero() ? _wind : SpeedVector::Zero();
+    wind_reciprocal = wind.bearing.Reciprocal();
+
+    vectors.clear();
+    min_arrival_altitudes.clear();
+    effective_wind_angles.clear();
+    head_winds.clear();
+  }
+
+  /**
+   * Reserve space for the specified number of destinations.
+   */
+  void reserve(unsigned n) {
+    vectors.reserve(n);
+    min_arrival_altitudes.reserve(n);
+    effective_wind_angles.reserve(n);
+    head_winds.reserve(n);
+    speeds.reserve(n);
+    ground_speeds.reserve(n);
+    cruise_speeds.reserve(n);
+    lds.reserve(n);
+  }
+
+  /**
+   * Add a destination.
+   *
+   * @param vector Distance and bearing from the aircraft
+   * @param min_arrival_altitude Height of the destination plus
+   * safety margin (m above MSL)
+   */
+  void Add(const GeoVector &vector, fixed min_arrival_altitude) {
+    vectors.push_back(vector);
+    min_arrival_altitudes.push_back(min_arrival_altitude);
+
+    /* same as GlideState::CalcSpeedups() */
+    if (wind.IsNonZero()) {
+      const Angle effective_wind_angle = wind_reciprocal - vector.bearing;
+      effective_wind_angles.push_back(effective_wind_angle);
+      head_winds.push_back(-wind.norm * effective_wind_angle.cos());
+    } else {
+      effective_wind_angles.push_back(Angle::Zero());
+      head_winds.push_back(fixed(0));
+    }
+  }
+
+  gcc_pure
+  unsigned size() const {
+    return vectors.size();
+  }
+
+  gcc_pure
+  bool empty() const {
+    return vectors.empty();
+  }
+
+  /**
+   * Construct the #GlideState of one destination.
+   */
+  gcc_pure
+  GlideState GetState(unsigned i) const {
+    assert(i < size());
+
+    return GlideState(vectors[i], min_arrival_altitudes[i], altitude, wind,
+                      effective_wind_angles[i], head_winds[i]);
+  }
+};
+
+#endif
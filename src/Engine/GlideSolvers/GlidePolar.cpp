@@ -21,6 +21,7 @@
  */
 
 #include "GlidePolar.hpp"
+#include "GlideSpeedTable.hpp"
 #include "GlideState.hpp"
 #include "GlideResult.hpp"
 #include "MacCready.hpp"
@@ -46,7 +47,9 @@ GlidePolar::GlidePolar(const fixed _mc, const fixed _bugs, const fixed _ballast)
   ballast_ratio(0.3),
   reference_mass(300),
   dry_mass(reference_mass),
-  wing_area(fixed(0))
+  wing_area(fixed(0)),
+  loading_factor(fixed(1)),
+  speed_table(nullptr)
 {
   Update();
 
@@ -61,10 +64,11 @@ GlidePolar::Update()
 
   if (!ideal_polar.IsValid()) {
     Vmin = Vmax = fixed(0);
+    speed_table = nullptr;
     return;
   }
 
-  const fixed loading_factor = sqrt(GetTotalMass() / reference_mass);
+  loading_factor = sqrt(GetTotalMass() / reference_mass);
   const fixed inv_bugs = fixed(1)/bugs;
 
   polar.a = inv_bugs * ideal_polar.a / loading_factor;
@@ -73,10 +77,20 @@ GlidePolar::Update()
 
   assert(polar.IsValid());
 
+  UpdateSpeedTable();
   UpdateSMax();
   UpdateSMin();
 }
 
+void
+GlidePolar::UpdateSpeedTable()
+{
+  GlideSpeedTable::Key key;
+  key.polar = ideal_polar;
+  key.cruise_efficiency = cruise_efficiency;
+  speed_table = &GlideSpeedTable::Obtain(key);
+}
+
 void
 GlidePolar::UpdateSMax()
 {
@@ -108,6 +122,15 @@ GlidePolar::SetBallastLitres(const fixed litres)
   Update();
 }
 
+void
+GlidePolar::SetCruiseEfficiency(const fixed _ce)
+{
+  cruise_efficiency = _ce;
+
+  if (ideal_polar.IsValid())
+    UpdateSpeedTable();
+}
+
 void
 GlidePolar::SetMC(const fixed _mc)
 {
@@ -265,68 +288,6 @@ GlidePolar::IsGlidePossible(const GlideState &task) const
   return true;
 }
 
-/**
- * Finds speed to fly for a given MacCready setting
- * Intended to be used temporarily.
- *
- * This finds the speed that maximises the glide angle over the ground
- */
-class GlidePolarSpeedToFly final : public ZeroFinder {
-  const GlidePolar &polar;
-  const fixed m_net_sink_rate;
-  const fixed m_head_wind;
-
-public:
-  /**
-   * Constructor.
-   *
-   * @param _polar Glide polar to optimise
-   * @param net_sink_rate Instantaneous netto sink rate (m/s), positive down
-   * @param head_wind Head wind component (m/s)
-   * @param vmin Minimum speed to search (m/s)
-   * @param vmax Maximum speed to search (m/s)
-   *
-   * @return Initialised object (no search yet)
-   */
-  GlidePolarSpeedToFly(const GlidePolar &_polar, const fixed net_sink_rate,
-                       const fixed head_wind, const fixed vmin,
-                       const fixed vmax) :
-    ZeroFinder(std::max(fixed(1), vmin - head_wind), vmax - head_wind,
-               fixed(TOLERANCE_POLAR_DOLPHIN)),
-    polar(_polar),
-    m_net_sink_rate(net_sink_rate),
-    m_head_wind(head_wind)
-  {
-  }
-
-  /**
-   * Glide ratio over ground function
-   *
-   * @param V Speed over ground (m/s)
-   *
-   * @return MacCready-adjusted inverse glide ratio over ground
-   */
-  fixed
-  f(const fixed V)
-  {
-    return (polar.MSinkRate(V + m_head_wind) + m_net_sink_rate) / V;
-  }
-
-  /**
-   * Find best speed to fly
-   *
-   * @param Vstart Initial search speed (m/s)
-   *
-   * @return Speed to fly (m/s)
-   */
-  fixed
-  solve(const fixed Vstart)
-  {
-    fixed Vopt = find_min(Vstart);
-    return Vopt + m_head_wind;
-  }
-};
-
 fixed
 GlidePolar::SpeedToFly(const AircraftState &state,
     const GlideResult &solution, const bool block_stf) const
@@ -345,8 +306,15 @@ GlidePolar::SpeedToFly(const AircraftState &state,
                           : fixed(0));
     const fixed stf_sink_rate (block_stf ? fixed(0) : -state.netto_vario);
 
-    GlidePolarSpeedToFly gp_stf(*this, stf_sink_rate, head_wind, Vmin, Vmax);
-    V_stf = gp_stf.solve(Vmax);
+    /* the speed which minimises the MacCready-adjusted glide ratio
+       over ground: the tangent from (head_wind, -mc-stf_sink_rate)
+       to the parabolic polar */
+    const fixed s = sqr(head_wind) +
+      (mc + stf_sink_rate + polar.c + polar.b * head_wind) / polar.a;
+    const fixed v_low = std::max(Vmin, head_wind + fixed(1));
+    V_stf = negative(s)
+      ? v_low
+      : std::min(Vmax, std::max(v_low, head_wind + sqrt(s)));
   }
 
   return std::max(Vmin, V_stf * g_scaling);
@@ -416,6 +384,46 @@ GlidePolar::GetBestGlideRatioSpeed(fixed head_wind) const
   return head_wind + sqrt(s);
 }
 
+fixed
+GlidePolar::GetBestGlideSpeed(fixed head_wind, fixed cross_wind) const
+{
+  if (!IsValid() || speed_table == nullptr)
+    return fixed(-1);
+
+  /* the table is calculated at the reference mass; scale the wind
+     and the resulting speed by the loading factor */
+  const fixed inv_loading_factor = fixed(1) / loading_factor;
+  const fixed v = speed_table->Get(head_wind * inv_loading_factor,
+                                   cross_wind * inv_loading_factor);
+  return positive(v) ? std::min(v * loading_factor, Vmax) : v;
+}
+
+void
+GlidePolar::GetBestGlideSpeeds(const fixed *head_winds,
+                               const fixed wind_speed_squared,
+                               fixed *speeds, unsigned n) const
+{
+  if (!IsValid() || speed_table == nullptr) {
+    std::fill_n(speeds, n, fixed(-1));
+    return;
+  }
+
+  const GlideSpeedTable &table = *speed_table;
+  const fixed inv_loading_factor = fixed(1) / loading_factor;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const fixed head_wind = head_winds[i];
+    const fixed cross_wind_squared = wind_speed_squared - sqr(head_wind);
+    const fixed cross_wind = positive(cross_wind_squared)
+      ? sqrt(cross_wind_squared)
+      : fixed(0);
+
+    const fixed v = table.Get(head_wind * inv_loading_factor,
+                              cross_wind * inv_loading_factor);
+    speeds[i] = positive(v) ? std::min(v * loading_factor, Vmax) : v;
+  }
+}
+
 fixed
 GlidePolar::GetVTakeoff() const
 {
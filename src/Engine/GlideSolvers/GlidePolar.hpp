@@ -28,6 +28,7 @@
 
 #include <type_traits>
 
+class GlideSpeedTable;
 struct GlideState;
 struct GlideResult;
 struct AircraftState;
@@ -99,6 +100,17 @@ class GlidePolar
   /** Reference wing area, m^2 */
   fixed wing_area;
 
+  /** Square root of the ratio of total mass to reference mass */
+  fixed loading_factor;
+
+  /**
+   * The shared table of best glide speeds for #ideal_polar and
+   * #cruise_efficiency; nullptr if the polar is invalid.  It is
+   * obtained by Update() and SetCruiseEfficiency(), which keeps
+   * lookups free of locks.
+   */
+  const GlideSpeedTable *speed_table;
+
   friend class GlidePolarTest;
 
 public:
@@ -258,6 +270,33 @@ public:
   gcc_pure
   fixed GetBestGlideRatioSpeed(fixed head_wind) const;
 
+  /**
+   * Look up the airspeed for the best glide ratio over ground at
+   * MC=0, taking the cruise efficiency and both wind components into
+   * account.  The value is interpolated from a #GlideSpeedTable,
+   * which is shared by all polars with the same coefficients and
+   * cruise efficiency, and limited to Vmax.
+   *
+   * @param head_wind Head wind component (m/s)
+   * @param cross_wind Cross wind component (m/s)
+   * @return Speed (m/s), or a negative value if the wind is outside
+   * the table
+   */
+  gcc_pure
+  fixed GetBestGlideSpeed(fixed head_wind, fixed cross_wind) const;
+
+  /**
+   * Like GetBestGlideSpeed(), but for many destinations in the same
+   * wind.  The table and the loading factor are resolved only once.
+   *
+   * @param head_winds Head wind component of each destination (m/s)
+   * @param wind_speed_squared The square of the wind speed
+   * @param speeds An array of n elements which receives the speeds
+   */
+  void GetBestGlideSpeeds(const fixed *head_winds,
+                          fixed wind_speed_squared,
+                          fixed *speeds, unsigned n) const;
+
   /**
    * Takeoff speed
    * @return Takeoff speed threshold (m/s)
@@ -270,11 +309,7 @@ public:
    *
    * @param _ce The new cruise efficiency value
    */
-  void
-  SetCruiseEfficiency(const fixed _ce)
-  {
-    cruise_efficiency = _ce;
-  }
+  void SetCruiseEfficiency(const fixed _ce);
 
   /**
    * Accessor for current cruise efficiency
@@ -575,6 +610,9 @@ public:
   void Update();
 
 private:
+  /** Obtain the #GlideSpeedTable for the current settings */
+  void UpdateSpeedTable();
+
   /** Update sink rate at max. cruise speed */
   void UpdateSMax();
 
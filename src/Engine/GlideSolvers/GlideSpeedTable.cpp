@@ -0,0 +1,182 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "GlideSpeedTable.hpp"
+#include "Math/ZeroFinder.hpp"
+#include "Util/Tolerances.hpp"
+#include "Thread/FastMutex.hpp"
+
+#include <algorithm>
+#include <list>
+
+/**
+ * The upper bound of the speed search (m/s).  The table is not
+ * limited by Vmax; GlidePolar::GetBestGlideSpeed() clamps the
+ * result, which gives the same speed because the glide ratio over
+ * ground has only one optimum.
+ */
+static constexpr unsigned SEARCH_V_MAX = 150;
+
+/** The head wind (m/s) of the first row of the table */
+static constexpr int HEAD_WIND_MIN =
+  -int((GlideSpeedTable::HEAD_WIND - 1) * GlideSpeedTable::STEP / 2);
+
+/**
+ * Finds the airspeed with the best glide ratio over ground at MC=0,
+ * the same optimisation as MacCready::OptimiseGlide().
+ */
+class GlideSpeedSolver final : public ZeroFinder {
+  const PolarCoefficients &polar;
+  const fixed head_wind;
+  const fixed cross_wind_squared;
+  const fixed cruise_efficiency;
+
+public:
+  GlideSpeedSolver(const GlideSpeedTable::Key &key, const fixed v_min,
+                   const fixed _head_wind, const fixed cross_wind) :
+    ZeroFinder(v_min, fixed(SEARCH_V_MAX),
+               fixed(TOLERANCE_MC_OPT_GLIDE)),
+    polar(key.polar),
+    head_wind(_head_wind),
+    cross_wind_squared(sqr(cross_wind)),
+    cruise_efficiency(key.cruise_efficiency)
+  {
+  }
+
+  /**
+   * @param v Cruise true air speed (m/s)
+   * @return Ground speed (m/s), negative if the wind is too strong
+   */
+  gcc_pure
+  fixed GroundSpeed(const fixed v) const {
+    const fixed v_squared = sqr(v * cruise_efficiency);
+    if (v_squared < cross_wind_squared)
+      return fixed(-1);
+
+    return sqrt(v_squared - cross_wind_squared) - head_wind;
+  }
+
+  /**
+   * @param v Cruise true air speed (m/s)
+   * @return Magnified inverse LD over ground, see MacCreadyVopt
+   */
+  fixed
+  f(const fixed v)
+  {
+    const fixed ground_speed = GroundSpeed(v);
+    if (!positive(ground_speed))
+      return fixed(1000000);
+
+    const fixed sink_rate = (polar.a * v + polar.b) * v + polar.c;
+    return sink_rate * 1024 / ground_speed;
+  }
+};
+
+void
+GlideSpeedTable::Build(const Key &_key)
+{
+  key = _key;
+
+  /* the speed for minimum sink, see GlidePolar::UpdateSMin() */
+  const fixed v_min = -key.polar.b / Double(key.polar.a);
+
+  for (unsigned i = 0; i < HEAD_WIND; ++i) {
+    const fixed head_wind = fixed(HEAD_WIND_MIN + int(i * STEP));
+
+    for (unsigned j = 0; j < CROSS_WIND; ++j) {
+      fixed &v = speeds[i][j];
+      v = fixed(-1);
+
+      GlideSpeedSolver solver(key, v_min, head_wind, fixed(int(j * STEP)));
+
+      /* only accept wind conditions where all speeds give a positive
+         ground speed, so interpolated entries are valid as well */
+      if (positive(solver.GroundSpeed(v_min)))
+        v = solver.find_min(v_min);
+    }
+  }
+}
+
+fixed
+GlideSpeedTable::Get(fixed head_wind, fixed cross_wind) const
+{
+  const fixed x = (head_wind - fixed(HEAD_WIND_MIN)) / int(STEP);
+  const fixed y = fabs(cross_wind) / int(STEP);
+  if (negative(x) || x > fixed(int(HEAD_WIND - 1)) ||
+      y > fixed(int(CROSS_WIND - 1)))
+    return fixed(-1);
+
+  const unsigned i = std::min((unsigned)x, HEAD_WIND - 2);
+  const unsigned j = std::min((unsigned)y, CROSS_WIND - 2);
+
+  const fixed v00 = speeds[i][j];
+  const fixed v01 = speeds[i][j + 1];
+  const fixed v10 = speeds[i + 1][j];
+  const fixed v11 = speeds[i + 1][j + 1];
+  if (negative(v00) || negative(v01) || negative(v10) || negative(v11))
+    return fixed(-1);
+
+  const fixed dx = x - fixed(i), dy = y - fixed(j);
+  const fixed v0 = v00 + (v01 - v00) * dy;
+  const fixed v1 = v10 + (v11 - v10) * dy;
+  return v0 + (v1 - v0) * dx;
+}
+
+static FastMutex tables_mutex;
+
+/**
+ * All tables which were built so far.  A std::list keeps the
+ * addresses of its elements stable.  This is a function-local static
+ * because global #GlidePolar objects obtain tables during static
+ * initialisation.
+ */
+static std::list<GlideSpeedTable> &
+GetTables()
+{
+  static std::list<GlideSpeedTable> tables;
+  return tables;
+}
+
+const GlideSpeedTable &
+GlideSpeedTable::Obtain(const Key &key)
+{
+  tables_mutex.Lock();
+
+  std::list<GlideSpeedTable> &tables = GetTables();
+
+  for (const auto &table : tables) {
+    if (table.key == key) {
+      tables_mutex.Unlock();
+      return table;
+    }
+  }
+
+  /* build the table while holding the lock, so concurrent callers
+     don't build it twice */
+  tables.emplace_back();
+  GlideSpeedTable &table = tables.back();
+  table.Build(key);
+
+  tables_mutex.Unlock();
+  return table;
+}
@@ -0,0 +1,110 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GLIDE_SPEED_TABLE_HPP
+#define XCSOAR_GLIDE_SPEED_TABLE_HPP
+
+#include "PolarCoefficients.hpp"
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+/**
+ * The airspeed (m/s) which gives the best glide ratio over ground at
+ * MC=0, indexed by the head wind and the cross wind component.  This
+ * replaces the numerical search in MacCready::OptimiseGlide(), see
+ * GlidePolar::GetBestGlideSpeed().
+ *
+ * The table is calculated for the polar at its reference mass without
+ * bugs.  Bugs scale all sink rates and don't move the optimum.  The
+ * loading factor L scales both speeds and sink rates, therefore the
+ * optimum in the wind W is L times the optimum in the wind W/L.  The
+ * table does not depend on the MacCready setting either, so it only
+ * changes with the polar shape and the cruise efficiency.
+ *
+ * Tables are immutable and shared by all #GlidePolar objects; see
+ * Obtain().
+ */
+class GlideSpeedTable {
+public:
+  /** Step of the wind components (m/s) */
+  static constexpr unsigned STEP = 2;
+  /** Number of head wind rows, covering -20 m/s to +20 m/s */
+  static constexpr unsigned HEAD_WIND = 21;
+  /** Number of cross wind columns, covering 0 to 20 m/s */
+  static constexpr unsigned CROSS_WIND = 11;
+
+  /**
+   * The parameters a table is calculated from.
+   */
+  struct Key {
+    /** The polar coefficients at the reference mass without bugs */
+    PolarCoefficients polar;
+
+    fixed cruise_efficiency;
+
+    bool operator==(const Key &other) const {
+      return polar.a == other.polar.a && polar.b == other.polar.b &&
+        polar.c == other.polar.c &&
+        cruise_efficiency == other.cruise_efficiency;
+    }
+  };
+
+private:
+  Key key;
+
+  /**
+   * Negative entries mark wind conditions which leave no positive
+   * ground speed.
+   */
+  fixed speeds[HEAD_WIND][CROSS_WIND];
+
+  /**
+   * Calculate all entries for the specified parameters.
+   */
+  void Build(const Key &key);
+
+public:
+  /**
+   * Interpolate the speed bilinearly.  The resulting glide ratio is
+   * within 0.01% of the exact optimum (see TestGlidePolar).
+   *
+   * @param head_wind Head wind component (m/s)
+   * @param cross_wind Cross wind component (m/s)
+   * @return Speed (m/s), or a negative value if the wind is outside
+   * the table
+   */
+  gcc_pure
+  fixed Get(fixed head_wind, fixed cross_wind) const;
+
+  /**
+   * Return the table for the specified parameters; it is built if it
+   * does not exist yet.  Tables are never modified or deleted, so the
+   * returned reference remains valid and may be used by any thread
+   * without locking.  There is one table per polar and cruise
+   * efficiency setting, which are only changed by the user.  This
+   * method is thread-safe.
+   */
+  static const GlideSpeedTable &Obtain(const Key &key);
+};
+
+#endif
@@ -83,6 +83,19 @@ GlideState::GlideState(const GeoVector &vector, const fixed htarget,
   CalcSpeedups(wind);
 }
 
+GlideState::GlideState(const GeoVector &vector, const fixed htarget,
+                       fixed altitude, const SpeedVector _wind,
+                       Angle _effective_wind_angle, fixed _head_wind) :
+  vector(vector),
+  min_arrival_altitude(htarget),
+  wind(_wind),
+  altitude_difference(altitude - min_arrival_altitude),
+  effective_wind_angle(_effective_wind_angle),
+  head_wind(_head_wind),
+  wind_speed_squared(sqr(wind.norm))
+{
+}
+
 void
 GlideState::CalcSpeedups(const SpeedVector _wind)
 {
@@ -105,23 +118,19 @@ GlideState::DriftedDistance(const fixed time) const
   if (wind.IsZero())
     return vector.distance;
 
-  // Distance that the wine travels in the given #time
-  const fixed distance_wind = wind.norm * time;
-  // Direction of the wind
-  auto sc_wind = wind.bearing.Reciprocal().SinCos();
-  const fixed sin_wind = sc_wind.first, cos_wind = sc_wind.second;
-
-  // Distance to the target
-  const fixed distance_task = vector.distance;
-  // Direction to the target
-  auto sc_task = vector.bearing.SinCos();
-  const fixed sin_task = sc_task.first, cos_task = sc_task.second;
+  /* split the drift into the components along and across the
+     direction to the target; this needs no trigonometry, because the
+     head wind was already calculated by CalcSpeedups() */
 
-  // X-/Y-Components of the resulting vector
-  const fixed dx = distance_task * sin_task - distance_wind * sin_wind;
-  const fixed dy = distance_task * cos_task - distance_wind * cos_wind;
+  // Distance to the target plus the drift against it
+  const fixed distance_along = vector.distance + head_wind * time;
+  // Drift across the direction to the target
+  const fixed cross_wind_squared = wind_speed_squared - sqr(head_wind);
+  const fixed distance_across = positive(cross_wind_squared)
+    ? sqrt(cross_wind_squared) * time
+    : fixed(0);
 
-  return MediumHypot(dx, dy);
+  return MediumHypot(distance_along, distance_across);
 
   // ??   task.Bearing = RAD_TO_DEG*(atan2(dx,dy));
 }
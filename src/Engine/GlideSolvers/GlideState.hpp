@@ -70,6 +70,19 @@ public:
   GlideState(const GeoVector &vector, const fixed htarget,
              fixed altitude, const SpeedVector wind);
 
+  /**
+   * Constructor for a task whose wind components have already been
+   * calculated by CalcSpeedups(), see #GlideBatch.
+   *
+   * @param wind the wind vector (SpeedVector::Zero() if there is no
+   * wind)
+   * @param effective_wind_angle the #effective_wind_angle
+   * @param head_wind the #head_wind
+   */
+  GlideState(const GeoVector &vector, const fixed htarget,
+             fixed altitude, const SpeedVector wind,
+             Angle effective_wind_angle, fixed head_wind);
+
   /**
    * Calculate internal quantities to reduce computation time
    * by clients of this class
@@ -23,6 +23,7 @@
 #include "MacCready.hpp"
 #include "GlideSettings.hpp"
 #include "GlideState.hpp"
+#include "GlideBatch.hpp"
 #include "GlidePolar.hpp"
 #include "GlideResult.hpp"
 #include "Navigation/Aircraft.hpp"
@@ -125,22 +126,19 @@ MacCready::SolveSink(const GlideSettings &settings,
   return mac.SolveSink(task, sink_rate);
 }
 
-GlideResult
-MacCready::SolveCruise(const GlideState &task) const
-{
-  // cruise speed for current MC (m/s)
-  const fixed mc_speed = glide_polar.GetVBestLD();
-
-  GlideResult result(task, mc_speed);
-
-  // sink rate at current MC speed (m/s)
-  const fixed mc_sink_rate = glide_polar.GetSBestLD();
+/**
+ * The parameters of the climb-cruise which depend only on the polar
+ * and the MacCready setting, see MacCready::SolveCruise().
+ */
+struct CruiseParameters {
+  /** MC value (m/s) */
+  fixed mc;
 
-  // MC value (m/s)
-  const fixed mc = glide_polar.GetMC();
+  /** Inverse MC value (s/m) */
+  fixed inv_mc;
 
-  // Inverse MC value (s/m)
-  const fixed inv_mc = glide_polar.GetInvMC();
+  /** sink rate at current MC speed (m/s) */
+  fixed sink_rate;
 
   /*
       |      rho = S / MC
@@ -156,22 +154,43 @@ MacCready::SolveCruise(const GlideState &task) const
       |  resulting speed
   */
 
-  // Sink rate divided by MC value
-  // same as (cruise speed - resulting speed) / resulting speed
-  const fixed rho = mc_sink_rate * inv_mc;
+  /**
+   * Sink rate divided by MC value, same as (cruise speed - resulting
+   * speed) / resulting speed
+   */
+  fixed rho;
 
-  // quotient of cruise speed over resulting speed (> 1.0)
-  const fixed rho_plus_one = fixed(1) + rho;
+  /** quotient of cruise speed over resulting speed (> 1.0) */
+  fixed rho_plus_one;
 
-  // quotient of resulting speed over cruise speed (0 .. 1)
-  const fixed inv_rho_plus_one = fixed(1) / rho_plus_one;
+  /** quotient of resulting speed over cruise speed (0 .. 1) */
+  fixed inv_rho_plus_one;
 
-  const fixed estimated_speed =
-      task.CalcAverageSpeed(mc_speed * cruise_efficiency * inv_rho_plus_one);
+  explicit CruiseParameters(const GlidePolar &glide_polar)
+    :mc(glide_polar.GetMC()), inv_mc(glide_polar.GetInvMC()),
+     sink_rate(glide_polar.GetSBestLD()),
+     rho(sink_rate * inv_mc), rho_plus_one(fixed(1) + rho),
+     inv_rho_plus_one(fixed(1) / rho_plus_one) {}
+};
+
+/**
+ * Calculate a climb-cruise to the destination of the specified task.
+ * This is shared by MacCready::SolveCruise() and
+ * MacCready::SolveBatch().
+ *
+ * @param result The result, freshly constructed for the task
+ * @param estimated_speed The ground speed including the climbs (m/s)
+ * @param ld_ground The L/D over ground at the best glide speed
+ */
+static void
+CalcCruise(GlideResult &result, const GlideState &task,
+           const CruiseParameters &cruise, const fixed estimated_speed,
+           const fixed ld_ground)
+{
   if (!positive(estimated_speed)) {
     result.validity = GlideResult::Validity::WIND_EXCESSIVE;
     result.vector.distance = fixed(0);
-    return result;
+    return;
   }
 
   fixed time_climb_drift = fixed(0);
@@ -179,61 +198,60 @@ MacCready::SolveCruise(const GlideState &task) const
 
   // Calculate additional distance_with_climb_drift/time due to wind drift while circling
   if (negative(task.altitude_difference)) {
-    time_climb_drift = -task.altitude_difference * inv_mc;
+    time_climb_drift = -task.altitude_difference * cruise.inv_mc;
     distance_with_climb_drift = task.DriftedDistance(time_climb_drift);
   }
 
   // Estimated time to finish the task
   const fixed estimated_time = distance_with_climb_drift / estimated_speed;
   // Estimated time in cruise
-  const fixed time_cruise = estimated_time * inv_rho_plus_one;
+  const fixed time_cruise = estimated_time * cruise.inv_rho_plus_one;
   // Estimated time in climb (including wind drift while circling)
-  const fixed time_climb = time_cruise * rho + time_climb_drift;
+  const fixed time_climb = time_cruise * cruise.rho + time_climb_drift;
 
-  const fixed sink_glide = time_cruise * mc_sink_rate;
+  const fixed sink_glide = time_cruise * cruise.sink_rate;
 
   result.time_elapsed = estimated_time + time_climb_drift;
   result.time_virtual = fixed(0);
-  result.height_climb = time_climb * mc;
+  result.height_climb = time_climb * cruise.mc;
   result.height_glide = sink_glide;
   result.altitude_difference -= sink_glide;
-  result.effective_wind_speed *= rho_plus_one;
+  result.effective_wind_speed *= cruise.rho_plus_one;
 
   result.validity = GlideResult::Validity::OK;
-  result.pure_glide_height = task.vector.distance /
-    glide_polar.GetLDOverGround(task.vector.bearing, task.wind);
+  result.pure_glide_height = task.vector.distance / ld_ground;
   result.pure_glide_altitude_difference -= result.pure_glide_height;
-
-  return result;
 }
 
-GlideResult
-MacCready::SolveGlide(const GlideState &task, const fixed v_set,
-                      const fixed sink_rate, const bool allow_partial) const
+/**
+ * Calculate a straight glide to the destination.  This is shared by
+ * MacCready::SolveGlide() and MacCready::SolveBatch().
+ *
+ * @param result The result, freshly constructed for the task
+ * @param estimated_speed The ground speed in the glide (m/s)
+ * @param sink_rate The sink rate in the glide (m/s)
+ * @param inv_mc Inverse MC value (s/m)
+ * @param allow_partial Stop the glide when the altitude is exhausted
+ */
+static void
+CalcGlide(GlideResult &result, const fixed estimated_speed,
+          const fixed sink_rate, const fixed inv_mc,
+          const bool allow_partial)
 {
-  // spend a lot of time in this function, so it should be quick!
-
-  GlideResult result(task, v_set);
-
-  // distance relation
-  //   V*V=Vn*Vn+W*W-2*Vn*W*cos(theta)
-  //     Vn*Vn-2*Vn*W*cos(theta)+W*W-V*V=0  ... (1)
-
-  const fixed estimated_speed = task.CalcAverageSpeed(v_set * cruise_efficiency);
   if (!positive(estimated_speed)) {
     result.validity = GlideResult::Validity::WIND_EXCESSIVE;
     result.vector.distance = fixed(0);
-    return result;
+    return;
   }
 
   result.validity = GlideResult::Validity::OK;
 
   if (allow_partial) {
-    const fixed Vndh = estimated_speed * task.altitude_difference;
+    const fixed Vndh = estimated_speed * result.altitude_difference;
 
     // S/Vn > dh/task.Distance
-    if (sink_rate * task.vector.distance > Vndh) {
-      if (negative(task.altitude_difference))
+    if (sink_rate * result.vector.distance > Vndh) {
+      if (negative(result.altitude_difference))
         // insufficient height, and can't climb
         result.vector.distance = fixed(0);
       else
@@ -250,13 +268,43 @@ MacCready::SolveGlide(const GlideState &task, const fixed v_set,
   result.altitude_difference -= result.height_glide;
   result.pure_glide_altitude_difference -= result.pure_glide_height;
 
-  const fixed inv_mc = glide_polar.GetInvMC();
   if(positive(inv_mc))
     // equivalent time to gain the height that was used
     result.time_virtual = result.height_glide * inv_mc;
   else
     result.time_virtual = fixed(0);
+}
+
+GlideResult
+MacCready::SolveCruise(const GlideState &task) const
+{
+  const CruiseParameters cruise(glide_polar);
+
+  // cruise speed for current MC (m/s)
+  const fixed mc_speed = glide_polar.GetVBestLD();
+
+  GlideResult result(task, mc_speed);
+  CalcCruise(result, task, cruise,
+             task.CalcAverageSpeed(mc_speed * cruise_efficiency *
+                                   cruise.inv_rho_plus_one),
+             glide_polar.GetLDOverGround(task.vector.bearing, task.wind));
+  return result;
+}
+
+GlideResult
+MacCready::SolveGlide(const GlideState &task, const fixed v_set,
+                      const fixed sink_rate, const bool allow_partial) const
+{
+  // spend a lot of time in this function, so it should be quick!
+
+  GlideResult result(task, v_set);
 
+  // distance relation
+  //   V*V=Vn*Vn+W*W-2*Vn*W*cos(theta)
+  //     Vn*Vn-2*Vn*W*cos(theta)+W*W-V*V=0  ... (1)
+
+  CalcGlide(result, task.CalcAverageSpeed(v_set * cruise_efficiency),
+            sink_rate, glide_polar.GetInvMC(), allow_partial);
   return result;
 }
 
@@ -336,6 +384,164 @@ MacCready::Solve(const GlideState &task) const
   return result_fg;
 }
 
+/**
+ * Calculate the ground speed for the specified cruise speed, like
+ * GlideState::CalcAverageSpeed(), but without branches, so loops
+ * over many destinations can be vectorised.
+ *
+ * @return Ground speed (m/s), negative if the wind is too strong
+ */
+gcc_const
+static inline fixed
+BatchGroundSpeed(const fixed v, const fixed head_wind,
+                 const fixed wind_speed_squared)
+{
+  const fixed d = sqr(head_wind) - wind_speed_squared + sqr(v);
+  return negative(d) ? fixed(-1) : sqrt(d) - head_wind;
+}
+
+/**
+ * Look up the best glide speed at MC=0 for the specified wind, see
+ * GlidePolar::GetBestGlideSpeed().
+ *
+ * @param wind_speed_squared The square of the wind speed
+ * @return the speed (m/s), or zero if there is none
+ */
+gcc_pure
+static fixed
+GetBestGlideSpeed(const GlidePolar &glide_polar, const fixed head_wind,
+                  const fixed wind_speed_squared)
+{
+  const fixed cross_wind_squared = wind_speed_squared - sqr(head_wind);
+  return glide_polar.GetBestGlideSpeed(head_wind,
+                                       positive(cross_wind_squared)
+                                       ? sqrt(cross_wind_squared)
+                                       : fixed(0));
+}
+
+void
+MacCready::SolveBatch(GlideBatch &batch, GlideResult *results,
+                      const bool straight) const
+{
+  const unsigned n = batch.size();
+
+  if (!glide_polar.IsValid()) {
+    for (unsigned i = 0; i < n; ++i)
+      results[i].Reset();
+    return;
+  }
+
+  const fixed inv_mc = glide_polar.GetInvMC();
+  const fixed wind_speed_squared = sqr(batch.wind.norm);
+  const fixed *const head_winds = batch.head_winds.data();
+
+  /* the scratch buffers allocate only when the batch has grown */
+  batch.ground_speeds.resize(n);
+  fixed *const ground_speeds = batch.ground_speeds.data();
+
+  if (!positive(glide_polar.GetMC())) {
+    /* pure glide at the best glide speed over ground, see
+       OptimiseGlide() */
+
+    batch.speeds.resize(n);
+    fixed *const speeds = batch.speeds.data();
+
+    if (cruise_efficiency == glide_polar.GetCruiseEfficiency())
+      glide_polar.GetBestGlideSpeeds(head_winds, wind_speed_squared,
+                                     speeds, n);
+    else
+      std::fill_n(speeds, n, fixed(0));
+
+    for (unsigned i = 0; i < n; ++i)
+      ground_speeds[i] = positive(speeds[i])
+        ? BatchGroundSpeed(speeds[i] * cruise_efficiency, head_winds[i],
+                           wind_speed_squared)
+        : fixed(-1);
+
+    for (unsigned i = 0; i < n; ++i) {
+      const GlideState task = batch.GetState(i);
+
+      if (!positive(task.vector.distance) || !positive(ground_speeds[i])) {
+        /* unusual case, use the generic solver */
+        results[i] = straight ? SolveStraight(task) : Solve(task);
+        continue;
+      }
+
+      results[i] = GlideResult(task, speeds[i]);
+      CalcGlide(results[i], ground_speeds[i],
+                glide_polar.SinkRate(speeds[i]), inv_mc, false);
+    }
+
+    return;
+  }
+
+  /* MacCready cruise: all destinations share the glide speed and the
+     cruise speed including climbs, see Solve() */
+
+  const CruiseParameters cruise(glide_polar);
+  const fixed v_glide = glide_polar.GetVBestLD();
+  const fixed v_glide_eff = v_glide * cruise_efficiency;
+  const fixed v_cruise_eff = v_glide_eff * cruise.inv_rho_plus_one;
+
+  batch.cruise_speeds.resize(n);
+  batch.lds.resize(n);
+  fixed *const cruise_speeds = batch.cruise_speeds.data();
+  fixed *const lds = batch.lds.data();
+
+  for (unsigned i = 0; i < n; ++i) {
+    ground_speeds[i] = BatchGroundSpeed(v_glide_eff, head_winds[i],
+                                        wind_speed_squared);
+    cruise_speeds[i] = BatchGroundSpeed(v_cruise_eff, head_winds[i],
+                                        wind_speed_squared);
+
+    /* the L/D over ground at best glide, see
+       GlidePolar::GetLDOverGround() */
+    lds[i] = std::max(fixed(0), BatchGroundSpeed(v_glide, head_winds[i],
+                                                 wind_speed_squared))
+      / cruise.sink_rate;
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    const GlideState task = batch.GetState(i);
+    GlideResult &result = results[i];
+
+    if (!positive(task.vector.distance) || !positive(ground_speeds[i])) {
+      /* unusual case, use the generic solver */
+      result = straight ? SolveStraight(task) : Solve(task);
+      continue;
+    }
+
+    result = GlideResult(task, v_glide);
+
+    if (straight) {
+      CalcGlide(result, ground_speeds[i], cruise.sink_rate, inv_mc, false);
+      continue;
+    }
+
+    if (negative(task.altitude_difference)) {
+      /* whole task climb-cruise */
+      CalcCruise(result, task, cruise, cruise_speeds[i], lds[i]);
+      continue;
+    }
+
+    /* final glide as far as possible */
+    CalcGlide(result, ground_speeds[i], cruise.sink_rate, inv_mc, true);
+    if (!positive(task.vector.distance - result.vector.distance))
+      /* whole task final glided */
+      continue;
+
+    /* climb-cruise remainder of way */
+
+    GlideState sub_task = task;
+    sub_task.vector.distance -= result.vector.distance;
+    sub_task.altitude_difference -= result.height_glide;
+
+    GlideResult result_cc(sub_task, v_glide);
+    CalcCruise(result_cc, sub_task, cruise, cruise_speeds[i], lds[i]);
+    result.Add(result_cc);
+  }
+}
+
 /**
  * Class used to find VOpt to optimize glide distance, for final glide
  * calculations.  Intended to be used temporarily only.
@@ -407,6 +613,14 @@ MacCready::OptimiseGlide(const GlideState &task, const bool allow_partial) const
 {
   assert(!positive(glide_polar.GetMC()));
 
+  if (cruise_efficiency == glide_polar.GetCruiseEfficiency()) {
+    /* fast path: the speed was precalculated by GlidePolar */
+    const fixed v = GetBestGlideSpeed(glide_polar, task.head_wind,
+                                      sqr(task.wind.norm));
+    if (positive(v))
+      return SolveGlide(task, v, allow_partial);
+  }
+
   MacCreadyVopt mc_vopt(task, *this,
                        glide_polar.GetVMin(), glide_polar.GetVMax(),
                        allow_partial);
@@ -27,6 +27,7 @@
 
 struct GlideSettings;
 struct GlideState;
+class GlideBatch;
 struct GlideResult;
 class GlidePolar;
 
@@ -105,6 +106,23 @@ public:
                            const GlidePolar &glide_polar,
                            const GlideState &task);
 
+  /**
+   * Solve all destinations of a batch in one pass.  The results are
+   * the same as calling Solve() (or SolveStraight()) for each
+   * destination, but the polar and wind setup is shared, and the
+   * common cases (final glide, climb-cruise, glide at MC=0) are
+   * calculated in loops which the compiler can vectorise.
+   *
+   * @param batch The destinations; its scratch buffers are used for
+   * intermediate values
+   * @param results An array of batch.size() elements which receives
+   * the solutions
+   * @param straight Like SolveStraight(): assume straight glide, no
+   * cruise
+   */
+  void SolveBatch(GlideBatch &batch, GlideResult *results,
+                  bool straight = false) const;
+
   /**
    * Calculates the glide solution for a classical MacCready theory task
    * with no climb component (pure glide).  This is used internally to
@@ -27,6 +27,7 @@ Copyright_License {
 #include "Util/ReservablePriorityQueue.hpp"
 #include "Compiler.h"
 
+#include <vector>
 #include <assert.h>
 
 #define DIJKSTRA_MINMAX_OFFSET 134217727
@@ -214,6 +215,57 @@ public:
       q.push(Value(i.second.value, i));
   }
 
+  /**
+   * Add a known node to the queue again, to have it expanded with its
+   * current value.
+   *
+   * @return false if the node is unknown
+   */
+  bool Enqueue(const Node node) {
+    edge_iterator it = edges.find(node);
+    if (it == edges.end())
+      return false;
+
+    q.push(Value(it->second.value, it));
+    return true;
+  }
+
+  /**
+   * Renumber the nodes after the underlying data has been modified.
+   * The #Remapper is invoked for each node with a copy of its edge;
+   * it may modify both, or return false to drop the node.  Nodes
+   * which were still waiting in the queue stay there.
+   */
+  template<typename Remapper>
+  void Remap(Remapper &remapper) {
+    /* remember the nodes which are waiting in the queue; stale
+       entries were superseded by a better link and are skipped */
+    std::vector<Node> queued;
+    queued.reserve(q.size());
+    while (!q.empty()) {
+      const Value &top = q.top();
+      if (top.iterator->second.value == top.edge_value)
+        queued.push_back(top.iterator->first);
+      q.pop();
+    }
+
+    EdgeMap old_edges;
+    old_edges.swap(edges);
+
+    for (const auto &i : old_edges) {
+      Node node = i.first;
+      Edge edge = i.second;
+      if (remapper(node, edge))
+        edges.insert(std::make_pair(node, edge));
+    }
+
+    for (Node node : queued) {
+      Edge edge = old_edges.find(node)->second;
+      if (remapper(node, edge))
+        Enqueue(node);
+    }
+  }
+
 private:
   /**
    * Add node to search queue
@@ -105,7 +105,7 @@ protected:
 };
 
 
-AirspaceRoute::RouteAirspaceIntersection
+AirspaceRoute::RouteObstacle
 AirspaceRoute::FirstIntersecting(const RouteLink& e) const
 {
   const GeoPoint origin(task_projection.Unproject(e.first));
@@ -114,7 +114,7 @@ AirspaceRoute::FirstIntersecting(const RouteLink& e) const
   m_airspaces.VisitIntersecting(origin, dest, visitor);
   const AIV::AIVResult res (visitor.get_nearest());
   count_airspace++;
-  return RouteAirspaceIntersection(res.first, res.second);
+  return RouteObstacle(res.first, res.second);
 }
 
 const AbstractAirspace*
@@ -248,7 +248,7 @@ AirspaceRoute::Synchronise(const Airspaces& master,
 }
 
 void
-AirspaceRoute::AddNearbyAirspace(const RouteAirspaceIntersection &inx,
+AirspaceRoute::AddNearbyAirspace(const RouteObstacle &inx,
                                    const RouteLink &e)
 {
   const SearchPointVector& fat =
@@ -264,15 +264,12 @@ AirspaceRoute::AddNearbyAirspace(const RouteAirspaceIntersection &inx,
 }
 
 void
-AirspaceRoute::AddNearby(const RouteLink &e)
+AirspaceRoute::AddNearby(const RouteLink &e, const RouteObstacle &obstacle)
 {
-  if (m_inx.airspace == NULL) {
-    // NOTE: m_inx is "mutable" so that const in AddNearbyTerrain is ignored!!
-    // The copy is really needed!
-    RoutePoint ptmp = m_inx.point;
-    AddNearbyTerrain(ptmp, e);
-  } else
-    AddNearbyAirspace(m_inx, e);
+  if (obstacle.airspace == NULL)
+    AddNearbyTerrain(obstacle.point, e);
+  else
+    AddNearbyAirspace(obstacle, e);
 }
 
 bool
@@ -281,8 +278,7 @@ AirspaceRoute::CheckSecondary(const RouteLink &e)
   if (!rpolars_route.IsAirspaceEnabled())
     return true; // trivial
 
-  m_inx = FirstIntersecting(e);
-  if (m_inx.airspace != NULL)  {
+  if (FirstIntersecting(e).airspace != NULL)  {
     AddCandidate(e);
     return false;
   };
@@ -290,26 +286,23 @@ AirspaceRoute::CheckSecondary(const RouteLink &e)
 }
 
 bool
-AirspaceRoute::CheckClearance(const RouteLink &e, RoutePoint& inp) const
+AirspaceRoute::CheckClearance(const RouteLink &e,
+                              RouteObstacle &obstacle) const
 {
   // attempt terrain clearance first
 
-  if (!CheckClearanceTerrain(e, inp)) {
-    m_inx.airspace = NULL;
-    m_inx.point = inp;
+  obstacle.airspace = NULL;
+  if (!CheckClearanceTerrain(e, obstacle.point))
     return false;
-  }
 
   if (!rpolars_route.IsAirspaceEnabled())
     return true; // trivial
 
   // passes terrain, so now check airspace clearance
 
-  m_inx = FirstIntersecting(e);
-  if (m_inx.airspace != NULL)  {
-    inp = m_inx.point;
+  obstacle = FirstIntersecting(e);
+  if (obstacle.airspace != NULL)
     return false;
-  }
 
   // made it this far!
   return true;
@@ -28,21 +28,6 @@
 class AirspaceRoute: public RoutePlanner {
   Airspaces m_airspaces;
 
-  struct RouteAirspaceIntersection {
-    const AbstractAirspace *airspace;
-
-    RoutePoint point;
-
-    RouteAirspaceIntersection() = default;
-
-    constexpr
-    RouteAirspaceIntersection(const AbstractAirspace *_airspace,
-                              RoutePoint _point)
-      :airspace(_airspace), point(_point) {}
-  };
-
-  mutable RouteAirspaceIntersection m_inx;
-
 public:
   friend class PrintHelper;
 
@@ -67,13 +52,14 @@ protected:
   }
 
 private:
-  virtual bool CheckClearance(const RouteLink &e, RoutePoint& inp) const;
-  virtual void AddNearby(const RouteLink& e);
+  virtual bool CheckClearance(const RouteLink &e,
+                              RouteObstacle &obstacle) const;
+  virtual void AddNearby(const RouteLink& e, const RouteObstacle &obstacle);
   virtual bool CheckSecondary(const RouteLink &e);
 
-  void AddNearbyAirspace(const RouteAirspaceIntersection &inx, const RouteLink& e);
+  void AddNearbyAirspace(const RouteObstacle &inx, const RouteLink& e);
 
-  RouteAirspaceIntersection
+  RouteObstacle
   FirstIntersecting(const RouteLink& e) const;
 
   const AbstractAirspace*
@@ -23,9 +23,37 @@
 #include "RoutePlanner.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "OS/Clock.hpp"
+
+/**
+ * Batches smaller than this are checked on the calling thread; waking
+ * up the pool would cost more than the checks.
+ */
+static constexpr unsigned MIN_PARALLEL_LINKS = 4;
+
+class RoutePlanner::CheckClearanceJob final : public WorkerPool::Job {
+  const RoutePlanner &planner;
+  const RouteLink *links;
+  LinkClearance *clearances;
+
+public:
+  CheckClearanceJob(const RoutePlanner &_planner,
+                    const RouteLink *_links, LinkClearance *_clearances)
+    :planner(_planner), links(_links), clearances(_clearances) {}
+
+  virtual void Process(unsigned i) override {
+    LinkClearance &c = clearances[i];
+    c.clear = planner.CheckClearance(links[i], c.obstacle);
+  }
+};
 
 RoutePlanner::RoutePlanner()
-  :terrain(NULL), planner(0), reach_polar_mode(RoutePlannerConfig::Polar::TASK)
+  :terrain(NULL), planner(0), pool(NULL),
+   reach_polar_mode(RoutePlannerConfig::Polar::TASK),
+   count_dij(0), count_unique(0), count_supressed(0),
+   time_solve(0), time_clearance(0), time_expand(0),
+   count_airspace(0), count_terrain(0)
 #ifndef PLANNER_SET
   , unique_links(50000)
 #endif
@@ -117,6 +145,10 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   count_airspace = 0;
   count_terrain = 0;
   count_supressed = 0;
+  time_clearance = 0;
+  time_expand = 0;
+
+  const uint64_t start_time = MonotonicClockUS();
 
   bool retval = false;
   planner.Restart(start);
@@ -152,16 +184,13 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
     // shoot for final
     RouteLink e(node, astar_goal, task_projection);
     if (IsSetUnique(e))
-      AddEdges(e);
-
-    while (!links.empty()) {
-      AddEdges(links.front());
-      links.pop();
-    }
+      links.push_back(e);
 
+    ProcessLinks();
   }
 
   count_unique = unique_links.size();
+  time_solve = MonotonicClockUS() - start_time;
 
   if (retval) {
     // correct solution for rounding
@@ -298,7 +327,7 @@ RoutePlanner::AddCandidate(const RouteLinkBase& e)
   const RouteLink c_link =
       rpolars_route.GenerateIntermediate(e.first, e.second, task_projection);
 
-  links.push(c_link);
+  links.push_back(c_link);
 }
 
 void
@@ -307,7 +336,7 @@ RoutePlanner::AddCandidate(const RouteLink &e)
   if (!IsSetUnique(e))
     return;
 
-  links.push(e);
+  links.push_back(e);
 }
 
 void
@@ -334,23 +363,54 @@ RoutePlanner::AddShortcut(const RoutePoint &node)
 
   assert(pre.altitude <= node.altitude);
 
-  RoutePoint inx;
+  RouteObstacle obstacle;
   const RoughAltitude vh = rpolars_route.CalcVHeight(r_shortcut);
   if (!rpolars_route.CanClimb())
     r_shortcut.second.altitude = r_shortcut.first.altitude + vh;
 
-  if (CheckClearance(r_shortcut, inx))
+  if (CheckClearance(r_shortcut, obstacle))
     LinkCleared(r_shortcut);
 }
 
 void
-RoutePlanner::AddEdges(const RouteLink &e)
+RoutePlanner::ProcessLinks()
+{
+  while (!links.empty()) {
+    /* the candidates generated by this batch go to the next one, so
+       the links are passed to AddEdges() in the same order as with a
+       FIFO queue */
+    batch.swap(links);
+    links.clear();
+
+    const unsigned n = batch.size();
+    batch_clearances.resize(n);
+
+    const uint64_t check_time = MonotonicClockUS();
+
+    CheckClearanceJob job(*this, batch.data(), batch_clearances.data());
+    if (pool != NULL && n >= MIN_PARALLEL_LINKS)
+      pool->Run(job, n);
+    else
+      for (unsigned i = 0; i < n; ++i)
+        job.Process(i);
+
+    const uint64_t expand_time = MonotonicClockUS();
+    time_clearance += expand_time - check_time;
+
+    for (unsigned i = 0; i < n; ++i)
+      AddEdges(batch[i], batch_clearances[i]);
+
+    time_expand += MonotonicClockUS() - expand_time;
+  }
+}
+
+void
+RoutePlanner::AddEdges(const RouteLink &e, const LinkClearance &clearance)
 {
   const bool this_short = e.IsShort();
-  RoutePoint inx;
-  if (!CheckClearance(e, inx)) {
+  if (!clearance.clear) {
     if (!this_short)
-      AddNearby(e);
+      AddNearby(e, clearance.obstacle);
 
     return;
   }
@@ -34,8 +34,14 @@
 
 #include <utility>
 #include <algorithm>
+#include <vector>
+#include <atomic>
+
+#include <stdint.h>
 
 class GlidePolar;
+class WorkerPool;
+class AbstractAirspace;
 
 // define PLANNER_SET if STL tr1 extensions are not to be used
 // (with performance penalty)
@@ -106,11 +112,34 @@ namespace std
  * Since this class calls RasterMap functions repeatedly, rather than acquiring
  * and releasing locks each time, we assume the hookup to the main program
  * (RoutePlannerGlue) is responsible for locking the RasterMap on solve() calls.
+ *
+ * The candidate links are checked for obstacles in batches.  If a
+ * #WorkerPool is set, the checks of one batch run in parallel, while
+ * the A* search is updated with the results on the calling thread, in
+ * the order in which the candidates were generated.  The solution is
+ * therefore the same with or without a pool.
  */
 class RoutePlanner {
 protected:
   typedef std::pair<AFlatGeoPoint, AFlatGeoPoint> ClearingPair;
 
+  /**
+   * The first obstacle found by CheckClearance() on a link.
+   */
+  struct RouteObstacle {
+    /** The airspace which was hit, or NULL if it was terrain */
+    const AbstractAirspace *airspace;
+
+    /** The clearance point */
+    RoutePoint point;
+
+    RouteObstacle() = default;
+
+    constexpr
+    RouteObstacle(const AbstractAirspace *_airspace, RoutePoint _point)
+      :airspace(_airspace), point(_point) {}
+  };
+
   /** Whether an updated solution is required */
   bool dirty;
   /** Task projection used for flat-earth representation */
@@ -150,9 +179,28 @@ private:
 #endif
   /** Links that have been visited during solution */
   RouteLinkSet unique_links;
-  typedef std::queue< RouteLink> RouteLinkQueue;
   /** Link candidates to be processed for intersection tests */
-  RouteLinkQueue links;
+  std::vector<RouteLink> links;
+
+  /**
+   * The result of CheckClearance() for one candidate link.
+   */
+  struct LinkClearance {
+    RouteObstacle obstacle;
+    bool clear;
+  };
+
+  class CheckClearanceJob;
+
+  /** The candidate links being processed by ProcessLinks() */
+  std::vector<RouteLink> batch;
+  /** The CheckClearance() results of #batch */
+  std::vector<LinkClearance> batch_clearances;
+
+  /**
+   * If set, the candidate links are checked on this pool.
+   */
+  WorkerPool *pool;
 
   /** Result route found by solve() method */
   Route solution_route;
@@ -170,10 +218,18 @@ private:
   mutable unsigned long count_unique;
   mutable unsigned long count_supressed;
 
+  /**
+   * Wall time (in microseconds) of the last Solve() call, of its
+   * batched clearance checks and of the A* search updates.
+   */
+  uint64_t time_solve, time_clearance, time_expand;
+
 protected:
   RoutePoint astar_goal;
-  mutable unsigned long count_airspace;
-  mutable unsigned long count_terrain;
+
+  /* these are incremented concurrently by the clearance checks */
+  mutable std::atomic<unsigned long> count_airspace;
+  mutable std::atomic<unsigned long> count_terrain;
 
 public:
   friend class PrintHelper;
@@ -193,6 +249,17 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Check the candidate links with the specified #WorkerPool from
+   * now on.  The terrain and the obstacles of the subclass must not
+   * be modified during Solve().
+   *
+   * @param pool the pool, or NULL to check them on the calling thread
+   */
+  void SetWorkerPool(WorkerPool *_pool) {
+    pool = _pool;
+  }
+
   bool IsReachEmpty() const {
     return reach.IsEmpty();
   }
@@ -388,22 +455,25 @@ private:
    * any obstacle.  If it does, find also the first location that is clear to
    * the destination.
    *
+   * This may be called from several threads at a time (see
+   * SetWorkerPool()), and must not modify the object.
+   *
    * @param e Link to attempt
-   * @param inp Output clearance point if intersection occurs
+   * @param obstacle Output obstacle and clearance point if intersection occurs
    *
    * @return True if path is clear
    */
-
-  virtual bool CheckClearance(const RouteLink &e, RoutePoint& inx) const = 0;
+  virtual bool CheckClearance(const RouteLink &e,
+                              RouteObstacle &obstacle) const = 0;
 
   /**
    * Given a desired path e, and a clearance point, generate candidates directly
    * to the clearance point and elsewhere in attempt to avoid the obstacle.
    *
-   * @param inx Clearance point from last check
    * @param e Link that was attempted
+   * @param obstacle Obstacle found by CheckClearance()
    */
-  virtual void AddNearby(const RouteLink &e) = 0;
+  virtual void AddNearby(const RouteLink &e, const RouteObstacle &obstacle) = 0;
 
   /**
    * Hook to allow subclasses to update internal data at start of solve() call
@@ -425,13 +495,21 @@ private:
    */
   void AddNearbyTerrainSweep(const RoutePoint& p, const RouteLink &c_link, const int sign);
 
+  /**
+   * Check all candidate links in #links (in parallel if there is a
+   * #WorkerPool) and pass them to AddEdges(), until no new candidates
+   * are generated.
+   */
+  void ProcessLinks();
+
   /**
    * For a link known to not clear obstacles, generate whatever candidate edges
    * are required to attempt to avoid the obstacles or at least to continue searching.
    *
    * @param e Link to check
+   * @param clearance The CheckClearance() result of the link
    */
-  void AddEdges(const RouteLink &e);
+  void AddEdges(const RouteLink &e, const LinkClearance &clearance);
 
   /**
    * Test whether a candidate destination is inside the area already searched
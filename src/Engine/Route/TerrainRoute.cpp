@@ -21,24 +21,16 @@
  */
 #include "TerrainRoute.hpp"
 
-TerrainRoute::TerrainRoute():
-  m_inx_terrain(0, 0, RoughAltitude(0))
-{
-
-}
-
 bool
-TerrainRoute::CheckClearance(const RouteLink &e, RoutePoint& inp) const
+TerrainRoute::CheckClearance(const RouteLink &e, RouteObstacle &obstacle) const
 {
-  if (CheckClearanceTerrain(e, inp))
-    return true;
-  m_inx_terrain = inp;
-  return false;
+  obstacle.airspace = NULL;
+  return CheckClearanceTerrain(e, obstacle.point);
 }
 
 void
-TerrainRoute::AddNearby(const RouteLink& e)
+TerrainRoute::AddNearby(const RouteLink& e, const RouteObstacle &obstacle)
 {
-  AddNearbyTerrain(m_inx_terrain, e);
+  AddNearbyTerrain(obstacle.point, e);
 }
 
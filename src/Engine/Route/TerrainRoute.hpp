@@ -28,16 +28,12 @@ class RasterMap;
 
 class TerrainRoute: public RoutePlanner
 {
-  mutable RoutePoint m_inx_terrain;
-
 public:
-  TerrainRoute();
-
   friend class PrintHelper;
 
 private:
-  bool CheckClearance(const RouteLink &e, RoutePoint& inp) const;
-  void AddNearby(const RouteLink& e);
+  bool CheckClearance(const RouteLink &e, RouteObstacle &obstacle) const;
+  void AddNearby(const RouteLink& e, const RouteObstacle &obstacle);
 };
 
 #endif
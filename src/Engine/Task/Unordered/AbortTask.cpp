@@ -24,7 +24,9 @@
 #include "Task/TaskBehaviour.hpp"
 #include "Navigation/Aircraft.hpp"
 #include "Task/Visitors/TaskPointVisitor.hpp"
-#include "Task/Solvers/TaskSolution.hpp"
+#include "GlideSolvers/GlideBatch.hpp"
+#include "GlideSolvers/GlideResult.hpp"
+#include "GlideSolvers/MacCready.hpp"
 #include "Task/TaskEvents.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "Waypoint/WaypointVisitor.hpp"
@@ -140,46 +142,62 @@ AbortTask::FillReachable(const AircraftState &state,
   if (IsTaskFull() || approx_waypoints.empty())
     return false;
 
-  const AGeoPoint p_start(state.location, state.altitude);
+  /* solve the glides to all candidates in one pass */
+
+  GlideBatch batch;
+  batch.Reset(state.altitude, state.wind);
+  batch.reserve(approx_waypoints.size());
+
+  for (const auto &v : approx_waypoints)
+    if (!only_airfield || v.waypoint.IsAirport())
+      batch.Add(GeoVector(state.location, v.waypoint.location),
+                std::max(fixed(0), v.waypoint.elevation +
+                         task_behaviour.safety_height_arrival));
+
+  std::vector<GlideResult> results(batch.size());
+  const MacCready mac_cready(task_behaviour.glide, polar);
+  mac_cready.SolveBatch(batch, results.data());
 
   bool found_final_glide = false;
   reservable_priority_queue<Alternate, AlternateVector, AbortRank> q;
   q.reserve(32);
 
-  for (auto v = approx_waypoints.begin(); v != approx_waypoints.end();) {
-    if (only_airfield && !v->waypoint.IsAirport()) {
-      ++v;
-      continue;
-    }
+  /* move the reachable waypoints to the queue, and compact the
+     remaining ones in place */
+  auto remaining = approx_waypoints.begin();
+  auto result = results.begin();
+  for (auto v = approx_waypoints.begin(), end = approx_waypoints.end();
+       v != end; ++v) {
+    if (!only_airfield || v->waypoint.IsAirport()) {
+      const GlideResult &solution = *result++;
 
-    UnorderedTaskPoint t(v->waypoint, task_behaviour);
-    GlideResult result =
-        TaskSolution::GlideSolutionRemaining(t, state,
-                                             task_behaviour.glide, polar);
+      if (IsReachable(solution, final_glide)) {
+        bool intersects = false;
+        const bool is_reachable_final = IsReachable(solution, true);
 
-    if (IsReachable(result, final_glide)) {
-      bool intersects = false;
-      const bool is_reachable_final = IsReachable(result, true);
+        if (intersection_test && final_glide && is_reachable_final)
+          intersects = intersection_test->Intersects(
+              AGeoPoint(v->waypoint.location, solution.min_arrival_altitude));
 
-      if (intersection_test && final_glide && is_reachable_final)
-        intersects = intersection_test->Intersects(
-            AGeoPoint(v->waypoint.location, result.min_arrival_altitude));
+        if (!intersects) {
+          q.push(Alternate(std::move(v->waypoint), solution));
 
-      if (!intersects) {
-        q.push(Alternate(v->waypoint, result));
-        // remove it since it's already in the list now      
-        approx_waypoints.erase(v);
+          if (is_reachable_final)
+            found_final_glide = true;
 
-        if (is_reachable_final)
-          found_final_glide = true;
-
-        continue; // skip incrementing v since we just erased it
+          // remove it since it's already in the list now
+          continue;
+        }
       }
-    } 
+    }
 
-    ++v;
+    if (remaining != v)
+      *remaining = std::move(*v);
+    ++remaining;
   }
 
+  approx_waypoints.erase(remaining, approx_waypoints.end());
+
   while (!q.empty() && !IsTaskFull()) {
     const Alternate top = q.top();
     task_points.emplace_back(top.waypoint, task_behaviour, top.solution);
@@ -24,37 +24,46 @@ Copyright_License {
 #include "Trace.hpp"
 #include "Vector.hpp"
 #include "Navigation/Aircraft.hpp"
-#include "Util/GlobalSliceAllocator.hpp"
 
 #include <algorithm>
 
 Trace::Trace(const unsigned _no_thin_time, const unsigned max_time,
              const unsigned max_size)
-  :chronological_list(ListHead::empty()),
-   cached_size(0),
+  :nodes(max_size + 1), heap(max_size),
    max_time(max_time),
    no_thin_time(_no_thin_time),
    max_size(max_size),
-   opt_size((3 * max_size) / 4)
+   opt_size((3 * max_size) / 4),
+   average_delta_time(0), average_delta_distance(0)
 {
   assert(max_size >= 4);
+
+  ClearNodes();
+}
+
+void
+Trace::ClearNodes()
+{
+  TraceDelta &head = GetHead();
+  head.previous = head.next = GetHeadIndex();
+
+  for (unsigned i = 0; i < max_size; ++i)
+    nodes[i].next = i + 1 < max_size ? i + 1 : INVALID_INDEX;
+  free_head = 0;
+
+  heap_size = 0;
+  cached_size = 0;
 }
 
 void
 Trace::clear()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
+  assert(cached_size == heap_size);
 
   average_delta_distance = 0;
   average_delta_time = 0;
 
-  delta_list.clear();
-  chronological_list.Clear();
-  cached_size = 0;
-
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
+  ClearNodes();
 
   ++modify_serial;
   ++append_serial;
@@ -74,51 +83,119 @@ Trace::GetRecentTime(const unsigned t) const
 }
 
 void
-Trace::UpdateDelta(TraceDelta &td)
+Trace::HeapSiftUp(unsigned position)
+{
+  while (position > 0) {
+    const unsigned parent = (position - 1) / 2;
+    if (!HeapLess(position, parent))
+      break;
+
+    HeapSwap(position, parent);
+    position = parent;
+  }
+}
+
+void
+Trace::HeapSiftDown(unsigned position)
+{
+  while (true) {
+    const unsigned left = 2 * position + 1;
+    if (left >= heap_size)
+      break;
+
+    const unsigned right = left + 1;
+    const unsigned best = right < heap_size && HeapLess(right, left)
+      ? right : left;
+    if (!HeapLess(best, position))
+      break;
+
+    HeapSwap(position, best);
+    position = best;
+  }
+}
+
+void
+Trace::HeapPush(unsigned i)
+{
+  assert(heap_size < max_size);
+  assert(nodes[i].heap_index == INVALID_INDEX);
+
+  const unsigned position = heap_size++;
+  heap[position] = i;
+  nodes[i].heap_index = position;
+  HeapSiftUp(position);
+}
+
+void
+Trace::HeapRemove(unsigned i)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
+  const unsigned position = nodes[i].heap_index;
+  assert(position < heap_size);
+  assert(heap[position] == i);
 
-  if (chronological_list.IsEdge(td))
+  nodes[i].heap_index = INVALID_INDEX;
+
+  --heap_size;
+  if (position == heap_size)
     return;
 
-  const TraceDelta &previous = td.GetPrevious();
-  const TraceDelta &next = td.GetNext();
+  /* move the last item into the gap */
+  const unsigned last = heap[heap_size];
+  heap[position] = last;
+  nodes[last].heap_index = position;
+  HeapUpdate(last);
+}
+
+void
+Trace::HeapUpdate(unsigned i)
+{
+  const unsigned position = nodes[i].heap_index;
+  assert(position < heap_size);
+
+  if (position > 0 && HeapLess(position, (position - 1) / 2))
+    HeapSiftUp(position);
+  else
+    HeapSiftDown(position);
+}
+
+void
+Trace::Unlink(unsigned i)
+{
+  TraceDelta &td = nodes[i];
+  nodes[td.previous].next = td.next;
+  nodes[td.next].previous = td.previous;
 
-  TraceDelta temp_td = td;
-  temp_td.SetDisconnected();
+  if (td.heap_index != INVALID_INDEX)
+    HeapRemove(i);
+
+  td.next = free_head;
+  free_head = i;
+}
 
-  td.Replace(temp_td);
+void
+Trace::UpdateDelta(unsigned i)
+{
+  if (IsFirst(i) || IsLast(i))
+    return;
 
-  // erase old one
-  auto i = delta_list.find(td);
-  assert(i != delta_list.end());
-  delta_list.erase(i);
+  TraceDelta &td = nodes[i];
+  td.Update(nodes[td.previous].point, nodes[td.next].point);
 
-  // insert new in sorted position
-  temp_td.Update(previous.point, next.point);
-  TraceDelta &new_td = Insert(temp_td);
-  new_td.SetDisconnected();
-  temp_td.Replace(new_td);
+  if (td.heap_index != INVALID_INDEX)
+    HeapUpdate(i);
 }
 
 void
-Trace::EraseInside(TraceDelta::iterator it)
+Trace::EraseInside(unsigned i)
 {
   assert(cached_size > 0);
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
-  assert(it != delta_list.end());
-
-  const TraceDelta &td = *it;
-  assert(!td.IsEdge());
+  assert(!nodes[i].IsEdge());
 
-  TraceDelta &previous = const_cast<TraceDelta &>(td.GetPrevious());
-  TraceDelta &next = const_cast<TraceDelta &>(td.GetNext());
+  const unsigned previous = nodes[i].previous;
+  const unsigned next = nodes[i].next;
 
   // now delete the item
-  td.RemoveConst();
-  delta_list.erase(it);
+  Unlink(i);
   --cached_size;
 
   // and update the deltas
@@ -129,8 +206,7 @@ Trace::EraseInside(TraceDelta::iterator it)
 bool
 Trace::EraseDelta(const unsigned target_size, const unsigned recent)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
+  assert(cached_size == heap_size);
 
   if (size() < 2)
     return false;
@@ -139,44 +215,48 @@ Trace::EraseDelta(const unsigned target_size, const unsigned recent)
 
   const unsigned recent_time = GetRecentTime(recent);
 
-  TraceDelta::iterator candidate = delta_list.begin();
-  while (size() > target_size) {
-    const TraceDelta &td = *candidate;
+  /* candidates whose removal is suppressed are taken out of the heap
+     until we're done; they are parked at the end of the heap array,
+     which is not used while they are missing */
+  unsigned n_skipped = 0;
+
+  while (size() > target_size && heap_size > 0) {
+    const unsigned i = heap[0];
+    const TraceDelta &td = nodes[i];
     if (!td.IsEdge() && td.point.GetTime() < recent_time) {
-      EraseInside(candidate);
-      candidate = delta_list.begin(); // find new top
+      EraseInside(i);
       modified = true;
     } else {
-      ++candidate;
       // suppressed removal, skip it.
+      HeapRemove(i);
+      heap[max_size - 1 - n_skipped++] = i;
     }
   }
 
+  while (n_skipped > 0) {
+    --n_skipped;
+    HeapPush(heap[max_size - 1 - n_skipped]);
+  }
+
   return modified;
 }
 
 bool
 Trace::EraseEarlierThan(const unsigned p_time)
 {
-  if (p_time == 0 || empty() || GetFront().point.GetTime() >= p_time)
+  if (p_time == 0 || empty() || front().GetTime() >= p_time)
     // there will be nothing to remove
     return false;
 
   do {
-    TraceDelta &td = GetFront();
-    td.Remove();
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase(i);
-
+    Unlink(GetHead().next);
     --cached_size;
-  } while (!empty() && GetFront().point.GetTime() < p_time);
+  } while (!empty() && front().GetTime() < p_time);
 
   // need to set deltas for first point, only one of these
   // will occur (have to search for this point)
   if (!empty())
-    EraseStart(GetFront());
+    EraseStart(GetHead().next);
 
   ++modify_serial;
   ++append_serial;
@@ -189,60 +269,57 @@ Trace::EraseLaterThan(const unsigned min_time)
   assert(min_time > 0);
   assert(!empty());
 
-  while (!empty() && GetBack().point.GetTime() > min_time) {
-    TraceDelta &td = GetBack();
-
-    td.Remove();
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase(i);
-
+  while (!empty() && back().GetTime() > min_time) {
+    Unlink(GetHead().previous);
     --cached_size;
   }
 
   /* need to set deltas for first point, only one of these will occur
      (have to search for this point) */
   if (!empty())
-    EraseStart(GetBack());
+    EraseStart(GetHead().previous);
 }
 
-Trace::TraceDelta &
-Trace::Insert(const TraceDelta &td) {
-  TraceDelta::iterator it = delta_list.insert(td);
+unsigned
+Trace::Insert(const TracePoint &point)
+{
+  assert(free_head != INVALID_INDEX);
+
+  const unsigned i = free_head;
+  TraceDelta &td = nodes[i];
+  free_head = td.next;
+
+  td.Set(point);
+  td.heap_index = INVALID_INDEX;
 
-  /* std::set doesn't allow modification of an item, but we
-     override that */
-  TraceDelta &new_td = const_cast<TraceDelta &>(*it);
-  return new_td;
+  TraceDelta &head = GetHead();
+  td.previous = head.previous;
+  td.next = GetHeadIndex();
+  nodes[head.previous].next = i;
+  head.previous = i;
+
+  HeapPush(i);
+  return i;
 }
 
 /**
  * Update start node (and neighbour) after min time pruning
  */
 void
-Trace::EraseStart(TraceDelta &td_start) {
-  TraceDelta temp_td = td_start;
-  temp_td.SetDisconnected();
-  td_start.Replace(temp_td);
-
-  auto i_start = delta_list.find(td_start);
-  assert(i_start != delta_list.end());
-  delta_list.erase(i_start);
-
-  temp_td.elim_distance = null_delta;
-  temp_td.elim_time = null_time;
+Trace::EraseStart(unsigned i)
+{
+  TraceDelta &td = nodes[i];
+  td.elim_distance = null_delta;
+  td.elim_time = null_time;
 
-  TraceDelta &new_td = Insert(temp_td);
-  new_td.SetDisconnected();
-  temp_td.Replace(new_td);
+  if (td.heap_index != INVALID_INDEX)
+    HeapUpdate(i);
 }
 
 void
 Trace::push_back(const TracePoint &point)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
+  assert(cached_size == heap_size);
 
   if (empty()) {
     // first point determines origin for flat projection
@@ -271,14 +348,13 @@ Trace::push_back(const TracePoint &point)
 
   assert(size() < max_size);
 
-  TraceDelta &td = Insert(point);
-  td.point.Project(task_projection);
-  td.InsertBefore(chronological_list);
+  const unsigned i = Insert(point);
+  nodes[i].point.Project(task_projection);
 
   ++cached_size;
 
-  if (!chronological_list.IsFirst(td))
-    UpdateDelta(td.GetPrevious());
+  if (!IsFirst(i))
+    UpdateDelta(nodes[i].previous);
 
   ++append_serial;
 }
@@ -290,10 +366,10 @@ Trace::CalcAverageDeltaDistance(const unsigned no_thin) const
   unsigned acc = 0;
   unsigned counter = 0;
 
-  const ChronologicalConstIterator end = chronological_list.end();
-  for (ChronologicalConstIterator it = chronological_list.begin();
-       it != end && it->point.GetTime() < r; ++it, ++counter)
-    acc += it->delta_distance;
+  for (unsigned i = GetHead().next;
+       i != GetHeadIndex() && nodes[i].point.GetTime() < r;
+       i = nodes[i].next, ++counter)
+    acc += nodes[i].delta_distance;
 
   if (counter)
     return acc / counter;
@@ -308,19 +384,20 @@ Trace::CalcAverageDeltaTime(const unsigned no_thin) const
   unsigned counter = 0;
 
   /* find the last item before the "r" timestamp */
-  const ChronologicalConstIterator end = chronological_list.end();
-  ChronologicalConstIterator it;
-  for (it = chronological_list.begin(); it != end && it->point.GetTime() < r; ++it)
+  unsigned i;
+  for (i = GetHead().next;
+       i != GetHeadIndex() && nodes[i].point.GetTime() < r;
+       i = nodes[i].next)
     ++counter;
 
   if (counter < 2)
     return 0;
 
-  --it;
+  i = nodes[i].previous;
   --counter;
 
   unsigned start_time = front().GetTime();
-  unsigned end_time = it->point.GetTime();
+  unsigned end_time = nodes[i].point.GetTime();
   return (end_time - start_time) / counter;
 }
 
@@ -361,8 +438,7 @@ Trace::Thin2()
 void
 Trace::Thin()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
+  assert(cached_size == heap_size);
   assert(size() == max_size);
 
   Thin2();
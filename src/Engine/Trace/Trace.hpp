@@ -26,15 +26,15 @@ Copyright_License {
 
 #include "Point.hpp"
 #include "Util/NonCopyable.hpp"
-#include "Util/SliceAllocator.hpp"
-#include "Util/ListHead.hpp"
-#include "Util/CastIterator.hpp"
+#include "Util/AllocatedArray.hpp"
 #include "Util/Serial.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Compiler.h"
 
-#include <set>
+#include <algorithm>
+#include <iterator>
 #include <assert.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -50,10 +50,14 @@ class TracePointerVector;
  * the candidate point removed.  In this version, time differences is also a
  * secondary factor, such that thinning attempts to remove points such that,
  * for equal distance ranking, smaller time step details are removed first.
+ *
+ * All items live in one array which is allocated by the constructor.
+ * They are chained in chronological order by their indices, and a
+ * binary heap of indices ranks them for thinning.
  */
 class Trace : private NonCopyable
 {
-  struct TraceDelta : public ListHead {
+  struct TraceDelta {
     /**
      * Function used to points for sorting by deltas.
      * Ranking is primarily by distance delta; for equal distances, rank by
@@ -85,39 +89,29 @@ class Trace : private NonCopyable
       return false;
     }
 
-    struct DeltaRankOp {
-      bool operator()(const TraceDelta &s1, const TraceDelta &s2) {
-        return DeltaRank(s1, s2);
-      }
-    };
-
-    /* using std::multiset, not because we need multiple values (we
-       don't), but to avoid std::set's overhead for duplicate
-       elimination */
-    typedef std::multiset<TraceDelta, DeltaRankOp,
-                          GlobalSliceAllocator<TraceDelta, 128u> > List;
-    typedef List::iterator iterator;
-    typedef List::const_iterator const_iterator;
-
     TracePoint point;
 
     unsigned elim_time;
     unsigned elim_distance;
     unsigned delta_distance;
 
-    TraceDelta(const TracePoint &p)
-      :point(p),
-       elim_time(null_time), elim_distance(null_delta),
-       delta_distance(0) {}
-
-    TraceDelta(const TracePoint &p_last, const TracePoint &p,
-               const TracePoint &p_next)
-      :point(p),
-       elim_time(TimeMetric(p_last, p, p_next)),
-       elim_distance(DistanceMetric(p_last, p, p_next)),
-       delta_distance(p.FlatDistanceTo(p_last))
-    {
-      assert(elim_distance != null_delta);
+    /**
+     * The indices of the chronological neighbours in #nodes.  For
+     * unused items, #next links the free list.
+     */
+    unsigned previous, next;
+
+    /**
+     * The position of this item in #heap, or #INVALID_INDEX if it
+     * is not in the heap.
+     */
+    unsigned heap_index;
+
+    void Set(const TracePoint &p) {
+      point = p;
+      elim_time = null_time;
+      elim_distance = null_delta;
+      delta_distance = 0;
     }
 
     /**
@@ -127,22 +121,6 @@ class Trace : private NonCopyable
       return elim_time == null_time;
     }
 
-    TraceDelta &GetPrevious() {
-      return *(TraceDelta *)ListHead::GetPrevious();
-    }
-
-    TraceDelta &GetNext() {
-      return *(TraceDelta *)ListHead::GetNext();
-    }
-
-    const TraceDelta &GetPrevious() const {
-      return *(const TraceDelta *)ListHead::GetPrevious();
-    }
-
-    const TraceDelta &GetNext() const {
-      return *(const TraceDelta *)ListHead::GetNext();
-    }
-
     void Update(const TracePoint &p_last, const TracePoint &p_next) {
       elim_time = TimeMetric(p_last, point, p_next);
       elim_distance = DistanceMetric(p_last, point, p_next);
@@ -186,10 +164,29 @@ class Trace : private NonCopyable
     }
   };
 
-  typedef CastIterator<const TraceDelta, ListHead::const_iterator> ChronologicalConstIterator;
+  static constexpr unsigned INVALID_INDEX = 0 - 1;
+
+  /**
+   * All items.  The last element is not a point, it is the head of
+   * the chronological list: its #TraceDelta::next is the first point,
+   * and its #TraceDelta::previous is the last one.
+   */
+  AllocatedArray<TraceDelta> nodes;
+
+  /**
+   * The first unused element of #nodes, or #INVALID_INDEX if all
+   * are in use.
+   */
+  unsigned free_head;
+
+  /**
+   * A binary min-heap of #nodes indices, ranked by
+   * TraceDelta::DeltaRank().  The best thinning candidate is on
+   * top.
+   */
+  AllocatedArray<unsigned> heap;
+  unsigned heap_size;
 
-  TraceDelta::List delta_list;
-  ListHead chronological_list;
   unsigned cached_size;
 
   TaskProjection task_projection;
@@ -230,25 +227,19 @@ protected:
   unsigned GetRecentTime(const unsigned t) const;
 
   /**
-   * Update delta values for specified item in the delta list and the
-   * tree.  This repositions the item after into its sorted position.
-   *
-   * @param it Item to update
-   * @param tree Tree containing leaf
+   * Update delta values for specified item, and move it to its new
+   * position in the heap.
    *
-   * @return Iterator to updated item
+   * @param i Index of the item to update
    */
-  void UpdateDelta(TraceDelta &td);
+  void UpdateDelta(unsigned i);
 
   /**
-   * Erase a non-edge item from delta list and tree, updating
-   * deltas in the process.  This Invalidates the calling iterator.
-   *
-   * @param it Item to erase
-   * @param tree Tree to remove from
+   * Erase a non-edge item, updating the deltas of its neighbours.
    *
+   * @param i Index of the item to erase
    */
-  void EraseInside(TraceDelta::iterator it);
+  void EraseInside(unsigned i);
 
   /**
    * Erase elements based on delta metric until the size is
@@ -259,7 +250,6 @@ protected:
    * fail to set the target size.
    *
    * @param target_size Size of desired list.
-   * @param tree Tree to remove from
    * @param recent Time window for which to not remove points
    *
    * @return True if items were erased
@@ -268,11 +258,10 @@ protected:
                   const unsigned recent = 0);
 
   /**
-   * Erase elements older than specified time from delta and tree,
-   * and update earliest item to become the new start
+   * Erase elements older than specified time, and update earliest
+   * item to become the new start
    *
    * @param p_time Time to remove
-   * @param tree Tree to remove from
    *
    * @return True if items were erased
    */
@@ -284,12 +273,17 @@ protected:
    */
   void EraseLaterThan(const unsigned min_time);
 
-  TraceDelta &Insert(const TraceDelta &td);
+  /**
+   * Append a point to the chronological list.
+   *
+   * @return the index of the new item
+   */
+  unsigned Insert(const TracePoint &point);
 
   /**
    * Update start node (and neighbour) after min time pruning
    */
-  void EraseStart(TraceDelta &td_start);
+  void EraseStart(unsigned i);
 
 public:
   /**
@@ -388,16 +382,69 @@ public:
   const TracePoint &front() const {
     assert(!empty());
 
-    return static_cast<const TraceDelta *>(chronological_list.GetNext())->point;
+    return nodes[GetHead().next].point;
   }
 
   const TracePoint &back() const {
     assert(!empty());
 
-    return static_cast<const TraceDelta *>(chronological_list.GetPrevious())->point;
+    return nodes[GetHead().previous].point;
   }
 
 private:
+  unsigned GetHeadIndex() const {
+    return max_size;
+  }
+
+  const TraceDelta &GetHead() const {
+    return nodes[GetHeadIndex()];
+  }
+
+  TraceDelta &GetHead() {
+    return nodes[GetHeadIndex()];
+  }
+
+  bool IsFirst(unsigned i) const {
+    return nodes[i].previous == GetHeadIndex();
+  }
+
+  bool IsLast(unsigned i) const {
+    return nodes[i].next == GetHeadIndex();
+  }
+
+  /**
+   * Reset the chronological list, the free list and the heap.
+   */
+  void ClearNodes();
+
+  /**
+   * Remove an item from the chronological list and from the heap,
+   * and put it on the free list.
+   */
+  void Unlink(unsigned i);
+
+  gcc_pure
+  bool HeapLess(unsigned a, unsigned b) const {
+    return TraceDelta::DeltaRank(nodes[heap[a]], nodes[heap[b]]);
+  }
+
+  void HeapSwap(unsigned a, unsigned b) {
+    std::swap(heap[a], heap[b]);
+    nodes[heap[a]].heap_index = a;
+    nodes[heap[b]].heap_index = b;
+  }
+
+  void HeapSiftUp(unsigned position);
+  void HeapSiftDown(unsigned position);
+
+  void HeapPush(unsigned i);
+  void HeapRemove(unsigned i);
+
+  /**
+   * Restore the heap order after the rank of the item has changed.
+   */
+  void HeapUpdate(unsigned i);
+
   /**
    * Enforce the maximum duration, i.e. remove points that are too
    * old.  This will be called before a new point is added, therefore
@@ -421,18 +468,6 @@ private:
    */
   void Thin();
 
-  TraceDelta &GetFront() {
-    assert(!empty());
-
-    return *static_cast<TraceDelta *>(chronological_list.GetNext());
-  }
-
-  TraceDelta &GetBack() {
-    assert(!empty());
-
-    return *static_cast<TraceDelta *>(chronological_list.GetPrevious());
-  }
-
   gcc_pure
   unsigned CalcAverageDeltaDistance(const unsigned no_thin) const;
 
@@ -456,13 +491,14 @@ public:
   class const_iterator {
     friend class Trace;
 
-    ListHead::const_iterator iterator;
+    const TraceDelta *nodes;
+    unsigned index;
 
-    const_iterator(ListHead::const_iterator _iterator)
-      :iterator(_iterator) {}
+    const_iterator(const TraceDelta *_nodes, unsigned _index)
+      :nodes(_nodes), index(_index) {}
 
   public:
-    typedef ListHead::const_iterator::iterator_category iterator_category;
+    typedef std::bidirectional_iterator_tag iterator_category;
     typedef ptrdiff_t difference_type;
     typedef const TracePoint value_type;
     typedef const TracePoint *pointer;
@@ -471,76 +507,74 @@ public:
     const_iterator() = default;
 
     const TracePoint &operator*() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return td.point;
+      return nodes[index].point;
     }
 
     const TracePoint *operator->() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return &td.point;
+      return &nodes[index].point;
     }
 
     const_iterator &operator++() {
-      ++iterator;
+      index = nodes[index].next;
       return *this;
     }
 
     const_iterator operator++(int) {
       const_iterator old = *this;
-      iterator++;
+      index = nodes[index].next;
       return old;
     }
 
     const_iterator &operator--() {
-      --iterator;
+      index = nodes[index].previous;
       return *this;
     }
 
     const_iterator operator--(int) {
       const_iterator old = *this;
-      iterator--;
+      index = nodes[index].previous;
       return old;
     }
 
     const_iterator &NextSquareRange(unsigned sq_resolution,
                                     const const_iterator &end) {
-      const TracePoint &previous = ((const TraceDelta &)*iterator).point;
+      const TracePoint &previous = nodes[index].point;
       while (true) {
-        ++iterator;
+        index = nodes[index].next;
 
-        if (iterator == end.iterator)
+        if (index == end.index)
           return *this;
 
-        const TraceDelta &td = (const TraceDelta &)*iterator;
-        if (td.point.FlatSquareDistanceTo(previous) >= sq_resolution)
+        if (nodes[index].point.FlatSquareDistanceTo(previous) >= sq_resolution)
           return *this;
       }
     }
 
     bool operator==(const const_iterator &other) const {
-      return iterator == other.iterator;
+      return index == other.index;
     }
 
     bool operator!=(const const_iterator &other) const {
-      return iterator != other.iterator;
+      return index != other.index;
     }
   };
 
   const_iterator begin() const {
-    return chronological_list.begin();
+    return const_iterator(nodes.begin(), GetHead().next);
   }
 
   const_iterator end() const {
-    return chronological_list.end();
+    return const_iterator(nodes.begin(), GetHeadIndex());
   }
 
   class const_reverse_iterator {
     friend class Trace;
 
-    ListHead::const_reverse_iterator iterator;
+    const TraceDelta *nodes;
+    unsigned index;
 
-    const_reverse_iterator(ListHead::const_reverse_iterator _iterator)
-      :iterator(_iterator) {}
+    const_reverse_iterator(const TraceDelta *_nodes, unsigned _index)
+      :nodes(_nodes), index(_index) {}
 
   public:
     typedef std::forward_iterator_tag iterator_category;
@@ -552,52 +586,50 @@ public:
     const_reverse_iterator() = default;
 
     const TracePoint &operator*() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return td.point;
+      return nodes[index].point;
     }
 
     const TracePoint *operator->() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return &td.point;
+      return &nodes[index].point;
     }
 
     const_reverse_iterator &operator++() {
-      ++iterator;
+      index = nodes[index].previous;
       return *this;
     }
 
     const_reverse_iterator operator++(int) {
       const_reverse_iterator old = *this;
-      iterator++;
+      index = nodes[index].previous;
       return old;
     }
 
     const_reverse_iterator &operator--() {
-      --iterator;
+      index = nodes[index].next;
       return *this;
     }
 
     const_reverse_iterator operator--(int) {
       const_reverse_iterator old = *this;
-      iterator--;
+      index = nodes[index].next;
       return old;
     }
 
     bool operator==(const const_reverse_iterator &other) const {
-      return iterator == other.iterator;
+      return index == other.index;
     }
 
     bool operator!=(const const_reverse_iterator &other) const {
-      return iterator != other.iterator;
+      return index != other.index;
     }
   };
 
   const_reverse_iterator rbegin() const {
-    return chronological_list.rbegin();
+    return const_reverse_iterator(nodes.begin(), GetHead().previous);
   }
 
   const_reverse_iterator rend() const {
-    return chronological_list.rend();
+    return const_reverse_iterator(nodes.begin(), GetHeadIndex());
   }
 
   const TaskProjection &GetProjection() const {
@@ -50,6 +50,12 @@ public:
     Visit(wp);
   }
 
+  void
+  operator()(const Waypoint *wp)
+  {
+    Visit(*wp);
+  }
+
   /**
    * Visit item inside envelope
    */
@@ -115,37 +121,62 @@ Waypoints::Waypoints():
 void
 Waypoints::Optimise()
 {
+  if (!static_index.IsBuilt()) {
+    if (!static_waypoints.IsEmpty())
+      BuildStaticIndex();
+    return;
+  }
+
   if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
     /* empty or already optimised */
     return;
 
+  /* the projection is fixed, and Append() has already projected the
+     new waypoints */
+  waypoint_tree.Optimise();
+}
+
+void
+Waypoints::BuildStaticIndex()
+{
   task_projection.Update();
 
-  for (auto &i : waypoint_tree)
+  std::vector<const Waypoint *> pointers;
+  pointers.reserve(static_waypoints.size());
+  for (auto &i : static_waypoints) {
     i.Project(task_projection);
+    pointers.push_back(&i);
+  }
 
-  waypoint_tree.Optimise();
+  static_index.Build(pointers.begin(), pointers.end());
 }
 
 const Waypoint &
 Waypoints::Append(Waypoint &&wp)
 {
-  if (waypoint_tree.HaveBounds()) {
+  const bool is_static = !static_index.IsBuilt();
+
+  if (is_static) {
+    if (static_waypoints.IsEmpty())
+      task_projection.Reset(wp.location);
+
+    task_projection.Scan(wp.location);
+  } else {
     wp.Project(task_projection);
-    if (!waypoint_tree.IsWithinBounds(wp)) {
+    if (waypoint_tree.HaveBounds() && !waypoint_tree.IsWithinBounds(wp)) {
       /* schedule an optimise() call */
       waypoint_tree.Flatten();
       waypoint_tree.ClearBounds();
     }
-  } else if (IsEmpty())
-    task_projection.Reset(wp.location);
+  }
 
   wp.flags.watched = (wp.file_num == 3);
 
-  task_projection.Scan(wp.location);
   wp.id = next_id++;
 
-  const Waypoint &new_wp = waypoint_tree.Add(std::move(wp));
+  const Waypoint &new_wp = is_static
+    ? static_waypoints.Add(std::move(wp))
+    : waypoint_tree.Add(std::move(wp));
   name_tree.Add(new_wp);
 
   ++serial;
@@ -153,25 +184,16 @@ Waypoints::Append(Waypoint &&wp)
   return new_wp;
 }
 
+static bool
+AlwaysTrue(const Waypoint &wp)
+{
+  return true;
+}
+
 const Waypoint*
 Waypoints::GetNearest(const GeoPoint &loc, fixed range) const
 {
-  if (IsEmpty())
-    return NULL;
-
-  Waypoint bb_target(loc);
-  bb_target.Project(task_projection);
-  const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
-  const auto found = waypoint_tree.FindNearest(bb_target, mrange);
-
-#ifdef INSTRUMENT_TASK
-  n_queries++;
-#endif
-
-  if (found.first == waypoint_tree.end())
-    return NULL;
-
-  return &*found.first;
+  return GetNearestIf(loc, range, AlwaysTrue);
 }
 
 static bool
@@ -180,6 +202,18 @@ IsLandable(const Waypoint &wp)
   return wp.IsLandable();
 }
 
+/**
+ * Adapts a Waypoint predicate to the elements of the
+ * #StaticWaypointIndex.
+ */
+struct PointerPredicate {
+  bool (*predicate)(const Waypoint &);
+
+  bool operator()(const Waypoint *wp) const {
+    return predicate(*wp);
+  }
+};
+
 const Waypoint*
 Waypoints::GetNearestLandable(const GeoPoint &loc, fixed range) const
 {
@@ -196,16 +230,27 @@ Waypoints::GetNearestIf(const GeoPoint &loc, fixed range,
   Waypoint bb_target(loc);
   bb_target.Project(task_projection);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
-  const auto found = waypoint_tree.FindNearestIf(bb_target, mrange, predicate);
+
+  const PointerPredicate pointer_predicate = { predicate };
+  const auto found =
+    static_index.FindNearestIf(bb_target.flat_location.longitude,
+                               bb_target.flat_location.latitude,
+                               mrange, pointer_predicate);
+  const Waypoint *nearest = found.first != NULL ? *found.first : NULL;
+
+  if (!waypoint_tree.IsEmpty()) {
+    const auto found2 = waypoint_tree.FindNearestIf(bb_target, mrange,
+                                                    predicate);
+    if (found2.first != waypoint_tree.end() &&
+        (nearest == NULL || found2.second <= found.second))
+      nearest = &*found2.first;
+  }
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
 #endif
 
-  if (found.first == waypoint_tree.end())
-    return NULL;
-
-  return &*found.first;
+  return nearest;
 }
 
 const Waypoint*
@@ -232,7 +277,7 @@ Waypoints::LookupLocation(const GeoPoint &loc, const fixed range) const
 const Waypoint*
 Waypoints::FindHome()
 {
-  for (const auto &wp : waypoint_tree) {
+  for (const auto &wp : *this) {
     if (wp.flags.home) {
       home = &wp;
       return &wp;
@@ -257,7 +302,7 @@ Waypoints::SetHome(const unsigned id)
 const Waypoint*
 Waypoints::LookupId(const unsigned id) const
 {
-  for (const auto &wp : waypoint_tree)
+  for (const auto &wp : *this)
     if (wp.id == id)
       return &wp;
 
@@ -277,7 +322,12 @@ Waypoints::VisitWithinRange(const GeoPoint &loc, const fixed range,
 
   WaypointEnvelopeVisitor wve(&visitor);
 
-  waypoint_tree.VisitWithinRange(bb_target, mrange, wve);
+  static_index.VisitWithinRange(bb_target.flat_location.longitude,
+                                bb_target.flat_location.latitude,
+                                mrange, wve);
+
+  if (!waypoint_tree.IsEmpty())
+    waypoint_tree.VisitWithinRange(bb_target, mrange, wve);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -297,6 +347,8 @@ Waypoints::Clear()
   ++serial;
   home = NULL;
   name_tree.clear();
+  static_index.Clear();
+  static_waypoints.clear();
   waypoint_tree.clear();
   next_id = 1;
 }
@@ -307,36 +359,65 @@ Waypoints::Erase(const Waypoint& wp)
   if (home == &wp)
     home = NULL;
 
-  const auto it = waypoint_tree.FindPointer(&wp);
-  assert(it != waypoint_tree.end());
-
   name_tree.Remove(wp);
-  waypoint_tree.erase(it);
+
+  const unsigned static_position = FindStatic(wp);
+  if (static_position != StaticWaypointIndex::NOT_FOUND) {
+    static_index.Erase(static_position);
+
+    const auto it = static_waypoints.FindPointer(&wp);
+    assert(it != static_waypoints.end());
+    static_waypoints.erase(it);
+  } else {
+    WaypointTree &tree = static_index.IsBuilt()
+      ? waypoint_tree
+      : static_waypoints;
+    const auto it = tree.FindPointer(&wp);
+    assert(it != tree.end());
+    tree.erase(it);
+  }
+
   ++serial;
 }
 
 void
 Waypoints::Replace(const Waypoint &orig, const Waypoint &replacement)
 {
-  assert(!waypoint_tree.IsEmpty());
+  assert(!IsEmpty());
 
   name_tree.Remove(orig);
 
   Waypoint new_waypoint(replacement);
   new_waypoint.id = orig.id;
 
-  if (waypoint_tree.HaveBounds()) {
+  const unsigned static_position = FindStatic(orig);
+  if (static_position != StaticWaypointIndex::NOT_FOUND) {
+    /* modify the object in place and update its position in the
+       index */
+    new_waypoint.Project(task_projection);
+
+    const auto it = static_waypoints.FindPointer(&orig);
+    assert(it != static_waypoints.end());
+    static_waypoints.Replace(it, new_waypoint);
+    static_index.Update(static_position);
+  } else if (!static_index.IsBuilt()) {
+    /* not yet projected, this is done by BuildStaticIndex() */
+    const auto it = static_waypoints.FindPointer(&orig);
+    assert(it != static_waypoints.end());
+    static_waypoints.Replace(it, new_waypoint);
+  } else {
     new_waypoint.Project(task_projection);
-    if (!waypoint_tree.IsWithinBounds(new_waypoint)) {
+    if (waypoint_tree.HaveBounds() &&
+        !waypoint_tree.IsWithinBounds(new_waypoint)) {
       /* schedule an optimise() call */
       waypoint_tree.Flatten();
       waypoint_tree.ClearBounds();
     }
-  }
 
-  const auto it = waypoint_tree.FindPointer(&orig);
-  assert(it != waypoint_tree.end());
-  waypoint_tree.Replace(it, new_waypoint);
+    const auto it = waypoint_tree.FindPointer(&orig);
+    assert(it != waypoint_tree.end());
+    waypoint_tree.Replace(it, new_waypoint);
+  }
 
   name_tree.Add(orig);
   ++serial;
@@ -26,6 +26,7 @@
 #include "Util/SliceAllocator.hpp"
 #include "Util/RadixTree.hpp"
 #include "Util/QuadTree.hpp"
+#include "Util/PackedPointTree.hpp"
 #include "Util/Serial.hpp"
 #include "Waypoint.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
@@ -35,6 +36,12 @@ class WaypointVisitor;
 /**
  * Container for waypoints using kd-tree representation internally for fast 
  * geospatial lookups.
+ *
+ * The waypoints appended before the first Optimise() call (usually
+ * the ones loaded from files) are indexed by an immutable
+ * #PackedPointTree, and the first Optimise() call fixes the task
+ * projection.  Waypoints appended later (e.g. by the user or by a
+ * task) are kept in a #QuadTree, which can be modified cheaply.
  */
 class Waypoints: private NonCopyable 
 {
@@ -60,6 +67,28 @@ class Waypoints: private NonCopyable
   typedef QuadTree<Waypoint, WaypointAccessor,
                    SliceAllocator<Waypoint, 512u> > WaypointTree;
 
+  /**
+   * Function object used to provide access to coordinate values by
+   * PackedPointTree.
+   */
+  struct WaypointPointerAccessor {
+    constexpr
+    int GetX(const Waypoint *wp) const {
+      return wp->flat_location.longitude;
+    }
+
+    constexpr
+    int GetY(const Waypoint *wp) const {
+      return wp->flat_location.latitude;
+    }
+  };
+
+  /**
+   * Type of the bulk-loaded index for the static waypoints
+   */
+  typedef PackedPointTree<const Waypoint *,
+                          WaypointPointerAccessor> StaticWaypointIndex;
+
   class WaypointNameTree : public RadixTree<const Waypoint*> {
   public:
     const Waypoint *Get(const TCHAR *name) const;
@@ -75,14 +104,78 @@ class Waypoints: private NonCopyable
 
   unsigned next_id;
 
+  /**
+   * The waypoints appended before the first Optimise() call.  This
+   * tree is never optimised; it only keeps the objects at a stable
+   * address for #static_index.
+   */
+  WaypointTree static_waypoints;
+
+  StaticWaypointIndex static_index;
+
+  /**
+   * The waypoints appended after the first Optimise() call.
+   */
   WaypointTree waypoint_tree;
+
   WaypointNameTree name_tree;
   TaskProjection task_projection;
 
   const Waypoint *home;
 
 public:
-  typedef WaypointTree::const_iterator const_iterator;
+  /**
+   * Iterates over the static waypoints, followed by the ones
+   * appended after the first Optimise() call.
+   */
+  class const_iterator {
+    friend class Waypoints;
+
+    WaypointTree::const_iterator i, next, end;
+
+    const_iterator(WaypointTree::const_iterator _i,
+                   WaypointTree::const_iterator _next,
+                   WaypointTree::const_iterator _end)
+      :i(_i), next(_next), end(_end) {
+      SkipEnd();
+    }
+
+    void SkipEnd() {
+      if (i == end) {
+        i = next;
+        next = end;
+      }
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef ptrdiff_t difference_type;
+    typedef const Waypoint value_type;
+    typedef const Waypoint *pointer;
+    typedef const Waypoint &reference;
+
+    const_iterator &operator++() {
+      ++i;
+      SkipEnd();
+      return *this;
+    }
+
+    const Waypoint &operator*() const {
+      return *i;
+    }
+
+    const Waypoint *operator->() const {
+      return &*i;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return i == other.i && next == other.next;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+  };
 
   /**
    * Constructor.  Task projection is updated after call to optimise().
@@ -98,6 +191,14 @@ public:
     return serial;
   }
 
+  /**
+   * Returns the id which will be assigned to the next waypoint
+   * passed to Append().
+   */
+  unsigned GetNextId() const {
+    return next_id;
+  }
+
   /**
    * Add waypoint to internal store.  Internal copy is made.
    * optimise() must be called after inserting waypoints prior to
@@ -137,11 +238,10 @@ public:
   /**
    * Optimise the internal search tree after adding/removing elements.
    * Also performs projection to flat earth for new elements.
-   * This updates the task_projection.
-   *
-   * Note: currently this code doesn't check for task projections
-   * being modified from multiple calls to optimise() so it should
-   * only be called once (until this is fixed).
+   * The first call after construction or Clear() updates the
+   * task_projection and builds the index of the static waypoints;
+   * later calls only rebuild the tree of waypoints appended since
+   * then, using the same projection.
    */
   void Optimise();
 
@@ -158,7 +258,7 @@ public:
    */
   gcc_pure
   unsigned size() const {
-    return waypoint_tree.size();
+    return static_waypoints.size() + waypoint_tree.size();
   }
 
   /**
@@ -168,7 +268,7 @@ public:
    */
   gcc_pure
   bool IsEmpty() const {
-    return waypoint_tree.IsEmpty();
+    return static_waypoints.IsEmpty() && waypoint_tree.IsEmpty();
   }
 
   /**
@@ -331,7 +431,8 @@ public:
    * @return First waypoint in store
    */
   const_iterator begin() const {
-    return waypoint_tree.begin();
+    return const_iterator(static_waypoints.begin(), waypoint_tree.begin(),
+                          waypoint_tree.end());
   }
 
   /**
@@ -340,7 +441,23 @@ public:
    * @return End waypoint in store
    */
   const_iterator end() const {
-    return waypoint_tree.end();
+    return const_iterator(waypoint_tree.end(), waypoint_tree.end(),
+                          waypoint_tree.end());
+  }
+
+private:
+  /**
+   * Build #static_index from #static_waypoints.
+   */
+  void BuildStaticIndex();
+
+  /**
+   * Returns the index of the specified waypoint in #static_index, or
+   * StaticWaypointIndex::NOT_FOUND if it is not a static waypoint.
+   */
+  gcc_pure
+  unsigned FindStatic(const Waypoint &wp) const {
+    return static_index.Find(&wp);
   }
 };
 
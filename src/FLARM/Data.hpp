@@ -61,11 +61,12 @@ struct FlarmData {
     traffic.Complement(add.traffic);
   }
 
-  void Expire(fixed clock) {
-    error.Expire(clock);
-    version.Expire(clock);
-    status.Expire(clock);
-    traffic.Expire(clock);
+  bool Expire(fixed clock) {
+    bool expired = error.Expire(clock);
+    expired |= version.Expire(clock);
+    expired |= status.Expire(clock);
+    expired |= traffic.Expire(clock);
+    return expired;
   }
 };
 
@@ -85,9 +85,10 @@ struct FlarmError {
     }
   }
 
-  void Expire(fixed clock) {
+  bool Expire(fixed clock) {
     /* no expiry; this object will be cleared only when the device
        connection is lost */
+    return false;
   }
 
   /**
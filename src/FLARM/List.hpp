@@ -29,6 +29,7 @@ Copyright_License {
 #include "Util/TrivialArray.hpp"
 
 #include <type_traits>
+#include <algorithm>
 
 /**
  * This class keeps track of the traffic objects received from a
@@ -54,21 +55,36 @@ struct TrafficList {
     return list.empty();
   }
 
+  /**
+   * Copy the specified object.  Unlike the assignment operator, this
+   * copies only the used elements of the list, not all #MAX_COUNT.
+   */
+  void Copy(const TrafficList &src) {
+    new_traffic = src.new_traffic;
+    list.resize(src.list.size());
+    std::copy(src.list.begin(), src.list.end(), list.begin());
+  }
+
   /**
    * Adds data from the specified object, unless already present in
    * this one.
    */
   void Complement(const TrafficList &add) {
     if (IsEmpty() && !add.IsEmpty())
-      *this = add;
+      Copy(add);
   }
 
-  void Expire(fixed clock) {
-    new_traffic.Expire(clock, fixed(60));
+  bool Expire(fixed clock) {
+    bool expired = new_traffic.Expire(clock, fixed(60));
 
-    for (unsigned i = list.size(); i-- > 0;)
-      if (!list[i].Refresh(clock))
+    for (unsigned i = list.size(); i-- > 0;) {
+      if (!list[i].Refresh(clock)) {
         list.quick_remove(i);
+        expired = true;
+      }
+    }
+
+    return expired;
   }
 
   unsigned GetActiveTrafficCount() const {
@@ -62,8 +62,8 @@ struct FlarmStatus {
       *this = add;
   }
 
-  void Expire(fixed clock) {
-    available.Expire(clock, fixed(10));
+  bool Expire(fixed clock) {
+    return available.Expire(clock, fixed(10));
   }
 };
 
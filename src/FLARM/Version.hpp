@@ -50,9 +50,10 @@ struct FlarmVersion {
     }
   }
 
-  void Expire(fixed clock) {
+  bool Expire(fixed clock) {
     /* no expiry; this object will be cleared only when the device
        connection is lost */
+    return false;
   }
 };
 
@@ -26,10 +26,35 @@
 #include "Geo/SearchPoint.hpp"
 #include "Compiler.h"
 
-struct GeoPoint;
 struct FlatGeoPoint;
 class SearchPoint;
 
+/**
+ * The contribution of the polygon edge from #a to #b to the winding
+ * number of #p: +1 for an upward crossing with #p on its left, -1
+ * for a downward crossing with #p on its right, 0 otherwise.
+ */
+gcc_pure
+static inline int
+PolygonWinding(const GeoPoint &p, const GeoPoint &a, const GeoPoint &b)
+{
+  if (a.latitude <= p.latitude) {
+    // an upward crossing, p left of edge
+    if (b.latitude > p.latitude &&
+        ((b.longitude - a.longitude) * (p.latitude - a.latitude)
+         - (p.longitude - a.longitude) * (b.latitude - a.latitude)).Sign() > 0)
+      return 1;
+  } else {
+    // a downward crossing, p right of edge
+    if (b.latitude <= p.latitude &&
+        ((b.longitude - a.longitude) * (p.latitude - a.latitude)
+         - (p.longitude - a.longitude) * (b.latitude - a.latitude)).Sign() < 0)
+      return -1;
+  }
+
+  return 0;
+}
+
 /**
  * Note that this expects the vector to be closed, that is, starting point
  * and ending point are the same
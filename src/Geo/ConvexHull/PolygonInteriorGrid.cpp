@@ -0,0 +1,205 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#include "PolygonInteriorGrid.hpp"
+#include "PolygonInterior.hpp"
+#include "Math/FastMath.h"
+#include "Util/Clamp.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+
+/**
+ * The cells and rows are widened by this fraction of their size when
+ * assigning edges, so rounding errors when locating a point can never
+ * put it into a cell whose edges are incomplete.
+ */
+static constexpr int CELL_MARGIN_DIVISOR = 256;
+
+PolygonInteriorGrid::PolygonInteriorGrid(const SearchPoint *begin,
+                                         const SearchPoint *end)
+{
+  const unsigned n = end - begin;
+  assert(n >= 3);
+
+  min_longitude = max_longitude = begin->GetLocation().longitude.Native();
+  min_latitude = max_latitude = begin->GetLocation().latitude.Native();
+  for (auto i = begin; i != end; ++i) {
+    const fixed x = i->GetLocation().longitude.Native();
+    const fixed y = i->GetLocation().latitude.Native();
+    min_longitude = std::min(min_longitude, x);
+    max_longitude = std::max(max_longitude, x);
+    min_latitude = std::min(min_latitude, y);
+    max_latitude = std::max(max_latitude, y);
+  }
+
+  columns = rows = Clamp(2 * isqrt4(n), 4u, unsigned(MAX_SIZE));
+
+  const fixed width = max_longitude - min_longitude;
+  const fixed height = max_latitude - min_latitude;
+  const fixed cell_width = width / columns, cell_height = height / rows;
+  inv_cell_width = positive(width) ? fixed(columns) / width : fixed(0);
+  inv_cell_height = positive(height) ? fixed(rows) / height : fixed(0);
+
+  const fixed margin_x = cell_width / CELL_MARGIN_DIVISOR;
+  const fixed margin_y = cell_height / CELL_MARGIN_DIVISOR;
+
+  /* assign the edges to the rows they span; the first pass counts,
+     the second pass fills */
+
+  row_offsets.assign(rows + 1, 0);
+
+  for (unsigned i = 0; i + 1 < n; ++i) {
+    const fixed y1 = begin[i].GetLocation().latitude.Native();
+    const fixed y2 = begin[i + 1].GetLocation().latitude.Native();
+    const unsigned first = GetRow(std::min(y1, y2) - margin_y);
+    const unsigned last = GetRow(std::max(y1, y2) + margin_y);
+    for (unsigned row = first; row <= last; ++row)
+      ++row_offsets[row + 1];
+  }
+
+  for (unsigned row = 0; row < rows; ++row)
+    row_offsets[row + 1] += row_offsets[row];
+
+  row_edges.resize(row_offsets[rows]);
+  std::vector<unsigned> fill(row_offsets.begin(), row_offsets.end() - 1);
+
+  cells.assign(columns * rows, Cell::OUTSIDE);
+
+  for (unsigned i = 0; i + 1 < n; ++i) {
+    const fixed x1 = begin[i].GetLocation().longitude.Native();
+    const fixed y1 = begin[i].GetLocation().latitude.Native();
+    const fixed x2 = begin[i + 1].GetLocation().longitude.Native();
+    const fixed y2 = begin[i + 1].GetLocation().latitude.Native();
+    const fixed y_min = std::min(y1, y2), y_max = std::max(y1, y2);
+
+    const unsigned first = GetRow(y_min - margin_y);
+    const unsigned last = GetRow(y_max + margin_y);
+    for (unsigned row = first; row <= last; ++row) {
+      row_edges[fill[row]++] = i;
+
+      /* clip the edge to the (widened) row, and mark the cells it
+         touches */
+
+      fixed x_a = x1, x_b = x2;
+      if (y1 != y2) {
+        const fixed row_min = min_latitude + cell_height * row - margin_y;
+        const fixed row_max = row_min + cell_height + margin_y * 2;
+        const fixed slope = (x2 - x1) / (y2 - y1);
+        x_a = x1 + (std::max(y_min, row_min) - y1) * slope;
+        x_b = x1 + (std::min(y_max, row_max) - y1) * slope;
+      }
+
+      const unsigned column_first =
+        GetColumn(std::min(x_a, x_b) - margin_x);
+      const unsigned column_last =
+        GetColumn(std::max(x_a, x_b) + margin_x);
+      for (unsigned column = column_first; column <= column_last; ++column)
+        cells[row * columns + column] = Cell::EDGE;
+    }
+  }
+
+  /* the winding number is constant within a cell which is not
+     touched by an edge; determine it at the center */
+
+  for (unsigned row = 0; row < rows; ++row) {
+    const Angle latitude =
+      Angle::Native(min_latitude + cell_height * (row * 2 + 1) / 2);
+
+    for (unsigned column = 0; column < columns; ++column) {
+      Cell &cell = cells[row * columns + column];
+      if (cell == Cell::EDGE)
+        continue;
+
+      const GeoPoint center(Angle::Native(min_longitude +
+                                          cell_width * (column * 2 + 1) / 2),
+                            latitude);
+      if (IsInsideRow(center, GetRow(center.latitude.Native()), begin))
+        cell = Cell::INSIDE;
+    }
+  }
+}
+
+unsigned
+PolygonInteriorGrid::GetColumn(fixed longitude) const
+{
+  const fixed column = (longitude - min_longitude) * inv_cell_width;
+  return negative(column)
+    ? 0
+    : std::min((unsigned)column, columns - 1);
+}
+
+unsigned
+PolygonInteriorGrid::GetRow(fixed latitude) const
+{
+  const fixed row = (latitude - min_latitude) * inv_cell_height;
+  return negative(row)
+    ? 0
+    : std::min((unsigned)row, rows - 1);
+}
+
+bool
+PolygonInteriorGrid::IsInsideRow(const GeoPoint &p, unsigned row,
+                                 const SearchPoint *vertices) const
+{
+  int wn = 0;
+
+  for (unsigned i = row_offsets[row], end = row_offsets[row + 1];
+       i != end; ++i) {
+    const unsigned j = row_edges[i];
+    wn += PolygonWinding(p, vertices[j].GetLocation(),
+                         vertices[j + 1].GetLocation());
+  }
+
+  return wn != 0;
+}
+
+bool
+PolygonInteriorGrid::IsInside(const GeoPoint &p,
+                              const SearchPoint *vertices) const
+{
+  const fixed x = p.longitude.Native();
+  const fixed y = p.latitude.Native();
+
+  /* no edge can cross the horizontal ray of a point below or above
+     all vertices */
+  if (y < min_latitude || y >= max_latitude)
+    return false;
+
+  const unsigned row = GetRow(y);
+
+  if (x >= min_longitude && x <= max_longitude) {
+    const Cell cell = cells[row * columns + GetColumn(x)];
+    if (cell != Cell::EDGE)
+      return cell == Cell::INSIDE;
+  }
+
+  return IsInsideRow(p, row, vertices);
+}
+
+size_t
+PolygonInteriorGrid::GetMemoryUsage() const
+{
+  return sizeof(*this) + cells.capacity() * sizeof(cells.front()) +
+    (row_offsets.capacity() + row_edges.capacity()) * sizeof(unsigned);
+}
@@ -0,0 +1,119 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#ifndef POLYGON_INTERIOR_GRID_HPP
+#define POLYGON_INTERIOR_GRID_HPP
+
+#include "Math/fixed.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+struct GeoPoint;
+class SearchPoint;
+
+/**
+ * An acceleration structure for PolygonInterior() on polygons with
+ * many vertices.  The bounding box of the polygon is divided into a
+ * uniform grid; cells which are not touched by any edge are entirely
+ * inside or outside, and are answered without looking at the
+ * polygon.  For the other cells, only the edges which span the
+ * latitude of the cell's row are tested.
+ *
+ * The grid works on the geographic coordinates of the polygon
+ * (which are an affine transformation of the flat projection), and
+ * uses the same per-edge arithmetic as PolygonInterior(), so the
+ * results are identical.
+ */
+class PolygonInteriorGrid : private NonCopyable {
+  enum class Cell : uint8_t {
+    OUTSIDE,
+    INSIDE,
+    EDGE,
+  };
+
+  fixed min_longitude, min_latitude, max_longitude, max_latitude;
+  fixed inv_cell_width, inv_cell_height;
+
+  unsigned columns, rows;
+
+  std::vector<Cell> cells;
+
+  /**
+   * For each row, the index of its first entry in #row_edges; has
+   * #rows + 1 elements.
+   */
+  std::vector<unsigned> row_offsets;
+
+  /**
+   * The vertex indices of the edges spanning each row.
+   */
+  std::vector<unsigned> row_edges;
+
+public:
+  /**
+   * Polygons with fewer vertices are not worth a grid.
+   */
+  static constexpr unsigned MIN_VERTICES = 32;
+
+  /**
+   * The maximum number of columns and rows; this limits the memory
+   * usage of the cell array to 4 kB.
+   */
+  static constexpr unsigned MAX_SIZE = 64;
+
+  /**
+   * @param begin the vertices of the polygon, which must be closed
+   * (the last vertex equals the first one) and have at least 3
+   * vertices
+   */
+  PolygonInteriorGrid(const SearchPoint *begin, const SearchPoint *end);
+
+  /**
+   * Equivalent to PolygonInterior() on the vertices this object was
+   * constructed with.
+   */
+  gcc_pure
+  bool IsInside(const GeoPoint &p, const SearchPoint *vertices) const;
+
+  /**
+   * Returns the number of bytes allocated by this object.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const;
+
+private:
+  gcc_pure
+  unsigned GetColumn(fixed longitude) const;
+
+  gcc_pure
+  unsigned GetRow(fixed latitude) const;
+
+  gcc_pure
+  bool IsInsideRow(const GeoPoint &p, unsigned row,
+                   const SearchPoint *vertices) const;
+};
+
+#endif
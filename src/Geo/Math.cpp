@@ -317,24 +317,41 @@ FindLatitudeLongitude(const GeoPoint &loc, const Angle bearing,
   if (!positive(distance))
     return loc;
 
-  GeoPoint loc_out;
+  return RadialLocator(loc, distance).At(bearing);
+}
+
+RadialLocator::RadialLocator(const GeoPoint &_origin, fixed distance)
+  :origin(_origin), zero(!positive(distance))
+{
+  assert(!negative(distance));
 
   const Angle distance_angle = EarthDistanceToAngle(distance);
 
   const auto scd = distance_angle.SinCos();
-  const fixed sin_distance = scd.first, cos_distance = scd.second;
+  sin_distance = scd.first;
+  cos_distance = scd.second;
+
+  const auto scl = origin.latitude.SinCos();
+  sin_latitude = scl.first;
+  cos_latitude = scl.second;
+}
+
+GeoPoint
+RadialLocator::At(Angle bearing) const
+{
+  if (zero)
+    return origin;
+
+  GeoPoint loc_out;
 
   const auto scb = bearing.SinCos();
   const fixed sin_bearing = scb.first, cos_bearing = scb.second;
 
-  const auto scl = loc.latitude.SinCos();
-  const fixed sin_latitude = scl.first, cos_latitude = scl.second;
-
   loc_out.latitude = EarthASin(SmallMult(sin_latitude, cos_distance)
                                + SmallMult(cos_latitude, sin_distance,
                                            cos_bearing));
 
-  loc_out.longitude = loc.longitude +
+  loc_out.longitude = origin.longitude +
     Angle::FromXY(cos_distance - SmallMult(sin_latitude,
                                            loc_out.latitude.sin()),
                   SmallMult(sin_bearing, sin_distance, cos_latitude));
@@ -33,11 +33,10 @@ Copyright_License {
 
 #include "Math/fixed.hpp"
 #include "Math/Angle.hpp"
+#include "GeoPoint.hpp"
 #include "Constants.hpp"
 #include "Compiler.h"
 
-struct GeoPoint;
-
 /**
  * Convert a distance on earth's surface [m] to the according Angle,
  * assuming the earth is a sphere.
@@ -145,4 +144,27 @@ gcc_pure
 GeoPoint FindLatitudeLongitude(const GeoPoint &loc,
                                const Angle bearing, const fixed distance);
 
+/**
+ * Calculates FindLatitudeLongitude() for many bearings with the same
+ * location and distance, e.g. the vertices of an arc.  The
+ * trigonometric functions of the location and the distance are
+ * evaluated only once; the results are identical.
+ */
+class RadialLocator {
+  GeoPoint origin;
+  fixed sin_distance, cos_distance;
+  fixed sin_latitude, cos_latitude;
+  bool zero;
+
+public:
+  RadialLocator(const GeoPoint &origin, fixed distance);
+
+  /**
+   * Returns the location at the distance from the origin in the
+   * specified direction.
+   */
+  gcc_pure
+  GeoPoint At(Angle bearing) const;
+};
+
 #endif
@@ -30,12 +30,18 @@ IOThread::Start()
   assert(!IsDefined());
   assert(files.empty());
 
-  modified = quit = running = false;
+  modified_files = NULL;
+  quit = running = false;
 
   if (!pipe.Create())
     return false;
 
-  poll.SetMask(pipe.GetReadFD(), Poll::READ);
+#ifdef __linux__
+  if (!poll.IsDefined() || !poll.Add(pipe.GetReadFD(), READ))
+    return false;
+#else
+  poll.SetMask(pipe.GetReadFD(), READ);
+#endif
 
   return Thread::Start();
 }
@@ -76,10 +82,8 @@ IOThread::Add(int fd, unsigned mask, FileEventHandler &handler)
     file.handler = &handler;
   }
 
-  file.modified = true;
-
   /* schedule an Update() call */
-  modified = true;
+  SetModified(file);
 }
 
 void
@@ -99,8 +103,7 @@ IOThread::Remove(int fd)
   if (file.mask != 0) {
     /* schedule for removal */
     file.mask = file.ready_mask = 0;
-    file.modified = true;
-    modified = true;
+    SetModified(file);
   }
 }
 
@@ -108,9 +111,9 @@ void
 IOThread::LockAdd(int fd, unsigned mask, FileEventHandler &handler)
 {
   mutex.Lock();
-  const bool old_modified = modified;
+  const bool old_modified = modified_files != NULL;
   Add(fd, mask, handler);
-  const bool new_modified = modified;
+  const bool new_modified = modified_files != NULL;
   mutex.Unlock();
 
   if (!old_modified && new_modified)
@@ -121,9 +124,9 @@ void
 IOThread::LockRemove(int fd)
 {
   mutex.Lock();
-  const bool old_modified = modified;
+  const bool old_modified = modified_files != NULL;
   Remove(fd);
-  const bool new_modified = modified;
+  const bool new_modified = modified_files != NULL;
 
   if (new_modified && running && !IsInside()) {
     /* this method is synchronous: after returning, all handlers must
@@ -140,31 +143,78 @@ IOThread::LockRemove(int fd)
     pipe.Signal();
 }
 
+void
+IOThread::UpdateFile(File &file)
+{
+#ifdef __linux__
+  if (file.mask == 0) {
+    if (file.registered_mask != 0)
+      poll.Remove(file.fd);
+  } else if (file.registered_mask == 0 ||
+             !poll.Modify(file.fd, file.mask))
+    /* not registered yet, or the kernel has dropped the registration
+       because the file descriptor was closed in the meantime (and
+       the number reused) */
+    poll.Add(file.fd, file.mask);
+#else
+  poll.SetMask(file.fd, file.mask);
+#endif
+
+  file.registered_mask = file.mask;
+}
+
 void
 IOThread::Update()
 {
-  for (auto i = files.begin(), end = files.end(); i != end;) {
-    File &file = i->second;
-    assert(file.fd == i->first);
+  while (modified_files != NULL) {
+    File &file = *modified_files;
+    modified_files = file.next_modified;
+
+    assert(file.modified);
+    file.modified = false;
 
-    if (!file.modified) {
-      ++i;
+    UpdateFile(file);
+
+    if (file.mask == 0)
+      files.erase(file.fd);
+  }
+}
+
+#ifdef __linux__
+
+IOThread::File *
+IOThread::CollectReady()
+{
+  File *ready = NULL;
+  for (unsigned i = 0, n = poll.GetCount(); i < n; ++i) {
+    const int fd = poll.GetFD(i);
+    const unsigned mask = poll.GetMask(i);
+    assert(mask != 0);
+
+    if (fd == pipe.GetReadFD()) {
+      pipe.Read();
       continue;
     }
 
-    file.modified = false;
+    auto j = files.find(fd);
+    if (j == files.end())
+      /* a stale event for a file descriptor which was closed without
+         being removed from the kernel's list */
+      continue;
 
-    poll.SetMask(file.fd, file.mask);
-    if (file.mask == 0)
-      /* the iterator must be incremented before calling map::erase()
-         (with its old value), because map::erase() invalidates the
-         iterator */
-      files.erase(i++);
-    else
-      ++i;
+    File &file = j->second;
+    assert(file.fd == fd);
+
+    file.ready_mask = mask;
+    file.next_ready = ready;
+    ready = &file;
   }
+
+  return ready;
 }
 
+#else
+
 IOThread::File *
 IOThread::CollectReady()
 {
@@ -193,6 +243,8 @@ IOThread::CollectReady()
   return ready;
 }
 
+#endif
+
 void
 IOThread::HandleReady(File *ready)
 {
@@ -219,8 +271,7 @@ IOThread::HandleReady(File *ready)
 
     if (!result && ready->mask != 0) {
       ready->mask = 0;
-      ready->modified = true;
-      modified = true;
+      SetModified(*ready);
     }
 
     ready = ready->next_ready;
@@ -240,10 +291,7 @@ IOThread::Run()
   mutex.Lock();
 
   while (!quit) {
-    if (modified) {
-      modified = false;
-      Update();
-    }
+    Update();
 
     mutex.Unlock();
     poll.Wait();
@@ -24,7 +24,12 @@ Copyright_License {
 #ifndef XCSOAR_IO_THREAD_HPP
 #define XCSOAR_IO_THREAD_HPP
 
+#ifdef __linux__
+#include "OS/EPoll.hpp"
+#else
 #include "OS/Poll.hpp"
+#endif
+
 #include "OS/EventPipe.hpp"
 #include "Thread/Thread.hpp"
 #include "Thread/Mutex.hpp"
@@ -37,27 +42,49 @@ class FileEventHandler;
 
 /**
  * A thread that is used for asynchronous (non-blocking) I/O.
+ *
+ * On Linux, it uses epoll, which keeps the list of file descriptors
+ * in the kernel and reports only the ones which are ready.  On other
+ * platforms, it uses poll().
  */
 class IOThread final : protected Thread {
+#ifdef __linux__
+  typedef EPoll Backend;
+#else
+  typedef Poll Backend;
+#endif
+
   struct File {
     File *next_ready;
 
+    /**
+     * The next item in the list of modified files, see
+     * #IOThread::modified_files.
+     */
+    File *next_modified;
+
     const int fd;
 
     unsigned mask, ready_mask;
 
+    /**
+     * The mask which is currently registered with the #Backend
+     * instance; 0 if the file descriptor is not registered.
+     */
+    unsigned registered_mask;
+
     FileEventHandler *handler;
 
     /**
      * Has this object been modified?  i.e. does it need to be
-     * synchronised with the #Poll instance?
+     * synchronised with the #Backend instance?
      */
     bool modified;
 
     File(int fd):fd(fd) {}
 
     File(int fd, unsigned mask, FileEventHandler &handler)
-      :fd(fd), mask(mask), ready_mask(0),
+      :fd(fd), mask(mask), ready_mask(0), registered_mask(0),
        handler(&handler), modified(false) {}
 
     bool operator<(const File &other) const {
@@ -65,7 +92,7 @@ class IOThread final : protected Thread {
     }
   };
 
-  Poll poll;
+  Backend poll;
 
   EventPipe pipe;
 
@@ -79,11 +106,18 @@ class IOThread final : protected Thread {
 
   std::map<int, File> files;
 
-  bool modified, quit, running;
+  /**
+   * A linked list of files which need to be synchronised with the
+   * #Backend instance by Update().  Only these are visited, not the
+   * whole #files map.
+   */
+  File *modified_files;
+
+  bool quit, running;
 
 public:
-  static constexpr unsigned READ = Poll::READ;
-  static constexpr unsigned WRITE = Poll::WRITE;
+  static constexpr unsigned READ = Backend::READ;
+  static constexpr unsigned WRITE = Backend::WRITE;
 
   /**
    * Start the thread.  This method should be called after creating
@@ -145,10 +179,27 @@ public:
 
 protected:
   /**
-   * Synchronise the file list with the #Poll instance.
+   * Schedule an Update() call for the specified file.
+   */
+  void SetModified(File &file) {
+    if (!file.modified) {
+      file.modified = true;
+      file.next_modified = modified_files;
+      modified_files = &file;
+    }
+  }
+
+  /**
+   * Synchronise the modified files with the #Backend instance.
    */
   void Update();
 
+  /**
+   * Register the new mask of the specified file with the #Backend
+   * instance.
+   */
+  void UpdateFile(File &file);
+
   /**
    * Collect a linked list of all file descriptors that are "ready".
    */
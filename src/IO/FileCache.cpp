@@ -24,6 +24,7 @@ Copyright_License {
 #include "FileCache.hpp"
 #include "OS/FileUtil.hpp"
 #include "OS/PathName.hpp"
+#include "OS/FileMapping.hpp"
 #include "Compatibility/path.h"
 #include "Compiler.h"
 
@@ -156,6 +157,31 @@ FileCache::Load(const TCHAR *name, const TCHAR *original_path)
   return file;
 }
 
+FileMapping *
+FileCache::Map(const TCHAR *name, const TCHAR *original_path,
+               size_t &offset_r)
+{
+  /* validate the header */
+  FILE *file = Load(name, original_path);
+  if (file == NULL)
+    return NULL;
+
+  const long offset = ftell(file);
+  fclose(file);
+  if (offset < 0)
+    return NULL;
+
+  TCHAR path[PathBufferSize(name)];
+  FileMapping *mapping = new FileMapping(MakeCachePath(path, name));
+  if (mapping->error()) {
+    delete mapping;
+    return NULL;
+  }
+
+  offset_r = offset;
+  return mapping;
+}
+
 FILE *
 FileCache::Save(const TCHAR *name, const TCHAR *original_path)
 {
@@ -139,16 +139,15 @@ MapWindow::UpdateTerrain()
 
   // always service terrain even if it's not used by the map,
   // because it's used by other calculations
-  RasterTerrain::ExclusiveLease lease(*terrain);
-  lease->SetViewCenter(location, radius);
-  if (lease->IsDirty())
+  const bool dirty = terrain->UpdateTiles(location, radius);
+  if (dirty)
     terrain_radius = fixed(0);
   else {
     terrain_radius = radius;
     terrain_center = location;
   }
 
-  return lease->IsDirty();
+  return dirty;
 }
 
 bool
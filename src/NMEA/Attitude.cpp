@@ -40,8 +40,8 @@ AttitudeState::Complement(const AttitudeState &add)
     heading = add.heading;
 }
 
-void
+bool
 AttitudeState::Expire(fixed now)
 {
-  heading_available.Expire(now, fixed(5));
+  return heading_available.Expire(now, fixed(5));
 }
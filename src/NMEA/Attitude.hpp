@@ -54,7 +54,7 @@ struct AttitudeState
    */
   void Complement(const AttitudeState &add);
 
-  void Expire(fixed now);
+  bool Expire(fixed now);
 };
 
 #endif
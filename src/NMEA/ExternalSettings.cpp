@@ -35,11 +35,12 @@ ExternalSettings::Clear()
   volume_available.Clear();
 }
 
-void
+bool
 ExternalSettings::Expire(fixed time)
 {
   /* the settings do not expire, they are only updated with a new
      value */
+  return false;
 }
 
 void
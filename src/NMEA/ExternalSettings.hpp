@@ -73,7 +73,7 @@ struct ExternalSettings {
   unsigned volume;
 
   void Clear();
-  void Expire(fixed time);
+  bool Expire(fixed time);
   void Complement(const ExternalSettings &add);
 
   /**
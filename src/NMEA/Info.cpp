@@ -40,14 +40,19 @@ GPSState::Reset()
   replay = false;
 }
 
-void
+bool
 GPSState::Expire(fixed now)
 {
-  if (fix_quality_available.Expire(now, fixed(5)))
+  bool expired = false;
+
+  if (fix_quality_available.Expire(now, fixed(5))) {
     fix_quality = FixQuality::NO_FIX;
+    expired = true;
+  }
 
-  satellites_used_available.Expire(now, fixed(5));
-  satellite_ids_available.Expire(now, fixed(60));
+  expired |= satellites_used_available.Expire(now, fixed(5));
+  expired |= satellite_ids_available.Expire(now, fixed(60));
+  return expired;
 }
 
 void
@@ -220,34 +225,39 @@ NMEAInfo::ExpireWallClock()
   }
 }
 
-void
+bool
 NMEAInfo::Expire()
 {
-  location_available.Expire(clock, fixed(10));
-  track_available.Expire(clock, fixed(10));
-  ground_speed_available.Expire(clock, fixed(10));
+  bool expired = false;
+
+  expired |= location_available.Expire(clock, fixed(10));
+  expired |= track_available.Expire(clock, fixed(10));
+  expired |= ground_speed_available.Expire(clock, fixed(10));
 
-  if (airspeed_available.Expire(clock, fixed(30)))
+  if (airspeed_available.Expire(clock, fixed(30))) {
     airspeed_real = false;
+    expired = true;
+  }
 
-  gps_altitude_available.Expire(clock, fixed(30));
-  static_pressure_available.Expire(clock, fixed(30));
-  dyn_pressure_available.Expire(clock, fixed(30));
-  pitot_pressure_available.Expire(clock, fixed(30));
-  sensor_calibration_available.Expire(clock, fixed(3600));
-  baro_altitude_available.Expire(clock, fixed(30));
-  pressure_altitude_available.Expire(clock, fixed(30));
-  noncomp_vario_available.Expire(clock, fixed(5));
-  total_energy_vario_available.Expire(clock, fixed(5));
-  netto_vario_available.Expire(clock, fixed(5));
-  settings.Expire(clock);
-  external_wind_available.Expire(clock, fixed(600));
-  engine_noise_level_available.Expire(clock, fixed(30));
-  voltage_available.Expire(clock, fixed(300));
-  battery_level_available.Expire(clock, fixed(300));
-  flarm.Expire(clock);
-  gps.Expire(clock);
-  attitude.Expire(clock);
+  expired |= gps_altitude_available.Expire(clock, fixed(30));
+  expired |= static_pressure_available.Expire(clock, fixed(30));
+  expired |= dyn_pressure_available.Expire(clock, fixed(30));
+  expired |= pitot_pressure_available.Expire(clock, fixed(30));
+  expired |= sensor_calibration_available.Expire(clock, fixed(3600));
+  expired |= baro_altitude_available.Expire(clock, fixed(30));
+  expired |= pressure_altitude_available.Expire(clock, fixed(30));
+  expired |= noncomp_vario_available.Expire(clock, fixed(5));
+  expired |= total_energy_vario_available.Expire(clock, fixed(5));
+  expired |= netto_vario_available.Expire(clock, fixed(5));
+  expired |= settings.Expire(clock);
+  expired |= external_wind_available.Expire(clock, fixed(600));
+  expired |= engine_noise_level_available.Expire(clock, fixed(30));
+  expired |= voltage_available.Expire(clock, fixed(300));
+  expired |= battery_level_available.Expire(clock, fixed(300));
+  expired |= flarm.Expire(clock);
+  expired |= gps.Expire(clock);
+  expired |= attitude.Expire(clock);
+  return expired;
 }
 
 void
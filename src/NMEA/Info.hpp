@@ -103,7 +103,7 @@ struct GPSState
 #endif
 
   void Reset();
-  void Expire(fixed now);
+  bool Expire(fixed now);
 };
 
 /**
@@ -663,8 +663,10 @@ struct NMEAInfo {
    * Check expiry times of all attributes which have a time stamp
    * associated with them.  This should be called after the GPS time
    * stamp has been updated.
+   *
+   * @return true if at least one attribute has expired
    */
-  void Expire();
+  bool Expire();
 
   /**
    * Adds data from the specified object, unless already present in
@@ -0,0 +1,65 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_NMEA_SENTENCE_TAG_HPP
+#define XCSOAR_NMEA_SENTENCE_TAG_HPP
+
+#include <stdint.h>
+
+/**
+ * The maximum number of characters of a sentence identifier which
+ * can be packed by NMEASentenceTag().
+ */
+static constexpr unsigned MAX_NMEA_SENTENCE_TAG = 8;
+
+static constexpr uint64_t
+PackNMEASentenceTag(const char *p, uint64_t tag, unsigned length)
+{
+  return *p == 0
+    ? tag
+    : (length == MAX_NMEA_SENTENCE_TAG
+       ? 0
+       : PackNMEASentenceTag(p + 1, (tag << 8) | (uint8_t)*p, length + 1));
+}
+
+/**
+ * Packs an NMEA sentence identifier (the first field, e.g. "$GPRMC"
+ * or "$PFLAU") into an integer.  This allows dispatching on the
+ * identifier with a "switch" statement, which the compiler turns into
+ * a jump table or a binary search, instead of a chain of string
+ * comparisons:
+ *
+ *   switch (NMEASentenceTag(type)) {
+ *   case NMEASentenceTag("$PFLAU"):
+ *     ...
+ *
+ * Identifiers longer than #MAX_NMEA_SENTENCE_TAG characters yield 0,
+ * which matches no identifier.
+ */
+static constexpr uint64_t
+NMEASentenceTag(const char *p)
+{
+  return PackNMEASentenceTag(p, 0, 0);
+}
+
+#endif
@@ -0,0 +1,144 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_EPOLL_HPP
+#define XCSOAR_EPOLL_HPP
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+/**
+ * A wrapper for the Linux epoll API.  Unlike #Poll, the kernel
+ * maintains the file descriptor list, which is modified
+ * incrementally, and Wait() returns only the file descriptors which
+ * are ready.  It is not thread safe.
+ */
+class EPoll {
+public:
+  /**
+   * The maximum number of events returned by one Wait() call.  More
+   * events will be returned by the next call.
+   */
+  static constexpr unsigned MAX_EVENTS = 64;
+
+  /**
+   * Mask bit for "file is ready for reading".
+   */
+  static constexpr unsigned READ = EPOLLIN;
+
+  /**
+   * Mask bit for "file is ready for writing".
+   */
+  static constexpr unsigned WRITE = EPOLLOUT;
+
+private:
+  int fd;
+
+  struct epoll_event events[MAX_EVENTS];
+
+  unsigned n_events;
+
+public:
+  EPoll():fd(::epoll_create1(EPOLL_CLOEXEC)), n_events(0) {}
+
+  ~EPoll() {
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  EPoll(const EPoll &other) = delete;
+  EPoll &operator=(const EPoll &other) = delete;
+
+  bool IsDefined() const {
+    return fd >= 0;
+  }
+
+  /**
+   * Register a file descriptor.
+   *
+   * @param mask the bit mask of interesting events
+   * @return false on error
+   */
+  bool Add(int _fd, unsigned mask) {
+    return Control(EPOLL_CTL_ADD, _fd, mask);
+  }
+
+  /**
+   * Change the event mask of a registered file descriptor.
+   *
+   * @return false on error, e.g. if the file descriptor is not
+   * registered (anymore), because it has been closed
+   */
+  bool Modify(int _fd, unsigned mask) {
+    return Control(EPOLL_CTL_MOD, _fd, mask);
+  }
+
+  /**
+   * Unregister a file descriptor.  Errors are ignored, because the
+   * kernel has already unregistered a file descriptor which has
+   * been closed.
+   */
+  void Remove(int _fd) {
+    Control(EPOLL_CTL_DEL, _fd, 0);
+  }
+
+  /**
+   * Wait for events on the registered file descriptors.  Afterwards,
+   * they can be obtained with GetCount(), GetFD() and GetMask().
+   *
+   * @param timeout_ms a timeout in milliseconds; -1 means no timeout
+   * (the default)
+   * @return false on error
+   */
+  bool Wait(int timeout_ms=-1) {
+    const int result = ::epoll_wait(fd, events, MAX_EVENTS, timeout_ms);
+    n_events = result > 0 ? result : 0;
+    return result >= 0;
+  }
+
+  /**
+   * Returns the number of events returned by the last Wait() call.
+   */
+  unsigned GetCount() const {
+    return n_events;
+  }
+
+  int GetFD(unsigned i) const {
+    return events[i].data.fd;
+  }
+
+  unsigned GetMask(unsigned i) const {
+    return events[i].events;
+  }
+
+private:
+  bool Control(int op, int _fd, unsigned mask) {
+    struct epoll_event event;
+    event.events = mask;
+    event.data.u64 = 0;
+    event.data.fd = _fd;
+    return ::epoll_ctl(fd, op, _fd, &event) == 0;
+  }
+};
+
+#endif
@@ -45,6 +45,7 @@ Copyright_License {
 #include "Tracking/TrackingGlue.hpp"
 #include "Operation/MessageOperationEnvironment.hpp"
 #include "Event/Idle.hpp"
+#include "Terrain/RasterTerrain.hpp"
 
 #ifdef _WIN32_WCE
 static void
@@ -266,6 +267,13 @@ ProcessTimer()
     }
   }
 
+  if (terrain != NULL) {
+    const NMEAInfo &basic = CommonInterface::Basic();
+    if (basic.location_available && basic.track_available &&
+        basic.MovementDetected())
+      terrain->Prefetch(basic.location, basic.track, basic.ground_speed);
+  }
+
 #ifdef HAVE_TRACKING
   if (tracking != NULL && CommonInterface::Basic().gps.real) {
     tracking->SetSettings(CommonInterface::GetComputerSettings().tracking);
@@ -33,7 +33,7 @@ Copyright_License {
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Engine/Waypoint/WaypointVisitor.hpp"
 #include "Engine/Navigation/Aircraft.hpp"
-#include "Engine/GlideSolvers/GlideState.hpp"
+#include "Engine/GlideSolvers/GlideBatch.hpp"
 #include "Engine/GlideSolvers/GlideResult.hpp"
 #include "Engine/GlideSolvers/MacCready.hpp"
 #include "Engine/Task/Unordered/UnorderedTaskPoint.hpp"
@@ -55,6 +55,8 @@ Copyright_License {
 #include "Engine/Route/ReachResult.hpp"
 #include "Look/Fonts.hpp"
 
+#include <vector>
+
 #include <assert.h>
 #include <stdio.h>
 
@@ -81,19 +83,11 @@ struct VisibleWaypoint {
     in_task = _in_task;
   }
 
-  void CalculateReachabilityDirect(const MoreData &basic,
-                                   const SpeedVector &wind,
-                                   const MacCready &mac_cready,
-                                   const TaskBehaviour &task_behaviour) {
-    assert(basic.location_available);
-    assert(basic.NavAltitudeAvailable());
-
-    const fixed elevation = waypoint->elevation +
-      task_behaviour.safety_height_arrival;
-    const GlideState state(GeoVector(basic.location, waypoint->location),
-                           elevation, basic.nav_altitude, wind);
-
-    const GlideResult result = mac_cready.SolveStraight(state);
+  /**
+   * Apply the result of the direct glide calculation, see
+   * WaypointVisitorMap::CalculateDirect().
+   */
+  void SetReachabilityDirect(const GlideResult &result) {
     if (!result.IsOk())
       return;
 
@@ -407,13 +401,28 @@ public:
       : calculated.glide_polar_safety;
     const MacCready mac_cready(task_behaviour.glide, glide_polar);
 
-    for (auto it = waypoints.begin(), end = waypoints.end(); it != end; ++it) {
-      VisibleWaypoint &vwp = *it;
+    /* solve all glides in one pass */
+    GlideBatch batch;
+    batch.Reset(basic.nav_altitude, calculated.GetWindOrZero());
+    batch.reserve(waypoints.size());
+    for (const VisibleWaypoint &vwp : waypoints) {
       const Waypoint &way_point = *vwp.waypoint;
+      if (way_point.IsLandable() || way_point.flags.watched)
+        batch.Add(GeoVector(basic.location, way_point.location),
+                  way_point.elevation + task_behaviour.safety_height_arrival);
+    }
+
+    if (batch.empty())
+      return;
+
+    std::vector<GlideResult> results(batch.size());
+    mac_cready.SolveBatch(batch, results.data(), true);
 
+    auto result = results.begin();
+    for (VisibleWaypoint &vwp : waypoints) {
+      const Waypoint &way_point = *vwp.waypoint;
       if (way_point.IsLandable() || way_point.flags.watched)
-        vwp.CalculateReachabilityDirect(basic, calculated.GetWindOrZero(),
-                                        mac_cready, task_behaviour);
+        vwp.SetReachabilityDirect(*result++);
     }
   }
 
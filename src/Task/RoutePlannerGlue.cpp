@@ -22,6 +22,7 @@
 
 #include "RoutePlannerGlue.hpp"
 #include "Thread/Guard.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Terrain/RasterTerrain.hpp"
 #include "Geo/SpeedVector.hpp"
 #include "NMEA/Derived.hpp"
@@ -29,8 +30,21 @@
 
 RoutePlannerGlue::RoutePlannerGlue(const Airspaces &master):
   terrain(NULL),
-  planner(master)
+  planner(master),
+  pool(NULL)
 {
+  /* a search rarely has more than a few dozen candidate links at a
+     time */
+  const unsigned n_threads = std::min(WorkerPool::GetProcessorCount(), 4u);
+  if (n_threads > 1) {
+    pool = new WorkerPool(n_threads);
+    planner.SetWorkerPool(pool);
+  }
+}
+
+RoutePlannerGlue::~RoutePlannerGlue()
+{
+  delete pool;
 }
 
 void
@@ -27,13 +27,21 @@
 struct GlideSettings;
 class RoughAltitude;
 class RasterTerrain;
+class WorkerPool;
 
 class RoutePlannerGlue {
   const RasterTerrain *terrain;
   AirspaceRoute planner;
 
+  /**
+   * Checks the candidate links of the planner in parallel; NULL on
+   * single-core systems.
+   */
+  WorkerPool *pool;
+
 public:
   RoutePlannerGlue(const Airspaces &master);
+  ~RoutePlannerGlue();
 
   void SetTerrain(const RasterTerrain *terrain);
 
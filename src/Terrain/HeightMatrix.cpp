@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "HeightMatrix.hpp"
 #include "RasterMap.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
@@ -30,7 +31,11 @@ Copyright_License {
 #include "Projection/WindowProjection.hpp"
 #endif
 
+#include <algorithm>
+
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 void
 HeightMatrix::SetSize(size_t _size)
@@ -57,6 +62,86 @@ HeightMatrix::SetSize(unsigned width, unsigned height,
           (height + quantisation_pixels - 1) / quantisation_pixels);
 }
 
+void
+HeightMatrix::ScanRow(const RasterMap &map, const GeoPoint &start,
+                      const GeoPoint &end, unsigned y,
+                      unsigned x_begin, unsigned x_end, bool interpolate)
+{
+  assert(y < height);
+  assert(x_begin < x_end);
+  assert(x_end <= width);
+
+  short *p = data.begin() + y * width;
+
+  if (x_end - x_begin < 2 && width >= 2) {
+    /* RasterMap::ScanLine() needs at least two samples; scan one
+       more (valid) cell */
+    if (x_end < width)
+      ++x_end;
+    else
+      --x_begin;
+  }
+
+  if (x_begin == 0 && x_end == width) {
+    map.ScanLine(start, end, p, width, interpolate);
+    return;
+  }
+
+  /* ScanLine() samples at equal distances from the start, so a part
+     of the row is the part of the line between the two column
+     edges */
+  map.ScanLine(start.Interpolate(end, fixed(x_begin) / width),
+               start.Interpolate(end, fixed(x_end) / width),
+               p + x_begin, x_end - x_begin, interpolate);
+}
+
+void
+HeightMatrix::ScanRowOutside(const RasterMap &map, unsigned y,
+                             const PixelRect &valid, bool interpolate)
+{
+  const GeoPoint &start = row_points[y * 2];
+  const GeoPoint &end = row_points[y * 2 + 1];
+
+  if ((int)y < valid.top || (int)y >= valid.bottom) {
+    ScanRow(map, start, end, y, 0, width, interpolate);
+  } else {
+    if (valid.left > 0)
+      ScanRow(map, start, end, y, 0, valid.left, interpolate);
+    if ((unsigned)valid.right < width)
+      ScanRow(map, start, end, y, valid.right, width, interpolate);
+  }
+}
+
+class HeightMatrix::ScanRowsJob final : public WorkerPool::Job {
+  HeightMatrix &matrix;
+  const RasterMap &map;
+  const PixelRect &valid;
+  const bool interpolate;
+
+public:
+  ScanRowsJob(HeightMatrix &_matrix, const RasterMap &_map,
+              const PixelRect &_valid, bool _interpolate)
+    :matrix(_matrix), map(_map), valid(_valid), interpolate(_interpolate) {}
+
+  virtual void Process(unsigned y) override {
+    matrix.ScanRowOutside(map, y, valid, interpolate);
+  }
+};
+
+void
+HeightMatrix::ScanRowsOutside(const RasterMap &map, const PixelRect &valid,
+                              bool interpolate)
+{
+  if (pool == NULL) {
+    for (unsigned y = 0; y < height; ++y)
+      ScanRowOutside(map, y, valid, interpolate);
+    return;
+  }
+
+  ScanRowsJob job(*this, map, valid, interpolate);
+  pool->Run(job, height);
+}
+
 #ifdef ENABLE_OPENGL
 
 void
@@ -64,15 +149,23 @@ HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
                    unsigned width, unsigned height, bool interpolate)
 {
   SetSize(width, height);
+  FillOutside(map, bounds, PixelRect(0, 0, 0, 0), interpolate);
+}
+
+void
+HeightMatrix::FillOutside(const RasterMap &map, const GeoBounds &bounds,
+                          const PixelRect &valid, bool interpolate)
+{
+  row_points.GrowDiscard(height * 2);
 
   const Angle delta_y = bounds.GetHeight() / height;
   Angle latitude = bounds.GetNorth();
-  for (short *p = data.begin(), *const end = p + width * height;
-       p != end; p += width, latitude -= delta_y) {
-    map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
-                 GeoPoint(bounds.GetEast(), latitude),
-                 p, width, interpolate);
+  for (unsigned y = 0; y < height; ++y, latitude -= delta_y) {
+    row_points[y * 2] = GeoPoint(bounds.GetWest(), latitude);
+    row_points[y * 2 + 1] = GeoPoint(bounds.GetEast(), latitude);
   }
+
+  ScanRowsOutside(map, valid, interpolate);
 }
 
 #else
@@ -87,13 +180,54 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
   SetSize((screen_width + quantisation_pixels - 1) / quantisation_pixels,
           (screen_height + quantisation_pixels - 1) / quantisation_pixels);
 
-  short *p = data.begin();
-  for (unsigned y = 0; y < screen_height;
-       y += quantisation_pixels, p += width) {
-    map.ScanLine(projection.ScreenToGeo(0, y),
-                 projection.ScreenToGeo(screen_width, y),
-                 p, width, interpolate);
+  FillOutside(map, projection, quantisation_pixels, PixelRect(0, 0, 0, 0),
+              interpolate);
+}
+
+void
+HeightMatrix::FillOutside(const RasterMap &map,
+                          const WindowProjection &projection,
+                          unsigned quantisation_pixels,
+                          const PixelRect &valid, bool interpolate)
+{
+  const unsigned screen_width = projection.GetScreenWidth();
+
+  row_points.GrowDiscard(height * 2);
+
+  for (unsigned y = 0; y < height; ++y) {
+    const int screen_y = y * quantisation_pixels;
+    row_points[y * 2] = projection.ScreenToGeo(0, screen_y);
+    row_points[y * 2 + 1] = projection.ScreenToGeo(screen_width, screen_y);
   }
+
+  ScanRowsOutside(map, valid, interpolate);
 }
 
 #endif
+
+PixelRect
+HeightMatrix::Shift(int dx, int dy)
+{
+  assert(abs(dx) < (int)width);
+  assert(abs(dy) < (int)height);
+
+  const PixelRect valid(std::max(0, -dx), std::max(0, -dy),
+                        std::min((int)width, (int)width - dx),
+                        std::min((int)height, (int)height - dy));
+
+  const unsigned n = valid.right - valid.left;
+
+  /* copy in the direction which does not overwrite rows which are
+     still needed; within a row, the ranges may overlap */
+  if (dy >= 0) {
+    for (int y = valid.top; y < valid.bottom; ++y)
+      memmove(data.begin() + y * width + valid.left,
+              GetRow(y + dy) + valid.left + dx, n * sizeof(short));
+  } else {
+    for (int y = valid.bottom - 1; y >= valid.top; --y)
+      memmove(data.begin() + y * width + valid.left,
+              GetRow(y + dy) + valid.left + dx, n * sizeof(short));
+  }
+
+  return valid;
+}
@@ -26,9 +26,12 @@ Copyright_License {
 
 #include "Util/NonCopyable.hpp"
 #include "Util/AllocatedArray.hpp"
+#include "Screen/Point.hpp"
+#include "Geo/GeoPoint.hpp"
 #include "Compiler.h"
 
 class RasterMap;
+class WorkerPool;
 
 #ifdef ENABLE_OPENGL
 class GeoBounds;
@@ -37,17 +40,63 @@ class WindowProjection;
 #endif
 
 class HeightMatrix : private NonCopyable {
+  class ScanRowsJob;
+
   AllocatedArray<short> data;
   unsigned width, height;
 
+  /**
+   * The start and end point of each row, see ScanRow().
+   */
+  AllocatedArray<GeoPoint> row_points;
+
+  /**
+   * If set, then the rows are scanned in parallel on this pool.
+   */
+  WorkerPool *pool;
+
 public:
-  HeightMatrix():width(0), height(0) {}
+  HeightMatrix():width(0), height(0), pool(NULL) {}
+
+  /**
+   * Scan the rows with the specified #WorkerPool from now on.  The
+   * #RasterMap is only read, and each row is written by exactly one
+   * thread, so the result is the same as without a pool.
+   *
+   * @param pool the pool, or NULL to scan on the calling thread
+   */
+  void SetWorkerPool(WorkerPool *_pool) {
+    pool = _pool;
+  }
 
 protected:
   void SetSize(size_t _size);
   void SetSize(unsigned width, unsigned height);
   void SetSize(unsigned width, unsigned height, unsigned quantisation_pixels);
 
+  /**
+   * Scan the columns [x_begin, x_end) of one row.  The row is a
+   * straight line from #start (left edge of column 0) to #end (right
+   * edge of the last column).
+   */
+  void ScanRow(const RasterMap &map, const GeoPoint &start,
+               const GeoPoint &end, unsigned y,
+               unsigned x_begin, unsigned x_end, bool interpolate);
+
+  /**
+   * Scan the columns of row #y which are outside the #valid
+   * rectangle, along #row_points.
+   */
+  void ScanRowOutside(const RasterMap &map, unsigned y,
+                      const PixelRect &valid, bool interpolate);
+
+  /**
+   * Call ScanRowOutside() for all rows, on the #WorkerPool if there
+   * is one.  #row_points must have been filled before.
+   */
+  void ScanRowsOutside(const RasterMap &map, const PixelRect &valid,
+                       bool interpolate);
+
 public:
 #ifdef ENABLE_OPENGL
   /**
@@ -55,14 +104,41 @@ public:
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
             unsigned _width, unsigned _height, bool interpolate);
+
+  /**
+   * Like Fill(), but scan only the cells outside the specified
+   * rectangle; the size must not have changed since the last Fill()
+   * call.
+   */
+  void FillOutside(const RasterMap &map, const GeoBounds &bounds,
+                   const PixelRect &valid, bool interpolate);
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
             unsigned quantisation_pixels, bool interpolate);
+
+  /**
+   * Like Fill(), but scan only the cells outside the specified
+   * rectangle; the size must not have changed since the last Fill()
+   * call.
+   */
+  void FillOutside(const RasterMap &map,
+                   const WindowProjection &map_projection,
+                   unsigned quantisation_pixels,
+                   const PixelRect &valid, bool interpolate);
 #endif
 
+  /**
+   * Move the contents of the matrix, so that the new cell (x, y)
+   * contains the old cell (x + dx, y + dy).  Cells which were moved
+   * in from outside keep undefined values.
+   *
+   * @return the rectangle of cells which contain valid data
+   */
+  PixelRect Shift(int dx, int dy);
+
   unsigned GetWidth() const {
     return width;
   }
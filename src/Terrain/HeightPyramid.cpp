@@ -0,0 +1,263 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "HeightPyramid.hpp"
+#include "RasterBuffer.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <limits.h>
+
+static constexpr short EMPTY_MINIMUM = SHRT_MAX;
+static constexpr short EMPTY_MAXIMUM = SHRT_MIN;
+
+static inline short
+Load(const std::atomic<short> &bound)
+{
+  return bound.load(std::memory_order_relaxed);
+}
+
+static inline void
+Store(std::atomic<short> &bound, short value)
+{
+  bound.store(value, std::memory_order_relaxed);
+}
+
+void
+HeightPyramid::Resize(unsigned width, unsigned height)
+{
+  assert(width > 0);
+  assert(height > 0);
+
+  unsigned level_width = (width + (1u << BLOCK_BITS) - 1) >> BLOCK_BITS;
+  unsigned level_height = (height + (1u << BLOCK_BITS) - 1) >> BLOCK_BITS;
+  unsigned size = 0;
+
+  n_levels = 0;
+  while (true) {
+    assert(n_levels < MAX_LEVELS);
+
+    Level &level = levels[n_levels++];
+    level.width = level_width;
+    level.height = level_height;
+    level.offset = size;
+    size += level_width * level_height;
+
+    if (level_width == 1 && level_height == 1)
+      break;
+
+    level_width = (level_width + 1) / 2;
+    level_height = (level_height + 1) / 2;
+  }
+
+  lower.ResizeDiscard(size);
+  upper.ResizeDiscard(size);
+  for (unsigned i = 0; i < size; ++i) {
+    Store(lower[i], EMPTY_MINIMUM);
+    Store(upper[i], EMPTY_MAXIMUM);
+  }
+}
+
+void
+HeightPyramid::Include(unsigned block_x, unsigned block_y,
+                       short minimum, short maximum)
+{
+  assert(IsDefined());
+  assert(block_x < levels[0].width);
+  assert(block_y < levels[0].height);
+
+  /* each walk stops at the first level which already includes the
+     value, because the levels above include it, too */
+
+  for (unsigned level = 0; level < n_levels; ++level) {
+    std::atomic<short> &bound = lower[Index(level, block_x >> level,
+                                            block_y >> level)];
+    if (Load(bound) <= minimum)
+      break;
+
+    Store(bound, minimum);
+  }
+
+  for (unsigned level = 0; level < n_levels; ++level) {
+    std::atomic<short> &bound = upper[Index(level, block_x >> level,
+                                            block_y >> level)];
+    if (Load(bound) >= maximum)
+      break;
+
+    Store(bound, maximum);
+  }
+}
+
+void
+HeightPyramid::Include(const RasterBuffer &buffer, unsigned x, unsigned y)
+{
+  assert(IsDefined());
+  assert(buffer.IsDefined());
+
+  const unsigned width = buffer.GetWidth(), height = buffer.GetHeight();
+  if (width == 0 || height == 0)
+    return;
+
+  const unsigned first_column = x >> BLOCK_BITS;
+  const unsigned n_columns = ((x + width - 1) >> BLOCK_BITS) - first_column + 1;
+
+  AllocatedArray<Bounds> row_bounds(n_columns);
+
+  for (unsigned row = 0; row < height;) {
+    const unsigned block_y = (y + row) >> BLOCK_BITS;
+
+    for (auto &i : row_bounds) {
+      i.minimum = EMPTY_MINIMUM;
+      i.maximum = EMPTY_MAXIMUM;
+    }
+
+    /* collect the bounds of all rows of this block row */
+    for (; row < height && (y + row) >> BLOCK_BITS == block_y; ++row) {
+      const short *src = buffer.GetDataAt(0, row);
+      for (unsigned column = 0; column < width; ++column) {
+        Bounds &b = row_bounds[((x + column) >> BLOCK_BITS) - first_column];
+        b.minimum = std::min(b.minimum, src[column]);
+        b.maximum = std::max(b.maximum, src[column]);
+      }
+    }
+
+    for (unsigned i = 0; i < n_columns; ++i)
+      Include(first_column + i, block_y,
+              row_bounds[i].minimum, row_bounds[i].maximum);
+  }
+}
+
+void
+HeightPyramid::IncludeOverview(const RasterBuffer &overview)
+{
+  assert(IsDefined());
+
+  if (!overview.IsDefined())
+    return;
+
+  /* the overview may be smaller than the block grid; the last
+     overview pixel is used for the remaining blocks, like
+     RasterTileCache::GetFieldDirect() does */
+  const unsigned last_x = overview.GetWidth() - 1;
+  const unsigned last_y = overview.GetHeight() - 1;
+
+  const Level &l = levels[0];
+  for (unsigned y = 0; y < l.height; ++y) {
+    for (unsigned x = 0; x < l.width; ++x) {
+      const short h = overview.Get(std::min(x, last_x), std::min(y, last_y));
+      Include(x, y, h, h);
+    }
+  }
+}
+
+void
+HeightPyramid::LoadBlocks(const short *src)
+{
+  assert(IsDefined());
+
+  const unsigned n = levels[0].width * levels[0].height;
+  for (unsigned i = 0; i < n; ++i) {
+    Store(lower[i], std::min(Load(lower[i]), src[i]));
+    Store(upper[i], std::max(Load(upper[i]), src[n + i]));
+  }
+
+  BuildLevels();
+}
+
+void
+HeightPyramid::SaveBlocks(short *dest) const
+{
+  assert(IsDefined());
+
+  const unsigned n = levels[0].width * levels[0].height;
+  for (unsigned i = 0; i < n; ++i) {
+    dest[i] = Load(lower[i]);
+    dest[n + i] = Load(upper[i]);
+  }
+}
+
+void
+HeightPyramid::BuildLevels()
+{
+  for (unsigned level = 1; level < n_levels; ++level) {
+    const Level &below = levels[level - 1];
+    const Level &l = levels[level];
+
+    for (unsigned y = 0; y < l.height; ++y) {
+      const unsigned y0 = y * 2, y1 = std::min(y0 + 1, below.height - 1);
+
+      for (unsigned x = 0; x < l.width; ++x) {
+        const unsigned x0 = x * 2, x1 = std::min(x0 + 1, below.width - 1);
+
+        const unsigned a = Index(level - 1, x0, y0);
+        const unsigned b = Index(level - 1, x1, y0);
+        const unsigned c = Index(level - 1, x0, y1);
+        const unsigned d = Index(level - 1, x1, y1);
+        const unsigned i = Index(level, x, y);
+
+        Store(lower[i], std::min(std::min(Load(lower[a]), Load(lower[b])),
+                                 std::min(Load(lower[c]), Load(lower[d]))));
+        Store(upper[i], std::max(std::max(Load(upper[a]), Load(upper[b])),
+                                 std::max(Load(upper[c]), Load(upper[d]))));
+      }
+    }
+  }
+}
+
+HeightPyramid::Bounds
+HeightPyramid::GetBounds(unsigned x0, unsigned y0,
+                         unsigned x1, unsigned y1) const
+{
+  assert(IsDefined());
+  assert(x0 <= x1);
+  assert(y0 <= y1);
+
+  unsigned bx0 = x0 >> BLOCK_BITS, by0 = y0 >> BLOCK_BITS;
+  unsigned bx1 = x1 >> BLOCK_BITS, by1 = y1 >> BLOCK_BITS;
+  assert(bx1 < levels[0].width);
+  assert(by1 < levels[0].height);
+
+  /* the lowest level where the rectangle touches at most 2x2
+     pairs */
+  unsigned level = 0;
+  while (bx1 - bx0 > 1 || by1 - by0 > 1) {
+    ++level;
+    assert(level < n_levels);
+
+    bx0 >>= 1;
+    by0 >>= 1;
+    bx1 >>= 1;
+    by1 >>= 1;
+  }
+
+  const unsigned a = Index(level, bx0, by0), b = Index(level, bx1, by0);
+  const unsigned c = Index(level, bx0, by1), d = Index(level, bx1, by1);
+
+  Bounds result;
+  result.minimum = std::min(std::min(Load(lower[a]), Load(lower[b])),
+                            std::min(Load(lower[c]), Load(lower[d])));
+  result.maximum = std::max(std::max(Load(upper[a]), Load(upper[b])),
+                            std::max(Load(upper[c]), Load(upper[d])));
+  return result;
+}
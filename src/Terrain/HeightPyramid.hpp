@@ -0,0 +1,158 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_HEIGHT_PYRAMID_HPP
+#define XCSOAR_TERRAIN_HEIGHT_PYRAMID_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "Compiler.h"
+
+#include <atomic>
+
+class RasterBuffer;
+
+/**
+ * Lower and upper bounds of the terrain height: one pair for each
+ * block of 16x16 pixels (level 0), and mip levels above that, where
+ * each pair covers 2x2 pairs of the level below.  Line-of-sight
+ * queries use it to skip the terrain lookups on parts of a line which
+ * pass above all blocks they touch.
+ *
+ * The bounds only widen.  #RasterTileCache includes the overview and
+ * each tile when it gets loaded, but never narrows a bound when a tile
+ * is disposed.  Therefore the bounds are valid for any tile table a
+ * reader may see, and readers need no locking.  Only one thread may
+ * modify the object at a time.
+ */
+class HeightPyramid : private NonCopyable {
+public:
+  /**
+   * The size of a level 0 block is 2^BLOCK_BITS pixels.  This matches
+   * RasterTileCache::OVERVIEW_BITS, so each block is covered by
+   * exactly one overview pixel.
+   */
+  static constexpr unsigned BLOCK_BITS = 4;
+
+  struct Bounds {
+    short minimum, maximum;
+  };
+
+private:
+  static constexpr unsigned MAX_LEVELS = 24;
+
+  struct Level {
+    unsigned width, height;
+
+    /**
+     * The position of this level's first pair in #lower and #upper.
+     */
+    unsigned offset;
+  };
+
+  Level levels[MAX_LEVELS];
+  unsigned n_levels;
+
+  /**
+   * The bounds of all levels, level 0 first, each one row by row.
+   */
+  AllocatedArray<std::atomic<short>> lower, upper;
+
+public:
+  HeightPyramid():n_levels(0) {}
+
+  bool IsDefined() const {
+    return n_levels > 0;
+  }
+
+  void Reset() {
+    n_levels = 0;
+  }
+
+  /**
+   * Allocate the levels for a map of the specified size (in pixels),
+   * with empty bounds.
+   */
+  void Resize(unsigned width, unsigned height);
+
+  unsigned GetBlockWidth() const {
+    return levels[0].width;
+  }
+
+  unsigned GetBlockHeight() const {
+    return levels[0].height;
+  }
+
+  /**
+   * Widen the bounds of the specified block (and of the levels above)
+   * to include the specified range.
+   */
+  void Include(unsigned block_x, unsigned block_y,
+               short minimum, short maximum);
+
+  /**
+   * Include all heights of a buffer whose upper left pixel is at the
+   * specified location.
+   */
+  void Include(const RasterBuffer &buffer, unsigned x, unsigned y);
+
+  /**
+   * Include the overview heights, which are used for pixels whose
+   * tile is not loaded.
+   */
+  void IncludeOverview(const RasterBuffer &overview);
+
+  /**
+   * Include the level 0 bounds stored previously by SaveBlocks().
+   * This is only allowed when there are no readers.
+   */
+  void LoadBlocks(const short *src);
+
+  /**
+   * Copy the level 0 bounds to the specified array, which must have
+   * 2 * GetBlockWidth() * GetBlockHeight() elements: all lower bounds
+   * followed by all upper bounds.
+   */
+  void SaveBlocks(short *dest) const;
+
+  /**
+   * Returns bounds of the heights of all pixels in the rectangle from
+   * (x0, y0) to (x1, y1), both inclusive.  All coordinates must be
+   * inside the map.
+   */
+  gcc_pure
+  Bounds GetBounds(unsigned x0, unsigned y0, unsigned x1, unsigned y1) const;
+
+private:
+  unsigned Index(unsigned level, unsigned x, unsigned y) const {
+    const Level &l = levels[level];
+    return l.offset + y * l.width + x;
+  }
+
+  /**
+   * Recalculate all levels above level 0.
+   */
+  void BuildLevels();
+};
+
+#endif
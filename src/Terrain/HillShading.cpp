@@ -0,0 +1,686 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/HillShading.hpp"
+#include "Terrain/RasterBuffer.hpp"
+#include "Math/FastMath.h"
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+//#define FAST_RSQRT
+
+using namespace HillShading;
+
+static constexpr unsigned FLAT_OFFSET = FLAT * 256;
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the
+ * ShadedPixel() formula when the map file is broken, avoiding
+ * the sqrt() call with a negative argument.
+ */
+gcc_const
+static int
+ClipHeightDelta(int d)
+{
+  if (d > 512)
+    d = 512;
+  else if (d < -512)
+    d = -512;
+  return d;
+}
+
+gcc_const
+static inline unsigned
+HeightLevel(short h, unsigned height_scale)
+{
+  if (h < 0)
+    h = 0;
+
+  return std::min(254, h >> height_scale);
+}
+
+gcc_const
+static inline unsigned
+UnshadedPixel(short h, unsigned height_scale)
+{
+  if (gcc_likely(!RasterBuffer::IsSpecial(h)))
+    return FLAT_OFFSET + HeightLevel(h, height_scale);
+  else if (RasterBuffer::IsWater(h))
+    // we're in the water, so look up the color for water
+    return FLAT_OFFSET + WATER;
+  else
+    /* outside the terrain file bounds: white background */
+    return BACKGROUND;
+}
+
+/**
+ * @param p20 the horizontal distance of the left and right cells
+ * @param p31 the vertical distance of the cells above and below
+ */
+gcc_pure
+static inline unsigned
+ShadedPixel(const Parameters &parameters,
+            short h, short h_above, short h_below,
+            short h_left, short h_right,
+            unsigned p20, unsigned p31)
+{
+  if (gcc_unlikely(RasterBuffer::IsSpecial(h)))
+    return UnshadedPixel(h, parameters.height_scale);
+
+  const unsigned level = HeightLevel(h, parameters.height_scale);
+
+  // no need to calculate slope if undefined height or sea level
+
+  if (gcc_unlikely(RasterBuffer::IsSpecial(h_above) ||
+                   RasterBuffer::IsSpecial(h_below) ||
+                   RasterBuffer::IsSpecial(h_left) ||
+                   RasterBuffer::IsSpecial(h_right)))
+    /* some "special" terrain value surrounding us (water or
+       invalid), skip slope calculation */
+    return FLAT_OFFSET + level;
+
+  const int p32 = ClipHeightDelta(h_above - h_below);
+  const int p22 = ClipHeightDelta(h_right - h_left);
+
+  const int dd0 = p22 * p31;
+  const int dd1 = p20 * p32;
+  const int dd2 = p20 * p31 * parameters.height_slope_factor;
+
+  const int sx = parameters.sx, sy = parameters.sy, sz = parameters.sz;
+  const int contrast = parameters.contrast;
+
+#ifndef FAST_RSQRT
+  const int num = (dd2 * sz + dd0 * sx + dd1 * sy);
+  const int mag = (dd0 * dd0 + dd1 * dd1 + dd2 * dd2);
+#ifdef FIXED_MATH
+  const int sval = num / (int)isqrt4(mag);
+#else
+  const int sval = num / (int)sqrt((fixed)mag);
+#endif
+  int sindex = (sval - sz) * contrast / 128;
+  if (gcc_unlikely(sindex < -64))
+    sindex = -64;
+  if (gcc_unlikely(sindex > 63))
+    sindex = 63;
+  return level + 256 * (FLAT + sindex);
+#else
+  const short szindex = sz * contrast / 128;
+  const short sval_min = szindex - 64;
+  const short sval_max = szindex + 63;
+  const int sx_c = sx * contrast >> 7;
+  const int sy_c = sy * contrast >> 7;
+  const int sz_c = sz * contrast >> 7;
+
+  const int num = (dd2 * sz_c + dd0 * sx_c + dd1 * sy_c);
+  const int sval = i_normalise_mag3(num, dd0, dd1, dd2);
+  if (gcc_unlikely(sval <= sval_min))
+    return level;
+  else if (gcc_unlikely(sval >= sval_max))
+    return level + 127 * 256;
+  else
+    return level + (FLAT - szindex + sval) * 256;
+#endif
+}
+
+#ifdef HAVE_HILL_SHADING_SIMD
+
+/**
+ * The constants of one row for the vectorized implementation.
+ */
+struct RowConstants {
+  unsigned p20, p31;
+
+  /** the products of the per-row term of ShadedPixel() */
+  int dd2_sz, dd2_sq;
+};
+
+/**
+ * Can the vectorized implementation be used for a row with the
+ * specified distances?  It calculates with 16 bit integers where
+ * possible, and the scalar formula must not overflow.
+ */
+static bool
+CheckRowConstants(const Parameters &parameters,
+                  unsigned p20, unsigned p31, RowConstants &c)
+{
+  /* |sval| <= 2 * |sun|, which keeps all intermediate values of
+     Illumination() within 16 bits */
+  if (p20 == 0 || p31 == 0 || p20 > 63 || p31 > 63 ||
+      parameters.contrast < 0 || parameters.contrast > SHRT_MAX ||
+      abs(parameters.sx) + abs(parameters.sy) + abs(parameters.sz) > 8191)
+    return false;
+
+  const int64_t dd2 = (int64_t)p20 * p31 * parameters.height_slope_factor;
+  const int64_t max_dd0 = 512 * p31, max_dd1 = 512 * p20;
+
+  const int64_t max_num = dd2 * abs(parameters.sz) +
+    max_dd0 * abs(parameters.sx) + max_dd1 * abs(parameters.sy);
+  const int64_t max_mag = dd2 * dd2 + max_dd0 * max_dd0 + max_dd1 * max_dd1;
+  if (max_num > INT_MAX || max_mag > INT_MAX)
+    return false;
+
+  c.p20 = p20;
+  c.p31 = p31;
+  c.dd2_sz = (int)dd2 * parameters.sz;
+  c.dd2_sq = (int)(dd2 * dd2);
+  return true;
+}
+
+#endif
+
+#ifdef __SSE2__
+
+/**
+ * The lower 32 bits of the product of each lane (SSE2 lacks
+ * _mm_mullo_epi32()).
+ */
+static inline __m128i
+MulLo32(__m128i a, __m128i b)
+{
+  const __m128i even = _mm_mul_epu32(a, b);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                    _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/**
+ * Calculate (int)sqrt(mag) exactly: the single precision estimate is
+ * off by at most one for 0 <= mag <= INT_MAX.
+ */
+static inline __m128i
+IntegerSqrt(__m128i mag)
+{
+  __m128i s = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(mag)));
+
+  /* the squares may exceed INT_MAX, therefore compare unsigned */
+  const __m128i sign = _mm_set1_epi32(INT_MIN);
+  const __m128i mag_u = _mm_xor_si128(mag, sign);
+
+  /* decrement if s*s > mag */
+  s = _mm_add_epi32(s, _mm_cmpgt_epi32(_mm_xor_si128(MulLo32(s, s), sign),
+                                       mag_u));
+
+  /* increment if (s+1)*(s+1) <= mag */
+  const __m128i s1 = _mm_sub_epi32(s, _mm_set1_epi32(-1));
+  const __m128i too_big =
+    _mm_cmpgt_epi32(_mm_xor_si128(MulLo32(s1, s1), sign), mag_u);
+  return _mm_sub_epi32(s, _mm_andnot_si128(too_big, _mm_set1_epi32(-1)));
+}
+
+/**
+ * Calculate num / d with C semantics (truncated towards zero).  The
+ * single precision estimate is off by at most one for the quotients
+ * which occur here (|num / d| < 2^16).
+ */
+static inline __m128i
+IntegerDivide(__m128i num, __m128i d)
+{
+  __m128i q = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(num),
+                                          _mm_cvtepi32_ps(d)));
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i r = _mm_sub_epi32(num, MulLo32(q, d));
+  const __m128i negative = _mm_cmplt_epi32(num, zero);
+
+  /* num >= 0: 0 <= r < d; num < 0: -d < r <= 0 */
+  const __m128i dec =
+    _mm_or_si128(_mm_andnot_si128(negative, _mm_cmplt_epi32(r, zero)),
+                 _mm_and_si128(negative,
+                               _mm_cmplt_epi32(r, _mm_sub_epi32(one, d))));
+  const __m128i inc =
+    _mm_or_si128(_mm_andnot_si128(negative,
+                                  _mm_cmpgt_epi32(r, _mm_sub_epi32(d, one))),
+                 _mm_and_si128(negative, _mm_cmpgt_epi32(r, zero)));
+
+  return _mm_sub_epi32(_mm_add_epi32(q, dec), inc);
+}
+
+/**
+ * Calculate (sval - sz) * contrast / 128 for 8 values.
+ */
+static inline __m128i
+Illumination(__m128i sval_lo, __m128i sval_hi, __m128i sz, __m128i contrast)
+{
+  const __m128i t = _mm_subs_epi16(_mm_packs_epi32(sval_lo, sval_hi), sz);
+  const __m128i lo = _mm_mullo_epi16(t, contrast);
+  const __m128i hi = _mm_mulhi_epi16(t, contrast);
+
+  __m128i p_lo = _mm_unpacklo_epi16(lo, hi);
+  __m128i p_hi = _mm_unpackhi_epi16(lo, hi);
+
+  /* division rounding towards zero */
+  const __m128i bias = _mm_set1_epi32(127);
+  p_lo = _mm_srai_epi32(_mm_add_epi32(p_lo,
+                                      _mm_and_si128(_mm_srai_epi32(p_lo, 31),
+                                                    bias)), 7);
+  p_hi = _mm_srai_epi32(_mm_add_epi32(p_hi,
+                                      _mm_and_si128(_mm_srai_epi32(p_hi, 31),
+                                                    bias)), 7);
+
+  return _mm_packs_epi32(p_lo, p_hi);
+}
+
+/**
+ * Shade 8 pixels which are not at the left or right border.
+ *
+ * @return false if a special height value was found; the caller
+ * must use ShadedPixel() then
+ */
+static inline bool
+Shaded8(const Parameters &parameters, const RowConstants &c,
+        const short *src, const short *above, const short *below,
+        unsigned q, uint16_t *dest)
+{
+  const __m128i h = _mm_loadu_si128((const __m128i *)src);
+  const __m128i h_above = _mm_loadu_si128((const __m128i *)above);
+  const __m128i h_below = _mm_loadu_si128((const __m128i *)below);
+  const __m128i h_left = _mm_loadu_si128((const __m128i *)(src - q));
+  const __m128i h_right = _mm_loadu_si128((const __m128i *)(src + q));
+
+  const __m128i special = _mm_set1_epi16(RasterBuffer::TERRAIN_WATER_THRESHOLD + 1);
+  const __m128i any_special =
+    _mm_or_si128(_mm_or_si128(_mm_cmplt_epi16(h, special),
+                              _mm_cmplt_epi16(h_above, special)),
+                 _mm_or_si128(_mm_or_si128(_mm_cmplt_epi16(h_below, special),
+                                           _mm_cmplt_epi16(h_left, special)),
+                              _mm_cmplt_epi16(h_right, special)));
+  if (gcc_unlikely(_mm_movemask_epi8(any_special) != 0))
+    return false;
+
+  const __m128i level =
+    _mm_min_epi16(_mm_sra_epi16(_mm_max_epi16(h, _mm_setzero_si128()),
+                                _mm_cvtsi32_si128(parameters.height_scale)),
+                  _mm_set1_epi16(254));
+
+  /* the saturation does not change the result of the clipping */
+  const __m128i max_delta = _mm_set1_epi16(512);
+  const __m128i min_delta = _mm_set1_epi16(-512);
+  const __m128i p32 =
+    _mm_max_epi16(_mm_min_epi16(_mm_subs_epi16(h_above, h_below),
+                                max_delta), min_delta);
+  const __m128i p22 =
+    _mm_max_epi16(_mm_min_epi16(_mm_subs_epi16(h_right, h_left),
+                                max_delta), min_delta);
+
+  const __m128i dd0 = _mm_mullo_epi16(p22, _mm_set1_epi16(c.p31));
+  const __m128i dd1 = _mm_mullo_epi16(p32, _mm_set1_epi16(c.p20));
+
+  const __m128i d_lo = _mm_unpacklo_epi16(dd0, dd1);
+  const __m128i d_hi = _mm_unpackhi_epi16(dd0, dd1);
+
+  /* pairs of (sx, sy) for _mm_madd_epi16() */
+  const __m128i sxy = _mm_set1_epi32((parameters.sy << 16) |
+                                     (parameters.sx & 0xffff));
+  const __m128i dd2_sz = _mm_set1_epi32(c.dd2_sz);
+  const __m128i dd2_sq = _mm_set1_epi32(c.dd2_sq);
+
+  const __m128i num_lo = _mm_add_epi32(_mm_madd_epi16(d_lo, sxy), dd2_sz);
+  const __m128i num_hi = _mm_add_epi32(_mm_madd_epi16(d_hi, sxy), dd2_sz);
+  const __m128i mag_lo = _mm_add_epi32(_mm_madd_epi16(d_lo, d_lo), dd2_sq);
+  const __m128i mag_hi = _mm_add_epi32(_mm_madd_epi16(d_hi, d_hi), dd2_sq);
+
+  const __m128i sval_lo = IntegerDivide(num_lo, IntegerSqrt(mag_lo));
+  const __m128i sval_hi = IntegerDivide(num_hi, IntegerSqrt(mag_hi));
+
+  __m128i sindex = Illumination(sval_lo, sval_hi,
+                                _mm_set1_epi16(parameters.sz),
+                                _mm_set1_epi16(parameters.contrast));
+  sindex = _mm_max_epi16(_mm_min_epi16(sindex, _mm_set1_epi16(63)),
+                         _mm_set1_epi16(-64));
+
+  const __m128i index =
+    _mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(sindex, _mm_set1_epi16(FLAT)),
+                                 8),
+                  level);
+  _mm_storeu_si128((__m128i *)dest, index);
+  return true;
+}
+
+/**
+ * Calculate 8 unshaded pixels.
+ */
+static inline void
+Unshaded8(const short *src, unsigned height_scale, uint16_t *dest)
+{
+  const __m128i h = _mm_loadu_si128((const __m128i *)src);
+
+  const __m128i level =
+    _mm_min_epi16(_mm_sra_epi16(_mm_max_epi16(h, _mm_setzero_si128()),
+                                _mm_cvtsi32_si128(height_scale)),
+                  _mm_set1_epi16(254));
+
+  const __m128i special =
+    _mm_cmplt_epi16(h, _mm_set1_epi16(RasterBuffer::TERRAIN_WATER_THRESHOLD + 1));
+  const __m128i invalid =
+    _mm_cmpeq_epi16(h, _mm_set1_epi16(RasterBuffer::TERRAIN_INVALID));
+
+  /* special values are water, unless they are invalid */
+  __m128i index = _mm_add_epi16(_mm_set1_epi16(FLAT_OFFSET),
+                                _mm_or_si128(_mm_andnot_si128(special, level),
+                                             _mm_and_si128(special,
+                                                           _mm_set1_epi16(WATER))));
+  index = _mm_or_si128(_mm_andnot_si128(invalid, index),
+                       _mm_and_si128(invalid, _mm_set1_epi16(BACKGROUND)));
+
+  _mm_storeu_si128((__m128i *)dest, index);
+}
+
+#elif defined(__ARM_NEON__)
+
+/**
+ * Calculate (int)sqrt(mag) exactly: the estimate after two
+ * Newton-Raphson steps is off by at most one for 1 <= mag <= INT_MAX.
+ */
+static inline int32x4_t
+IntegerSqrt(int32x4_t mag)
+{
+  const float32x4_t x = vcvtq_f32_s32(mag);
+  float32x4_t e = vrsqrteq_f32(x);
+  e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(x, e), e));
+  e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(x, e), e));
+
+  int32x4_t s = vcvtq_s32_f32(vmulq_f32(x, e));
+
+  /* the squares may exceed INT_MAX, therefore compare unsigned */
+  const uint32x4_t mag_u = vreinterpretq_u32_s32(mag);
+
+  /* decrement if s*s > mag */
+  const uint32x4_t square = vreinterpretq_u32_s32(vmulq_s32(s, s));
+  s = vaddq_s32(s, vreinterpretq_s32_u32(vcgtq_u32(square, mag_u)));
+
+  /* increment if (s+1)*(s+1) <= mag */
+  const int32x4_t s1 = vaddq_s32(s, vdupq_n_s32(1));
+  const uint32x4_t square1 = vreinterpretq_u32_s32(vmulq_s32(s1, s1));
+  return vsubq_s32(s, vreinterpretq_s32_u32(vcleq_u32(square1, mag_u)));
+}
+
+/**
+ * Calculate num / d with C semantics (truncated towards zero).  The
+ * estimate is off by at most one for the quotients which occur here
+ * (|num / d| < 2^16).
+ */
+static inline int32x4_t
+IntegerDivide(int32x4_t num, int32x4_t d)
+{
+  const float32x4_t df = vcvtq_f32_s32(d);
+  float32x4_t r = vrecpeq_f32(df);
+  r = vmulq_f32(r, vrecpsq_f32(df, r));
+  r = vmulq_f32(r, vrecpsq_f32(df, r));
+
+  const int32x4_t q = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(num), r));
+
+  const int32x4_t zero = vdupq_n_s32(0);
+  const int32x4_t rem = vmlsq_s32(num, q, d);
+  const uint32x4_t negative = vcltq_s32(num, zero);
+
+  /* num >= 0: 0 <= rem < d; num < 0: -d < rem <= 0 */
+  const uint32x4_t dec =
+    vorrq_u32(vbicq_u32(vcltq_s32(rem, zero), negative),
+              vandq_u32(negative, vcleq_s32(rem, vnegq_s32(d))));
+  const uint32x4_t inc =
+    vorrq_u32(vbicq_u32(vcgeq_s32(rem, d), negative),
+              vandq_u32(negative, vcgtq_s32(rem, zero)));
+
+  return vsubq_s32(vaddq_s32(q, vreinterpretq_s32_u32(dec)),
+                   vreinterpretq_s32_u32(inc));
+}
+
+static inline int32x4_t
+DivideBy128(int32x4_t x)
+{
+  /* division rounding towards zero */
+  return vshrq_n_s32(vaddq_s32(x, vandq_s32(vshrq_n_s32(x, 31),
+                                            vdupq_n_s32(127))), 7);
+}
+
+static inline int16x8_t
+Illumination(int32x4_t sval_lo, int32x4_t sval_hi,
+             int16_t sz, int16_t contrast)
+{
+  const int16x8_t t = vqsubq_s16(vcombine_s16(vqmovn_s32(sval_lo),
+                                              vqmovn_s32(sval_hi)),
+                                 vdupq_n_s16(sz));
+
+  const int32x4_t p_lo = DivideBy128(vmull_n_s16(vget_low_s16(t), contrast));
+  const int32x4_t p_hi = DivideBy128(vmull_n_s16(vget_high_s16(t), contrast));
+
+  return vcombine_s16(vqmovn_s32(p_lo), vqmovn_s32(p_hi));
+}
+
+/**
+ * Shade 8 pixels which are not at the left or right border.
+ *
+ * @return false if a special height value was found; the caller
+ * must use ShadedPixel() then
+ */
+static inline bool
+Shaded8(const Parameters &parameters, const RowConstants &c,
+        const short *src, const short *above, const short *below,
+        unsigned q, uint16_t *dest)
+{
+  const int16x8_t h = vld1q_s16(src);
+  const int16x8_t h_above = vld1q_s16(above);
+  const int16x8_t h_below = vld1q_s16(below);
+  const int16x8_t h_left = vld1q_s16(src - q);
+  const int16x8_t h_right = vld1q_s16(src + q);
+
+  const int16x8_t special = vdupq_n_s16(RasterBuffer::TERRAIN_WATER_THRESHOLD + 1);
+  const uint16x8_t any_special =
+    vorrq_u16(vorrq_u16(vcltq_s16(h, special), vcltq_s16(h_above, special)),
+              vorrq_u16(vorrq_u16(vcltq_s16(h_below, special),
+                                  vcltq_s16(h_left, special)),
+                        vcltq_s16(h_right, special)));
+  const uint64x2_t any64 = vreinterpretq_u64_u16(any_special);
+  if (gcc_unlikely((vgetq_lane_u64(any64, 0) | vgetq_lane_u64(any64, 1)) != 0))
+    return false;
+
+  const int16x8_t level =
+    vminq_s16(vshlq_s16(vmaxq_s16(h, vdupq_n_s16(0)),
+                        vdupq_n_s16(-(int)parameters.height_scale)),
+              vdupq_n_s16(254));
+
+  /* the saturation does not change the result of the clipping */
+  const int16x8_t max_delta = vdupq_n_s16(512);
+  const int16x8_t min_delta = vdupq_n_s16(-512);
+  const int16x8_t p32 =
+    vmaxq_s16(vminq_s16(vqsubq_s16(h_above, h_below), max_delta), min_delta);
+  const int16x8_t p22 =
+    vmaxq_s16(vminq_s16(vqsubq_s16(h_right, h_left), max_delta), min_delta);
+
+  const int16x8_t dd0 = vmulq_n_s16(p22, c.p31);
+  const int16x8_t dd1 = vmulq_n_s16(p32, c.p20);
+
+  const int16_t sx = parameters.sx, sy = parameters.sy;
+
+  const int32x4_t dd2_sz = vdupq_n_s32(c.dd2_sz);
+  const int32x4_t num_lo =
+    vmlal_n_s16(vmlal_n_s16(dd2_sz, vget_low_s16(dd0), sx),
+                vget_low_s16(dd1), sy);
+  const int32x4_t num_hi =
+    vmlal_n_s16(vmlal_n_s16(dd2_sz, vget_high_s16(dd0), sx),
+                vget_high_s16(dd1), sy);
+
+  const int32x4_t dd2_sq = vdupq_n_s32(c.dd2_sq);
+  const int32x4_t mag_lo =
+    vmlal_s16(vmlal_s16(dd2_sq, vget_low_s16(dd0), vget_low_s16(dd0)),
+              vget_low_s16(dd1), vget_low_s16(dd1));
+  const int32x4_t mag_hi =
+    vmlal_s16(vmlal_s16(dd2_sq, vget_high_s16(dd0), vget_high_s16(dd0)),
+              vget_high_s16(dd1), vget_high_s16(dd1));
+
+  const int32x4_t sval_lo = IntegerDivide(num_lo, IntegerSqrt(mag_lo));
+  const int32x4_t sval_hi = IntegerDivide(num_hi, IntegerSqrt(mag_hi));
+
+  int16x8_t sindex = Illumination(sval_lo, sval_hi,
+                                  parameters.sz, parameters.contrast);
+  sindex = vmaxq_s16(vminq_s16(sindex, vdupq_n_s16(63)), vdupq_n_s16(-64));
+
+  const int16x8_t index =
+    vaddq_s16(vshlq_n_s16(vaddq_s16(sindex, vdupq_n_s16(FLAT)), 8), level);
+  vst1q_u16(dest, vreinterpretq_u16_s16(index));
+  return true;
+}
+
+/**
+ * Calculate 8 unshaded pixels.
+ */
+static inline void
+Unshaded8(const short *src, unsigned height_scale, uint16_t *dest)
+{
+  const int16x8_t h = vld1q_s16(src);
+
+  const int16x8_t level =
+    vminq_s16(vshlq_s16(vmaxq_s16(h, vdupq_n_s16(0)),
+                        vdupq_n_s16(-(int)height_scale)),
+              vdupq_n_s16(254));
+
+  const uint16x8_t special =
+    vcltq_s16(h, vdupq_n_s16(RasterBuffer::TERRAIN_WATER_THRESHOLD + 1));
+  const uint16x8_t invalid =
+    vceqq_s16(h, vdupq_n_s16(RasterBuffer::TERRAIN_INVALID));
+
+  /* special values are water, unless they are invalid */
+  uint16x8_t index =
+    vaddq_u16(vdupq_n_u16(FLAT_OFFSET),
+              vbslq_u16(special, vdupq_n_u16(WATER),
+                        vreinterpretq_u16_s16(level)));
+  index = vbslq_u16(invalid, vdupq_n_u16(BACKGROUND), index);
+
+  vst1q_u16(dest, index);
+}
+
+#endif
+
+void
+HillShading::UnshadedRow(const short *src, unsigned n, unsigned height_scale,
+                         uint16_t *dest)
+{
+  unsigned x = 0;
+
+#ifdef HAVE_HILL_SHADING_SIMD
+  for (; x + 8 <= n; x += 8)
+    Unshaded8(src + x, height_scale, dest + x);
+#endif
+
+  for (; x < n; ++x)
+    dest[x] = UnshadedPixel(src[x], height_scale);
+}
+
+/**
+ * Calculate one pixel of a row with ShadedPixel(), using the
+ * distances to the left and right neighbours which are valid for
+ * the given column.
+ */
+static inline void
+ShadedColumn(const Parameters &parameters,
+             const short *src, const short *above, const short *below,
+             unsigned width, unsigned x, unsigned p31, uint16_t *dest)
+{
+  const unsigned q = parameters.quantisation;
+
+  const unsigned column_plus_index = x + q < width
+    ? q
+    : width - 1 - x;
+  const unsigned column_minus_index = x >= q ? q : x;
+
+  dest[x] = ShadedPixel(parameters, src[x], above[x], below[x],
+                        src[x - column_minus_index],
+                        src[x + column_plus_index],
+                        column_plus_index + column_minus_index, p31);
+}
+
+// JMW: if zoomed right in (e.g. one unit is larger than terrain
+// grid), then increase the step size to be equal to the terrain
+// grid for purposes of calculating slope, to avoid shading problems
+// (gridding of display) This is why quantisation is used instead of 1
+// previously.  for large zoom levels, quantisation=1
+void
+HillShading::ShadedRow(const short *matrix, unsigned width, unsigned height,
+                       unsigned y, unsigned x_begin, unsigned x_end,
+                       const Parameters &parameters, uint16_t *dest)
+{
+  assert(y < height);
+  assert(x_begin <= x_end);
+  assert(x_end <= width);
+
+  const unsigned q = parameters.quantisation;
+  assert(q > 0);
+
+  const unsigned row_plus_index = y + q < height
+    ? q
+    : height - 1 - y;
+  const unsigned row_plus_offset = width * row_plus_index;
+
+  const unsigned row_minus_index = y >= q ? q : y;
+  const unsigned row_minus_offset = width * row_minus_index;
+
+  const unsigned p31 = row_plus_index + row_minus_index;
+
+  const short *src = matrix + y * width;
+  const short *above = src - row_minus_offset;
+  const short *below = src + row_plus_offset;
+
+  /* the columns in [q, width - q) have neighbours in both directions
+     at distance q */
+  const unsigned border_left = std::min(q, width);
+  const unsigned border_right = width > q ? width - q : 0;
+
+  unsigned x = x_begin;
+
+#if defined(HAVE_HILL_SHADING_SIMD) && !defined(FAST_RSQRT)
+  const unsigned simd_end = std::min(border_right, x_end);
+
+  RowConstants c;
+  if (parameters.simd && simd_end >= std::max(border_left, x) + 8 &&
+      CheckRowConstants(parameters, 2 * q, p31, c)) {
+    for (; x < border_left; ++x)
+      ShadedColumn(parameters, src, above, below, width, x, p31, dest);
+
+    for (; x + 8 <= simd_end; x += 8) {
+      if (gcc_unlikely(!Shaded8(parameters, c, src + x, above + x, below + x,
+                                q, dest + x)))
+        for (unsigned i = x; i < x + 8; ++i)
+          ShadedColumn(parameters, src, above, below, width, i, p31,
+                       dest);
+    }
+  }
+#endif
+
+  for (; x < x_end; ++x)
+    ShadedColumn(parameters, src, above, below, width, x, p31, dest);
+}
@@ -0,0 +1,143 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_HILL_SHADING_HPP
+#define XCSOAR_TERRAIN_HILL_SHADING_HPP
+
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+#define HAVE_HILL_SHADING_SIMD
+#endif
+
+/**
+ * Conversion of a height matrix to indices into the terrain color
+ * table.  The color table (see RasterRenderer::ColorTable()) has 128
+ * illumination levels with 256 entries each: 255 height levels and
+ * water.  The index is calculated as (illumination + 64) * 256 +
+ * height.
+ */
+namespace HillShading {
+  /**
+   * The illumination level for flat terrain.
+   */
+  static constexpr unsigned FLAT = 64;
+
+  /**
+   * The height level for water.
+   */
+  static constexpr unsigned WATER = 255;
+
+  /**
+   * The color table index for pixels outside of the terrain.  This
+   * is one past the illumination levels.
+   */
+  static constexpr unsigned BACKGROUND = 128 * 256;
+
+  /**
+   * The size of a color table which can be indexed by the values
+   * calculated here.
+   */
+  static constexpr unsigned TABLE_SIZE = BACKGROUND + 1;
+
+  struct Parameters {
+    /**
+     * The sun vector, scaled to 255.
+     */
+    int sx, sy, sz;
+
+    int contrast;
+
+    /**
+     * Height values are shifted right by this number of bits to
+     * obtain the height level.
+     */
+    unsigned height_scale;
+
+    /**
+     * The width of one height matrix cell [m].
+     */
+    unsigned height_slope_factor;
+
+    /**
+     * The distance between the cells used for the slope calculation.
+     * Must be positive.
+     */
+    unsigned quantisation;
+
+    /**
+     * Use the vectorized implementation if available?  It produces
+     * exactly the same output as the scalar one; this flag exists
+     * for testing and benchmarking.
+     */
+    bool simd;
+  };
+
+  /**
+   * Is a vectorized implementation compiled in?
+   */
+  constexpr bool HaveSIMD() {
+#ifdef HAVE_HILL_SHADING_SIMD
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Calculate the color table indices of one row, without shading.
+   *
+   * @param src the height values
+   * @param n the number of values
+   */
+  void UnshadedRow(const short *src, unsigned n, unsigned height_scale,
+                   uint16_t *dest);
+
+  /**
+   * Calculate the color table indices of a part of one row, with
+   * slope shading.
+   *
+   * @param matrix the height matrix
+   * @param width the width of the height matrix
+   * @param height the height of the height matrix
+   * @param y the row to calculate
+   * @param x_begin the first column to calculate
+   * @param x_end the column after the last one to calculate
+   * @param dest the destination buffer, with room for #width
+   * values; only the specified columns are written
+   */
+  void ShadedRow(const short *matrix, unsigned width, unsigned height,
+                 unsigned y, unsigned x_begin, unsigned x_end,
+                 const Parameters &parameters, uint16_t *dest);
+
+  /**
+   * Calculate the color table indices of one row, with slope shading.
+   */
+  static inline void
+  ShadedRow(const short *matrix, unsigned width, unsigned height,
+            unsigned y, const Parameters &parameters, uint16_t *dest) {
+    ShadedRow(matrix, width, height, y, 0, width, parameters, dest);
+  }
+}
+
+#endif
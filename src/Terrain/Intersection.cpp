@@ -26,6 +26,8 @@ Copyright_License {
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
 #include <algorithm>
 
 //#define DEBUG_TILE
@@ -33,6 +35,135 @@ Copyright_License {
 #include <stdio.h>
 #endif
 
+/**
+ * The minimum number of coarse steps checked with one #HeightPyramid
+ * query.
+ */
+static constexpr int PYRAMID_CHUNK_STEPS = 4;
+
+/**
+ * Returns the ideal position on the line from #a to #b after the
+ * specified number of the walk's steps.  The walk stays within one
+ * pixel of it.
+ */
+gcc_const
+static int
+LinePosition(int a, int b, int max_steps, int steps)
+{
+  return max_steps > 0
+    ? a + (int)((int64_t)(b - a) * steps / max_steps)
+    : a;
+}
+
+gcc_const
+static int
+Clamp(int value, unsigned size)
+{
+  return std::max(0, std::min(value, (int)size - 1));
+}
+
+bool
+RasterTileCache::IsLineClear(int x0, int y0, int x1, int y1, int max_steps,
+                             int from_step, int to_step,
+                             int h_max, int h_safety) const
+{
+  assert(pyramid.IsDefined());
+  assert(from_step <= to_step);
+
+  const int xa = LinePosition(x0, x1, max_steps, from_step);
+  const int ya = LinePosition(y0, y1, max_steps, from_step);
+  const int xb = LinePosition(x0, x1, max_steps, to_step);
+  const int yb = LinePosition(y0, y1, max_steps, to_step);
+
+  /* a margin for the walk's deviation from the line and for the
+     rounding in LinePosition() */
+  const int margin = 2;
+
+  const HeightPyramid::Bounds bounds =
+    pyramid.GetBounds(Clamp(std::min(xa, xb) - margin, width),
+                      Clamp(std::min(ya, yb) - margin, height),
+                      Clamp(std::max(xa, xb) + margin, width),
+                      Clamp(std::max(ya, yb) + margin, height));
+
+  /* the walks stop at negative heights, which therefore must not be
+     skipped either */
+  return bounds.minimum <= bounds.maximum &&
+    bounds.minimum + h_safety >= 0 &&
+    bounds.maximum + h_safety <= h_max;
+}
+
+/**
+ * The aircraft height of a FirstIntersection() walk as a function of
+ * the number of steps.
+ */
+struct ClimbProfile {
+  short h_origin, h_dest;
+  int slope_fact;
+  bool can_climb;
+
+  ClimbProfile(short _h_origin, short _h_dest, int _slope_fact,
+               bool _can_climb)
+    :h_origin(_h_origin), h_dest(_h_dest), slope_fact(_slope_fact),
+     can_climb(_can_climb) {}
+
+  gcc_pure
+  short operator()(int steps) const {
+    const short dh = (short)((steps*slope_fact)>>RASTER_SLOPE_FACT);
+    short h = dh + h_origin;
+    if (can_climb)
+      h = std::min(h, h_dest);
+    return h;
+  }
+};
+
+/**
+ * The aircraft height of an Intersection() walk as a function of the
+ * number of steps.
+ */
+struct GlideProfile {
+  short h_origin;
+  int slope_fact;
+
+  GlideProfile(short _h_origin, int _slope_fact)
+    :h_origin(_h_origin), slope_fact(_slope_fact) {}
+
+  gcc_pure
+  short operator()(int steps) const {
+    const short dh = (short)((steps*slope_fact)>>RASTER_SLOPE_FACT);
+    return h_origin - dh;
+  }
+};
+
+template<typename HeightFunction>
+int
+RasterTileCache::FindClearSteps(int x0, int y0, int x1, int y1,
+                                int max_steps, int from_step,
+                                int &chunk_steps, int min_steps,
+                                HeightFunction height, int h_safety) const
+{
+  /* the walks sample up to two steps beyond the destination */
+  const int end = max_steps + 2;
+  const short h_from = height(from_step);
+
+  while (true) {
+    const int to_step = std::min(from_step + chunk_steps, end);
+
+    /* the height is monotonic, so its minimum is at one of the
+       ends */
+    if (IsLineClear(x0, y0, x1, y1, max_steps, from_step, to_step,
+                    std::min(h_from, height(to_step)), h_safety)) {
+      /* try a longer part next time */
+      chunk_steps = std::min(chunk_steps * 2, end);
+      return to_step;
+    }
+
+    if (chunk_steps <= min_steps)
+      return -1;
+
+    chunk_steps = std::max(chunk_steps / 2, min_steps);
+  }
+}
+
 bool
 RasterTileCache::FirstIntersection(int x0, int y0,
                                    int x1, int y1,
@@ -108,6 +239,15 @@ RasterTileCache::FirstIntersection(int x0, int y0,
   unsigned last_clear_y = y0;
   short last_clear_h = h_origin;
 
+  /* the samples up to this step are known to be above the terrain,
+     and are not looked up; see FindClearSteps() */
+  int clear_until = -1;
+  // the next step where FindClearSteps() shall be tried
+  int check_at = 0;
+  // the number of steps FindClearSteps() tries first
+  int chunk_steps = max_steps + 2;
+  const int min_chunk_steps = PYRAMID_CHUNK_STEPS * step_coarse;
+
   while (h_terrain>=0) {
 
     if (!step_counter) {
@@ -115,7 +255,22 @@ RasterTileCache::FirstIntersection(int x0, int y0,
       if ((_x >= width) || (_y >= height))
         break; // outside bounds
 
-      h_terrain = GetFieldDirect(x_int, y_int, tile_index)+h_safety;
+      if (total_steps > clear_until && total_steps >= check_at &&
+          total_steps <= max_steps && pyramid.IsDefined()) {
+        clear_until = FindClearSteps(x0, y0, x1, y1, max_steps, total_steps,
+                                     chunk_steps, min_chunk_steps,
+                                     ClimbProfile(h_origin, h_dest,
+                                                  slope_fact, can_climb),
+                                     h_safety);
+        if (clear_until < total_steps)
+          check_at = total_steps + min_chunk_steps;
+      }
+
+      const bool known_clear = total_steps <= clear_until;
+      if (!known_clear)
+        h_terrain = GetFieldDirect(x_int, y_int, tile_index)+h_safety;
+      else
+        UpdateTileIndex(x_int, y_int, tile_index);
       step_counter = tile_index<0? step_coarse: step_fine;
 
       // calculate height of glide so far
@@ -132,7 +287,7 @@ RasterTileCache::FirstIntersection(int x0, int y0,
 #endif
 
       // this point has intersected if aircraft is below terrain height
-      const bool this_intersecting = (h_int< h_terrain);
+      const bool this_intersecting = !known_clear && (h_int< h_terrain);
 
       if (this_intersecting) {
         intersect_counter = 1;
@@ -234,9 +389,10 @@ RasterTileCache::GetFieldDirect(const unsigned px, const unsigned py, int& tile_
 
 #ifdef ACCURATE_TERRAIN_INTERSECTION
 
-  const RasterTile &tile = tiles.Get(px / tile_width, py / tile_height);
-  if (tile.IsEnabled())
-    return tile.GetHeight(px, py);
+  const unsigned tile_x = px / tile_width, tile_y = py / tile_height;
+  const RasterBuffer &data = GetTileBuffer(tile_x, tile_y);
+  if (data.IsDefined())
+    return tiles.Get(tile_x, tile_y).GetHeight(data, px, py);
 
 #endif
 
@@ -258,6 +414,22 @@ RasterTileCache::GetFieldDirect(const unsigned px, const unsigned py, int& tile_
   return overview.Get(x_overview, y_overview);
 }
 
+inline void
+RasterTileCache::UpdateTileIndex(const unsigned px, const unsigned py,
+                                 int &tile_index) const
+{
+  assert(px < width);
+  assert(py < height);
+
+#ifdef ACCURATE_TERRAIN_INTERSECTION
+  /* only a tile table lookup; see GetFieldDirect() */
+  if (GetTileBuffer(px / tile_width, py / tile_height).IsDefined())
+    return;
+#endif
+
+  tile_index = -1;
+}
+
 RasterLocation
 RasterTileCache::Intersection(int x0, int y0,
                               int x1, int y1,
@@ -313,6 +485,15 @@ RasterTileCache::Intersection(int x0, int y0,
   unsigned last_clear_y = _y;
   short last_clear_h = h_int;
 
+  /* the samples up to this step are known to be above the terrain,
+     and are not looked up; see FindClearSteps() */
+  int clear_until = -1;
+  // the next step where FindClearSteps() shall be tried
+  int check_at = 0;
+  // the number of steps FindClearSteps() tries first
+  int chunk_steps = max_steps + 2;
+  const int min_chunk_steps = PYRAMID_CHUNK_STEPS * step_coarse;
+
   while (h_terrain>=0) {
 
     if (!step_counter) {
@@ -320,7 +501,20 @@ RasterTileCache::Intersection(int x0, int y0,
       if ((_x >= width) || (_y >= height))
         break; // outside bounds
 
-      h_terrain = GetFieldDirect(_x, _y, tile_index);
+      if (total_steps > clear_until && total_steps >= check_at &&
+          total_steps <= max_steps && pyramid.IsDefined()) {
+        clear_until = FindClearSteps(x0, y0, x1, y1, max_steps, total_steps,
+                                     chunk_steps, min_chunk_steps,
+                                     GlideProfile(h_origin, slope_fact), 0);
+        if (clear_until < total_steps)
+          check_at = total_steps + min_chunk_steps;
+      }
+
+      const bool known_clear = total_steps <= clear_until;
+      if (!known_clear)
+        h_terrain = GetFieldDirect(_x, _y, tile_index);
+      else
+        UpdateTileIndex(_x, _y, tile_index);
       step_counter = tile_index<0? step_coarse: step_fine;
 
       // calculate height of glide so far
@@ -329,7 +523,7 @@ RasterTileCache::Intersection(int x0, int y0,
       // current aircraft height
       h_int = h_origin-dh;
 
-      if (h_int < h_terrain) {
+      if (!known_clear && h_int < h_terrain) {
         if (refine_step<3) // can't refine any further
           return RasterLocation(last_clear_x, last_clear_y);
 
@@ -32,7 +32,37 @@ RasterBuffer::Resize(unsigned _width, unsigned _height)
 {
   assert(_width > 0 && _height > 0);
 
-  data.GrowDiscard(_width, _height);
+  allocation.GrowDiscard(_width * _height);
+  data = allocation.begin();
+  width = _width;
+  height = _height;
+}
+
+void
+RasterBuffer::Swap(RasterBuffer &other)
+{
+  AllocatedArray<short> tmp(std::move(allocation));
+  allocation = std::move(other.allocation);
+  other.allocation = std::move(tmp);
+
+  std::swap(data, other.data);
+  std::swap(width, other.width);
+  std::swap(height, other.height);
+}
+
+void
+RasterBuffer::SetExternal(const short *_data,
+                          unsigned _width, unsigned _height)
+{
+  assert(_data != nullptr);
+  assert(_width > 0 && _height > 0);
+
+  /* free the old allocation, it will not be used */
+  allocation.ResizeDiscard(0);
+
+  data = _data;
+  width = _width;
+  height = _height;
 }
 
 short
@@ -250,5 +280,7 @@ RasterBuffer::ScanLineChecked(unsigned ax, unsigned ay,
 short
 RasterBuffer::GetMaximum() const
 {
-  return IsDefined() ? *std::max_element(data.begin(), data.end()) : 0;
+  return IsDefined()
+    ? *std::max_element(data, data + width * height)
+    : 0;
 }
@@ -25,10 +25,11 @@ Copyright_License {
 #define XCSOAR_RASTER_BUFFER_HPP
 
 #include "Util/NonCopyable.hpp"
-#include "Util/AllocatedGrid.hpp"
+#include "Util/AllocatedArray.hpp"
 #include "Compiler.h"
 
 #include <cstddef>
+#include <assert.h>
 
 class RasterBuffer : private NonCopyable {
 public:
@@ -67,23 +68,46 @@ public:
   }
 
 private:
-  AllocatedGrid<short> data;
+  /**
+   * The memory allocated by Resize().  It is not used while this
+   * object refers to external memory (see SetExternal()).
+   */
+  AllocatedArray<short> allocation;
+
+  /**
+   * Pointer to the first pixel.  This points either into
+   * #allocation or into read-only memory owned by somebody else,
+   * e.g. a memory-mapped file.
+   */
+  const short *data;
+
+  unsigned width, height;
 
 public:
-  RasterBuffer() = default;
+  RasterBuffer():data(nullptr), width(0), height(0) {}
   RasterBuffer(unsigned _width, unsigned _height)
-    :data(_width, _height) {}
+    :data(nullptr), width(0), height(0) {
+    Resize(_width, _height);
+  }
 
   bool IsDefined() const {
-    return data.IsDefined();
+    return data != nullptr;
+  }
+
+  /**
+   * Does this object refer to external memory?  Its contents must
+   * not be modified then.
+   */
+  bool IsExternal() const {
+    return data != nullptr && data != allocation.begin();
   }
 
   unsigned GetWidth() const {
-    return data.GetWidth();
+    return width;
   }
 
   unsigned GetHeight() const {
-    return data.GetHeight();
+    return height;
   }
 
   unsigned GetFineWidth() const {
@@ -95,23 +119,42 @@ public:
   }
 
   short *GetData() {
-    return data.begin();
+    assert(!IsExternal());
+
+    return allocation.begin();
   }
 
   const short *GetData() const {
-    return data.begin();
+    return data;
   }
 
   const short *GetDataAt(unsigned x, unsigned y) const {
-    return data.GetPointerAt(x, y);
+    assert(x < width);
+    assert(y < height);
+
+    return data + y * width + x;
   }
 
   void Reset() {
-    data.Reset();
+    allocation.ResizeDiscard(0);
+    data = nullptr;
+    width = height = 0;
   }
 
   void Resize(unsigned _width, unsigned _height);
 
+  /**
+   * Exchange the contents of two buffers.
+   */
+  void Swap(RasterBuffer &other);
+
+  /**
+   * Let this object refer to the specified read-only pixel array
+   * instead of allocating its own.  The caller is responsible for
+   * keeping the memory valid until Reset() is called.
+   */
+  void SetExternal(const short *_data, unsigned _width, unsigned _height);
+
   gcc_pure
   short GetInterpolated(unsigned lx, unsigned ly,
                         unsigned ix, unsigned iy) const;
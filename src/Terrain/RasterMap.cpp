@@ -22,8 +22,10 @@ Copyright_License {
 */
 
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/RasterLocation.hpp"
 #include "Geo/GeoClip.hpp"
 #include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
 #include "Util/ConvertString.hpp"
 
 #include <algorithm>
@@ -36,6 +38,41 @@ ToNarrowPath(const TCHAR *src)
   return WideToACPConverter(src).StealDup();
 }
 
+#ifndef _WIN32_WCE
+
+/**
+ * Use the raw (decoded) tiles from the cache, and generate the cache
+ * file if it does not exist yet.
+ */
+static void
+LoadRawTiles(RasterTileCache &rtc, const char *path,
+             FileCache &cache, const TCHAR *original_path,
+             OperationEnvironment &operation)
+{
+  size_t offset;
+  FileMapping *mapping = cache.Map(_T("terrain-raw"), original_path, offset);
+  if (mapping != NULL && rtc.LoadRawTiles(mapping, offset))
+    return;
+
+  FILE *file = cache.Save(_T("terrain-raw"), original_path);
+  if (file == NULL)
+    return;
+
+  if (!rtc.SaveRawTiles(path, file, operation)) {
+    cache.Cancel(_T("terrain-raw"), file);
+    return;
+  }
+
+  if (!cache.Commit(_T("terrain-raw"), file))
+    return;
+
+  mapping = cache.Map(_T("terrain-raw"), original_path, offset);
+  if (mapping != NULL)
+    rtc.LoadRawTiles(mapping, offset);
+}
+
+#endif
+
 RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
                      FileCache *cache, OperationEnvironment &operation)
   :path(ToNarrowPath(_path))
@@ -66,6 +103,13 @@ RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
     }
   }
 
+#ifndef _WIN32_WCE
+  /* Windows CE processes have only 32 MB of address space, which is
+     not enough to map the whole terrain */
+  if (cache != NULL)
+    LoadRawTiles(raster_tile_cache, path, *cache, _path, operation);
+#endif
+
   projection.Set(GetBounds(),
                  raster_tile_cache.GetFineWidth(),
                  raster_tile_cache.GetFineHeight());
@@ -83,9 +127,19 @@ AngleToPixel(Angle value, Angle start, Angle end, unsigned width)
 
 void
 RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
+{
+  if (RequestTiles(location, radius))
+    DecodeTiles();
+
+  CommitTiles(false);
+  ReclaimTiles();
+}
+
+bool
+RasterMap::RequestTiles(const GeoPoint &location, fixed radius)
 {
   if (!raster_tile_cache.GetInitialised())
-    return;
+    return false;
 
   const GeoBounds &bounds = GetBounds();
 
@@ -95,8 +149,38 @@ RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
   int y = AngleToPixel(location.latitude, bounds.GetNorth(), bounds.GetSouth(),
                        raster_tile_cache.GetHeight());
 
-  raster_tile_cache.UpdateTiles(path, x, y,
-                                projection.DistancePixelsCoarse(radius));
+  return raster_tile_cache.PollTiles(x, y,
+                                     projection.DistancePixelsCoarse(radius));
+}
+
+bool
+RasterMap::RequestPrefetchTiles(const GeoPoint *locations, unsigned n,
+                                fixed radius)
+{
+  if (!raster_tile_cache.GetInitialised())
+    return false;
+
+  const GeoBounds &bounds = GetBounds();
+
+  RasterLocation pixels[n];
+  unsigned n_pixels = 0;
+  for (unsigned i = 0; i < n; ++i) {
+    if (!bounds.IsInside(locations[i]))
+      /* outside of the map; the path may re-enter it later */
+      continue;
+
+    pixels[n_pixels].x =
+      AngleToPixel(locations[i].longitude, bounds.GetWest(), bounds.GetEast(),
+                   raster_tile_cache.GetWidth());
+    pixels[n_pixels].y =
+      AngleToPixel(locations[i].latitude, bounds.GetNorth(), bounds.GetSouth(),
+                   raster_tile_cache.GetHeight());
+    ++n_pixels;
+  }
+
+  return n_pixels > 0 &&
+    raster_tile_cache.PrefetchTiles(pixels, n_pixels,
+                                    projection.DistancePixelsCoarse(radius));
 }
 
 short
@@ -63,8 +63,66 @@ public:
     return GetBounds().GetCenter();
   }
 
+  /**
+   * Load the tiles around the specified location.  This must not be
+   * used while other threads may be reading; see RasterTerrain.
+   */
   void SetViewCenter(const GeoPoint &location, fixed radius);
 
+  /**
+   * Request the tiles around the specified location, like
+   * SetViewCenter(), but don't decode them yet.  This is the first
+   * step of loading tiles without locking out readers.  Calls to the
+   * tile loading methods must not overlap.
+   *
+   * @return true if DecodeTiles() shall be called
+   */
+  bool RequestTiles(const GeoPoint &location, fixed radius);
+
+  /**
+   * Like RequestTiles(), but request tiles along a predicted path
+   * without disposing any loaded tile.
+   *
+   * @see RasterTileCache::PrefetchTiles()
+   */
+  bool RequestPrefetchTiles(const GeoPoint *locations, unsigned n,
+                            fixed radius);
+
+  /**
+   * Decode the tiles requested by RequestTiles() or
+   * RequestPrefetchTiles().
+   */
+  void DecodeTiles() {
+    raster_tile_cache.DecodeTiles(path);
+  }
+
+  /**
+   * Make the tiles decoded by DecodeTiles() visible, and remove
+   * disposed tiles.  This must be called after each RequestTiles()
+   * or RequestPrefetchTiles() call.
+   *
+   * @return the number of tiles which were loaded
+   * @see RasterTileCache::CommitTiles()
+   */
+  unsigned CommitTiles(bool prefetch) {
+    return raster_tile_cache.CommitTiles(prefetch);
+  }
+
+  bool IsReclaimPending() const {
+    return raster_tile_cache.IsReclaimPending();
+  }
+
+  /**
+   * @see RasterTileCache::ReclaimTiles()
+   */
+  void ReclaimTiles() {
+    raster_tile_cache.ReclaimTiles();
+  }
+
+  unsigned GetPrefetchHits() const {
+    return raster_tile_cache.GetPrefetchHits();
+  }
+
   /**
    * Determines if SetViewCenter() should be called again to continue
    * loading.
@@ -23,7 +23,8 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
-#include "Math/FastMath.h"
+#include "Terrain/HillShading.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Screen/Ramp.hpp"
 #include "Screen/Layout.hpp"
 #include "Screen/Color.hpp"
@@ -31,10 +32,12 @@ Copyright_License {
 #include "Asset.hpp"
 #include "Event/Idle.hpp"
 
+#include <algorithm>
+
 #include <assert.h>
 #include <stdint.h>
-
-//#define FAST_RSQRT
+#include <stdlib.h>
+#include <string.h>
 
 constexpr
 static inline unsigned
@@ -67,18 +70,31 @@ RasterRenderer::RasterRenderer()
 #ifdef ENABLE_OPENGL
    last_quantisation_pixels(-1),
    bounds(GeoBounds::Invalid()),
+#else
+   matrix_valid(false),
 #endif
-   image(NULL)
+   valid_cells(0, 0, 0, 0), shift_x(0), shift_y(0),
+   image_valid(false),
+   image(NULL), scan_pool(NULL)
 {
   // scale quantisation_pixels so resolution is not too high on old hardware
   // with large displays
   if (IsAncientHardware())
     quantisation_pixels = Layout::FastScale(quantisation_pixels);
+
+  /* a few hundred rows per frame don't keep more than 4 threads
+     busy */
+  const unsigned n_threads = std::min(WorkerPool::GetProcessorCount(), 4u);
+  if (n_threads > 1) {
+    scan_pool = new WorkerPool(n_threads);
+    height_matrix.SetWorkerPool(scan_pool);
+  }
 }
 
 
 RasterRenderer::~RasterRenderer()
 {
+  delete scan_pool;
   delete image;
 }
 
@@ -143,18 +159,208 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
     quantisation_effective = 0;
 
 #ifdef ENABLE_OPENGL
-  bounds = projection.GetScreenBounds().Scale(fixed(1.5));
-  height_matrix.Fill(map, bounds,
-                     projection.GetScreenWidth() / quantisation_pixels,
-                     projection.GetScreenHeight() / quantisation_pixels,
-                     true);
+  const GeoBounds &screen_bounds = projection.GetScreenBounds();
+  const GeoBounds new_bounds = screen_bounds.Scale(fixed(1.5));
+  const unsigned width = projection.GetScreenWidth() / quantisation_pixels;
+  const unsigned height = projection.GetScreenHeight() / quantisation_pixels;
+
+  if (!ScanShifted(map, screen_bounds, new_bounds, width, height)) {
+    bounds = new_bounds;
+    height_matrix.Fill(map, bounds, width, height, true);
+    valid_cells = PixelRect(0, 0, 0, 0);
+  }
 
   last_quantisation_pixels = quantisation_pixels;
 #else
-  height_matrix.Fill(map, projection, quantisation_pixels, true);
+  if (!ScanShifted(map, projection)) {
+    height_matrix.Fill(map, projection, quantisation_pixels, true);
+    valid_cells = PixelRect(0, 0, 0, 0);
+
+    matrix_projection = projection;
+    matrix_valid = true;
+    shifted_cells = 0;
+  }
 #endif
 }
 
+#ifdef ENABLE_OPENGL
+
+bool
+RasterRenderer::ScanShifted(const RasterMap &map,
+                            const GeoBounds &screen_bounds,
+                            const GeoBounds &new_bounds,
+                            unsigned width, unsigned height)
+{
+  if (!bounds.IsValid() ||
+      quantisation_pixels != last_quantisation_pixels ||
+      width != height_matrix.GetWidth() ||
+      height != height_matrix.GetHeight())
+    return false;
+
+  const Angle cell_width = bounds.GetWidth() / width;
+  const Angle cell_height = bounds.GetHeight() / height;
+
+  /* the size must be nearly the same; the old size is kept */
+  if ((new_bounds.GetWidth() - bounds.GetWidth()).Absolute() > cell_width ||
+      (new_bounds.GetHeight() - bounds.GetHeight()).Absolute() > cell_height)
+    return false;
+
+  /* the rows and columns are equidistant in latitude and longitude,
+     so moving the bounds by whole cells moves the matrix contents
+     exactly */
+  const int dx = iround((new_bounds.GetWest() - bounds.GetWest()).AsDelta()
+                        .Native() / cell_width.Native());
+  const int dy = iround((bounds.GetNorth() - new_bounds.GetNorth()).AsDelta()
+                        .Native() / cell_height.Native());
+  if (abs(dx) >= (int)width || abs(dy) >= (int)height)
+    return false;
+
+  const GeoBounds shifted(GeoPoint(bounds.GetWest() + cell_width * dx,
+                                   bounds.GetNorth() - cell_height * dy),
+                          GeoPoint(bounds.GetEast() + cell_width * dx,
+                                   bounds.GetSouth() - cell_height * dy));
+  if (!shifted.IsInside(screen_bounds))
+    return false;
+
+  bounds = shifted;
+
+  valid_cells = height_matrix.Shift(dx, dy);
+  shift_x = dx;
+  shift_y = dy;
+
+  height_matrix.FillOutside(map, bounds, valid_cells, true);
+  return true;
+}
+
+#else
+
+/**
+ * Divide, rounding to the nearest integer.
+ */
+gcc_const
+static int
+RoundingDivide(int a, unsigned b)
+{
+  return a >= 0
+    ? (a + (int)b / 2) / (int)b
+    : -((-a + (int)b / 2) / (int)b);
+}
+
+bool
+RasterRenderer::ScanShifted(const RasterMap &map,
+                            const WindowProjection &projection)
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+  const unsigned screen_width = projection.GetScreenWidth();
+  const unsigned screen_height = projection.GetScreenHeight();
+
+  /* only a translation of the screen can be mapped to a translation
+     of the matrix; after a zoom or a rotation (e.g. track up after a
+     heading change), everything must be scanned again */
+  if (!matrix_valid ||
+      screen_width != matrix_projection.GetScreenWidth() ||
+      screen_height != matrix_projection.GetScreenHeight() ||
+      screen_width % quantisation_pixels != 0 ||
+      screen_height % quantisation_pixels != 0 ||
+      projection.GetScale() != matrix_projection.GetScale() ||
+      projection.GetScreenAngle() != matrix_projection.GetScreenAngle() ||
+      projection.GetScreenOrigin().x != matrix_projection.GetScreenOrigin().x ||
+      projection.GetScreenOrigin().y != matrix_projection.GetScreenOrigin().y)
+    return false;
+
+  /* where is the new screen origin in the old projection? */
+  const RasterPoint origin = matrix_projection.GetScreenOrigin();
+  const RasterPoint moved =
+    matrix_projection.GeoToScreen(projection.GetGeoLocation());
+
+  /* round to whole cells; the remaining error is less than half a
+     cell, which is not visible at this resolution */
+  const int dx = RoundingDivide(moved.x - origin.x, quantisation_pixels);
+  const int dy = RoundingDivide(moved.y - origin.y, quantisation_pixels);
+  if (abs(dx) >= (int)width || abs(dy) >= (int)height)
+    return false;
+
+  shifted_cells += abs(dx) + abs(dy);
+  if (shifted_cells > width + height)
+    return false;
+
+  const int q = quantisation_pixels;
+  matrix_projection.SetGeoLocation(matrix_projection.ScreenToGeo(origin.x + dx * q,
+                                                                 origin.y + dy * q));
+
+  valid_cells = height_matrix.Shift(dx, dy);
+  shift_x = dx;
+  shift_y = dy;
+
+  height_matrix.FillOutside(map, matrix_projection, quantisation_pixels,
+                            valid_cells, true);
+  return true;
+}
+
+#endif
+
+gcc_const
+static bool
+IsEmpty(const PixelRect &rc)
+{
+  return rc.left >= rc.right || rc.top >= rc.bottom;
+}
+
+/**
+ * Determine the columns of a row which are outside of the specified
+ * rectangle.
+ *
+ * @return the number of spans stored in the array (0 to 2)
+ */
+static unsigned
+GetInvalidSpans(const PixelRect &valid, unsigned width, unsigned y,
+                unsigned spans[2][2])
+{
+  if ((int)y < valid.top || (int)y >= valid.bottom) {
+    spans[0][0] = 0;
+    spans[0][1] = width;
+    return 1;
+  }
+
+  unsigned n = 0;
+  if (valid.left > 0) {
+    spans[n][0] = 0;
+    spans[n][1] = valid.left;
+    ++n;
+  }
+
+  if ((unsigned)valid.right < width) {
+    spans[n][0] = valid.right;
+    spans[n][1] = width;
+    ++n;
+  }
+
+  return n;
+}
+
+/**
+ * Can an image generated with the old parameters be reused for the
+ * new ones?
+ */
+gcc_pure
+static bool
+IsSameImage(bool old_shading, const HillShading::Parameters &old_parameters,
+            bool new_shading, const HillShading::Parameters &new_parameters)
+{
+  if (old_shading != new_shading ||
+      old_parameters.height_scale != new_parameters.height_scale)
+    return false;
+
+  return !new_shading ||
+    (old_parameters.sx == new_parameters.sx &&
+     old_parameters.sy == new_parameters.sy &&
+     old_parameters.sz == new_parameters.sz &&
+     old_parameters.contrast == new_parameters.contrast &&
+     old_parameters.height_slope_factor == new_parameters.height_slope_factor &&
+     old_parameters.quantisation == new_parameters.quantisation);
+}
+
 void
 RasterRenderer::GenerateImage(bool do_shading,
                               unsigned height_scale,
@@ -167,222 +373,143 @@ RasterRenderer::GenerateImage(bool do_shading,
     delete image;
     image = new RawBitmap(height_matrix.GetWidth(),
                           height_matrix.GetHeight());
+    image_valid = false;
   }
 
   if (quantisation_effective == 0)
     do_shading = false;
 
+  HillShading::Parameters parameters;
+  parameters.height_scale = height_scale;
+
+  if (do_shading) {
+    const Angle fudgeelevation =
+      Angle::Degrees(fixed(10.0 + 80.0 * brightness / 255.0));
+
+    parameters.sx = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastsine());
+    parameters.sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
+    parameters.sz = (int)(255 * fudgeelevation.fastsine());
+    parameters.contrast = contrast;
+    parameters.height_slope_factor = std::max(1, (int)pixel_size);
+    parameters.quantisation = quantisation_effective;
+    parameters.simd = true;
+  }
+
+  /* the pixels which can be copied from the previous image; with
+     shading, the pixels near the edge of the moved area depend on
+     cells which were not in the matrix before */
+  PixelRect valid = valid_cells;
+  if (do_shading) {
+    valid.left += quantisation_effective;
+    valid.top += quantisation_effective;
+    valid.right -= quantisation_effective;
+    valid.bottom -= quantisation_effective;
+  }
+
+  if (!image_valid || IsEmpty(valid) ||
+      !IsSameImage(image_shading, image_parameters, do_shading, parameters))
+    valid = PixelRect(0, 0, 0, 0);
+  else if (shift_x != 0 || shift_y != 0)
+    ShiftImage(valid);
+
   if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
-                       sunazimuth);
+    GenerateSlopeImage(parameters, valid);
   else
-    GenerateUnshadedImage(height_scale);
+    GenerateUnshadedImage(height_scale, valid);
+
+  image_valid = true;
+  image_shading = do_shading;
+  image_parameters = parameters;
+
+  /* the image now matches the matrix; another call without ScanMap()
+     must not shift again */
+  valid_cells = PixelRect(0, 0,
+                          height_matrix.GetWidth(), height_matrix.GetHeight());
+  shift_x = shift_y = 0;
 }
 
 void
-RasterRenderer::GenerateUnshadedImage(unsigned height_scale)
+RasterRenderer::ShiftImage(const PixelRect &valid)
 {
-  const short *src = height_matrix.GetData();
-  const BGRColor *oColorBuf = color_table + 64 * 256;
+  BGRColor *const top = image->GetTopRow();
+  const int stride = image->GetNextRow(top) - top;
+  const size_t n = (valid.right - valid.left) * sizeof(*top);
+
+  /* copy in the direction which does not overwrite rows which are
+     still needed; within a row, the ranges may overlap */
+  if (shift_y >= 0) {
+    for (int y = valid.top; y < valid.bottom; ++y)
+      memmove(top + y * stride + valid.left,
+              top + (y + shift_y) * stride + valid.left + shift_x, n);
+  } else {
+    for (int y = valid.bottom - 1; y >= valid.top; --y)
+      memmove(top + y * stride + valid.left,
+              top + (y + shift_y) * stride + valid.left + shift_x, n);
+  }
+}
+
+void
+RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
+                                      const PixelRect &valid)
+{
+  const unsigned width = height_matrix.GetWidth();
+  row_index.GrowDiscard(width);
+  uint16_t *index = row_index.begin();
+
   BGRColor *dest = image->GetTopRow();
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
+  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
+    const short *src = height_matrix.GetRow(y);
     BGRColor *p = dest;
     dest = image->GetNextRow(dest);
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
-      short h = *src++;
-      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
-        if (h < 0)
-          h = 0;
-
-        h = std::min(254, h >> height_scale);
-        *p++ = oColorBuf[h];
-      } else if (RasterBuffer::IsWater(h)) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = BGRColor(0xff, 0xff, 0xff);
-      }
+    unsigned spans[2][2];
+    const unsigned n = GetInvalidSpans(valid, width, y, spans);
+    for (unsigned i = 0; i < n; ++i) {
+      const unsigned begin = spans[i][0], end = spans[i][1];
+      HillShading::UnshadedRow(src + begin, end - begin, height_scale,
+                               index + begin);
+
+      for (unsigned x = begin; x < end; ++x)
+        p[x] = color_table[index[x]];
     }
   }
 
   image->SetDirty();
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-gcc_const
-static int
-ClipHeightDelta(int d)
-{
-  if (d > 512)
-    d = 512;
-  else if (d < -512)
-    d = -512;
-  return d;
-}
-
-// JMW: if zoomed right in (e.g. one unit is larger than terrain
-// grid), then increase the step size to be equal to the terrain
-// grid for purposes of calculating slope, to avoid shading problems
-// (gridding of display) This is why quantisation_effective is used instead of 1
-// previously.  for large zoom levels, quantisation_effective=1
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
-                                   int contrast,
-                                   const int sx, const int sy, const int sz)
+RasterRenderer::GenerateSlopeImage(const HillShading::Parameters &parameters,
+                                   const PixelRect &valid)
 {
   assert(quantisation_effective > 0);
 
-  PixelRect border;
-  border.left = quantisation_effective;
-  border.top = quantisation_effective;
-  border.right = height_matrix.GetWidth() - quantisation_effective;
-  border.bottom = height_matrix.GetHeight() - quantisation_effective;
-
-  const unsigned height_slope_factor = std::max(1, (int)pixel_size);
-
-  const short *src = height_matrix.GetData();
-  const BGRColor *oColorBuf = color_table + 64 * 256;
-#ifdef FAST_RSQRT
-  const short szindex = sz*contrast/128;
-  const short sval_min = szindex-64;
-  const short sval_max = szindex+63;
-  const BGRColor *szColorBuf = color_table + (64- szindex) * 256;
-  const int sx_c = sx*contrast>>7;
-  const int sy_c = sy*contrast>>7;
-  const int sz_c = sz*contrast>>7;
-#endif
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+  row_index.GrowDiscard(width);
+  uint16_t *index = row_index.begin();
 
   BGRColor *dest = image->GetTopRow();
 
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
-    const unsigned row_plus_index = y < (unsigned)border.bottom
-      ? quantisation_effective
-      : height_matrix.GetHeight() - 1 - y;
-    const unsigned row_plus_offset = height_matrix.GetWidth() * row_plus_index;
-
-    const unsigned row_minus_index = y >= quantisation_effective
-      ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.GetWidth() * row_minus_index;
-
-    const unsigned p31 = row_plus_index + row_minus_index;
-
+  for (unsigned y = 0; y < height; ++y) {
     BGRColor *p = dest;
     dest = image->GetNextRow(dest);
 
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
-      short h = *src;
-      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
-        if (h < 0)
-          h = 0;
-
-        h = std::min(254, h >> height_scale);
-
-        // no need to calculate slope if undefined height or sea level
-
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
-
-        // X direction
-
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetWidth() - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
-
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
-
-        short h_above = src[-(int)row_minus_offset];
-        short h_below = src[row_plus_offset];
-        short h_left = src[-(int)column_minus_index];
-        short h_right = src[column_plus_index];
-
-        if (gcc_unlikely(RasterBuffer::IsSpecial(h_above) ||
-                         RasterBuffer::IsSpecial(h_below) ||
-                         RasterBuffer::IsSpecial(h_left) ||
-                         RasterBuffer::IsSpecial(h_right))) {
-          /* some "special" terrain value surrounding us (water or
-             invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
-          continue;
-        }
-
-        const int p32 = ClipHeightDelta(h_above - h_below);
-        const int p22 = ClipHeightDelta(h_right - h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
+    unsigned spans[2][2];
+    const unsigned n = GetInvalidSpans(valid, width, y, spans);
+    for (unsigned i = 0; i < n; ++i) {
+      const unsigned begin = spans[i][0], end = spans[i][1];
+      HillShading::ShadedRow(height_matrix.GetData(), width, height, y,
+                             begin, end, parameters, index);
 
-        const int dd0 = p22 * p31;
-        const int dd1 = p20 * p32;
-        const int dd2 = p20 * p31 * height_slope_factor;
-#ifndef FAST_RSQRT
-        const int num = (dd2 * sz + dd0 * sx + dd1 * sy);
-        const int mag = (dd0 * dd0 + dd1 * dd1 + dd2 * dd2);
-#ifdef FIXED_MATH
-        const int sval = num / (int)isqrt4(mag);
-#else
-        const int sval = num / (int)sqrt((fixed)mag);
-#endif
-        int sindex = (sval - sz) * contrast / 128;
-        if (gcc_unlikely(sindex < -64))
-          sindex = -64;
-        if (gcc_unlikely(sindex > 63))
-          sindex = 63;
-        *p++ = oColorBuf[h + 256*sindex];
-#else
-        const int num = (dd2 * sz_c + dd0 * sx_c + dd1 * sy_c);
-        const int sval = i_normalise_mag3(num, dd0, dd1, dd2);
-        if (gcc_unlikely(sval<=sval_min))
-          *p++ = color_table[h];
-        else if (gcc_unlikely(sval >= sval_max))
-          *p++ = color_table[h + 127*256];
-        else
-          *p++ = szColorBuf[h + (sval*256)];
-
-#endif
-      } else if (RasterBuffer::IsWater(h)) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = BGRColor(0xff, 0xff, 0xff);
-      }
+      for (unsigned x = begin; x < end; ++x)
+        p[x] = color_table[index[x]];
     }
   }
 
   image->SetDirty();
 }
 
-void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
-                                   int contrast, int brightness,
-                                   const Angle sunazimuth)
-{
-  const Angle fudgeelevation =
-    Angle::Degrees(fixed(10.0 + 80.0 * brightness / 255.0));
-
-  const int sx = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastsine());
-  const int sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
-  const int sz = (int)(255 * fudgeelevation.fastsine());
-
-  GenerateSlopeImage(height_scale, contrast,
-                     sx, sy, sz);
-}
-
 void
 RasterRenderer::ColorTable(const ColorRamp *color_ramp, bool do_water,
                            unsigned height_scale, int interp_levels)
@@ -417,4 +544,9 @@ RasterRenderer::ColorTable(const ColorRamp *color_ramp, bool do_water,
       color_table[i + (mag + 64) * 256] = BGRColor(r, g, b);
     }
   }
+
+  /* outside the terrain file bounds: white background */
+  color_table[HillShading::BACKGROUND] = BGRColor(0xff, 0xff, 0xff);
+
+  image_valid = false;
 }
@@ -25,12 +25,16 @@ Copyright_License {
 #define XCSOAR_RASTER_RENDERER_HPP
 
 #include "Terrain/HeightMatrix.hpp"
+#include "Terrain/HillShading.hpp"
 #include "Screen/RawBitmap.hpp"
 #include "Math/fixed.hpp"
 #include "Util/NonCopyable.hpp"
+#include "Util/AllocatedArray.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#else
+#include "Projection/WindowProjection.hpp"
 #endif
 
 #define NUM_COLOR_RAMP_LEVELS 13
@@ -39,6 +43,7 @@ class Angle;
 class Canvas;
 class RasterMap;
 class WindowProjection;
+class WorkerPool;
 struct ColorRamp;
 
 class RasterRenderer : private NonCopyable {
@@ -66,14 +71,63 @@ class RasterRenderer : private NonCopyable {
    * texture has to be redrawn.
    */
   GeoBounds bounds;
+#else
+  /**
+   * The projection which was used to fill the #HeightMatrix, moved
+   * along with the matrix contents by incremental updates.
+   */
+  WindowProjection matrix_projection;
+
+  /**
+   * May the next ScanMap() call shift the #HeightMatrix instead of
+   * scanning it again?
+   */
+  bool matrix_valid;
+
+  /**
+   * The number of cells the #HeightMatrix was shifted by since the
+   * last full scan.  The screen projection is not exactly linear, so
+   * each shift adds a tiny error; a full scan is forced after a
+   * while.
+   */
+  unsigned shifted_cells;
 #endif
 
+  /**
+   * The #HeightMatrix cells which were not scanned by the last
+   * ScanMap() call, because they were only moved by (#shift_x,
+   * #shift_y) cells.  The rectangle is empty after a full scan.
+   */
+  PixelRect valid_cells;
+  int shift_x, shift_y;
+
+  /**
+   * Does the #image contain the picture of the #HeightMatrix before
+   * the last ScanMap() call, generated with #image_parameters?  Only
+   * then can it be updated incrementally.
+   */
+  bool image_valid;
+  bool image_shading;
+  HillShading::Parameters image_parameters;
+
   HeightMatrix height_matrix;
   RawBitmap *image;
 
+  /**
+   * Scans the rows of the #HeightMatrix in parallel on multi-core
+   * systems; NULL on single-core systems.
+   */
+  WorkerPool *scan_pool;
+
   fixed pixel_size;
 
-  BGRColor color_table[256 * 128];
+  /**
+   * The color table indices of the row being converted, see
+   * #HillShading.
+   */
+  AllocatedArray<uint16_t> row_index;
+
+  BGRColor color_table[HillShading::TABLE_SIZE];
 
 public:
   RasterRenderer();
@@ -91,11 +145,19 @@ public:
     return height_matrix.GetHeight();
   }
 
-#ifdef ENABLE_OPENGL
+  /**
+   * Discard the #HeightMatrix contents, e.g. because the map has
+   * changed.  The next ScanMap() call will do a full scan.
+   */
   void Invalidate() {
+#ifdef ENABLE_OPENGL
     bounds.SetInvalid();
+#else
+    matrix_valid = false;
+#endif
   }
 
+#ifdef ENABLE_OPENGL
   /**
    * Calculate a new #quantisation_pixels value.
    *
@@ -120,12 +182,16 @@ public:
                   unsigned height_scale, int interp_levels);
 
   /**
-   * Scan the map and fill the height matrix.
+   * Scan the map and fill the height matrix.  If the projection was
+   * only moved since the last call, then the matrix is shifted, and
+   * only the cells which were moved into the screen are scanned.
    */
   void ScanMap(const RasterMap &map, const WindowProjection &projection);
 
   /**
-   * Convert the height matrix into the image.
+   * Convert the height matrix into the image.  After a shift in
+   * ScanMap(), the image is shifted as well and only the new areas
+   * are converted, unless the parameters have changed.
    */
   void GenerateImage(bool do_shading,
                      unsigned height_scale, int contrast, int brightness,
@@ -136,23 +202,51 @@ public:
   }
 
 protected:
+#ifdef ENABLE_OPENGL
   /**
-   * Convert the height matrix into the image, without shading.
+   * Attempt to reuse the #HeightMatrix for the new bounds.
+   *
+   * @param screen_bounds the area which must be covered
+   * @param new_bounds the area which should be covered
+   * @return true if the matrix has been updated, false if a full
+   * scan is needed
+   */
+  bool ScanShifted(const RasterMap &map, const GeoBounds &screen_bounds,
+                   const GeoBounds &new_bounds,
+                   unsigned width, unsigned height);
+#else
+  /**
+   * Attempt to reuse the #HeightMatrix for the new projection.  This
+   * works only if the projection was moved, without any change to
+   * the scale, rotation or size.
+   *
+   * @return true if the matrix has been updated, false if a full
+   * scan is needed
    */
-  void GenerateUnshadedImage(unsigned height_scale);
+  bool ScanShifted(const RasterMap &map, const WindowProjection &projection);
+#endif
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Move the pixels of #image by (#shift_x, #shift_y).
+   *
+   * @param valid the destination rectangle
+   */
+  void ShiftImage(const PixelRect &valid);
+
+  /**
+   * Convert the height matrix into the image, without shading.
+   *
+   * @param valid the pixels which are already up to date
    */
-  void GenerateSlopeImage(unsigned height_scale, int contrast,
-                          const int sx, const int sy, const int sz);
+  void GenerateUnshadedImage(unsigned height_scale, const PixelRect &valid);
 
   /**
    * Convert the height matrix into the image, with slope shading.
+   *
+   * @param valid the pixels which are already up to date
    */
-  void GenerateSlopeImage(unsigned height_scale,
-                          int contrast, int brightness,
-                          const Angle sunazimuth);
+  void GenerateSlopeImage(const HillShading::Parameters &parameters,
+                          const PixelRect &valid);
 };
 
 #endif
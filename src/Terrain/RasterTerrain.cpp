@@ -25,6 +25,7 @@ Copyright_License {
 #include "Profile/Profile.hpp"
 #include "OS/PathName.hpp"
 #include "Compatibility/path.h"
+#include "OS/Clock.hpp"
 
 #include <windef.h> /* for MAX_PATH */
 
@@ -53,3 +54,61 @@ RasterTerrain::OpenTerrain(FileCache *cache, OperationEnvironment &operation)
 
   return rt;
 }
+
+unsigned
+RasterTerrain::LoadRequestedTiles(bool decode, bool prefetch)
+{
+  assert(load_mutex.IsLockedByCurrent());
+
+  if (decode)
+    map.DecodeTiles();
+
+  const unsigned n = map.CommitTiles(prefetch);
+
+  unsigned wait = 0;
+  if (map.IsReclaimPending()) {
+    const uint64_t wait_start = MonotonicClockUS();
+    readers.Synchronize();
+    wait = MonotonicClockUS() - wait_start;
+
+    map.ReclaimTiles();
+  }
+
+  const ScopeLock protect(statistics_mutex);
+  if (prefetch)
+    statistics.tiles_prefetched += n;
+
+  statistics.prefetch_hits = map.GetPrefetchHits();
+  statistics.reader_wait_us += wait;
+  if (wait > statistics.max_reader_wait_us)
+    statistics.max_reader_wait_us = wait;
+
+  return n;
+}
+
+bool
+RasterTerrain::UpdateTiles(const GeoPoint &location, fixed radius)
+{
+  const ScopeLock protect(load_mutex);
+
+  const bool requested = map.RequestTiles(location, radius);
+  LoadRequestedTiles(requested, false);
+  return map.IsDirty();
+}
+
+unsigned
+RasterTerrain::PrefetchTiles(const GeoPoint *locations, unsigned n,
+                             fixed radius)
+{
+  const ScopeLock protect(load_mutex);
+
+  const bool requested = map.RequestPrefetchTiles(locations, n, radius);
+  return LoadRequestedTiles(requested, true);
+}
+
+TerrainPrefetchStatistics
+RasterTerrain::GetPrefetchStatistics() const
+{
+  const ScopeLock protect(statistics_mutex);
+  return statistics;
+}
@@ -25,8 +25,11 @@ Copyright_License {
 #define XCSOAR_TERRAIN_RASTER_TERRAIN_HPP
 
 #include "RasterMap.hpp"
+#include "TerrainPrefetch.hpp"
 #include "Geo/GeoPoint.hpp"
-#include "Thread/Guard.hpp"
+#include "Thread/ReaderEpoch.hpp"
+#include "Thread/Mutex.hpp"
+#include "Util/NonCopyable.hpp"
 #include "Compiler.h"
 
 #include <tchar.h>
@@ -37,9 +40,13 @@ class OperationEnvironment;
 /**
  * Class to manage raster terrain database, potentially with 
  * caching or demand-loading.
- * 
+ *
+ * Readers never lock: they obtain a Lease, which registers them with
+ * a ReaderEpoch.  Tile loading publishes a new tile table (see
+ * RasterTileCache::CommitTiles()), and then waits for the readers of
+ * the old one before freeing disposed tiles.
  */
-class RasterTerrain : public Guard<RasterMap> {
+class RasterTerrain : private NonCopyable {
 public:
   friend class RoutePlannerGlue; // for route planning
   friend class ProtectedTaskManager; // for intersection
@@ -51,7 +58,75 @@ public:
 protected:
   RasterMap map;
 
+  mutable ReaderEpoch readers;
+
+  /**
+   * Serialises tile loading between the map view and the prefetch
+   * thread.
+   */
+  Mutex load_mutex;
+
+  /**
+   * Protects #statistics.
+   */
+  mutable Mutex statistics_mutex;
+
+  TerrainPrefetchStatistics statistics;
+
+  TerrainPrefetch prefetch;
+
 public:
+  /**
+   * A read-only lease on the terrain map.  It does not block, and it
+   * does not block the tile loader, but tiles disposed meanwhile are
+   * not freed before the lease ends.  Don't hold it for a long time,
+   * and don't load tiles while holding it.
+   */
+  class Lease {
+    const RasterTerrain &terrain;
+    ReaderEpoch::Reader reader;
+
+  public:
+    explicit Lease(const RasterTerrain &_terrain)
+      :terrain(_terrain), reader(terrain.readers) {}
+
+    operator const RasterMap&() const {
+      return terrain.map;
+    }
+
+    const RasterMap *operator->() const {
+      return &terrain.map;
+    }
+  };
+
+  /**
+   * An unprotected writable lease on the terrain map.  This is only
+   * allowed when the other threads which might access the map are
+   * suspended (e.g. during startup).
+   */
+  class UnprotectedLease {
+    RasterMap &map;
+
+  public:
+    explicit UnprotectedLease(RasterTerrain &terrain)
+      :map(terrain.map) {}
+
+    operator const RasterMap&() const {
+      return map;
+    }
+
+    operator RasterMap&() {
+      return map;
+    }
+
+    const RasterMap *operator->() const {
+      return &map;
+    }
+
+    RasterMap *operator->() {
+      return &map;
+    }
+  };
 
 /** 
  * Constructor.  Returns uninitialised object. 
@@ -59,7 +134,14 @@ public:
  */
   RasterTerrain(const TCHAR *path, const TCHAR *world_file, FileCache *cache,
                 OperationEnvironment &operation)
-    :Guard<RasterMap>(map), map(path, world_file, cache, operation) {}
+    :map(path, world_file, cache, operation),
+     prefetch(*this) {
+    statistics.Clear();
+  }
+
+  ~RasterTerrain() {
+    prefetch.Stop();
+  }
 
   const Serial &GetSerial() const {
     return map.GetSerial();
@@ -82,6 +164,47 @@ public:
     return map.GetMapCenter();
   }
 
+  /**
+   * Load the tiles around the specified location, like
+   * RasterMap::SetViewCenter().  Readers are not blocked while tiles
+   * are being loaded.  The calling thread must not hold a Lease.
+   *
+   * @return true if more tiles need to be loaded, see
+   * RasterMap::IsDirty()
+   */
+  bool UpdateTiles(const GeoPoint &location, fixed radius);
+
+  /**
+   * Load tiles around the specified locations, without disposing
+   * tiles which are already loaded.  This is called by the prefetch
+   * thread.
+   *
+   * @return the number of tiles which were loaded
+   */
+  unsigned PrefetchTiles(const GeoPoint *locations, unsigned n,
+                         fixed radius);
+
+  /**
+   * Submit the current aircraft state to the prefetch thread, which
+   * will load the tiles along the predicted flight path.
+   */
+  void Prefetch(const GeoPoint &location, Angle track, fixed ground_speed) {
+    prefetch.Update(location, track, ground_speed);
+  }
+
+  gcc_pure
+  TerrainPrefetchStatistics GetPrefetchStatistics() const;
+
+private:
+  /**
+   * Decode and publish the requested tiles, and free the disposed
+   * ones after all readers of the previous tile table are finished.
+   * Caller must lock #load_mutex.
+   *
+   * @param decode true if tiles have been requested
+   * @return the number of tiles which were loaded
+   */
+  unsigned LoadRequestedTiles(bool decode, bool prefetch);
 };
 
 #endif
@@ -48,20 +48,40 @@ RasterTile::LoadCache(FILE *file)
   return true;
 }
 
+bool
+RasterTile::SaveRawData(FILE *file) const
+{
+  assert(IsEnabled());
+
+  const size_t n = width * height;
+  return fwrite(buffer.GetData(), sizeof(*buffer.GetData()), n, file) == n;
+}
+
 void
 RasterTile::Enable()
 {
   if (!width || !height) {
     Disable();
   } else {
-    buffer.Resize(width, height);
+    pending.Resize(width, height);
   }
 }
 
+bool
+RasterTile::CommitPending()
+{
+  if (!pending.IsDefined())
+    return false;
+
+  buffer.Swap(pending);
+  pending.Reset();
+  return true;
+}
+
 short
-RasterTile::GetHeight(unsigned x, unsigned y) const
+RasterTile::GetHeight(const RasterBuffer &data, unsigned x, unsigned y) const
 {
-  assert(IsEnabled());
+  assert(data.IsDefined());
 
   x -= xstart;
   y -= ystart;
@@ -69,17 +89,18 @@ RasterTile::GetHeight(unsigned x, unsigned y) const
   assert(x < width);
   assert(y < height);
 
-  return buffer.Get(x, y);
+  return data.Get(x, y);
 }
 
 short
-RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
+RasterTile::GetInterpolatedHeight(const RasterBuffer &data,
+                                  unsigned lx, unsigned ly,
                                   unsigned ix, unsigned iy) const
 {
   // we want to exit out of this function as soon as possible
   // if we have the wrong tile
 
-  if (IsDisabled())
+  if (!data.IsDefined())
     return RasterBuffer::TERRAIN_INVALID;
 
   // check x in range
@@ -90,7 +111,7 @@ RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
   if ((ly -= ystart) >= height)
     return RasterBuffer::TERRAIN_INVALID;
 
-  return buffer.GetInterpolated(lx, ly, ix, iy);
+  return data.GetInterpolated(lx, ly, ix, iy);
 }
 
 bool
@@ -27,6 +27,7 @@ Copyright_License {
 #include "Terrain/RasterBuffer.hpp"
 #include "Util/NonCopyable.hpp"
 
+#include <assert.h>
 #include <stdio.h>
 
 class RasterTile : private NonCopyable {
@@ -46,12 +47,37 @@ public:
 
   bool request;
 
+  /**
+   * Was this tile loaded by the prefetch thread, and has not been
+   * needed by the map view yet?
+   */
+  bool prefetched;
+
+  /**
+   * The loaded height values.  This is owned by the tile loader;
+   * readers access it only through the tile table published by
+   * RasterTileCache.
+   */
   RasterBuffer buffer;
 
+  /**
+   * The buffer which the JPEG2000 decoder writes to.  It is not
+   * accessed by readers, which allows decoding without locking them
+   * out; CommitPending() moves it to #buffer.
+   */
+  RasterBuffer pending;
+
+  /**
+   * The buffer which was disposed by Disable().  Readers of the
+   * previous tile table may still be using it; it is freed by
+   * Reclaim().
+   */
+  RasterBuffer retired;
+
 public:
   RasterTile()
     :xstart(0), ystart(0), xend(0), yend(0),
-     width(0), height(0) {}
+     width(0), height(0), request(false), prefetched(false) {}
 
   void Set(unsigned _xstart, unsigned _ystart,
            unsigned _xend, unsigned _yend) {
@@ -94,13 +120,53 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+  /**
+   * Write the decoded height values of this tile to the file.
+   */
+  bool SaveRawData(FILE *file) const;
+
+  /**
+   * Enable this tile, referring to height values written previously
+   * by SaveRawData() (e.g. in a memory-mapped file) instead of
+   * allocating and decoding a buffer.
+   */
+  void EnableExternal(const short *data) {
+    assert(IsDefined());
+
+    buffer.SetExternal(data, width, height);
+  }
+
   bool CheckTileVisibility(int view_x, int view_y, unsigned view_radius);
 
   void Disable() {
-    buffer.Reset();
+    if (buffer.IsDefined()) {
+      assert(!retired.IsDefined());
+      retired.Swap(buffer);
+    }
+
+    pending.Reset();
+    prefetched = false;
   }
 
+  /**
+   * Free the buffer disposed by Disable().  Call this after all
+   * readers which may have seen it are finished.
+   */
+  void Reclaim() {
+    retired.Reset();
+  }
+
+  /**
+   * Allocate the #pending buffer for the decoder.
+   */
   void Enable();
+
+  /**
+   * Make the #pending buffer filled by the decoder visible.
+   *
+   * @return false if nothing was decoded
+   */
+  bool CommitPending();
   bool IsEnabled() const {
     return buffer.IsDefined();
   }
@@ -112,34 +178,38 @@ public:
    * Determine the non-interpolated height at the specified pixel
    * location.
    *
-   * @param x the pixel column within the tile; may be out of range
-   * @param y the pixel row within the tile; may be out of range
+   * @param data the published buffer of this tile
+   * @param x the pixel column within the map
+   * @param y the pixel row within the map
    */
   gcc_pure
-  short GetHeight(unsigned x, unsigned y) const;
+  short GetHeight(const RasterBuffer &data, unsigned x, unsigned y) const;
 
   /**
    * Determine the interpolated height at the specified sub-pixel
    * location.
    *
-   * @param x the pixel column within the tile; may be out of range
-   * @param y the pixel row within the tile; may be out of range
+   * @param data the published buffer of this tile
+   * @param x the pixel column within the map; may be out of range
+   * @param y the pixel row within the map; may be out of range
    * @param ix the sub-pixel column for interpolation (0..255)
    * @param iy the sub-pixel row for interpolation (0..255)
    */
   gcc_pure
-  short GetInterpolatedHeight(unsigned x, unsigned y,
+  short GetInterpolatedHeight(const RasterBuffer &data,
+                              unsigned x, unsigned y,
                               unsigned ix, unsigned iy) const;
 
   inline short* GetImageBuffer() {
-    return buffer.GetData();
+    return pending.GetData();
   }
 
   bool VisibilityChanged(int view_x, int view_y, unsigned view_radius);
 
-  void ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
+  void ScanLine(const RasterBuffer &data,
+                unsigned ax, unsigned ay, unsigned bx, unsigned by,
                 short *dest, unsigned size, bool interpolate) const {
-    buffer.ScanLine(ax - (xstart << 8), ay - (ystart << 8),
+    data.ScanLine(ax - (xstart << 8), ay - (ystart << 8),
                     bx - (xstart << 8), by - (ystart << 8),
                     dest, size, interpolate);
   }
@@ -27,6 +27,8 @@ Copyright_License {
 #include "Math/Angle.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "Operation/Operation.hpp"
+#include "OS/FileMapping.hpp"
+#include "Util/AllocatedArray.hpp"
 #include "Math/FastMath.h"
 
 #include <string.h>
@@ -45,6 +47,11 @@ void
 RasterTileCache::SetTile(unsigned index,
                          int xstart, int ystart, int xend, int yend)
 {
+  if (!scan_overview)
+    /* the tile metadata is already known; don't modify it while
+       readers may be accessing it (see DecodeTiles()) */
+    return;
+
   if (!segments.empty() && !segments.last().IsTileSegment())
     /* link current marker segment with this tile */
     segments.last().tile = index;
@@ -68,7 +75,7 @@ struct RTDistanceSort {
 bool
 RasterTileCache::PollTiles(int x, int y, unsigned radius)
 {
-  if (scan_overview)
+  if (scan_overview || raw_tiles != NULL)
     return false;
 
   /* tiles are usually 256 pixels wide; with a radius smaller than
@@ -77,14 +84,6 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
      the screen will be loaded in advance */
   radius += 256;
 
-  enum {
-    /**
-     * Maximum number of tiles loaded at a time, to reduce system load
-     * peaks.
-    */
-    MAX_ACTIVATE = MAX_ACTIVE_TILES > 32 ? 16 : MAX_ACTIVE_TILES / 2,
-  };
-
   /* query all tiles; all tiles which are either in range or already
      loaded are added to RequestTiles */
 
@@ -103,6 +102,8 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
     /* dispose all tiles which are out of range */
     for (unsigned i = MAX_ACTIVE_TILES; i < request_tiles.size(); ++i) {
       RasterTile &tile = tiles.GetLinear(request_tiles[i]);
+      if (tile.IsEnabled())
+        tiles_disposed = true;
       tile.Disable();
     }
 
@@ -116,8 +117,15 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
   unsigned num_activate = 0;
   for (unsigned i = 0; i < request_tiles.size(); ++i) {
     RasterTile &tile = tiles.GetLinear(request_tiles[i]);
-    if (tile.IsEnabled())
+    if (tile.IsEnabled()) {
+      if (tile.prefetched && (unsigned)tile.GetDistance() <= radius) {
+        /* this tile was loaded in advance by PrefetchTiles() */
+        tile.prefetched = false;
+        ++prefetch_hits;
+      }
+
       continue;
+    }
 
     if (++num_activate <= MAX_ACTIVATE)
       /* request the tile in the current iteration */
@@ -130,6 +138,147 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
   return num_activate > 0;
 }
 
+bool
+RasterTileCache::PrefetchTiles(const RasterLocation *locations, unsigned n,
+                               unsigned radius)
+{
+  if (scan_overview || raw_tiles != NULL)
+    return false;
+
+  /* see PollTiles() */
+  radius += 256;
+
+  unsigned num_enabled = 0;
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it) {
+    it->ClearRequest();
+    if (it->IsEnabled())
+      ++num_enabled;
+  }
+
+  if (num_enabled >= MAX_ACTIVE_TILES)
+    /* no room for more tiles */
+    return false;
+
+  const unsigned max_activate =
+    MAX_ACTIVE_TILES - num_enabled < MAX_ACTIVATE
+    ? MAX_ACTIVE_TILES - num_enabled
+    : MAX_ACTIVATE;
+
+  request_tiles.clear();
+
+  for (unsigned j = 0; j < n; ++j) {
+    for (unsigned i = 0; i < tiles.GetSize(); ++i) {
+      RasterTile &tile = tiles.GetLinear(i);
+      if (tile.IsEnabled() || tile.IsRequested() ||
+          !tile.CheckTileVisibility(locations[j].x, locations[j].y, radius))
+        continue;
+
+      tile.SetRequest();
+      request_tiles.append(i);
+      if (request_tiles.size() >= max_activate)
+        return true;
+    }
+  }
+
+  return !request_tiles.empty();
+}
+
+void
+RasterTileCache::DecodeTiles(const char *path)
+{
+  remaining_segments = 0;
+
+  LoadJPG2000(path);
+}
+
+unsigned
+RasterTileCache::CommitTiles(bool prefetch)
+{
+  unsigned n = 0;
+
+  for (auto it = request_tiles.begin(), end = request_tiles.end();
+      it != end; ++it) {
+    RasterTile &tile = tiles.GetLinear(*it);
+    if (!tile.IsRequested())
+      continue;
+
+    tile.ClearRequest();
+
+    if (tile.CommitPending()) {
+      /* before publishing the tile, so readers which see it see its
+         bounds, too */
+      pyramid.Include(tile.buffer, tile.xstart, tile.ystart);
+      tile.prefetched = prefetch;
+      ++n;
+    } else
+      /* permanently disable the requested tiles which are still not
+         loaded, to prevent trying to reload them over and over in a
+         busy loop */
+      tile.Clear();
+  }
+
+  if (n > 0 || tiles_disposed)
+    PublishTiles();
+
+  return n;
+}
+
+void
+RasterTileCache::PublishTiles()
+{
+  assert(!reclaim_pending);
+
+  /* the other table is not used by any reader since the last
+     ReclaimTiles() call */
+  TileTable &table =
+    current_table.load(std::memory_order_relaxed) == &tables[0]
+    ? tables[1] : tables[0];
+  assert(table.buffers.size() >= tiles.GetSize());
+
+  for (unsigned i = 0, n = tiles.GetSize(); i < n; ++i) {
+    const RasterBuffer &src = tiles.GetLinear(i).buffer;
+    RasterBuffer &dest = table.buffers[i];
+    if (src.IsDefined())
+      dest.SetExternal(src.GetData(), src.GetWidth(), src.GetHeight());
+    else
+      dest.Reset();
+  }
+
+  current_table.store(&table, std::memory_order_release);
+
+  tiles_disposed = false;
+  reclaim_pending = true;
+  ++serial;
+}
+
+void
+RasterTileCache::ReclaimTiles()
+{
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    it->Reclaim();
+
+  reclaim_pending = false;
+}
+
+void
+RasterTileCache::ResetTileTables()
+{
+  for (unsigned i = 0; i < 2; ++i) {
+    AllocatedArray<RasterBuffer> &buffers = tables[i].buffers;
+    buffers.GrowDiscard(tiles.GetSize());
+    for (auto it = buffers.begin(), end = buffers.end(); it != end; ++it)
+      it->Reset();
+  }
+
+  current_table.store(&tables[0]);
+
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    it->Reclaim();
+
+  tiles_disposed = false;
+  reclaim_pending = false;
+}
+
 bool
 RasterTileCache::TileRequest(unsigned index)
 {
@@ -149,9 +298,10 @@ RasterTileCache::GetHeight(unsigned px, unsigned py) const
     // outside overall bounds
     return RasterBuffer::TERRAIN_INVALID;
 
-  const RasterTile &tile = tiles.Get(px / tile_width, py / tile_height);
-  if (tile.IsEnabled())
-    return tile.GetHeight(px, py);
+  const unsigned tile_x = px / tile_width, tile_y = py / tile_height;
+  const RasterBuffer &data = GetTileBuffer(tile_x, tile_y);
+  if (data.IsDefined())
+    return tiles.Get(tile_x, tile_y).GetHeight(data, px, py);
 
   // still not found, so go to overview
   return overview.GetInterpolated(px << (SUBPIXEL_BITS - OVERVIEW_BITS),
@@ -169,9 +319,11 @@ RasterTileCache::GetInterpolatedHeight(unsigned int lx, unsigned int ly) const
   const unsigned int ix = CombinedDivAndMod(px);
   const unsigned int iy = CombinedDivAndMod(py);
 
-  const RasterTile &tile = tiles.Get(px / tile_width, py / tile_height);
-  if (tile.IsEnabled())
-    return tile.GetInterpolatedHeight(px, py, ix, iy);
+  const unsigned tile_x = px / tile_width, tile_y = py / tile_height;
+  const RasterBuffer &data = GetTileBuffer(tile_x, tile_y);
+  if (data.IsDefined())
+    return tiles.Get(tile_x, tile_y).GetInterpolatedHeight(data, px, py,
+                                                            ix, iy);
 
   // still not found, so go to overview
   return overview.GetInterpolated(lx >> OVERVIEW_BITS,
@@ -183,6 +335,12 @@ RasterTileCache::SetSize(unsigned _width, unsigned _height,
                          unsigned _tile_width, unsigned _tile_height,
                          unsigned tile_columns, unsigned tile_rows)
 {
+  if (!scan_overview)
+    /* the decoder calls this each time; the size is already known,
+       and must not be modified while readers may be accessing it
+       (see DecodeTiles()) */
+    return;
+
   width = _width;
   height = _height;
   tile_width = _tile_width;
@@ -192,7 +350,10 @@ RasterTileCache::SetSize(unsigned _width, unsigned _height,
   overview_width_fine = width << SUBPIXEL_BITS;
   overview_height_fine = height << SUBPIXEL_BITS;
 
+  pyramid.Resize(width, height);
+
   tiles.GrowDiscard(tile_columns, tile_rows);
+  ResetTileTables();
 }
 
 void
@@ -211,6 +372,13 @@ RasterTileCache::SetLatLonBounds(double _lon_min, double _lon_max,
   bounds_initialised = true;
 }
 
+RasterTileCache::~RasterTileCache()
+{
+  /* disable all tiles before unmapping the memory they may point
+     to */
+  Reset();
+}
+
 void
 RasterTileCache::Reset()
 {
@@ -222,9 +390,15 @@ RasterTileCache::Reset()
   scan_overview = true;
 
   overview.Reset();
+  pyramid.Reset();
 
   for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
     it->Disable();
+
+  ResetTileTables();
+
+  delete raw_tiles;
+  raw_tiles = NULL;
 }
 
 gcc_pure
@@ -422,7 +596,9 @@ RasterTileCache::LoadOverview(const char *path, const TCHAR *world_file,
   if (initialised && !bounds_initialised)
     initialised = false;
 
-  if (!initialised)
+  if (initialised)
+    pyramid.IncludeOverview(overview);
+  else
     Reset();
 
   operation = NULL;
@@ -432,24 +608,11 @@ RasterTileCache::LoadOverview(const char *path, const TCHAR *world_file,
 void
 RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
 {
-  if (!PollTiles(x, y, radius))
-    return;
-
-  remaining_segments = 0;
+  if (PollTiles(x, y, radius))
+    DecodeTiles(path);
 
-  LoadJPG2000(path);
-
-  /* permanently disable the requested tiles which are still not
-     loaded, to prevent trying to reload them over and over in a busy
-     loop */
-  for (auto it = request_tiles.begin(), end = request_tiles.end();
-      it != end; ++it) {
-    RasterTile &tile = tiles.GetLinear(*it);
-    if (tile.IsRequested() && !tile.IsEnabled())
-      tile.Clear();
-  }
-
-  ++serial;
+  CommitTiles(false);
+  ReclaimTiles();
 }
 
 bool
@@ -554,7 +717,205 @@ RasterTileCache::LoadCache(FILE *file)
             overview_size, file) != overview_size)
     return false;
 
+  pyramid.IncludeOverview(overview);
+
   initialised = true;
   scan_overview = false;
   return true;
 }
+
+/**
+ * Write zero bytes until the file position is aligned to 16 bytes.
+ * Tiles are aligned this way to make access through a memory mapping
+ * efficient.
+ */
+static bool
+AlignFile(FILE *file)
+{
+  long position = ftell(file);
+  if (position < 0)
+    return false;
+
+  for (; position % 16 != 0; ++position)
+    if (fputc(0, file) == EOF)
+      return false;
+
+  return true;
+}
+
+bool
+RasterTileCache::SaveRawTiles(const char *path, FILE *file,
+                              OperationEnvironment &_operation)
+{
+  assert(initialised);
+  assert(!scan_overview);
+  assert(raw_tiles == NULL);
+
+  const unsigned num_tiles = tiles.GetSize();
+  const unsigned num_bounds =
+    2 * pyramid.GetBlockWidth() * pyramid.GetBlockHeight();
+
+  /* check if the file will fit into a mapping; tile metadata is
+     known already, so this is cheap */
+  size_t total_size = sizeof(RawTileHeader) + num_tiles * sizeof(uint32_t) +
+    num_bounds * sizeof(short);
+  for (unsigned i = 0; i < num_tiles; ++i) {
+    const RasterTile &tile = tiles.GetLinear(i);
+    if (tile.IsDefined())
+      total_size += tile.width * tile.height * sizeof(short) + 16;
+  }
+
+  if (total_size > MAX_RAW_TILES_SIZE)
+    return false;
+
+  const long base = ftell(file);
+  if (base < 0)
+    return false;
+
+  RawTileHeader header;
+  header.magic = RawTileHeader::MAGIC;
+  header.version = RawTileHeader::VERSION;
+  header.width = width;
+  header.height = height;
+  header.tile_columns = tiles.GetWidth();
+  header.tile_rows = tiles.GetHeight();
+
+  /* the offset table and the block bounds are written twice: now as
+     a placeholder, and again at the end, when all tiles are
+     known */
+  AllocatedArray<uint32_t> offsets(num_tiles);
+  std::fill(offsets.begin(), offsets.end(), 0);
+
+  AllocatedArray<short> bounds(num_bounds);
+  std::fill(bounds.begin(), bounds.end(), 0);
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(offsets.begin(), sizeof(*offsets.begin()),
+             num_tiles, file) != num_tiles ||
+      fwrite(bounds.begin(), sizeof(*bounds.begin()),
+             num_bounds, file) != num_bounds)
+    return false;
+
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    it->ClearRequest();
+
+  _operation.SetProgressRange(num_tiles);
+
+  /* decode the tiles in batches, to limit the amount of memory
+     needed */
+  unsigned i = 0;
+  while (i < num_tiles) {
+    request_tiles.clear();
+    for (; i < num_tiles && request_tiles.size() < MAX_ACTIVE_TILES; ++i) {
+      RasterTile &tile = tiles.GetLinear(i);
+      if (tile.IsDefined()) {
+        tile.SetRequest();
+        request_tiles.append(i);
+      }
+    }
+
+    if (request_tiles.empty())
+      break;
+
+    DecodeTiles(path);
+
+    for (auto it = request_tiles.begin(), end = request_tiles.end();
+         it != end; ++it) {
+      RasterTile &tile = tiles.GetLinear(*it);
+      if (tile.CommitPending()) {
+        pyramid.Include(tile.buffer, tile.xstart, tile.ystart);
+
+        if (!AlignFile(file))
+          return false;
+
+        offsets[*it] = ftell(file) - base;
+
+        if (!tile.SaveRawData(file))
+          return false;
+      }
+
+      /* tiles which failed to decode keep offset 0, and will fall
+         back to the overview */
+
+      tile.Disable();
+      tile.Reclaim();
+      tile.ClearRequest();
+    }
+
+    _operation.SetProgressPosition(i);
+  }
+
+  pyramid.SaveBlocks(bounds.begin());
+
+  /* now write the real offset table and block bounds */
+  return fseek(file, base + sizeof(header), SEEK_SET) == 0 &&
+    fwrite(offsets.begin(), sizeof(*offsets.begin()),
+           num_tiles, file) == num_tiles &&
+    fwrite(bounds.begin(), sizeof(*bounds.begin()),
+           num_bounds, file) == num_bounds &&
+    fseek(file, 0, SEEK_END) == 0;
+}
+
+bool
+RasterTileCache::LoadRawTiles(FileMapping *mapping, size_t offset)
+{
+  assert(mapping != NULL);
+  assert(raw_tiles == NULL);
+
+  const unsigned num_tiles = tiles.GetSize();
+  const unsigned num_bounds =
+    2 * pyramid.GetBlockWidth() * pyramid.GetBlockHeight();
+  const size_t size = mapping->size();
+
+  if (!initialised || mapping->error() ||
+      offset + sizeof(RawTileHeader) + num_tiles * sizeof(uint32_t) +
+      num_bounds * sizeof(short) > size) {
+    delete mapping;
+    return false;
+  }
+
+  const RawTileHeader &header =
+    *(const RawTileHeader *)mapping->at(offset);
+  if (header.magic != RawTileHeader::MAGIC ||
+      header.version != RawTileHeader::VERSION ||
+      header.width != width || header.height != height ||
+      header.tile_columns != tiles.GetWidth() ||
+      header.tile_rows != tiles.GetHeight()) {
+    delete mapping;
+    return false;
+  }
+
+  const uint32_t *offsets = (const uint32_t *)(&header + 1);
+  const short *bounds = (const short *)(offsets + num_tiles);
+
+  /* validate all offsets before modifying any tile */
+  for (unsigned i = 0; i < num_tiles; ++i) {
+    if (offsets[i] == 0)
+      continue;
+
+    const RasterTile &tile = tiles.GetLinear(i);
+    const size_t start = offset + offsets[i];
+    if (!tile.IsDefined() || start % sizeof(short) != 0 ||
+        start + tile.width * tile.height * sizeof(short) > size) {
+      delete mapping;
+      return false;
+    }
+  }
+
+  for (unsigned i = 0; i < num_tiles; ++i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    if (offsets[i] != 0)
+      tile.EnableExternal((const short *)mapping->at(offset + offsets[i]));
+    else
+      tile.Disable();
+  }
+
+  raw_tiles = mapping;
+  dirty = false;
+
+  /* this is called during startup, there are no readers yet */
+  pyramid.LoadBlocks(bounds);
+  PublishTiles();
+  ReclaimTiles();
+  return true;
+}
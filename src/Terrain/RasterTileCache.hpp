@@ -25,11 +25,15 @@ Copyright_License {
 #define XCSOAR_RASTERTILE_CACHE_HPP
 
 #include "RasterTile.hpp"
+#include "HeightPyramid.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "Util/NonCopyable.hpp"
+#include "Util/AllocatedGrid.hpp"
 #include "Util/StaticArray.hpp"
 #include "Util/Serial.hpp"
 
+#include <atomic>
+
 #include <assert.h>
 #include <tchar.h>
 #include <stddef.h>
@@ -41,6 +45,7 @@ Copyright_License {
 struct RasterLocation;
 struct GridLocation;
 class OperationEnvironment;
+class FileMapping;
 
 class RasterTileCache : private NonCopyable {
   static constexpr unsigned MAX_RTC_TILES = 4096;
@@ -62,6 +67,13 @@ class RasterTileCache : private NonCopyable {
   static constexpr unsigned MAX_ACTIVE_TILES = 16;
 #endif
 
+  /**
+   * Maximum number of tiles loaded at a time, to reduce system load
+   * peaks.
+   */
+  static constexpr unsigned MAX_ACTIVATE =
+    MAX_ACTIVE_TILES > 32 ? 16 : MAX_ACTIVE_TILES / 2;
+
   /**
    * The width and height of the terrain bitmap is shifted by this
    * number of bits to determine the overview size.
@@ -131,6 +143,39 @@ protected:
     GeoBounds bounds;
   };
 
+  /**
+   * The header of a raw tile file, see SaveRawTiles().  It is
+   * followed by an array of uint32_t offsets (one per tile, relative
+   * to the beginning of the header, 0 if the tile is not available),
+   * the level 0 bounds of the #HeightPyramid (two shorts per block)
+   * and the tile data.
+   */
+  struct RawTileHeader {
+    enum {
+      MAGIC = 0x57415254,
+      VERSION = 2,
+    };
+
+    uint32_t magic, version;
+    uint32_t width, height;
+    uint32_t tile_columns, tile_rows;
+  };
+
+  /**
+   * An immutable snapshot of the loaded tiles, which is what readers
+   * see.  Each element refers to the RasterTile::buffer of the tile
+   * with the same index, or is undefined if that tile is not loaded.
+   */
+  struct TileTable {
+    AllocatedArray<RasterBuffer> buffers;
+  };
+
+  /**
+   * The maximum size of the raw tile file.  Larger maps are decoded
+   * from the JPEG2000 file on demand.
+   */
+  static constexpr size_t MAX_RAW_TILES_SIZE = 768 * 1024 * 1024;
+
   bool initialised;
 
   /** is the "bounds" attribute valid? */
@@ -147,7 +192,37 @@ protected:
   AllocatedGrid<RasterTile> tiles;
   unsigned short tile_width, tile_height;
 
+  /**
+   * Two tile tables: one is published in #current_table, the other
+   * one is rebuilt by the next PublishTiles() call.
+   */
+  TileTable tables[2];
+
+  /**
+   * The tile table which is visible to readers.  Readers do not lock
+   * anything; the tile loader must wait until they are finished
+   * before calling ReclaimTiles() (see ReaderEpoch).
+   */
+  std::atomic<const TileTable *> current_table;
+
+  /**
+   * Have tiles been disposed since the last PublishTiles() call?
+   */
+  bool tiles_disposed;
+
+  /**
+   * Has PublishTiles() been called, and ReclaimTiles() not yet?
+   */
+  bool reclaim_pending;
+
   RasterBuffer overview;
+
+  /**
+   * Height bounds of the overview and of all tiles which have been
+   * loaded so far, for the line-of-sight queries.
+   */
+  HeightPyramid pyramid;
+
   bool scan_overview;
   unsigned int width, height;
   unsigned int overview_width_fine, overview_height_fine;
@@ -163,22 +238,52 @@ protected:
 
   /**
    * An array that is used to sort the requested tiles by distance.
-   * This is only used by PollTiles() internally, but is stored in the
-   * class because it would be too large for the stack.
+   * This is only used by the tile loading methods internally, but is
+   * stored in the class because it would be too large for the stack.
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  /**
+   * The number of tiles loaded by PrefetchTiles() which were later
+   * needed by PollTiles().
+   */
+  unsigned prefetch_hits;
+
   /**
    * Progress callbacks for loading the file during startup.
    */
   OperationEnvironment *operation;
 
+  /**
+   * The memory-mapped raw tile file (see LoadRawTiles()).  All tiles
+   * point into this mapping.  NULL if tiles are decoded from the
+   * JPEG2000 file on demand.
+   */
+  FileMapping *raw_tiles;
+
 public:
-  RasterTileCache():operation(NULL) {
+  RasterTileCache()
+    :current_table(&tables[0]), tiles_disposed(false), reclaim_pending(false),
+     prefetch_hits(0), operation(NULL), raw_tiles(NULL) {
     Reset();
   }
 
+  ~RasterTileCache();
+
 protected:
+  /**
+   * Returns the published buffer of the specified tile, which is
+   * undefined if the tile is not loaded.  It remains valid until the
+   * calling reader is finished.
+   */
+  const RasterBuffer &GetTileBuffer(unsigned index) const {
+    return current_table.load(std::memory_order_acquire)->buffers[index];
+  }
+
+  const RasterBuffer &GetTileBuffer(unsigned x, unsigned y) const {
+    return GetTileBuffer(y * tiles.GetWidth() + x);
+  }
+
   void ScanTileLine(GridLocation start, GridLocation end,
                     short *buffer, unsigned size, bool interpolate) const;
 
@@ -244,6 +349,41 @@ protected:
    */
   short GetFieldDirect(const unsigned px, const unsigned py, int &tile_index) const;
 
+  /**
+   * Update the tile index like GetFieldDirect() does, without
+   * reading the height.  This is used for the samples which
+   * FindClearSteps() skips, so they choose the same step size as if
+   * they had been looked up.
+   */
+  void UpdateTileIndex(const unsigned px, const unsigned py, int &tile_index) const;
+
+  /**
+   * Are the terrain heights plus the safety margin within [0, h_max]
+   * at all samples between the specified steps of a
+   * FirstIntersection() or Intersection() walk from (x0, y0) to (x1,
+   * y1)?  This only consults the #HeightPyramid, and may return false
+   * even if the line is clear.
+   */
+  gcc_pure
+  bool IsLineClear(int x0, int y0, int x1, int y1, int max_steps,
+                   int from_step, int to_step,
+                   int h_max, int h_safety) const;
+
+  /**
+   * Find the part of a FirstIntersection() or Intersection() walk
+   * beginning at the specified step which passes above the terrain,
+   * according to IsLineClear().  It tries #chunk_steps first, and
+   * halves that down to #min_steps.
+   *
+   * @param height the aircraft height as a (monotonic) function of
+   * the number of steps
+   * @return the last step which is known to be clear, or -1
+   */
+  template<typename HeightFunction>
+  int FindClearSteps(int x0, int y0, int x1, int y1, int max_steps,
+                     int from_step, int &chunk_steps, int min_steps,
+                     HeightFunction height, int h_safety) const;
+
 public:
   bool LoadOverview(const char *path, const TCHAR *world_file,
                     OperationEnvironment &operation);
@@ -251,8 +391,101 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+  /**
+   * Decode all tiles from the JPEG2000 file and write their raw
+   * height values to the file, to be used later by LoadRawTiles().
+   * This is slow, but needs to be done only once per map file.
+   */
+  bool SaveRawTiles(const char *path, FILE *file,
+                    OperationEnvironment &operation);
+
+  /**
+   * Use the raw tile file written previously by SaveRawTiles().  All
+   * tiles are enabled at once, pointing straight into the mapping;
+   * UpdateTiles() will not decode anything after that.
+   *
+   * @param mapping the mapped file; this object takes ownership, even
+   * on failure
+   * @param offset the position of the raw tile header within the
+   * mapping
+   */
+  bool LoadRawTiles(FileMapping *mapping, size_t offset);
+
+  /**
+   * Are the tiles being read from a raw tile file?
+   */
+  bool HasRawTiles() const {
+    return raw_tiles != NULL;
+  }
+
+  /**
+   * Load the tiles around the specified pixel location.  This is a
+   * shortcut for PollTiles(), DecodeTiles(), CommitTiles() and
+   * ReclaimTiles(), to be used when there are no concurrent readers.
+   */
   void UpdateTiles(const char *path, int x, int y, unsigned radius);
 
+  /**
+   * Determine which tiles are needed around the specified pixel
+   * location, and request them to be decoded.  Tiles which are too
+   * far away are disposed, but remain visible to readers until the
+   * next CommitTiles() call.
+   *
+   * @return true if tiles have been requested
+   */
+  bool PollTiles(int x, int y, unsigned radius);
+
+  /**
+   * Request tiles around the specified pixel locations, e.g. along
+   * the predicted flight path.  Unlike PollTiles(), this never
+   * disposes loaded tiles, and gives up when the maximum number of
+   * active tiles has been reached.  Tiles near the first locations
+   * are preferred.
+   *
+   * @return true if tiles have been requested
+   */
+  bool PrefetchTiles(const RasterLocation *locations, unsigned n,
+                     unsigned radius);
+
+  /**
+   * Decode the tiles requested by PollTiles() or PrefetchTiles().
+   * None of the tile loading methods modify anything which is
+   * accessed by readers, except for the atomic switch to a new tile
+   * table; however, calls to them must not overlap.
+   */
+  void DecodeTiles(const char *path);
+
+  /**
+   * Make the tiles decoded by DecodeTiles() visible, and remove the
+   * tiles disposed by PollTiles().  Requested tiles which have failed
+   * to decode are disabled permanently.  If anything has changed, a
+   * new tile table is published, and ReclaimTiles() must be called
+   * when all readers of the previous one are finished.
+   *
+   * @param prefetch true if the tiles were requested by
+   * PrefetchTiles()
+   * @return the number of tiles which were loaded
+   */
+  unsigned CommitTiles(bool prefetch);
+
+  /**
+   * Does ReclaimTiles() need to be called?
+   */
+  bool IsReclaimPending() const {
+    return reclaim_pending;
+  }
+
+  /**
+   * Free the memory of disposed tiles, and allow reusing the previous
+   * tile table.  Caller must ensure that no reader is still using
+   * the tile table which was replaced by the last CommitTiles() call.
+   */
+  void ReclaimTiles();
+
+  unsigned GetPrefetchHits() const {
+    return prefetch_hits;
+  }
+
   /**
    * Determines if there are still tiles scheduled to be loaded.  Call
    * this after UpdateTiles() to determine if UpdateTiles() should be
@@ -279,6 +512,18 @@ public:
   }
 
 private:
+  /**
+   * Build a new tile table from the current tile state, and make it
+   * visible to readers.
+   */
+  void PublishTiles();
+
+  /**
+   * Clear both tile tables and free all disposed tiles.  Only allowed
+   * while there are no readers.
+   */
+  void ResetTileTables();
+
   gcc_pure
   const MarkerSegmentInfo *
   FindMarkerSegment(uint32_t file_offset) const;
@@ -307,9 +552,6 @@ public:
     initialised = val;
   }
 
-protected:
-  bool PollTiles(int x, int y, unsigned radius);
-
 public:
   short GetMaxElevation() const {
     return overview.GetMaximum();
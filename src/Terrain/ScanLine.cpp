@@ -296,11 +296,12 @@ RasterTileCache::ScanTileLine(GridLocation start, GridLocation end,
     --start.tile_y;
   }
 
-  const RasterTile &tile = tiles.Get(start.tile_x, start.tile_y);
-  if (tile.IsEnabled())
-    tile.ScanLine(start.x, start.y, end.x, end.y,
-                  buffer + start.index, end.index - start.index,
-                  interpolate);
+  const RasterBuffer &data = GetTileBuffer(start.tile_x, start.tile_y);
+  if (data.IsDefined())
+    tiles.Get(start.tile_x, start.tile_y)
+      .ScanLine(data, start.x, start.y, end.x, end.y,
+                buffer + start.index, end.index - start.index,
+                interpolate);
   else
     /* need range checking in the overview buffer because its size may
        be rounded down, and then the "fine" location may exceed its
@@ -0,0 +1,67 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/TerrainPrefetch.hpp"
+#include "Terrain/RasterTerrain.hpp"
+#include "Geo/Math.hpp"
+
+void
+TerrainPrefetch::Update(const GeoPoint &_location, Angle _track,
+                        fixed _ground_speed)
+{
+  if (!clock.CheckUpdate(10000))
+    /* later */
+    return;
+
+  ScopeLock protect(mutex);
+  if (IsBusy())
+    /* still loading, skip this update */
+    return;
+
+  location = _location;
+  track = _track;
+  ground_speed = _ground_speed;
+
+  Trigger();
+}
+
+void
+TerrainPrefetch::Tick()
+{
+  GeoPoint path[PREDICTION_MINUTES];
+  for (unsigned i = 0; i < PREDICTION_MINUTES; ++i)
+    path[i] = FindLatitudeLongitude(location, track,
+                                    ground_speed * fixed((i + 1) * 60));
+
+  /* each call loads only a few tiles; repeat until everything has
+     been loaded, but check for the "stop" command in between */
+  while (!IsStopped()) {
+    mutex.Unlock();
+    const unsigned n = terrain.PrefetchTiles(path, PREDICTION_MINUTES,
+                                             fixed(5000));
+    mutex.Lock();
+
+    if (n == 0)
+      break;
+  }
+}
@@ -0,0 +1,112 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_PREFETCH_HPP
+#define XCSOAR_TERRAIN_PREFETCH_HPP
+
+#include "Thread/StandbyThread.hpp"
+#include "Time/PeriodClock.hpp"
+#include "Geo/GeoPoint.hpp"
+
+#include <stdint.h>
+
+class RasterTerrain;
+
+/**
+ * Counters which allow verifying that terrain tiles are loaded in
+ * background, without blocking other threads.
+ */
+struct TerrainPrefetchStatistics {
+  /**
+   * The number of tiles loaded by the prefetch thread.
+   */
+  unsigned tiles_prefetched;
+
+  /**
+   * The number of prefetched tiles which were later needed by the
+   * map view.
+   */
+  unsigned prefetch_hits;
+
+  /**
+   * The total time tile loading has spent waiting for readers of
+   * disposed tiles [us].  Readers never wait for tile loading.
+   */
+  uint64_t reader_wait_us;
+
+  /**
+   * The longest time tile loading has waited for readers [us].
+   */
+  unsigned max_reader_wait_us;
+
+  void Clear() {
+    tiles_prefetched = 0;
+    prefetch_hits = 0;
+    reader_wait_us = 0;
+    max_reader_wait_us = 0;
+  }
+};
+
+/**
+ * A thread which loads terrain tiles along the predicted flight path
+ * in background, so the tiles are already there when the map view
+ * and the calculations get there.
+ */
+class TerrainPrefetch final : private StandbyThread {
+  /**
+   * Predict the aircraft location for this number of minutes.
+   */
+  static constexpr unsigned PREDICTION_MINUTES = 10;
+
+  RasterTerrain &terrain;
+
+  PeriodClock clock;
+
+  GeoPoint location;
+  Angle track;
+  fixed ground_speed;
+
+public:
+  explicit TerrainPrefetch(RasterTerrain &_terrain)
+    :terrain(_terrain) {}
+
+  /**
+   * Stop the thread synchronously.  Must be called before the
+   * destructor.
+   */
+  void Stop() {
+    ScopeLock protect(mutex);
+    StandbyThread::Stop();
+  }
+
+  /**
+   * Submit the current aircraft state.  This method is rate-limited,
+   * so it may be called often.
+   */
+  void Update(const GeoPoint &location, Angle track, fixed ground_speed);
+
+protected:
+  virtual void Tick() override;
+};
+
+#endif
@@ -262,7 +262,12 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
   compare_projection = CompareProjection(map_projection);
 #endif
 
-  terrain_serial = terrain->GetSerial();
+  if (terrain_serial != terrain->GetSerial()) {
+    /* new terrain data has been loaded; the height matrix must be
+       scanned again, it cannot be shifted */
+    terrain_serial = terrain->GetSerial();
+    raster_renderer.Invalidate();
+  }
 
   last_sun_azimuth = sunazimuth;
 
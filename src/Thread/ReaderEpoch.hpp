@@ -0,0 +1,143 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_READER_EPOCH_HPP
+#define XCSOAR_THREAD_READER_EPOCH_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "OS/Sleep.h"
+
+#include <atomic>
+
+#ifndef WIN32
+#include <sched.h>
+#endif
+
+/**
+ * Synchronisation for read-copy-update data structures.  Readers
+ * announce themselves with Enter() and Leave(), which never block.
+ * A writer publishes a new version of the data, and then calls
+ * Synchronize() to wait until all readers which may still see the
+ * old version are finished, before disposing it.
+ *
+ * Readers are counted per epoch; only the parity of the epoch is
+ * relevant, because Synchronize() waits until the previous epoch has
+ * drained before returning.
+ */
+class ReaderEpoch : private NonCopyable {
+  /**
+   * The number of times Synchronize() checks the reader counter in a
+   * busy loop, before it starts yielding the CPU.
+   */
+  static constexpr unsigned SPIN_COUNT = 100;
+
+  /**
+   * The number of times Synchronize() yields the CPU, before it
+   * falls back to sleeping.
+   */
+  static constexpr unsigned YIELD_COUNT = 10;
+
+  std::atomic<unsigned> epoch;
+  std::atomic<unsigned> readers[2];
+
+public:
+  ReaderEpoch():epoch(0) {
+    readers[0] = 0;
+    readers[1] = 0;
+  }
+
+  /**
+   * Register a reader.  This may spin briefly when it races with
+   * Synchronize(), but it never waits for another thread.
+   *
+   * @return a token to be passed to Leave()
+   */
+  unsigned Enter() {
+    while (true) {
+      const unsigned e = epoch.load();
+      ++readers[e & 1];
+      if (epoch.load() == e)
+        return e;
+
+      /* Synchronize() has started a new epoch in the meantime; it
+         may not wait for us, so try again */
+      --readers[e & 1];
+    }
+  }
+
+  void Leave(unsigned e) {
+    --readers[e & 1];
+  }
+
+  /**
+   * Wait until all readers which have entered before this call have
+   * left.  Calls to this method must not overlap, and the calling
+   * thread must not be a reader itself.
+   */
+  void Synchronize() {
+    const unsigned e = epoch.fetch_add(1);
+    const std::atomic<unsigned> &r = readers[e & 1];
+
+    /* readers are usually short, and usually there are none at all:
+       spin and yield before sleeping for a whole scheduler tick */
+    for (unsigned i = 0; r.load() != 0; ++i) {
+      if (i < SPIN_COUNT)
+        continue;
+      else if (i < SPIN_COUNT + YIELD_COUNT)
+        YieldCPU();
+      else
+        Sleep(1);
+    }
+  }
+
+private:
+  static void YieldCPU() {
+#ifdef WIN32
+    ::Sleep(0);
+#else
+    sched_yield();
+#endif
+  }
+
+public:
+  /**
+   * A scope guard which registers a reader.
+   */
+  class Reader {
+    ReaderEpoch &epoch;
+    const unsigned token;
+
+  public:
+    explicit Reader(ReaderEpoch &_epoch)
+      :epoch(_epoch), token(epoch.Enter()) {}
+
+    ~Reader() {
+      epoch.Leave(token);
+    }
+
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+  };
+};
+
+#endif
@@ -158,7 +158,7 @@ public:
 #ifdef HAVE_POSIX
     pthread_mutex_lock(&mutex);
 
-    if (!value)
+    while (!value)
       pthread_cond_wait(&cond, &mutex);
 
     pthread_mutex_unlock(&mutex);
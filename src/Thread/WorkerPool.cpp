@@ -0,0 +1,131 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/WorkerPool.hpp"
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+#include <assert.h>
+
+WorkerPool::WorkerPool(unsigned concurrency)
+  :n_workers(0), job(NULL), n_items(0), next_item(0), stop(false)
+{
+  assert(concurrency > 0);
+
+  if (concurrency > MAX_CONCURRENCY)
+    concurrency = MAX_CONCURRENCY;
+
+  while (n_workers + 1 < concurrency) {
+    Worker *worker = new Worker(*this);
+    if (!worker->Start()) {
+      /* continue with the threads we have; the caller takes part
+         anyway */
+      delete worker;
+      break;
+    }
+
+    workers[n_workers++] = worker;
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  stop = true;
+
+  for (unsigned i = 0; i < n_workers; ++i)
+    workers[i]->start.Signal();
+
+  for (unsigned i = 0; i < n_workers; ++i) {
+    workers[i]->Join();
+    delete workers[i];
+  }
+}
+
+void
+WorkerPool::Work()
+{
+  unsigned i;
+  while ((i = next_item++) < n_items)
+    job->Process(i);
+}
+
+void
+WorkerPool::Run(Job &_job, unsigned n)
+{
+  assert(job == NULL);
+
+  if (n_workers == 0 || n < 2) {
+    for (unsigned i = 0; i < n; ++i)
+      _job.Process(i);
+    return;
+  }
+
+  job = &_job;
+  n_items = n;
+  next_item = 0;
+
+  /* the Trigger's mutex publishes the job to the workers */
+  for (unsigned i = 0; i < n_workers; ++i) {
+    workers[i]->done.Reset();
+    workers[i]->start.Signal();
+  }
+
+  Work();
+
+  for (unsigned i = 0; i < n_workers; ++i)
+    workers[i]->done.Wait();
+
+  job = NULL;
+}
+
+void
+WorkerPool::Worker::Run()
+{
+  while (true) {
+    start.Wait();
+    start.Reset();
+
+    if (pool.stop)
+      break;
+
+    pool.Work();
+    done.Signal();
+  }
+}
+
+unsigned
+WorkerPool::GetProcessorCount()
+{
+#ifdef HAVE_POSIX
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (unsigned)n : 1;
+#else
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#endif
+}
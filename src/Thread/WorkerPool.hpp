@@ -0,0 +1,119 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_WORKER_POOL_HPP
+#define XCSOAR_THREAD_WORKER_POOL_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Trigger.hpp"
+
+#include <atomic>
+
+/**
+ * A small set of threads which process the items of a #Job in
+ * parallel.  The calling thread takes part in the work, and Run()
+ * returns only after all items have been processed, so the job may
+ * refer to data on the caller's stack.
+ *
+ * Each item is processed exactly once, but the order and the thread
+ * are undefined.  Jobs must not call Run() recursively.
+ */
+class WorkerPool : private NonCopyable {
+public:
+  /**
+   * The maximum number of threads (including the caller) which may
+   * work on a job.
+   */
+  static constexpr unsigned MAX_CONCURRENCY = 8;
+
+  class Job {
+  public:
+    /**
+     * Process one item.  This may be called from any thread of the
+     * pool, concurrently with other items.
+     */
+    virtual void Process(unsigned i) = 0;
+  };
+
+private:
+  class Worker final : public Thread {
+    WorkerPool &pool;
+
+  public:
+    Trigger start, done;
+
+    explicit Worker(WorkerPool &_pool):pool(_pool) {}
+
+  protected:
+    virtual void Run() override;
+  };
+
+  Worker *workers[MAX_CONCURRENCY - 1];
+  unsigned n_workers;
+
+  Job *job;
+  unsigned n_items;
+  std::atomic<unsigned> next_item;
+
+  bool stop;
+
+public:
+  /**
+   * Create the pool and start its threads.
+   *
+   * @param concurrency the number of threads which work on a job,
+   * including the caller of Run(); 1 means no additional threads
+   */
+  explicit WorkerPool(unsigned concurrency);
+
+  /**
+   * Stop and join all threads.
+   */
+  ~WorkerPool();
+
+  /**
+   * Returns the number of threads which work on a job, including the
+   * caller of Run().
+   */
+  unsigned GetConcurrency() const {
+    return n_workers + 1;
+  }
+
+  /**
+   * Call Job::Process() for all items [0, n), and wait until all of
+   * them are finished.  Must not be called by more than one thread at
+   * a time.
+   */
+  void Run(Job &job, unsigned n);
+
+  /**
+   * Returns the number of processors in this system, at least 1.
+   */
+  static unsigned GetProcessorCount();
+
+private:
+  void Work();
+};
+
+#endif
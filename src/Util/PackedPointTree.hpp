@@ -0,0 +1,623 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PACKED_POINT_TREE_HPP
+#define XCSOAR_PACKED_POINT_TREE_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * An immutable spatial index of points, bulk-loaded from a vector of
+ * values.  The values are sorted along a Hilbert curve and stored in
+ * one contiguous array, and their coordinates are copied to two
+ * separate arrays which are all that the inner loops of the queries
+ * read.  Each run of #LEAF_SIZE values forms a leaf, and
+ * each run of #FANOUT nodes gets a parent; the bounding boxes of all
+ * nodes live in one flat array, level by level, and the tree
+ * structure is implicit in the indices.
+ *
+ * Values cannot be added after Build().  Erase() only marks a value
+ * as erased, and Replace() overwrites it in place, enlarging the
+ * bounding boxes if it moves.  To index objects which are owned
+ * elsewhere, T may be a pointer type.
+ *
+ * The query methods have the same semantics as the ones of
+ * #QuadTree: ranges are circular, and distances are squared.
+ */
+template<typename T, typename Accessor>
+class PackedPointTree : private NonCopyable {
+  struct AlwaysTrue {
+    constexpr
+    bool operator()(const T &value) const {
+      return true;
+    }
+  };
+
+public:
+  typedef int position_type;
+  typedef uint64_t distance_type;
+
+  /**
+   * The number of values in one leaf.
+   */
+  static constexpr unsigned LEAF_SIZE = 16;
+
+  /**
+   * The number of children of an inner node.
+   */
+  static constexpr unsigned FANOUT = 16;
+
+  /**
+   * Returned by Find() if the value does not exist.
+   */
+  static constexpr unsigned NOT_FOUND = ~0u;
+
+  class const_iterator;
+
+private:
+  struct Node {
+    position_type left, bottom, right, top;
+
+    Node(position_type x, position_type y)
+      :left(x), bottom(y), right(x), top(y) {}
+
+    void Include(position_type x, position_type y) {
+      left = std::min(left, x);
+      right = std::max(right, x);
+      bottom = std::min(bottom, y);
+      top = std::max(top, y);
+    }
+
+    void Include(const Node &other) {
+      left = std::min(left, other.left);
+      right = std::max(right, other.right);
+      bottom = std::min(bottom, other.bottom);
+      top = std::max(top, other.top);
+    }
+
+    /**
+     * The square distance from the specified point to the nearest
+     * point of this box.
+     */
+    gcc_pure
+    distance_type SquareDistanceTo(position_type x, position_type y) const {
+      const int64_t dx = x < left
+        ? int64_t(left) - x
+        : (x > right ? int64_t(x) - right : 0);
+      const int64_t dy = y < bottom
+        ? int64_t(bottom) - y
+        : (y > top ? int64_t(y) - top : 0);
+      return Square(dx) + Square(dy);
+    }
+  };
+
+  /**
+   * The values, sorted along the Hilbert curve.
+   */
+  std::vector<T> values;
+
+  /**
+   * The coordinates of the values, in the same order.
+   */
+  std::vector<position_type> xs, ys;
+
+  /**
+   * A non-zero element marks an erased value.
+   */
+  std::vector<uint8_t> erased;
+
+  unsigned n_erased;
+
+  /**
+   * The bounding boxes of all nodes, level by level starting with
+   * the leaves; the root is the last element.
+   */
+  std::vector<Node> nodes;
+
+  /**
+   * The index of the first node of each level in #nodes, followed
+   * by the size of #nodes.
+   */
+  std::vector<unsigned> level_offsets;
+
+public:
+  PackedPointTree():n_erased(0) {}
+
+  /**
+   * Calculate the square of this number.
+   */
+  gcc_const
+  static distance_type Square(int64_t x) {
+    return distance_type(x * x);
+  }
+
+  /**
+   * Replace the contents with copies of the values in the specified
+   * range.
+   */
+  template<typename I>
+  void Build(I begin, I end);
+
+  void Clear() {
+    values.clear();
+    xs.clear();
+    ys.clear();
+    erased.clear();
+    n_erased = 0;
+    nodes.clear();
+    level_offsets.clear();
+  }
+
+  /**
+   * Has this object been built from a non-empty vector?  This
+   * remains true after all values have been erased.
+   */
+  gcc_pure
+  bool IsBuilt() const {
+    return !values.empty();
+  }
+
+  /**
+   * Returns the number of values which have not been erased.
+   */
+  gcc_pure
+  unsigned size() const {
+    return values.size() - n_erased;
+  }
+
+  gcc_pure
+  bool IsEmpty() const {
+    return size() == 0;
+  }
+
+  /**
+   * Find the index of the specified value (which has not been
+   * erased) with a point query at its position.  If the position of
+   * the value has changed since it was indexed, it will not be
+   * found.
+   *
+   * @return the index or #NOT_FOUND
+   */
+  gcc_pure
+  unsigned Find(const T &value) const {
+    if (values.empty())
+      return NOT_FOUND;
+
+    const Accessor accessor;
+    return Find(GetHeight() - 1, 0,
+                accessor.GetX(value), accessor.GetY(value), value);
+  }
+
+  /**
+   * Mark the specified value as erased.  It is skipped by all
+   * queries and by iteration, but it is not destructed until the
+   * next Build() or Clear().
+   */
+  void Erase(unsigned i) {
+    assert(i < values.size());
+    assert(!erased[i]);
+
+    erased[i] = 1;
+    ++n_erased;
+  }
+
+  /**
+   * Overwrite the specified value and Update() its position.
+   */
+  template<typename U>
+  void Replace(unsigned i, U &&value) {
+    assert(i < values.size());
+    assert(!erased[i]);
+
+    values[i] = std::forward<U>(value);
+    Update(i);
+  }
+
+  /**
+   * Read the position of the specified value again, after the
+   * object it refers to has been modified.  The bounding boxes of
+   * its ancestors are enlarged if necessary; they are never shrunk,
+   * so moving values far away makes queries slower until the next
+   * Build().
+   */
+  void Update(unsigned i) {
+    assert(i < values.size());
+
+    const Accessor accessor;
+    const position_type x = accessor.GetX(values[i]);
+    const position_type y = accessor.GetY(values[i]);
+    if (x == xs[i] && y == ys[i])
+      return;
+
+    xs[i] = x;
+    ys[i] = y;
+
+    unsigned node = i / LEAF_SIZE;
+    for (unsigned level = 0, height = GetHeight(); level < height;
+         ++level, node /= FANOUT)
+      nodes[level_offsets[level] + node].Include(x, y);
+  }
+
+  /**
+   * Find the nearest value within the specified range which matches
+   * the predicate.
+   *
+   * @return a pointer to the value (nullptr if none was found) and
+   * its square distance
+   */
+  template<class P>
+  gcc_pure
+  std::pair<const T *, distance_type>
+  FindNearestIf(position_type x, position_type y, distance_type range,
+                const P &predicate) const {
+    NearestSearch<P> search(x, y, Square(range), predicate);
+    if (!values.empty())
+      SearchNearest(GetHeight() - 1, 0, search);
+    return std::make_pair(search.best, search.best_distance);
+  }
+
+  gcc_pure
+  std::pair<const T *, distance_type>
+  FindNearest(position_type x, position_type y, distance_type range) const {
+    return FindNearestIf(x, y, range, AlwaysTrue());
+  }
+
+  /**
+   * Call the visitor with all values within the specified range.
+   */
+  template<class V>
+  void VisitWithinRange(position_type x, position_type y, distance_type range,
+                        V &visitor) const {
+    const distance_type square_range = Square(range);
+    if (!values.empty() && nodes.back().SquareDistanceTo(x, y) <= square_range)
+      VisitWithinRange(GetHeight() - 1, 0, x, y, square_range, visitor);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(*this, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(*this, values.size());
+  }
+
+  /**
+   * Iterates over all values which have not been erased, in
+   * Hilbert curve order.
+   */
+  class const_iterator {
+    friend class PackedPointTree;
+
+    const PackedPointTree *tree;
+    unsigned i;
+
+    const_iterator(const PackedPointTree &_tree, unsigned _i)
+      :tree(&_tree), i(_i) {
+      SkipErased();
+    }
+
+    void SkipErased() {
+      while (i < tree->values.size() && tree->erased[i])
+        ++i;
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef ptrdiff_t difference_type;
+    typedef const T value_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+
+    const_iterator():tree(nullptr), i(0) {}
+
+    const_iterator &operator++() {
+      ++i;
+      SkipErased();
+      return *this;
+    }
+
+    const T &operator*() const {
+      return tree->values[i];
+    }
+
+    const T *operator->() const {
+      return &tree->values[i];
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return i == other.i;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return i != other.i;
+    }
+  };
+
+private:
+  gcc_pure
+  unsigned GetHeight() const {
+    return level_offsets.size() - 1;
+  }
+
+  gcc_pure
+  unsigned GetLevelSize(unsigned level) const {
+    return level_offsets[level + 1] - level_offsets[level];
+  }
+
+  gcc_pure
+  const Node &GetNode(unsigned level, unsigned i) const {
+    return nodes[level_offsets[level] + i];
+  }
+
+  gcc_pure
+  distance_type SquareDistanceTo(unsigned i,
+                                 position_type x, position_type y) const {
+    return Square(int64_t(xs[i]) - x) + Square(int64_t(ys[i]) - y);
+  }
+
+  /**
+   * The resolution of the Hilbert curve in each dimension [bits].
+   */
+  static constexpr unsigned HILBERT_BITS = 16;
+
+  /**
+   * Calculate the distance of the specified cell along the Hilbert
+   * curve.  Unlike the Z-order curve, consecutive cells are always
+   * adjacent, so the leaves of the tree have small bounding boxes.
+   */
+  gcc_const
+  static uint32_t HilbertKey(uint32_t x, uint32_t y) {
+    constexpr uint32_t n = 1u << HILBERT_BITS;
+    uint32_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+      const uint32_t rx = (x & s) != 0;
+      const uint32_t ry = (y & s) != 0;
+      d += s * s * ((3 * rx) ^ ry);
+
+      if (ry == 0) {
+        if (rx != 0) {
+          x = n - 1 - x;
+          y = n - 1 - y;
+        }
+
+        std::swap(x, y);
+      }
+    }
+
+    return d;
+  }
+
+  void BuildNodes();
+
+  gcc_pure
+  unsigned Find(unsigned level, unsigned node,
+                position_type x, position_type y, const T &value) const {
+    if (level == 0) {
+      const unsigned begin = node * LEAF_SIZE;
+      const unsigned end = std::min(begin + LEAF_SIZE,
+                                    unsigned(values.size()));
+      for (unsigned i = begin; i != end; ++i)
+        if (xs[i] == x && ys[i] == y && !erased[i] && values[i] == value)
+          return i;
+    } else {
+      const unsigned begin = node * FANOUT;
+      const unsigned end = std::min(begin + FANOUT, GetLevelSize(level - 1));
+      for (unsigned i = begin; i != end; ++i) {
+        if (GetNode(level - 1, i).SquareDistanceTo(x, y) > 0)
+          continue;
+
+        const unsigned found = Find(level - 1, i, x, y, value);
+        if (found != NOT_FOUND)
+          return found;
+      }
+    }
+
+    return NOT_FOUND;
+  }
+
+  template<class V>
+  void VisitWithinRange(unsigned level, unsigned node,
+                        position_type x, position_type y,
+                        distance_type square_range, V &visitor) const {
+    if (level == 0) {
+      const unsigned begin = node * LEAF_SIZE;
+      const unsigned end = std::min(begin + LEAF_SIZE,
+                                    unsigned(values.size()));
+      for (unsigned i = begin; i != end; ++i)
+        if (SquareDistanceTo(i, x, y) <= square_range && !erased[i])
+          visitor((const T &)values[i]);
+    } else {
+      const unsigned begin = node * FANOUT;
+      const unsigned end = std::min(begin + FANOUT, GetLevelSize(level - 1));
+      for (unsigned i = begin; i != end; ++i)
+        if (GetNode(level - 1, i).SquareDistanceTo(x, y) <= square_range)
+          VisitWithinRange(level - 1, i, x, y, square_range, visitor);
+    }
+  }
+
+  template<class P>
+  struct NearestSearch {
+    position_type x, y;
+    const P &predicate;
+
+    const T *best;
+    distance_type best_distance;
+
+    NearestSearch(position_type _x, position_type _y,
+                  distance_type square_range, const P &_predicate)
+      :x(_x), y(_y), predicate(_predicate),
+       best(nullptr), best_distance(square_range) {}
+  };
+
+  template<class P>
+  void SearchNearest(unsigned level, unsigned node,
+                     NearestSearch<P> &search) const {
+    if (level == 0) {
+      const unsigned begin = node * LEAF_SIZE;
+      const unsigned end = std::min(begin + LEAF_SIZE,
+                                    unsigned(values.size()));
+      for (unsigned i = begin; i != end; ++i) {
+        const distance_type d = SquareDistanceTo(i, search.x, search.y);
+        if (d <= search.best_distance && !erased[i] &&
+            search.predicate(values[i])) {
+          search.best = &values[i];
+          search.best_distance = d;
+        }
+      }
+
+      return;
+    }
+
+    /* visit the children nearest first, so the search range shrinks
+       quickly */
+    std::pair<distance_type, unsigned> children[FANOUT];
+    unsigned n_children = 0;
+
+    const unsigned begin = node * FANOUT;
+    const unsigned end = std::min(begin + FANOUT, GetLevelSize(level - 1));
+    for (unsigned i = begin; i != end; ++i) {
+      const distance_type d =
+        GetNode(level - 1, i).SquareDistanceTo(search.x, search.y);
+      if (d <= search.best_distance)
+        children[n_children++] = std::make_pair(d, i);
+    }
+
+    std::sort(children, children + n_children);
+
+    for (unsigned i = 0; i < n_children; ++i)
+      if (children[i].first <= search.best_distance)
+        SearchNearest(level - 1, children[i].second, search);
+  }
+};
+
+template<typename T, typename Accessor>
+template<typename I>
+void
+PackedPointTree<T, Accessor>::Build(I begin, I end)
+{
+  Clear();
+
+  std::vector<T> source(begin, end);
+  if (source.empty())
+    return;
+
+  const unsigned n = source.size();
+
+  /* read all positions first, in the order of the source, which is
+     faster if T is a pointer */
+  const Accessor accessor;
+  std::vector<position_type> source_xs, source_ys;
+  source_xs.reserve(n);
+  source_ys.reserve(n);
+  for (const auto &i : source) {
+    source_xs.push_back(accessor.GetX(i));
+    source_ys.push_back(accessor.GetY(i));
+  }
+
+  Node bounds(source_xs.front(), source_ys.front());
+  for (unsigned i = 1; i < n; ++i)
+    bounds.Include(source_xs[i], source_ys[i]);
+
+  /* scale the bounds down to the resolution of the curve */
+  unsigned shift = 0;
+  while (((uint32_t(bounds.right) - uint32_t(bounds.left)) >> shift) >=
+         (1u << HILBERT_BITS) ||
+         ((uint32_t(bounds.top) - uint32_t(bounds.bottom)) >> shift) >=
+         (1u << HILBERT_BITS))
+    ++shift;
+
+  /* the curve position in the upper half, the source index in the
+     lower half */
+  std::vector<uint64_t> keys;
+  keys.reserve(n);
+  for (unsigned i = 0; i < n; ++i) {
+    const uint32_t x =
+      (uint32_t(source_xs[i]) - uint32_t(bounds.left)) >> shift;
+    const uint32_t y =
+      (uint32_t(source_ys[i]) - uint32_t(bounds.bottom)) >> shift;
+    keys.push_back((uint64_t(HilbertKey(x, y)) << 32) | i);
+  }
+
+  std::sort(keys.begin(), keys.end());
+
+  values.reserve(n);
+  xs.reserve(n);
+  ys.reserve(n);
+  for (const auto key : keys) {
+    const unsigned i = uint32_t(key);
+    values.push_back(std::move(source[i]));
+    xs.push_back(source_xs[i]);
+    ys.push_back(source_ys[i]);
+  }
+
+  erased.assign(values.size(), 0);
+
+  BuildNodes();
+}
+
+template<typename T, typename Accessor>
+void
+PackedPointTree<T, Accessor>::BuildNodes()
+{
+  const unsigned n = values.size();
+  nodes.reserve(n / LEAF_SIZE + n / (LEAF_SIZE * (FANOUT - 1)) + 2);
+
+  level_offsets.push_back(0);
+
+  for (unsigned begin = 0; begin < n; begin += LEAF_SIZE) {
+    Node node(xs[begin], ys[begin]);
+    const unsigned end = std::min(begin + LEAF_SIZE, n);
+    for (unsigned i = begin + 1; i < end; ++i)
+      node.Include(xs[i], ys[i]);
+    nodes.push_back(node);
+  }
+
+  level_offsets.push_back(nodes.size());
+
+  while (GetLevelSize(GetHeight() - 1) > 1) {
+    const unsigned level_begin = level_offsets[GetHeight() - 1];
+    const unsigned level_end = level_offsets[GetHeight()];
+
+    for (unsigned begin = level_begin; begin < level_end; begin += FANOUT) {
+      Node node = nodes[begin];
+      const unsigned end = std::min(begin + FANOUT, level_end);
+      for (unsigned i = begin + 1; i < end; ++i)
+        node.Include(nodes[i]);
+      nodes.push_back(node);
+    }
+
+    level_offsets.push_back(nodes.size());
+  }
+}
+
+#endif
@@ -0,0 +1,291 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "WaypointCache.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
+#include "Compiler.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
+struct WaypointCacheHeader {
+  enum {
+    MAGIC = 0x50594157,
+    VERSION = 1,
+  };
+
+  uint32_t magic, version;
+
+  /**
+   * The size of #WaypointCacheRecord and of TCHAR; a cache file
+   * written by a different build is rejected.
+   */
+  uint32_t record_size, char_size;
+
+  uint32_t n_waypoints;
+
+  /**
+   * The number of characters in the string table, including the
+   * null terminators.
+   */
+  uint32_t n_chars;
+
+  /**
+   * The offset of the original file's path in the string table.
+   */
+  uint32_t path;
+
+  uint32_t reserved;
+};
+
+/**
+ * The attributes of one #Waypoint which are known after parsing.
+ * Strings are stored as offsets into the string table, which follows
+ * the records.
+ */
+struct WaypointCacheRecord {
+  GeoPoint location;
+  fixed elevation;
+  uint32_t original_id;
+  uint32_t name, comment, details;
+  Runway runway;
+  RadioFrequency radio_frequency;
+  Waypoint::Type type;
+  Waypoint::Flags flags;
+  int8_t file_num;
+};
+
+/**
+ * Sections are aligned to this many bytes, relative to the beginning
+ * of the (page aligned) mapping.
+ */
+static constexpr size_t ALIGNMENT = 16;
+
+static constexpr size_t
+AlignOffset(size_t offset)
+{
+  return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+static bool
+AlignFile(FILE *file)
+{
+  long position = ftell(file);
+  if (position < 0)
+    return false;
+
+  for (; position % ALIGNMENT != 0; ++position)
+    if (fputc(0, file) == EOF)
+      return false;
+
+  return true;
+}
+
+/**
+ * Collects null-terminated strings, storing each distinct value only
+ * once.
+ */
+class StringTableBuilder {
+  std::vector<TCHAR> chars;
+  std::map<tstring, uint32_t> offsets;
+
+public:
+  uint32_t Add(const tstring &value) {
+    const auto i = offsets.find(value);
+    if (i != offsets.end())
+      return i->second;
+
+    const uint32_t offset = chars.size();
+    chars.insert(chars.end(), value.begin(), value.end());
+    chars.push_back(_T('\0'));
+    offsets.insert(std::make_pair(value, offset));
+    return offset;
+  }
+
+  uint32_t Add(const TCHAR *value) {
+    return Add(tstring(value));
+  }
+
+  const std::vector<TCHAR> &GetChars() const {
+    return chars;
+  }
+};
+
+static bool
+SaveWaypointCache(FILE *file, const TCHAR *path,
+                  const Waypoint *const*begin, const Waypoint *const*end)
+{
+  StringTableBuilder strings;
+
+  WaypointCacheHeader header;
+  header.magic = WaypointCacheHeader::MAGIC;
+  header.version = WaypointCacheHeader::VERSION;
+  header.record_size = sizeof(WaypointCacheRecord);
+  header.char_size = sizeof(TCHAR);
+  header.n_waypoints = end - begin;
+  header.path = strings.Add(path);
+  header.reserved = 0;
+
+  std::vector<WaypointCacheRecord> records;
+  records.reserve(end - begin);
+  for (auto i = begin; i != end; ++i) {
+    const Waypoint &waypoint = **i;
+
+    WaypointCacheRecord record;
+    /* clear the padding, to make the file reproducible */
+    memset(&record, 0, sizeof(record));
+    record.location = waypoint.location;
+    record.elevation = waypoint.elevation;
+    record.original_id = waypoint.original_id;
+    record.name = strings.Add(waypoint.name);
+    record.comment = strings.Add(waypoint.comment);
+    record.details = strings.Add(waypoint.details);
+    record.runway = waypoint.runway;
+    record.radio_frequency = waypoint.radio_frequency;
+    record.type = waypoint.type;
+    record.flags = waypoint.flags;
+    record.file_num = waypoint.file_num;
+    records.push_back(record);
+  }
+
+  const std::vector<TCHAR> &chars = strings.GetChars();
+  header.n_chars = chars.size();
+
+  return AlignFile(file) &&
+    fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(records.data(), sizeof(records.front()), records.size(),
+           file) == records.size() &&
+    fwrite(chars.data(), sizeof(chars.front()), chars.size(),
+           file) == chars.size();
+}
+
+bool
+SaveWaypointCache(FileCache &cache, const TCHAR *name, const TCHAR *path,
+                  const Waypoint *const*begin, const Waypoint *const*end)
+{
+  FILE *file = cache.Save(name, path);
+  if (file == NULL)
+    return false;
+
+  if (!SaveWaypointCache(file, path, begin, end)) {
+    cache.Cancel(name, file);
+    return false;
+  }
+
+  return cache.Commit(name, file);
+}
+
+/**
+ * Check the header and the bounds of all sections.
+ *
+ * @return the header, or NULL if the cache file is not usable
+ */
+gcc_pure
+static const WaypointCacheHeader *
+CheckWaypointCache(const FileMapping &mapping, size_t offset,
+                   const TCHAR *path)
+{
+  const size_t size = mapping.size();
+
+  offset = AlignOffset(offset);
+  if (offset > size || size - offset < sizeof(WaypointCacheHeader))
+    return NULL;
+
+  const WaypointCacheHeader &header =
+    *(const WaypointCacheHeader *)mapping.at(offset);
+  if (header.magic != WaypointCacheHeader::MAGIC ||
+      header.version != WaypointCacheHeader::VERSION ||
+      header.record_size != sizeof(WaypointCacheRecord) ||
+      header.char_size != sizeof(TCHAR) ||
+      header.n_chars == 0)
+    return NULL;
+
+  size_t available = size - offset - sizeof(header);
+  if (header.n_waypoints > available / sizeof(WaypointCacheRecord))
+    return NULL;
+
+  available -= header.n_waypoints * sizeof(WaypointCacheRecord);
+  if (header.n_chars > available / sizeof(TCHAR))
+    return NULL;
+
+  const WaypointCacheRecord *records =
+    (const WaypointCacheRecord *)(&header + 1);
+  const TCHAR *strings = (const TCHAR *)(records + header.n_waypoints);
+  if (strings[header.n_chars - 1] != _T('\0') ||
+      header.path >= header.n_chars ||
+      _tcscmp(strings + header.path, path) != 0)
+    return NULL;
+
+  for (unsigned i = 0; i < header.n_waypoints; ++i)
+    if (records[i].name >= header.n_chars ||
+        records[i].comment >= header.n_chars ||
+        records[i].details >= header.n_chars)
+      return NULL;
+
+  return &header;
+}
+
+bool
+LoadWaypointCache(Waypoints &waypoints, FileCache &cache,
+                  const TCHAR *name, const TCHAR *path)
+{
+  size_t offset;
+  const std::unique_ptr<FileMapping> mapping(cache.Map(name, path, offset));
+  if (!mapping)
+    return false;
+
+  const WaypointCacheHeader *header =
+    CheckWaypointCache(*mapping, offset, path);
+  if (header == NULL) {
+    cache.Flush(name);
+    return false;
+  }
+
+  const WaypointCacheRecord *records =
+    (const WaypointCacheRecord *)(header + 1);
+  const TCHAR *strings = (const TCHAR *)(records + header->n_waypoints);
+
+  for (auto i = records, end = records + header->n_waypoints; i != end; ++i) {
+    Waypoint waypoint(i->location);
+    waypoint.original_id = i->original_id;
+    waypoint.elevation = i->elevation;
+    waypoint.runway = i->runway;
+    waypoint.radio_frequency = i->radio_frequency;
+    waypoint.type = i->type;
+    waypoint.flags = i->flags;
+    waypoint.file_num = i->file_num;
+    waypoint.name = strings + i->name;
+    waypoint.comment = strings + i->comment;
+    waypoint.details = strings + i->details;
+
+    waypoints.Append(std::move(waypoint));
+  }
+
+  return true;
+}
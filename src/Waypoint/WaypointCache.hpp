@@ -0,0 +1,71 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_WAYPOINT_CACHE_HPP
+#define XCSOAR_WAYPOINT_CACHE_HPP
+
+#include <tchar.h>
+
+struct Waypoint;
+class Waypoints;
+class FileCache;
+
+/*
+ * A binary snapshot of the waypoints parsed from one file, stored in
+ * the #FileCache.  It contains fixed-size records and a table of
+ * (deduplicated) strings, and is loaded with a single mapping of the
+ * cache file.  The cache is keyed by the size and modification time
+ * of the original file and by its path.
+ *
+ * The waypoints are stored in the order they were parsed, so
+ * Waypoints::Append() assigns the same ids when they are loaded
+ * from the cache.
+ */
+
+/**
+ * Append the waypoints stored in the specified cache file to the
+ * #Waypoints object.  Optimise() must be called afterwards, as after
+ * parsing the original file.
+ *
+ * @param name the name of the cache file
+ * @param path the path of the original waypoint file
+ * @return true on success, false if the cache file does not exist
+ * or is not valid for the given file (nothing is appended in this
+ * case)
+ */
+bool
+LoadWaypointCache(Waypoints &waypoints, FileCache &cache,
+                  const TCHAR *name, const TCHAR *path);
+
+/**
+ * Save the specified waypoints, which were parsed from the given
+ * file, to the cache.
+ *
+ * @param begin the waypoints in the order they were parsed
+ * @return true on success
+ */
+bool
+SaveWaypointCache(FileCache &cache, const TCHAR *name, const TCHAR *path,
+                  const Waypoint *const*begin, const Waypoint *const*end);
+
+#endif
@@ -28,6 +28,7 @@ Copyright_License {
 #include "LogFile.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "WaypointReader.hpp"
+#include "WaypointCache.hpp"
 #include "Language/Language.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Airspace/ProtectedAirspaceWarningManager.hpp"
@@ -38,6 +39,9 @@ Copyright_License {
 
 #include <windef.h> /* for MAX_PATH */
 
+#include <algorithm>
+#include <vector>
+
 namespace WaypointGlue {
   bool GetPath(int file_number, TCHAR *value);
   bool IsWritable(int file_number);
@@ -82,16 +86,49 @@ WaypointGlue::IsWritable()
   return IsWritable(1) || IsWritable(2) || IsWritable(3);
 }
 
+static bool
+CompareId(const Waypoint *a, const Waypoint *b)
+{
+  return a->id < b->id;
+}
+
+/**
+ * Save the waypoints which were appended after the one with the
+ * specified id (i.e. the ones parsed from the file) to the cache.
+ */
+static void
+SaveWaypointFileCache(const Waypoints &waypoints, unsigned first_id,
+                      FileCache &cache, const TCHAR *cache_name,
+                      const TCHAR *path)
+{
+  std::vector<const Waypoint *> parsed;
+  for (const auto &i : waypoints)
+    if (i.id >= first_id)
+      parsed.push_back(&i);
+
+  std::sort(parsed.begin(), parsed.end(), CompareId);
+
+  if (!SaveWaypointCache(cache, cache_name, path,
+                         parsed.data(), parsed.data() + parsed.size()))
+    LogStartUp(_T("Failed to save waypoint cache: %s"), cache_name);
+}
+
 static bool
 LoadWaypointFile(Waypoints &waypoints, const TCHAR *path, int file_num,
+                 const TCHAR *cache_name, FileCache *cache,
                  const RasterTerrain *terrain, OperationEnvironment &operation)
 {
+  if (cache != NULL && LoadWaypointCache(waypoints, *cache, cache_name, path))
+    return true;
+
   WaypointReader reader(path, file_num);
   if (reader.Error()) {
     LogStartUp(_T("Failed to open waypoint file: %s"), path);
     return false;
   }
 
+  const unsigned first_id = waypoints.GetNextId();
+
   // parse the file
   reader.SetTerrain(terrain);
   if (!reader.Parse(waypoints, operation)) {
@@ -99,12 +136,18 @@ LoadWaypointFile(Waypoints &waypoints, const TCHAR *path, int file_num,
     return false;
   }
 
+  /* elevations looked up in the terrain are not cached, because the
+     terrain may change independently of the waypoint file */
+  if (cache != NULL && !reader.IsTerrainDependent())
+    SaveWaypointFileCache(waypoints, first_id, *cache, cache_name, path);
+
   return true;
 }
 
 bool
 WaypointGlue::LoadWaypoints(Waypoints &way_points,
                             const RasterTerrain *terrain,
+                            FileCache *cache,
                             OperationEnvironment &operation)
 {
   LogFormat("ReadWaypoints");
@@ -119,15 +162,18 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
 
   // ### FIRST FILE ###
   if (Profile::GetPath(ProfileKeys::WaypointFile, path))
-    found |= LoadWaypointFile(way_points, path, 1, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 1, _T("waypoints1"),
+                              cache, terrain, operation);
 
   // ### SECOND FILE ###
   if (Profile::GetPath(ProfileKeys::AdditionalWaypointFile, path))
-    found |= LoadWaypointFile(way_points, path, 2, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 2, _T("waypoints2"),
+                              cache, terrain, operation);
 
   // ### WATCHED WAYPOINT/THIRD FILE ###
   if (Profile::GetPath(ProfileKeys::WatchedWaypointFile, path))
-    found |= LoadWaypointFile(way_points, path, 3, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 3, _T("waypoints3"),
+                              cache, terrain, operation);
 
   // ### MAP/FOURTH FILE ###
 
@@ -136,10 +182,12 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
     TCHAR *tail = path + _tcslen(path);
 
     _tcscpy(tail, _T("/waypoints.xcw"));
-    found |= LoadWaypointFile(way_points, path, 0, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 0, _T("waypoints-map-xcw"),
+                              cache, terrain, operation);
 
     _tcscpy(tail, _T("/waypoints.cup"));
-    found |= LoadWaypointFile(way_points, path, 0, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 0, _T("waypoints-map-cup"),
+                              cache, terrain, operation);
   }
 
   // Optimise the waypoint list after attaching new waypoints
@@ -82,6 +82,14 @@ public:
   /** Sets the terrain that should be used for waypoint elevation detection */
   void SetTerrain(const RasterTerrain* _terrain);
 
+  /**
+   * Did the last Parse() call look up waypoint elevations in the
+   * terrain (or drop waypoints because there was no terrain)?
+   */
+  bool IsTerrainDependent() const {
+    return reader != NULL && reader->IsTerrainDependent();
+  }
+
   /**
    * Parses the waypoint file into the given Waypoints instance
    * @param way_points A Waypoints instance that will hold the parsed waypoints
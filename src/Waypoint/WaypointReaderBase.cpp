@@ -35,7 +35,8 @@ WaypointReaderBase::WaypointReaderBase(const int _file_num,
                            bool _compressed):
   file_num(_file_num),
   terrain(NULL),
-  compressed(_compressed)
+  compressed(_compressed),
+  terrain_dependent(false)
 {
 }
 
@@ -156,8 +157,9 @@ WaypointReaderBase::CheckAltitude(Waypoint &new_waypoint,
 }
 
 bool
-WaypointReaderBase::CheckAltitude(Waypoint &new_waypoint) const
+WaypointReaderBase::CheckAltitude(Waypoint &new_waypoint)
 {
+  terrain_dependent = true;
   return CheckAltitude(new_waypoint, terrain);
 }
 
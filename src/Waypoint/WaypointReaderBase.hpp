@@ -41,6 +41,12 @@ protected:
   const RasterTerrain* terrain;
   bool compressed;
 
+  /**
+   * Set when the elevation of a waypoint was missing in the file,
+   * i.e. the result of Parse() depends on the terrain.
+   */
+  bool terrain_dependent;
+
 protected:
   WaypointReaderBase(const int _file_num,
                bool _compressed = false);
@@ -61,9 +67,13 @@ public:
     terrain = _terrain;
   }
 
+  bool IsTerrainDependent() const {
+    return terrain_dependent;
+  }
+
 protected:
   static bool CheckAltitude(Waypoint &new_waypoint, const RasterTerrain *terrain);
-  bool CheckAltitude(Waypoint &new_waypoint) const;
+  bool CheckAltitude(Waypoint &new_waypoint);
 
   /**
    * Parse a file line
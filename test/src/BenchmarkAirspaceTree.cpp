@@ -0,0 +1,158 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Load an airspace file and compare the build time and the query
+ * latency of the kd-tree and the R-tree backend of #Airspaces.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "OS/Clock.hpp"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned N = 100000;
+
+struct CountVisitor {
+  unsigned n;
+
+  CountVisitor():n(0) {}
+
+  void operator()(const Airspace &airspace) {
+    ++n;
+  }
+};
+
+struct AlwaysTrue {
+  bool operator()(const Airspace &airspace) const {
+    return true;
+  }
+};
+
+/**
+ * Generate query locations close to the airspaces, like an aircraft
+ * flying through the country.
+ */
+static std::vector<FlatGeoPoint>
+MakeLocations(const Airspaces &airspaces)
+{
+  std::vector<const Airspace *> all;
+  for (const auto &i : airspaces)
+    all.push_back(&i);
+
+  std::vector<FlatGeoPoint> locations;
+  for (unsigned i = 0; i < N; ++i) {
+    const FlatGeoPoint center = all[rand() % all.size()]->GetCenter();
+    locations.push_back(FlatGeoPoint(center.longitude + rand() % 200 - 100,
+                                     center.latitude + rand() % 200 - 100));
+  }
+
+  return locations;
+}
+
+static void
+Report(const char *backend, const char *name, uint64_t start,
+       unsigned n_found)
+{
+  const uint64_t us = MonotonicClockUS() - start;
+  printf("%-8s %-14s %8.3f us/query %8.1f found/query\n",
+         backend, name, double(us) / N, double(n_found) / N);
+}
+
+template<typename Tree>
+static void
+Benchmark(const char *backend, const Airspaces &airspaces,
+          const std::vector<FlatGeoPoint> &locations, int range)
+{
+  Tree tree;
+
+  uint64_t start = MonotonicClockUS();
+  for (const auto &i : airspaces)
+    tree.insert(i);
+  tree.optimise();
+  printf("%-8s %-14s %8u us\n", backend, "build",
+         unsigned(MonotonicClockUS() - start));
+
+  CountVisitor visitor;
+  start = MonotonicClockUS();
+  for (const auto &i : locations)
+    tree.visit_within_range(FlatBoundingBox(i), -range, visitor);
+  Report(backend, "within range", start, visitor.n);
+
+  CountVisitor inside;
+  start = MonotonicClockUS();
+  for (const auto &i : locations)
+    tree.visit_within_range(FlatBoundingBox(i), 0, inside);
+  Report(backend, "inside", start, inside.n);
+
+  unsigned n_nearest = 0;
+  start = MonotonicClockUS();
+  for (const auto &i : locations)
+    if (tree.find_nearest_if(FlatBoundingBox(i), BBDist(0, range),
+                             AlwaysTrue()).first != tree.end())
+      ++n_nearest;
+  Report(backend, "nearest", start, n_nearest);
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = argc > 1 ? argv[1] : "test/data/AirspaceAus-DAA.txt";
+
+  FileLineReader reader(path, ConvertLineReader::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  Airspaces airspaces;
+  AirspaceParser parser(airspaces);
+
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  airspaces.Optimise();
+  printf("%u airspaces\n", airspaces.size());
+  if (airspaces.empty())
+    return EXIT_SUCCESS;
+
+  srand(42);
+  const std::vector<FlatGeoPoint> locations = MakeLocations(airspaces);
+
+  /* a typical search range of the map and the warnings */
+  const GeoPoint center = airspaces.GetProjection().GetCenter();
+  const int range =
+    airspaces.GetProjection().ProjectRangeInteger(center, fixed(20000));
+
+  Benchmark<Airspaces::AirspaceKDTree>("kdtree", airspaces, locations, range);
+  Benchmark<AirspaceRTree>("rtree", airspaces, locations, range);
+
+  return EXIT_SUCCESS;
+}
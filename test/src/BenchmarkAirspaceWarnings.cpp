@@ -0,0 +1,155 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Load an airspace file, fly straight legs between random airspaces
+ * and measure the cost of AirspaceWarningManager::Update().
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/AirspaceWarningConfig.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "OS/Clock.hpp"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned N_LEGS = 20;
+
+/**
+ * The maximum duration of one leg [s].
+ */
+static constexpr unsigned MAX_LEG_TIME = 3600;
+
+/**
+ * The cruise speed of the simulated glider [m/s].
+ */
+static constexpr unsigned SPEED = 40;
+
+static GeoPoint
+RandomLocation(const std::vector<const Airspace *> &all,
+               const TaskProjection &projection)
+{
+  return projection.Unproject(all[rand() % all.size()]->GetCenter());
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = argc > 1 ? argv[1] : "test/data/AirspaceAus-DAA.txt";
+
+  FileLineReader reader(path, ConvertLineReader::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  Airspaces airspaces;
+  AirspaceParser parser(airspaces);
+
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  airspaces.Optimise();
+  printf("%u airspaces\n", airspaces.size());
+  if (airspaces.empty())
+    return EXIT_SUCCESS;
+
+  std::vector<const Airspace *> all;
+  for (const auto &i : airspaces)
+    all.push_back(&i);
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  AirspaceWarningManager manager(airspaces);
+  manager.SetConfig(config);
+
+  const GlidePolar glide_polar(fixed(1));
+
+  TaskStats task_stats;
+  task_stats.task_valid = false;
+
+  AircraftState state;
+  state.Reset();
+  state.altitude = fixed(1500);
+  state.ground_speed = state.true_airspeed = fixed(SPEED);
+  state.flying = true;
+  state.location = RandomLocation(all, airspaces.GetProjection());
+  manager.Reset(state);
+
+  srand(42);
+
+  unsigned n_updates = 0, n_changed = 0, n_warnings = 0;
+  unsigned long n_tests = 0;
+  uint64_t total_us = 0, max_us = 0;
+
+  for (unsigned leg = 0; leg < N_LEGS; ++leg) {
+    const GeoPoint destination = RandomLocation(all, airspaces.GetProjection());
+    const unsigned n_steps =
+      std::min(unsigned(state.location.Distance(destination)) / SPEED,
+               MAX_LEG_TIME);
+    state.track = state.location.Bearing(destination);
+
+    for (unsigned i = 0; i < n_steps; ++i) {
+      state.time += fixed(1);
+      state.location = state.GetPredictedState(fixed(1)).location;
+
+      const uint64_t start = MonotonicClockUS();
+      if (manager.Update(state, glide_polar, task_stats, false, 1))
+        ++n_changed;
+      const uint64_t us = MonotonicClockUS() - start;
+
+      total_us += us;
+      max_us = std::max(max_us, us);
+      ++n_updates;
+      n_tests += manager.GetStatistics().tests;
+      n_warnings += manager.size();
+    }
+  }
+
+  if (n_updates == 0)
+    return EXIT_SUCCESS;
+
+  const AirspaceWarningManager::Statistics &statistics =
+    manager.GetStatistics();
+
+  printf("%u updates, %8.3f us/update, max %u us\n",
+         n_updates, double(total_us) / n_updates, unsigned(max_us));
+  printf("%u corridor refreshes, %u candidates, %.1f tests/update\n",
+         statistics.refreshes, statistics.candidates,
+         double(n_tests) / n_updates);
+  printf("%u changes, %.2f warnings/update\n",
+         n_changed, double(n_warnings) / n_updates);
+
+  return EXIT_SUCCESS;
+}
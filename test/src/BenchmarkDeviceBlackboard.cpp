@@ -0,0 +1,306 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the lock contention in the DeviceBlackboard.
+ * Four threads parse NMEA lines into the per-device data, like
+ * DeviceDescriptor::ParseLine() does, while another thread merges
+ * and copies the blackboard like MergeThread and CalculationThread
+ * do.  The wait and hold times of each lock are recorded, once with
+ * the parsers locking the global blackboard mutex (the old behaviour)
+ * and once with only the per-device mutex, e.g.:
+ *
+ *   BenchmarkDeviceBlackboard [SECONDS [LINE_RATE [MERGE_RATE]]]
+ *
+ * LINE_RATE is the number of lines parsed per second by each device
+ * (default 1000), MERGE_RATE is the number of merges per second
+ * (default 200).
+ */
+
+#include "Blackboard/DeviceBlackboard.hpp"
+#include "Device/Parser.hpp"
+#include "Device/All.hpp"
+#include "NMEA/Checksum.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
+#include "Protection.hpp"
+#include "Thread/Thread.hpp"
+#include "OS/Clock.hpp"
+#include "OS/Sleep.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void
+TriggerMergeThread()
+{
+}
+
+void
+AllDevicesPutMacCready(fixed mac_cready, OperationEnvironment &env)
+{
+}
+
+void
+AllDevicesPutBugs(fixed bugs, OperationEnvironment &env)
+{
+}
+
+void
+AllDevicesPutBallast(fixed fraction, fixed overload,
+                     OperationEnvironment &env)
+{
+}
+
+void
+AllDevicesPutQNH(const AtmosphericPressure &pressure,
+                 OperationEnvironment &env)
+{
+}
+
+static constexpr unsigned N_DEVICES = 4;
+
+static const char *const sentences[] = {
+  "$GPRMC,082310,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.0,W",
+  "$GPGGA,082310,5103.5403,N,00741.5742,E,1,06,1.2,262.0,M,47.9,M,,",
+  "$GPGSA,A,3,01,02,03,04,05,06,,,,,,,1.8,1.2,1.4",
+  "$PGRMZ,2447,F,2",
+  "$PFLAU,3,1,2,1,2,-30,2,-32,755",
+  "$PFLAA,0,-1234,1234,220,2,DD8F12,180,,30,-1.4,1",
+};
+
+/**
+ * Wait and hold times of one lock.
+ */
+struct LockStatistics {
+  std::vector<unsigned> wait, hold;
+
+  void Add(uint64_t locking, uint64_t locked, uint64_t unlocked) {
+    wait.push_back(locked - locking);
+    hold.push_back(unlocked - locked);
+  }
+
+  void Add(const LockStatistics &other) {
+    wait.insert(wait.end(), other.wait.begin(), other.wait.end());
+    hold.insert(hold.end(), other.hold.begin(), other.hold.end());
+  }
+};
+
+static void
+Print(const char *name, std::vector<unsigned> &values)
+{
+  if (values.empty())
+    return;
+
+  std::sort(values.begin(), values.end());
+
+  uint64_t sum = 0;
+  for (auto i : values)
+    sum += i;
+
+  const unsigned n = values.size();
+  printf("  %s: mean %.2f us, 99%% %u us, 99.9%% %u us, max %u us\n",
+         name, double(sum) / n, values[n * 99 / 100],
+         values[n * 999 / 1000], values.back());
+}
+
+/**
+ * Waits until the specified point in time; gives up the CPU only if
+ * it is more than one millisecond away.
+ */
+static void
+WaitUntil(uint64_t due)
+{
+  const uint64_t now = MonotonicClockUS();
+  if (due > now + 1000)
+    Sleep((due - now) / 1000);
+}
+
+class DeviceThread final : public Thread {
+  DeviceBlackboard &blackboard;
+  const unsigned index;
+  const bool global_lock;
+  const unsigned rate;
+  const std::vector<std::string> &lines;
+  const std::atomic<bool> &stop;
+
+public:
+  LockStatistics statistics;
+
+  DeviceThread(DeviceBlackboard &_blackboard, unsigned _index,
+               bool _global_lock, unsigned _rate,
+               const std::vector<std::string> &_lines,
+               const std::atomic<bool> &_stop)
+    :blackboard(_blackboard), index(_index), global_lock(_global_lock),
+     rate(_rate), lines(_lines), stop(_stop) {}
+
+protected:
+  virtual void Run() override {
+    NMEAParser parser;
+    Mutex &device_mutex = blackboard.GetDeviceMutex(index);
+
+    const uint64_t start = MonotonicClockUS();
+    for (unsigned n = 0; !stop.load(std::memory_order_relaxed); ++n) {
+      WaitUntil(start + uint64_t(n) * 1000000 / rate);
+
+      const char *line = lines[n % lines.size()].c_str();
+
+      const uint64_t locking = MonotonicClockUS();
+      if (global_lock)
+        blackboard.mutex.Lock();
+      device_mutex.Lock();
+      const uint64_t locked = MonotonicClockUS();
+
+      NMEAInfo &basic = blackboard.SetRealState(index);
+      basic.UpdateClock();
+      if (parser.ParseLine(line, basic))
+        basic.alive.Update(basic.clock);
+
+      device_mutex.Unlock();
+      if (global_lock)
+        blackboard.mutex.Unlock();
+      const uint64_t unlocked = MonotonicClockUS();
+
+      statistics.Add(locking, locked, unlocked);
+    }
+  }
+};
+
+/**
+ * Does what MergeThread::Tick() and CalculationThread::Tick() do
+ * with the global blackboard mutex held: merge the device data and
+ * copy the results.
+ */
+class BlackboardThread final : public Thread {
+  DeviceBlackboard &blackboard;
+  const unsigned rate;
+  const std::atomic<bool> &stop;
+
+public:
+  LockStatistics statistics;
+
+  BlackboardThread(DeviceBlackboard &_blackboard, unsigned _rate,
+              const std::atomic<bool> &_stop)
+    :blackboard(_blackboard), rate(_rate), stop(_stop) {}
+
+protected:
+  virtual void Run() override {
+    MoreData basic;
+    DerivedInfo calculated;
+
+    const uint64_t start = MonotonicClockUS();
+    for (unsigned n = 0; !stop.load(std::memory_order_relaxed); ++n) {
+      WaitUntil(start + uint64_t(n) * 1000000 / rate);
+
+      const uint64_t locking = MonotonicClockUS();
+      blackboard.mutex.Lock();
+      const uint64_t locked = MonotonicClockUS();
+
+      blackboard.Merge();
+      basic = blackboard.Basic();
+      calculated = blackboard.Calculated();
+      blackboard.ReadBlackboard(calculated);
+
+      blackboard.mutex.Unlock();
+      const uint64_t unlocked = MonotonicClockUS();
+
+      statistics.Add(locking, locked, unlocked);
+    }
+  }
+};
+
+static void
+Run(bool global_lock, unsigned seconds, unsigned line_rate,
+    unsigned merge_rate, const std::vector<std::string> &lines)
+{
+  DeviceBlackboard blackboard;
+  std::atomic<bool> stop(false);
+
+  DeviceThread *devices[N_DEVICES];
+  for (unsigned i = 0; i < N_DEVICES; ++i)
+    devices[i] = new DeviceThread(blackboard, i, global_lock, line_rate,
+                                  lines, stop);
+
+  BlackboardThread merge(blackboard, merge_rate, stop);
+
+  for (auto *device : devices)
+    device->Start();
+  merge.Start();
+
+  Sleep(seconds * 1000);
+  stop.store(true, std::memory_order_relaxed);
+
+  merge.Join();
+
+  LockStatistics parse;
+  for (auto *device : devices) {
+    device->Join();
+    parse.Add(device->statistics);
+    delete device;
+  }
+
+  printf("%s: %u lines, %u merges\n",
+         global_lock ? "global mutex" : "per-device mutex",
+         unsigned(parse.wait.size()), unsigned(merge.statistics.wait.size()));
+  Print("parse wait", parse.wait);
+  Print("parse hold", parse.hold);
+  Print("merge wait", merge.statistics.wait);
+  Print("merge hold", merge.statistics.hold);
+}
+
+int
+main(int argc, char **argv)
+{
+  if (argc > 4) {
+    fprintf(stderr, "Usage: %s [SECONDS [LINE_RATE [MERGE_RATE]]]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const unsigned seconds = argc > 1 ? atoi(argv[1]) : 3;
+  const unsigned line_rate = argc > 2 ? atoi(argv[2]) : 1000;
+  const unsigned merge_rate = argc > 3 ? atoi(argv[3]) : 200;
+  if (seconds == 0 || line_rate == 0 || merge_rate == 0) {
+    fprintf(stderr, "Invalid arguments\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> lines;
+  for (const char *sentence : sentences) {
+    char buffer[256];
+    strcpy(buffer, sentence);
+    AppendNMEAChecksum(buffer);
+    lines.push_back(buffer);
+  }
+
+  Run(true, seconds, line_rate, merge_rate, lines);
+  Run(false, seconds, line_rate, merge_rate, lines);
+
+  return EXIT_SUCCESS;
+}
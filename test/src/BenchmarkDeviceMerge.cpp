@@ -0,0 +1,300 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures DeviceBlackboard::Merge() with a synthetic
+ * load of four devices: a GPS, a barometric altimeter, a FLARM with
+ * the specified number of targets and a second GPS.  After each
+ * parsed line, the blackboard is merged, once with Merge() and once
+ * with the old implementation, which merged all devices from scratch
+ * and whose TrafficList::Complement() copied the whole FLARM traffic
+ * list with the assignment operator, e.g.:
+ *
+ *   BenchmarkDeviceMerge [TRAFFIC [MERGES]]
+ *
+ * TRAFFIC is the number of FLARM targets (default 3), MERGES the
+ * number of merges in each run (default 200000).  Each run is done
+ * with lines from all devices in turn, and then with lines from only
+ * one of them, while the others stay alive.
+ */
+
+#include "Blackboard/DeviceBlackboard.hpp"
+#include "Device/Parser.hpp"
+#include "Device/All.hpp"
+#include "NMEA/Checksum.hpp"
+#include "Protection.hpp"
+#include "OS/Clock.hpp"
+#include "Compiler.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void
+TriggerMergeThread()
+{
+}
+
+void
+AllDevicesPutMacCready(fixed mac_cready, OperationEnvironment &env)
+{
+}
+
+void
+AllDevicesPutBugs(fixed bugs, OperationEnvironment &env)
+{
+}
+
+void
+AllDevicesPutBallast(fixed fraction, fixed overload,
+                     OperationEnvironment &env)
+{
+}
+
+void
+AllDevicesPutQNH(const AtmosphericPressure &pressure,
+                 OperationEnvironment &env)
+{
+}
+
+static constexpr unsigned N_DEVICES = 4;
+
+/** the index of the simulated FLARM */
+static constexpr unsigned FLARM_DEVICE = 2;
+
+static std::string
+MakeLine(const char *sentence)
+{
+  char buffer[256];
+  strcpy(buffer, sentence);
+  AppendNMEAChecksum(buffer);
+  return buffer;
+}
+
+/**
+ * A simulated device: parses its lines one after another into its
+ * slot of the #DeviceBlackboard.
+ */
+struct SyntheticDevice {
+  std::vector<std::string> lines;
+  NMEAParser parser;
+  unsigned next;
+
+  SyntheticDevice():next(0) {}
+
+  void Add(const char *sentence) {
+    lines.push_back(MakeLine(sentence));
+  }
+
+  void ParseNext(DeviceBlackboard &blackboard, unsigned index) {
+    ScopeLock protect(blackboard.GetDeviceMutex(index));
+    NMEAInfo &basic = blackboard.SetRealState(index);
+    basic.UpdateClock();
+    if (parser.ParseLine(lines[next].c_str(), basic))
+      basic.alive.Update(basic.clock);
+
+    next = (next + 1) % lines.size();
+  }
+};
+
+/**
+ * The old DeviceBlackboard::Merge(), for comparison.  The result is
+ * copied to #basic instead of the blackboard.
+ */
+static void
+LegacyMerge(DeviceBlackboard &blackboard, NMEAInfo &real_data,
+            NMEAInfo &basic)
+{
+  real_data.Reset();
+  for (unsigned i = 0; i < NUMDEV; ++i) {
+    ScopeLock protect(blackboard.GetDeviceMutex(i));
+    NMEAInfo &device = blackboard.SetRealState(i);
+    if (!device.alive)
+      continue;
+
+    device.UpdateClock();
+    device.Expire();
+
+    const bool had_traffic = !real_data.flarm.traffic.IsEmpty();
+    real_data.Complement(device);
+    if (!had_traffic && !device.flarm.traffic.IsEmpty())
+      /* the old TrafficList::Complement() used the assignment
+         operator */
+      real_data.flarm.traffic = device.flarm.traffic;
+  }
+
+  basic = real_data;
+}
+
+/**
+ * The number of bytes copied by the struct copies of one legacy
+ * merge: the traffic list of the first device which has traffic, and
+ * the result.
+ */
+gcc_pure
+static size_t
+GetLegacyCopiedBytes(const NMEAInfo &basic)
+{
+  size_t n = sizeof(NMEAInfo);
+  if (!basic.flarm.traffic.IsEmpty())
+    n += sizeof(TrafficList);
+
+  return n;
+}
+
+/**
+ * Follows the bookkeeping of DeviceBlackboard::Merge() to count the
+ * bytes copied by its struct copies: resuming from the merged data
+ * of the unmodified devices, keeping the merged data before the
+ * modified device, the used entries of the traffic list when the
+ * FLARM is merged again, and the result.  All devices are alive and
+ * nothing expires during the benchmark.
+ */
+class MergeCopyCounter {
+  bool merged_valid[NUMDEV];
+
+public:
+  MergeCopyCounter() {
+    std::fill_n(merged_valid, NUMDEV, false);
+  }
+
+  size_t Merge(const NMEAInfo &basic, unsigned modified) {
+    size_t n = sizeof(NMEAInfo);
+
+    unsigned i = modified;
+    while (i > 0 && !merged_valid[i - 1])
+      --i;
+
+    if (i > 0)
+      n += sizeof(NMEAInfo);
+
+    for (; i < NUMDEV; ++i) {
+      if (i == FLARM_DEVICE && !basic.flarm.traffic.IsEmpty()) {
+        const unsigned n_unused = TrafficList::MAX_COUNT -
+          basic.flarm.traffic.GetActiveTrafficCount();
+        n += sizeof(TrafficList) - n_unused * sizeof(FlarmTraffic);
+      }
+
+      merged_valid[i] = i + 1 == modified;
+      if (merged_valid[i])
+        n += sizeof(NMEAInfo);
+    }
+
+    return n;
+  }
+};
+
+/**
+ * @param only the index of the only device which receives lines, or
+ * N_DEVICES if all devices receive lines in turn
+ */
+static void
+Run(bool legacy, unsigned n_merges, SyntheticDevice *devices,
+    unsigned only)
+{
+  DeviceBlackboard blackboard;
+  NMEAInfo real_data, basic;
+  MergeCopyCounter counter;
+
+  /* fill the blackboard before measuring */
+  for (unsigned i = 0; i < N_DEVICES; ++i)
+    for (unsigned j = 0; j < devices[i].lines.size(); ++j)
+      devices[i].ParseNext(blackboard, i);
+
+  uint64_t merge_time = 0, copied = 0;
+  for (unsigned n = 0; n < n_merges; ++n) {
+    const unsigned modified = only < N_DEVICES ? only : n % N_DEVICES;
+    devices[modified].ParseNext(blackboard, modified);
+
+    ScopeLock protect(blackboard.mutex);
+    const uint64_t start = MonotonicClockUS();
+    if (legacy)
+      LegacyMerge(blackboard, real_data, basic);
+    else
+      blackboard.Merge();
+    merge_time += MonotonicClockUS() - start;
+
+    copied += legacy
+      ? GetLegacyCopiedBytes(basic)
+      : counter.Merge(blackboard.Basic(), modified);
+  }
+
+  char load[32];
+  if (only < N_DEVICES)
+    sprintf(load, "device %u", only);
+  else
+    strcpy(load, "all devices");
+
+  printf("%s, %s: %u merges in %u ms, %u merges/s, "
+         "%u bytes copied per merge\n",
+         legacy ? "legacy" : "Merge()", load, n_merges,
+         unsigned(merge_time / 1000),
+         unsigned(uint64_t(n_merges) * 1000000 /
+                  (merge_time > 0 ? merge_time : 1)),
+         unsigned(copied / n_merges));
+}
+
+int
+main(int argc, char **argv)
+{
+  if (argc > 3) {
+    fprintf(stderr, "Usage: %s [TRAFFIC [MERGES]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const unsigned n_traffic = argc > 1 ? atoi(argv[1]) : 3;
+  const unsigned n_merges = argc > 2 ? atoi(argv[2]) : 200000;
+  if (n_traffic > TrafficList::MAX_COUNT || n_merges == 0) {
+    fprintf(stderr, "Invalid arguments\n");
+    return EXIT_FAILURE;
+  }
+
+  SyntheticDevice devices[N_DEVICES];
+
+  devices[0].Add("$GPRMC,082310,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.0,W");
+  devices[0].Add("$GPGGA,082310,5103.5403,N,00741.5742,E,1,06,1.2,262.0,M,47.9,M,,");
+
+  devices[1].Add("$PGRMZ,2447,F,2");
+
+  devices[FLARM_DEVICE].Add("$PFLAU,3,1,2,1,2,-30,2,-32,755");
+  for (unsigned i = 0; i < n_traffic; ++i) {
+    char buffer[128];
+    sprintf(buffer, "$PFLAA,0,%d,%d,220,2,DD%04X,180,,30,-1.4,1",
+            -1000 + 100 * (int)i, 1000 - 50 * (int)i, 0x1000 + i);
+    devices[FLARM_DEVICE].Add(buffer);
+  }
+
+  devices[3].Add("$GPRMC,082311,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.0,W");
+  devices[3].Add("$GPGSA,A,3,01,02,03,04,05,06,,,,,,,1.8,1.2,1.4");
+
+  for (unsigned only = 0; only <= N_DEVICES; ++only) {
+    Run(true, n_merges, devices, only);
+    Run(false, n_merges, devices, only);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the conversion of a height matrix to color
+ * table indices (the CPU part of RasterRenderer::GenerateImage()) at
+ * several screen resolutions, comparing the scalar and the
+ * vectorized implementation.
+ */
+
+#include "Terrain/HillShading.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "OS/Clock.hpp"
+
+#include <stdio.h>
+
+static void
+FillMatrix(short *matrix, unsigned width, unsigned height)
+{
+  /* rolling hills with some ridges, similar to a real terrain file */
+  for (unsigned y = 0; y < height; ++y) {
+    for (unsigned x = 0; x < width; ++x) {
+      const unsigned a = (x * 7 + y * 3) % 512, b = (x * 2 + y * 5) % 300;
+      matrix[y * width + x] = 200 + (a < 256 ? a : 511 - a) * 3 +
+        (b < 150 ? b : 299 - b) * 2;
+    }
+  }
+}
+
+/**
+ * @return the duration of one image [us]
+ */
+static unsigned
+Run(const short *matrix, unsigned width, unsigned height,
+    const HillShading::Parameters &parameters, uint16_t *dest,
+    unsigned &checksum)
+{
+  static constexpr unsigned ITERATIONS = 20;
+
+  const uint64_t start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < ITERATIONS; ++i) {
+    for (unsigned y = 0; y < height; ++y) {
+      HillShading::ShadedRow(matrix, width, height, y, parameters, dest);
+
+      /* prevent gcc from optimizing this loop away */
+      checksum += dest[y % width];
+    }
+  }
+
+  return (MonotonicClockUS() - start) / ITERATIONS;
+}
+
+int main(int argc, char **argv)
+{
+  static constexpr unsigned resolutions[][2] = {
+    { 320, 240 },
+    { 800, 480 },
+    { 1280, 720 },
+    { 1920, 1080 },
+  };
+
+  HillShading::Parameters parameters;
+  parameters.sx = 0;
+  parameters.sy = -132;
+  parameters.sz = 217;
+  parameters.contrast = 64;
+  parameters.height_scale = 4;
+  parameters.height_slope_factor = 60;
+  parameters.quantisation = 1;
+
+  printf("SIMD: %s\n", HillShading::HaveSIMD() ? "yes" : "no");
+
+  for (auto &resolution : resolutions) {
+    const unsigned width = resolution[0], height = resolution[1];
+
+    AllocatedArray<short> matrix(width * height);
+    FillMatrix(matrix.begin(), width, height);
+
+    AllocatedArray<uint16_t> dest(width);
+
+    unsigned scalar_checksum = 0, simd_checksum = 0;
+
+    parameters.simd = false;
+    const unsigned scalar = Run(matrix.begin(), width, height, parameters,
+                                dest.begin(), scalar_checksum);
+
+    parameters.simd = true;
+    const unsigned simd = Run(matrix.begin(), width, height, parameters,
+                              dest.begin(), simd_checksum);
+
+    printf("%4ux%-4u scalar=%6uus simd=%6uus%s\n",
+           width, height, scalar, simd,
+           scalar_checksum == simd_checksum ? "" : " MISMATCH");
+  }
+
+  return 0;
+}
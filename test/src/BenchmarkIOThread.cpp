@@ -0,0 +1,291 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the dispatch latency of the IOThread with
+ * many file descriptors.  It opens the specified number of
+ * pseudo-terminals and registers their master side with an IOThread.
+ * Then it writes single bytes to the slave side of random terminals,
+ * one at a time, and measures the time until the handler is invoked.
+ * Between these, terminals are removed from and added to the
+ * IOThread, to stress its incremental updates.  Finally, it writes to
+ * all terminals at once, to measure how fast a burst of events is
+ * dispatched, e.g.:
+ *
+ *   BenchmarkIOThread [PTYS [ROUNDS]]
+ *
+ * PTYS defaults to 48, ROUNDS to 2000.
+ */
+
+#include "IO/Async/IOThread.hpp"
+#include "IO/Async/FileEventHandler.hpp"
+#include "OS/TTYDescriptor.hpp"
+#include "OS/Clock.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+
+/**
+ * Remove and add a terminal every this number of rounds.
+ */
+static constexpr unsigned CHURN_INTERVAL = 4;
+
+static constexpr unsigned BURSTS = 100;
+
+static Mutex mutex;
+static Cond cond;
+
+/**
+ * The number of events received since the last Reset(), protected
+ * by #mutex.
+ */
+static unsigned n_received;
+
+class PseudoTerminal final : public FileEventHandler {
+  TTYDescriptor master, slave;
+
+public:
+  /**
+   * The time the last byte was received.  Protected by #mutex.
+   */
+  uint64_t received_time;
+
+  bool Open() {
+    if (!master.OpenNonBlocking("/dev/ptmx") || !master.Unlock())
+      return false;
+
+    const char *slave_name = master.GetSlaveName();
+    if (slave_name == NULL || !slave.Open(slave_name, O_RDWR | O_NOCTTY))
+      return false;
+
+    /* disable the line discipline's output processing */
+    struct termios attr;
+    if (!slave.GetAttr(attr))
+      return false;
+
+    cfmakeraw(&attr);
+    return slave.SetAttr(TCSANOW, attr);
+  }
+
+  int GetFD() const {
+    return master.Get();
+  }
+
+  bool Send() {
+    return slave.Write("x", 1) == 1;
+  }
+
+  virtual bool OnFileEvent(int fd, unsigned mask) override {
+    char buffer[64];
+    const ssize_t nbytes = master.Read(buffer, sizeof(buffer));
+    if (nbytes < 0)
+      return errno == EAGAIN || errno == EINTR;
+
+    if (nbytes == 0)
+      return false;
+
+    const uint64_t now = MonotonicClockUS();
+
+    ScopeLock protect(mutex);
+    received_time = now;
+    ++n_received;
+    cond.Broadcast();
+    return true;
+  }
+};
+
+static void
+PrintStatistics(const char *name, std::vector<unsigned> &values)
+{
+  if (values.empty())
+    return;
+
+  std::sort(values.begin(), values.end());
+
+  uint64_t sum = 0;
+  for (auto i : values)
+    sum += i;
+
+  const unsigned n = values.size();
+  printf("%s: mean %u us, median %u us, 99%% %u us, max %u us\n",
+         name, unsigned(sum / n), values[n / 2],
+         values[n * 99 / 100], values.back());
+}
+
+/**
+ * Wait until #n_received has reached the specified value.  Caller
+ * must lock #mutex.
+ *
+ * @return false on timeout
+ */
+static bool
+WaitReceived(unsigned n)
+{
+  while (n_received < n)
+    if (!cond.Wait(mutex, 1000))
+      return false;
+
+  return true;
+}
+
+static bool
+RunSingle(IOThread &io_thread, std::vector<PseudoTerminal *> &ptys,
+          unsigned rounds)
+{
+  std::vector<unsigned> latencies, churn_times;
+  latencies.reserve(rounds);
+
+  for (unsigned i = 0; i < rounds; ++i) {
+    if (i % CHURN_INTERVAL == 0) {
+      /* remove and add a terminal */
+      PseudoTerminal &churn = *ptys[rand() % ptys.size()];
+      const uint64_t start = MonotonicClockUS();
+      io_thread.LockRemove(churn.GetFD());
+      io_thread.LockAdd(churn.GetFD(), IOThread::READ, churn);
+      churn_times.push_back(MonotonicClockUS() - start);
+    }
+
+    PseudoTerminal &pty = *ptys[rand() % ptys.size()];
+
+    ScopeLock protect(mutex);
+    n_received = 0;
+
+    const uint64_t sent_time = MonotonicClockUS();
+    if (!pty.Send()) {
+      fprintf(stderr, "Failed to write to the pseudo-terminal\n");
+      return false;
+    }
+
+    if (!WaitReceived(1)) {
+      fprintf(stderr, "Timeout\n");
+      return false;
+    }
+
+    latencies.push_back(pty.received_time - sent_time);
+  }
+
+  printf("%u single events on %u pseudo-terminals\n",
+         rounds, unsigned(ptys.size()));
+  PrintStatistics("dispatch latency", latencies);
+  PrintStatistics("remove+add", churn_times);
+  return true;
+}
+
+static bool
+RunBursts(std::vector<PseudoTerminal *> &ptys)
+{
+  std::vector<unsigned> latencies, burst_times;
+  latencies.reserve(BURSTS * ptys.size());
+
+  for (unsigned i = 0; i < BURSTS; ++i) {
+    ScopeLock protect(mutex);
+    n_received = 0;
+
+    const uint64_t sent_time = MonotonicClockUS();
+    for (auto *pty : ptys) {
+      if (!pty->Send()) {
+        fprintf(stderr, "Failed to write to the pseudo-terminal\n");
+        return false;
+      }
+    }
+
+    if (!WaitReceived(ptys.size())) {
+      fprintf(stderr, "Timeout\n");
+      return false;
+    }
+
+    uint64_t last = sent_time;
+    for (auto *pty : ptys) {
+      latencies.push_back(pty->received_time - sent_time);
+      last = std::max(last, pty->received_time);
+    }
+
+    burst_times.push_back(last - sent_time);
+  }
+
+  printf("%u bursts of %u events\n", BURSTS, unsigned(ptys.size()));
+  PrintStatistics("dispatch latency", latencies);
+  PrintStatistics("burst duration", burst_times);
+  return true;
+}
+
+int
+main(int argc, char **argv)
+{
+  if (argc > 3) {
+    fprintf(stderr, "Usage: %s [PTYS [ROUNDS]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const unsigned n_ptys = argc > 1 ? atoi(argv[1]) : 48;
+  const unsigned rounds = argc > 2 ? atoi(argv[2]) : 2000;
+  if (n_ptys == 0 || rounds == 0) {
+    fprintf(stderr, "Invalid arguments\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<PseudoTerminal *> ptys;
+  for (unsigned i = 0; i < n_ptys; ++i) {
+    PseudoTerminal *pty = new PseudoTerminal();
+    ptys.push_back(pty);
+
+    if (!pty->Open()) {
+      fprintf(stderr, "Failed to open pseudo-terminal #%u\n", i);
+      for (auto *p : ptys)
+        delete p;
+      return EXIT_FAILURE;
+    }
+  }
+
+  IOThread io_thread;
+  if (!io_thread.Start()) {
+    fprintf(stderr, "Failed to start the I/O thread\n");
+    for (auto *pty : ptys)
+      delete pty;
+    return EXIT_FAILURE;
+  }
+
+  for (auto *pty : ptys)
+    io_thread.LockAdd(pty->GetFD(), IOThread::READ, *pty);
+
+  const bool success = RunSingle(io_thread, ptys, rounds) &&
+    RunBursts(ptys);
+
+  for (auto *pty : ptys)
+    io_thread.LockRemove(pty->GetFD());
+
+  io_thread.Stop();
+
+  for (auto *pty : ptys)
+    delete pty;
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measure how many glide solutions per second MacCready and
+ * GlidePolar deliver for typical final glide, reach and speed-to-fly
+ * calculations.
+ */
+
+#include "Engine/GlideSolvers/GlideSettings.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/GlideSolvers/GlideState.hpp"
+#include "Engine/GlideSolvers/GlideBatch.hpp"
+#include "Engine/GlideSolvers/GlideResult.hpp"
+#include "Engine/GlideSolvers/MacCready.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "OS/Clock.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N = 256 * 1024;
+
+static GlideSettings glide_settings;
+
+/* prevent the compiler from optimising the calculations away */
+static volatile double sink;
+
+static void
+Report(const char *name, uint64_t start)
+{
+  const uint64_t us = MonotonicClockUS() - start;
+  printf("%-24s %10.0f calls/s\n", name,
+         us > 0 ? N * 1000000. / us : 0.);
+}
+
+static void
+BenchmarkSolve(const char *name, const GlidePolar &polar,
+               const SpeedVector wind)
+{
+  const uint64_t start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < N; ++i) {
+    /* vary the bearing like the reach and abort calculations do */
+    const GeoVector vector(fixed(10000), Angle::Degrees(int(i % 360)));
+    const GlideState state(vector, fixed(500), fixed(1500), wind);
+    sink = (double)MacCready::Solve(glide_settings, polar,
+                                    state).height_glide;
+  }
+
+  Report(name, start);
+}
+
+/**
+ * Compare solving 5000 destinations one by one with
+ * MacCready::SolveBatch().
+ */
+static void
+BenchmarkBatch(const char *name, const GlidePolar &polar,
+               const SpeedVector wind)
+{
+  static constexpr unsigned n_destinations = 5000;
+
+  const fixed altitude(1500);
+
+  std::vector<GeoVector> vectors;
+  std::vector<fixed> elevations;
+  for (unsigned i = 0; i < n_destinations; ++i) {
+    vectors.push_back(GeoVector(fixed(int(i * 17 % 80000)),
+                                Angle::Degrees(int(i % 360))));
+    elevations.push_back(fixed(int(i * 53 % 1200)));
+  }
+
+  std::vector<GlideResult> results(n_destinations);
+  const MacCready mac_cready(glide_settings, polar);
+
+  char buffer[64];
+
+  uint64_t start = MonotonicClockUS();
+  for (unsigned i = 0; i < N; i += n_destinations) {
+    for (unsigned j = 0; j < n_destinations; ++j) {
+      const GlideState state(vectors[j], elevations[j], altitude, wind);
+      results[j] = mac_cready.Solve(state);
+    }
+
+    sink = (double)results[i % n_destinations].height_glide;
+  }
+
+  snprintf(buffer, sizeof(buffer), "%s single", name);
+  Report(buffer, start);
+
+  GlideBatch batch;
+  batch.reserve(n_destinations);
+
+  start = MonotonicClockUS();
+  for (unsigned i = 0; i < N; i += n_destinations) {
+    batch.Reset(altitude, wind);
+    for (unsigned j = 0; j < n_destinations; ++j)
+      batch.Add(vectors[j], elevations[j]);
+
+    mac_cready.SolveBatch(batch, results.data());
+    sink = (double)results[i % n_destinations].height_glide;
+  }
+
+  snprintf(buffer, sizeof(buffer), "%s batch", name);
+  Report(buffer, start);
+}
+
+static void
+BenchmarkSpeedToFly(const GlidePolar &polar)
+{
+  AircraftState state;
+  state.Reset();
+  state.g_load = fixed(1);
+
+  GlideResult solution;
+  solution.Reset();
+
+  const uint64_t start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < N; ++i) {
+    state.netto_vario = fixed(int(i % 64) - 48) / 16;
+    sink = (double)polar.SpeedToFly(state, solution, false);
+  }
+
+  Report("speed to fly", start);
+}
+
+int
+main(gcc_unused int argc, gcc_unused char **argv)
+{
+  glide_settings.SetDefaults();
+
+  GlidePolar polar(fixed(0));
+
+  BenchmarkSolve("mc=0 no wind", polar, SpeedVector::Zero());
+  BenchmarkSolve("mc=0 wind 10 m/s", polar,
+                 SpeedVector(Angle::Degrees(270), fixed(10)));
+  BenchmarkBatch("mc=0", polar,
+                 SpeedVector(Angle::Degrees(270), fixed(10)));
+
+  polar.SetMC(fixed(1.5));
+  BenchmarkSolve("mc=1.5 wind 10 m/s", polar,
+                 SpeedVector(Angle::Degrees(270), fixed(10)));
+  BenchmarkBatch("mc=1.5", polar,
+                 SpeedVector(Angle::Degrees(270), fixed(10)));
+  BenchmarkSpeedToFly(polar);
+
+  return 0;
+}
@@ -0,0 +1,304 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the latency of the NMEA input path.  Like
+ * FeedNMEA, it feeds NMEA data read from stdin to a pseudo-TTY, paced
+ * at the specified baud rate (0 = as fast as possible).  The other
+ * end is received the way DeviceDescriptor does it: TTYPort,
+ * PortLineSplitter, forwarding to a NMEA out port (another
+ * pseudo-TTY) and parsing with the device driver while holding a
+ * mutex.  For each line, it records the time from read() returning
+ * the data to the point where DeviceDescriptor would call
+ * DeviceBlackboard::ScheduleMerge(), e.g.:
+ *
+ *   BenchmarkNMEALatency LX 115200 <flight.nmea
+ */
+
+#include "Device/Port/TTYPort.hpp"
+#include "Device/Port/LineSplitter.hpp"
+#include "Device/Port/NullPort.hpp"
+#include "Device/Driver.hpp"
+#include "Device/Register.hpp"
+#include "Device/Parser.hpp"
+#include "Profile/DeviceConfig.hpp"
+#include "NMEA/Info.hpp"
+#include "IO/Async/GlobalIOThread.hpp"
+#include "IO/DataHandler.hpp"
+#include "Thread/Mutex.hpp"
+#include "Operation/Operation.hpp"
+#include "OS/PathName.hpp"
+#include "OS/Clock.hpp"
+#include "OS/Sleep.h"
+#include "Util/StringUtil.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class DiscardHandler final : public DataHandler {
+public:
+  virtual void DataReceived(const void *data, size_t length) override {}
+};
+
+/**
+ * Receives lines like DeviceDescriptor::LineReceived() does, and
+ * records the time stamps of each line.
+ */
+class Pipeline final : public PortLineSplitter {
+  Device *device;
+  NMEAParser parser;
+  NMEAInfo basic;
+
+  /**
+   * Stands in for DeviceBlackboard::mutex.
+   */
+  Mutex mutex;
+
+  Port &nmea_out;
+
+  /**
+   * The time when read() has returned the data which is currently
+   * being split.
+   */
+  uint64_t read_time;
+
+public:
+  std::vector<uint64_t> read_times, merge_times;
+  std::atomic<unsigned> n_lines;
+  unsigned n_parsed;
+
+  Pipeline(Device *_device, Port &_nmea_out, unsigned n)
+    :device(_device), nmea_out(_nmea_out), n_lines(0), n_parsed(0) {
+    basic.Reset();
+    read_times.reserve(n);
+    merge_times.reserve(n);
+  }
+
+  virtual void DataReceived(const void *data, size_t length) override {
+    read_time = MonotonicClockUS();
+    PortLineSplitter::DataReceived(data, length);
+  }
+
+protected:
+  virtual void LineReceived(const char *line) override {
+    nmea_out.WriteLine(line);
+
+    bool parsed;
+    {
+      ScopeLock protect(mutex);
+      basic.UpdateClock();
+      parsed = (device != NULL && device->ParseNMEA(line, basic)) ||
+        parser.ParseLine(line, basic);
+    }
+
+    if (parsed)
+      ++n_parsed;
+
+    read_times.push_back(read_time);
+    merge_times.push_back(MonotonicClockUS());
+    n_lines.fetch_add(1, std::memory_order_release);
+  }
+};
+
+static void
+PrintLatency(const char *name, std::vector<unsigned> &latencies)
+{
+  if (latencies.empty())
+    return;
+
+  std::sort(latencies.begin(), latencies.end());
+
+  uint64_t sum = 0;
+  for (auto i : latencies)
+    sum += i;
+
+  const unsigned n = latencies.size();
+  printf("%s: mean %u us, median %u us, 99%% %u us, max %u us\n",
+         name, unsigned(sum / n), latencies[n / 2],
+         latencies[n * 99 / 100], latencies.back());
+}
+
+static int
+Run(const DeviceRegister &driver, unsigned baud_rate,
+    const std::vector<std::string> &lines)
+{
+  DiscardHandler discard;
+
+  /* the NMEA out port: a pseudo-TTY which is read and discarded */
+  TTYPort nmea_out(discard);
+  const char *nmea_out_slave = nmea_out.OpenPseudo();
+  TTYPort nmea_out_sink(discard);
+  if (nmea_out_slave == NULL ||
+      !nmea_out_sink.Open(PathName(nmea_out_slave), 115200)) {
+    fprintf(stderr, "Failed to open the NMEA out pseudo-TTY\n");
+    return EXIT_FAILURE;
+  }
+
+  DeviceConfig config;
+  config.Clear();
+
+  NullPort null_port;
+  Device *device = driver.CreateOnPort != NULL
+    ? driver.CreateOnPort(config, null_port)
+    : NULL;
+
+  Pipeline pipeline(device, nmea_out, lines.size());
+
+  TTYPort *input = new TTYPort(pipeline);
+  const char *input_slave = input->OpenPseudo();
+  TTYPort feed(discard);
+  if (input_slave == NULL || !feed.Open(PathName(input_slave), 115200) ||
+      !input->StartRxThread()) {
+    fprintf(stderr, "Failed to open the input pseudo-TTY\n");
+    delete input;
+    delete device;
+    return EXIT_FAILURE;
+  }
+
+  NullOperationEnvironment env;
+
+  /* feed the lines, pacing them at the baud rate (10 bits per byte,
+     including start and stop bit) */
+
+  std::vector<uint64_t> write_times;
+  write_times.reserve(lines.size());
+
+  const uint64_t start = MonotonicClockUS();
+  uint64_t n_bytes = 0;
+
+  for (const auto &line : lines) {
+    if (baud_rate > 0) {
+      const uint64_t due = start + n_bytes * 10000000 / baud_rate;
+      const uint64_t now = MonotonicClockUS();
+      if (due > now + 1000)
+        Sleep((due - now) / 1000);
+    }
+
+    const std::string data = line + "\r\n";
+    write_times.push_back(MonotonicClockUS());
+    if (!feed.FullWrite(data.data(), data.length(), env, 1000)) {
+      fprintf(stderr, "Failed to write to port\n");
+      delete input;
+      delete device;
+      return EXIT_FAILURE;
+    }
+
+    n_bytes += data.length();
+  }
+
+  /* wait until all lines have been received, or no progress has been
+     made for one second */
+
+  unsigned last = 0;
+  unsigned idle_ms = 0;
+  while (idle_ms < 1000) {
+    const unsigned n = pipeline.n_lines.load(std::memory_order_acquire);
+    if (n >= lines.size())
+      break;
+
+    if (n == last) {
+      idle_ms += 10;
+    } else {
+      last = n;
+      idle_ms = 0;
+    }
+
+    Sleep(10);
+  }
+
+  /* close the input port, to be sure that the I/O thread doesn't
+     touch the pipeline anymore */
+  delete input;
+  delete device;
+
+  const unsigned n_received = pipeline.n_lines.load(std::memory_order_acquire);
+  const uint64_t end = n_received > 0
+    ? pipeline.merge_times[n_received - 1]
+    : start;
+
+  printf("%u of %u lines received (%u parsed) in %u ms: %u lines/s\n",
+         n_received, unsigned(lines.size()), pipeline.n_parsed,
+         unsigned((end - start) / 1000),
+         unsigned(uint64_t(n_received) * 1000000 /
+                  std::max(end - start, uint64_t(1))));
+
+  std::vector<unsigned> latencies;
+  latencies.reserve(n_received);
+  for (unsigned i = 0; i < n_received; ++i)
+    latencies.push_back(pipeline.merge_times[i] - pipeline.read_times[i]);
+
+  PrintLatency("read -> merge", latencies);
+
+  if (n_received == lines.size()) {
+    latencies.clear();
+    for (unsigned i = 0; i < n_received; ++i)
+      latencies.push_back(pipeline.merge_times[i] - write_times[i]);
+
+    PrintLatency("write -> merge", latencies);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int
+main(int argc, char **argv)
+{
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s DRIVER BAUD <FILE.nmea\n"
+            "Where DRIVER is one of:\n", argv[0]);
+
+    const struct DeviceRegister *driver;
+    for (unsigned i = 0; (driver = GetDriverByIndex(i)) != NULL; ++i)
+      _ftprintf(stderr, _T("\t%s\n"), driver->name);
+
+    return EXIT_FAILURE;
+  }
+
+  PathName driver_name(argv[1]);
+  const struct DeviceRegister *driver = FindDriverByName(driver_name);
+  if (driver == NULL) {
+    fprintf(stderr, "No such driver: %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  const unsigned baud_rate = atoi(argv[2]);
+
+  std::vector<std::string> lines;
+  char buffer[1024];
+  while (fgets(buffer, sizeof(buffer), stdin) != NULL) {
+    TrimRight(buffer);
+    if (*buffer != 0)
+      lines.push_back(buffer);
+  }
+
+  InitialiseIOThread();
+  const int result = Run(*driver, baud_rate, lines);
+  DeinitialiseIOThread();
+  return result;
+}
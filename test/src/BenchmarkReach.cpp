@@ -0,0 +1,195 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the terrain line-of-sight queries: the reach
+ * fan from a grid of positions around the map center, and glide lines
+ * (RasterMap::Intersection() and RasterMap::FirstIntersection()) in
+ * all directions from the same positions, e.g.:
+ *
+ *   BenchmarkReach /path/to/map.xcm [HEIGHT]
+ *
+ * HEIGHT is the altitude above the terrain at each position
+ * (default 1000 m).
+ */
+
+#include "Route/TerrainRoute.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/PathName.hpp"
+#include "OS/Clock.hpp"
+#include "Compatibility/path.h"
+#include "Operation/Operation.hpp"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <tchar.h>
+
+static constexpr unsigned GRID = 16, DIRECTIONS = 256;
+
+static GeoPoint
+GetGridPoint(const GeoPoint &center, unsigned i, unsigned j)
+{
+  const fixed fx = fixed(i) / (GRID - 1) * 2 - fixed(1);
+  const fixed fy = fixed(j) / (GRID - 1) * 2 - fixed(1);
+  return GeoPoint(center.longitude + Angle::Degrees(fixed(0.3) * fx),
+                  center.latitude + Angle::Degrees(fixed(0.2) * fy));
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s PATH [HEIGHT]\n", argv[0]);
+    return 1;
+  }
+
+  const char *map_path = argv[1];
+  const short height = argc > 2 ? atoi(argv[2]) : 1000;
+
+  TCHAR jp2_path[4096];
+  _tcscpy(jp2_path, PathName(map_path));
+  _tcscat(jp2_path, _T(DIR_SEPARATOR_S) _T("terrain.jp2"));
+
+  TCHAR j2w_path[4096];
+  _tcscpy(j2w_path, PathName(map_path));
+  _tcscat(j2w_path, _T(DIR_SEPARATOR_S) _T("terrain.j2w"));
+
+  NullOperationEnvironment operation;
+  RasterMap map(jp2_path, j2w_path, NULL, operation);
+  if (!map.IsDefined()) {
+    fprintf(stderr, "failed to load map\n");
+    return EXIT_FAILURE;
+  }
+
+  const GeoPoint center = map.GetMapCenter();
+  do {
+    map.SetViewCenter(center, fixed(100000));
+  } while (map.IsDirty());
+
+  GlideSettings settings;
+  settings.SetDefaults();
+  GlidePolar polar(fixed(1));
+  TerrainRoute route;
+  route.UpdatePolar(settings, polar, polar, SpeedVector::Zero());
+  route.SetTerrain(&map);
+
+  RoutePlannerConfig config;
+  config.SetDefaults();
+
+  /* the reach fan of each grid position */
+
+  const uint64_t reach_start = MonotonicClockUS();
+
+  unsigned n_reach = 0;
+  for (unsigned i = 0; i < GRID; ++i) {
+    for (unsigned j = 0; j < GRID; ++j) {
+      const GeoPoint location = GetGridPoint(center, i, j);
+      const AGeoPoint origin(location,
+                             RoughAltitude(map.GetHeight(location) + height));
+      if (route.SolveReach(origin, config, RoughAltitude::Max()))
+        ++n_reach;
+    }
+  }
+
+  const uint64_t reach_end = MonotonicClockUS();
+
+  printf("reach: %u of %u solved in %u ms\n", n_reach, GRID * GRID,
+         unsigned((reach_end - reach_start) / 1000));
+
+  /* glide lines in all directions from each grid position, with a
+     glide ratio of 1:40; the lines are prepared first, to measure
+     only the terrain queries */
+
+  struct GlideLine {
+    GeoPoint origin, destination;
+    short h_origin;
+  };
+
+  const fixed distance(fixed(height) * 40);
+  std::vector<GlideLine> lines;
+  lines.reserve(GRID * GRID * DIRECTIONS);
+
+  for (unsigned i = 0; i < GRID; ++i) {
+    for (unsigned j = 0; j < GRID; ++j) {
+      GlideLine line;
+      line.origin = GetGridPoint(center, i, j);
+      line.h_origin = map.GetHeight(line.origin) + height;
+
+      for (unsigned k = 0; k < DIRECTIONS; ++k) {
+        const Angle direction = Angle::FullCircle() * k / DIRECTIONS;
+        line.destination = GeoVector(distance, direction).EndPoint(line.origin);
+        lines.push_back(line);
+      }
+    }
+  }
+
+  std::vector<GeoPoint> arrivals(lines.size());
+
+  const uint64_t glide_start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < lines.size(); ++i)
+    arrivals[i] = map.Intersection(lines[i].origin, lines[i].h_origin,
+                                   height, lines[i].destination);
+
+  const uint64_t glide_end = MonotonicClockUS();
+
+  double sum = 0;
+  for (unsigned i = 0; i < lines.size(); ++i)
+    sum += (double)lines[i].origin.Distance(arrivals[i]);
+
+  printf("glide: %u lines in %u ms (mean range %.0f m)\n",
+         unsigned(lines.size()),
+         unsigned((glide_end - glide_start) / 1000),
+         sum / lines.size());
+
+  /* the same lines with a safety height of 1/4 of the height above
+     the terrain */
+
+  unsigned n_intersections = 0;
+
+  const uint64_t first_start = MonotonicClockUS();
+
+  for (const auto &line : lines) {
+    GeoPoint intersection;
+    short h;
+    if (map.FirstIntersection(line.origin, line.h_origin,
+                              line.destination, line.h_origin - height,
+                              height, SHRT_MAX, height / 4,
+                              intersection, h))
+      ++n_intersections;
+  }
+
+  const uint64_t first_end = MonotonicClockUS();
+
+  printf("first intersection: %u of %u lines in %u ms\n",
+         n_intersections, unsigned(lines.size()),
+         unsigned((first_end - first_start) / 1000));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program compares the two terrain tile backends: on-demand
+ * JPEG2000 decoding and the memory-mapped raw tile file in the file
+ * cache.  Run it once per backend (each in a fresh process, to get
+ * meaningful RSS values), e.g.:
+ *
+ *   BenchmarkTerrain jp2 /path/to/map.xcm
+ *   BenchmarkTerrain raw /path/to/map.xcm /tmp/cache
+ *
+ * The first "raw" run generates the raw tile file; this is included
+ * in its "load" time.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/PathName.hpp"
+#include "OS/Clock.hpp"
+#include "Compatibility/path.h"
+#include "Operation/Operation.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <tchar.h>
+
+/**
+ * Returns the resident set size of this process in kB, or 0 if
+ * unknown.
+ */
+static unsigned long
+GetResidentKB()
+{
+#ifdef __linux__
+  FILE *file = fopen("/proc/self/statm", "r");
+  if (file == NULL)
+    return 0;
+
+  unsigned long size, resident;
+  int n = fscanf(file, "%lu %lu", &size, &resident);
+  fclose(file);
+  return n == 2 ? resident * 4 : 0;
+#else
+  return 0;
+#endif
+}
+
+static GeoPoint
+Interpolate(const GeoPoint &a, const GeoPoint &b, fixed ratio)
+{
+  return GeoPoint(a.longitude + (b.longitude - a.longitude) * ratio,
+                  a.latitude + (b.latitude - a.latitude) * ratio);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3 || argc > 4) {
+    fprintf(stderr, "Usage: %s jp2|raw PATH [CACHE]\n", argv[0]);
+    return 1;
+  }
+
+  const bool raw = strcmp(argv[1], "raw") == 0;
+  if (!raw && strcmp(argv[1], "jp2") != 0) {
+    fprintf(stderr, "Unknown backend: %s\n", argv[1]);
+    return 1;
+  }
+
+  if (raw && argc != 4) {
+    fprintf(stderr, "The raw backend needs a cache directory\n");
+    return 1;
+  }
+
+  const char *map_path = argv[2];
+
+  TCHAR jp2_path[4096];
+  _tcscpy(jp2_path, PathName(map_path));
+  _tcscat(jp2_path, _T(DIR_SEPARATOR_S) _T("terrain.jp2"));
+
+  TCHAR j2w_path[4096];
+  _tcscpy(j2w_path, PathName(map_path));
+  _tcscat(j2w_path, _T(DIR_SEPARATOR_S) _T("terrain.j2w"));
+
+  FileCache *cache = raw ? new FileCache(PathName(argv[3])) : NULL;
+
+  NullOperationEnvironment operation;
+
+  const uint64_t start = MonotonicClockUS();
+
+  RasterMap map(jp2_path, j2w_path, cache, operation);
+  if (!map.IsDefined()) {
+    fprintf(stderr, "failed to load map\n");
+    return EXIT_FAILURE;
+  }
+
+  const uint64_t loaded = MonotonicClockUS();
+
+  /* first fix: the height at the map center in full resolution */
+  const GeoPoint center = map.GetMapCenter();
+  map.SetViewCenter(center, fixed(50000));
+  const short center_height = map.GetHeight(center);
+
+  const uint64_t first_fix = MonotonicClockUS();
+
+  printf("backend: %s\n", raw ? "raw" : "jp2");
+  printf("load: %u ms\n", unsigned((loaded - start) / 1000));
+  printf("first fix: %u us (height=%d)\n",
+         unsigned(first_fix - loaded), center_height);
+  printf("RSS after first fix: %lu kB\n", GetResidentKB());
+
+  /* steady state: a long final glide diagonally across the map,
+     sampling the terrain around the aircraft on each step */
+  const GeoBounds &bounds = map.GetBounds();
+  const GeoPoint from = bounds.GetNorthWest(), to = bounds.GetSouthEast();
+
+  constexpr unsigned STEPS = 200, SAMPLES = 1000;
+  long sum = 0;
+
+  const uint64_t glide_start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < STEPS; ++i) {
+    const GeoPoint location = Interpolate(from, to, fixed(i) / STEPS);
+    map.SetViewCenter(location, fixed(50000));
+
+    const GeoPoint ahead =
+      Interpolate(from, to, fixed(i + 1) / STEPS);
+    for (unsigned j = 0; j < SAMPLES; ++j)
+      sum += map.GetInterpolatedHeight(Interpolate(location, ahead,
+                                                   fixed(j) / SAMPLES));
+  }
+
+  const uint64_t glide_end = MonotonicClockUS();
+
+  printf("glide: %u steps in %u ms (checksum %ld)\n", STEPS,
+         unsigned((glide_end - glide_start) / 1000), sum);
+  printf("RSS steady state: %lu kB\n", GetResidentKB());
+
+  delete cache;
+  return EXIT_SUCCESS;
+}
@@ -27,9 +27,13 @@ Copyright_License {
 #include "OS/PathName.hpp"
 #include "OS/Args.hpp"
 #include "Operation/Operation.hpp"
+#include "OS/Clock.hpp"
+#include "Util/StaticString.hpp"
+#include "Util/StringUtil.hpp"
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <tchar.h>
 
 static bool
@@ -131,10 +135,128 @@ PrintWaypoint(const Waypoint *waypoint)
               waypoint->name.c_str());
 }
 
+/**
+ * The number of queries of each kind in the benchmark.
+ */
+static constexpr unsigned N_QUERIES = 10000;
+
+static GeoPoint
+RandomLocation()
+{
+  /* roughly the size of Germany */
+  return GeoPoint(Angle::Degrees(fixed(6 + (rand() % 9000) / 1000.)),
+                  Angle::Degrees(fixed(47 + (rand() % 8000) / 1000.)));
+}
+
+/**
+ * Add waypoints at random locations.
+ */
+static void
+AddRandomWaypoints(Waypoints &waypoints, unsigned n)
+{
+  for (unsigned i = 0; i < n; ++i) {
+    Waypoint waypoint(RandomLocation());
+    waypoint.type = i % 10 == 0
+      ? Waypoint::Type::AIRFIELD
+      : Waypoint::Type::NORMAL;
+
+    StaticString<32> name;
+    name.Format(_T("WP%u"), i);
+    waypoint.name = name;
+
+    waypoints.Append(std::move(waypoint));
+  }
+}
+
+class WaypointCounter : public WaypointVisitor {
+  unsigned count;
+
+public:
+  WaypointCounter():count(0) {}
+
+  unsigned GetCount() const {
+    return count;
+  }
+
+  virtual void Visit(const Waypoint &waypoint) {
+    ++count;
+  }
+};
+
+/**
+ * Run the nearest and range queries on the specified waypoints.
+ */
+static void
+BenchmarkQueries(const char *label, const Waypoints &waypoints)
+{
+  srand(1);
+  uint64_t start = MonotonicClockUS();
+  unsigned n_nearest = 0;
+  for (unsigned i = 0; i < N_QUERIES; ++i)
+    if (waypoints.GetNearestLandable(RandomLocation(), fixed(50000)) != NULL)
+      ++n_nearest;
+
+  const uint64_t nearest_us = MonotonicClockUS() - start;
+
+  srand(2);
+  start = MonotonicClockUS();
+  unsigned n_found = 0;
+  for (unsigned i = 0; i < N_QUERIES; ++i) {
+    WaypointCounter counter;
+    waypoints.VisitWithinRange(RandomLocation(), fixed(10000), counter);
+    n_found += counter.GetCount();
+  }
+
+  const uint64_t range_us = MonotonicClockUS() - start;
+
+  printf("  %-9s nearest %7.3f us/query (%u found)"
+         "   range %7.3f us/query (%.1f found)\n",
+         label, double(nearest_us) / N_QUERIES, n_nearest,
+         double(range_us) / N_QUERIES, double(n_found) / N_QUERIES);
+}
+
+/**
+ * Compare the bulk-loaded index with the #QuadTree which holds the
+ * waypoints appended after the first Waypoints::Optimise() call.
+ */
+static void
+Benchmark(unsigned n)
+{
+  printf("%u waypoints\n", n);
+
+  Waypoints packed;
+  srand(42);
+  AddRandomWaypoints(packed, n);
+  uint64_t start = MonotonicClockUS();
+  packed.Optimise();
+  const uint64_t packed_build_us = MonotonicClockUS() - start;
+
+  /* the first Optimise() call fixes the projection, and all
+     waypoints appended after that go to the dynamic tree */
+  Waypoints dynamic;
+  dynamic.Append(Waypoint(GeoPoint(Angle::Degrees(fixed(10.5)),
+                                  Angle::Degrees(fixed(51)))));
+  dynamic.Optimise();
+  dynamic.Erase(*dynamic.begin());
+
+  srand(42);
+  AddRandomWaypoints(dynamic, n);
+  start = MonotonicClockUS();
+  dynamic.Optimise();
+  const uint64_t dynamic_build_us = MonotonicClockUS() - start;
+
+  printf("  Optimise(): packed %u us, quadtree %u us\n",
+         unsigned(packed_build_us), unsigned(dynamic_build_us));
+
+  BenchmarkQueries("packed", packed);
+  BenchmarkQueries("quadtree", dynamic);
+}
+
 int main(int argc, char **argv)
 {
   WaypointType type = WaypointType::ALL;
   fixed range = fixed(100000);
+  bool benchmark = false;
 
   Args args(argc, argv,
             "PATH\n\nPATH is expected to be any compatible waypoint file.\n"
@@ -144,7 +266,9 @@ int main(int argc, char **argv)
             "2.12343 34.38432\n"
             "65.18234 -173.48307\n\n"
             "Output is in the format: LAT LON ELEV (in m) NAME\n\ne.g.\n"
-            "50.823055 6.186384 189 Aachen Merzbruc");
+            "50.823055 6.186384 189 Aachen Merzbruc\n\n"
+            "With --benchmark, PATH is not used; nearest and range queries\n"
+            "are timed on 1k, 10k and 100k random waypoints instead.");
 
   const char *arg;
   while ((arg = args.PeekNext()) != NULL && *arg == '-') {
@@ -159,11 +283,22 @@ int main(int argc, char **argv)
       type = WaypointType::AIRPORT;
     } else if (StringStartsWith(arg, "--landables-only")) {
       type = WaypointType::LANDABLE;
+    } else if (StringIsEqual(arg, "--benchmark")) {
+      benchmark = true;
     } else {
       args.UsageError();
     }
   }
 
+  if (benchmark) {
+    args.ExpectEnd();
+
+    Benchmark(1000);
+    Benchmark(10000);
+    Benchmark(100000);
+    return EXIT_SUCCESS;
+  }
+
   const char *path = args.ExpectNext();
   args.ExpectEnd();
 
@@ -139,6 +139,9 @@ void PrintHelper::print_route(RoutePlanner& r)
   printf("#   airspace queries %d\n", (int)r.count_airspace);
   printf("#   terrain queries %d\n", (int)r.count_terrain);
   printf("#   supressed %d\n", (int)r.count_supressed);
+  printf("#   solve time %u us\n", (unsigned)r.time_solve);
+  printf("#   clearance time %u us\n", (unsigned)r.time_clearance);
+  printf("#   expand time %u us\n", (unsigned)r.time_expand);
 }
 
 #include "Route/ReachFan.hpp"
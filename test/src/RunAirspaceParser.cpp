@@ -21,36 +21,184 @@ Copyright_License {
 }
 */
 
-#include "Airspace/AirspaceParser.hpp"
+#include "Airspace/ParseAirspaceFiles.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
-#include "IO/FileLineReader.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceVisitor.hpp"
 #include "Operation/Operation.hpp"
+#include "OS/Clock.hpp"
+#include "OS/FileUtil.hpp"
+
+#include <vector>
 
 #include <stdio.h>
 #include <tchar.h>
 
+#ifdef HAVE_POSIX
+#include <sys/resource.h>
+#endif
+
+class CountAirspaceVisitor : public AirspaceVisitor {
+public:
+  unsigned n;
+
+  CountAirspaceVisitor():n(0) {}
+
+  virtual void Visit(const AbstractAirspace &airspace) override {
+    ++n;
+  }
+};
+
+/**
+ * Measure the latency of range queries around the center of each
+ * airspace.
+ */
+static void
+BenchmarkQueries(const Airspaces &airspaces, fixed range)
+{
+  std::vector<GeoPoint> locations;
+  for (const auto &i : airspaces)
+    locations.push_back(i.GetAirspace()->GetCenter());
+
+  if (locations.empty())
+    return;
+
+  CountAirspaceVisitor visitor;
+  const uint64_t start = MonotonicClockUS();
+  for (unsigned i = 0; i < 100; ++i)
+    for (const auto &location : locations)
+      airspaces.VisitWithinRange(location, range, visitor);
+  const uint64_t us = MonotonicClockUS() - start;
+
+  printf("range %5u m: %8.3f us/query, %6.1f airspaces/query\n",
+         (unsigned)range, double(us) / (100 * locations.size()),
+         double(visitor.n) / (100 * locations.size()));
+}
+
+/**
+ * Call AbstractAirspace::Inside() on points scattered around the
+ * center of each airspace.
+ *
+ * @return the number of points inside
+ */
+static unsigned
+CountInside(const Airspaces &airspaces, unsigned &n_queries)
+{
+  unsigned n_inside = 0;
+  n_queries = 0;
+
+  for (const auto &i : airspaces) {
+    const AbstractAirspace &airspace = *i.GetAirspace();
+    const GeoPoint center = airspace.GetCenter();
+
+    for (int dx = -5; dx < 5; ++dx) {
+      for (int dy = -5; dy < 5; ++dy) {
+        const GeoPoint p(center.longitude + Angle::Degrees(fixed(dx) / 50),
+                         center.latitude + Angle::Degrees(fixed(dy) / 50));
+        ++n_queries;
+        if (airspace.Inside(p))
+          ++n_inside;
+      }
+    }
+  }
+
+  return n_inside;
+}
+
+/**
+ * Measure the latency of AbstractAirspace::Inside(), and report the
+ * memory used by the acceleration grids of the polygons.
+ */
+static void
+BenchmarkInside(const Airspaces &airspaces)
+{
+  unsigned n_queries;
+
+  /* the first pass builds the grids */
+  uint64_t start = MonotonicClockUS();
+  CountInside(airspaces, n_queries);
+  const uint64_t first_us = MonotonicClockUS() - start;
+
+  start = MonotonicClockUS();
+  const unsigned n_inside = CountInside(airspaces, n_queries);
+  const uint64_t us = MonotonicClockUS() - start;
+
+  unsigned n_grids = 0;
+  size_t grid_memory = 0;
+  for (const auto &i : airspaces) {
+    const AbstractAirspace &airspace = *i.GetAirspace();
+    if (airspace.GetShape() != AbstractAirspace::Shape::POLYGON)
+      continue;
+
+    const size_t memory = ((const AirspacePolygon &)airspace)
+      .GetInsideGridMemoryUsage();
+    if (memory > 0) {
+      ++n_grids;
+      grid_memory += memory;
+    }
+  }
+
+  printf("inside: %8.3f us/query (first pass %8.3f), %u of %u inside; "
+         "%u grids using %u bytes\n",
+         n_queries > 0 ? double(us) / n_queries : 0.,
+         n_queries > 0 ? double(first_us) / n_queries : 0.,
+         n_inside, n_queries, n_grids, (unsigned)grid_memory);
+}
+
 int main(int argc, char **argv)
 {
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s PATH\n", argv[0]);
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s PATH...\n", argv[0]);
     return 1;
   }
 
-  FileLineReader reader(argv[1], ConvertLineReader::AUTO);
-  if (reader.error()) {
-    fprintf(stderr, "Failed to open input file\n");
-    return 1;
+  const unsigned n_paths = argc - 1;
+  std::vector<const TCHAR *> paths;
+  uint64_t total_size = 0;
+  for (unsigned i = 0; i < n_paths; ++i) {
+    paths.push_back(argv[i + 1]);
+    total_size += File::GetSize(argv[i + 1]);
   }
 
   Airspaces airspaces;
-  AirspaceParser parser(airspaces);
 
   NullOperationEnvironment operation;
-  if (!parser.Parse(reader, operation)) {
+  uint64_t start = MonotonicClockUS();
+  if (!ParseAirspaceFiles(airspaces, paths.data(), n_paths, operation)) {
     fprintf(stderr, "Failed to parse input file\n");
     return 1;
   }
 
+  const uint64_t parse_us = MonotonicClockUS() - start;
+  printf("parsed %.2f MB in %u us, %.1f MB/s\n",
+         double(total_size) / (1024 * 1024), unsigned(parse_us),
+         parse_us > 0
+         ? double(total_size) / (1024 * 1024) / (double(parse_us) / 1000000)
+         : 0.);
+
+  start = MonotonicClockUS();
+  airspaces.Optimise();
+
+#ifdef AIRSPACE_KDTREE
+  const char *backend = "kdtree";
+#else
+  const char *backend = "rtree";
+#endif
+  printf("%u airspaces, %s built in %u us\n", airspaces.size(), backend,
+         unsigned(MonotonicClockUS() - start));
+
+  BenchmarkQueries(airspaces, fixed(0));
+  BenchmarkQueries(airspaces, fixed(5000));
+  BenchmarkQueries(airspaces, fixed(20000));
+  BenchmarkInside(airspaces);
+
+#ifdef HAVE_POSIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    printf("peak memory: %ld kB\n", usage.ru_maxrss);
+#endif
+
   printf("OK\n");
 
   return 0;
@@ -0,0 +1,150 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Replay a flight and run the incremental contest solvers after each
+ * fix, the way ContestComputer does during the flight.  Prints the
+ * solve times of the updates with and without thinning of the trace,
+ * and how often the solvers had to start from scratch.
+ */
+
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/Solvers/OLCClassic.hpp"
+#include "Contest/Solvers/DMStQuad.hpp"
+#include "Contest/Solvers/XContestFree.hpp"
+#include "Contest/Solvers/NetCoupe.hpp"
+#include "Contest/Solvers/OLCFAI.hpp"
+#include "Contest/Solvers/XContestTriangle.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "DebugReplay.hpp"
+
+#include <stdio.h>
+
+struct SolveTimes {
+  unsigned n;
+  uint64_t total_us, max_us;
+
+  SolveTimes():n(0), total_us(0), max_us(0) {}
+
+  void Add(uint64_t us) {
+    ++n;
+    total_us += us;
+    if (us > max_us)
+      max_us = us;
+  }
+
+  unsigned GetAverage() const {
+    return n > 0 ? unsigned(total_us / n) : 0;
+  }
+};
+
+struct IncrementalSolver {
+  const char *name;
+  ContestDijkstra &solver;
+
+  SolveTimes normal, thinned;
+};
+
+static Trace trace(0, Trace::null_time, 512);
+
+static OLCClassic olc_classic(trace);
+static DMStQuad dmst_quad(trace);
+static XContestFree xcontest_free(trace, false);
+static NetCoupe net_coupe(trace);
+static OLCFAI olc_fai(trace, false);
+static XContestTriangle xcontest_triangle(trace, false, false);
+
+static IncrementalSolver solvers[] = {
+  { "olc-classic", olc_classic },
+  { "dmst", dmst_quad },
+  { "xcontest-free", xcontest_free },
+  { "netcoupe", net_coupe },
+  { "olc-fai", olc_fai },
+  { "xcontest-tri", xcontest_triangle },
+};
+
+static void
+Run(DebugReplay &replay)
+{
+  for (auto &i : solvers)
+    i.solver.SetIncremental(true);
+
+  bool released = false;
+
+  while (replay.Next()) {
+    const MoreData &basic = replay.Basic();
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    if (!released && !negative(replay.Calculated().flight.release_time)) {
+      released = true;
+
+      trace.EraseEarlierThan(replay.Calculated().flight.release_time);
+    }
+
+    const Serial modify_serial = trace.GetModifySerial();
+    trace.push_back(TracePoint(basic));
+    const bool thinned = trace.GetModifySerial() != modify_serial;
+
+    for (auto &i : solvers) {
+      const uint64_t start = MonotonicClockUS();
+      i.solver.Solve(false);
+      const uint64_t us = MonotonicClockUS() - start;
+
+      (thinned ? i.thinned : i.normal).Add(us);
+    }
+  }
+
+  printf("%-14s %6s %8s %8s %6s %8s %8s %6s %6s %10s\n", "solver",
+         "n", "avg us", "max us", "thin", "avg us", "max us",
+         "full", "incr", "distance");
+
+  for (auto &i : solvers) {
+    i.solver.Solve(true);
+
+    printf("%-14s %6u %8u %8u %6u %8u %8u %6u %6u %10.3f\n", i.name,
+           i.normal.n, i.normal.GetAverage(), unsigned(i.normal.max_us),
+           i.thinned.n, i.thinned.GetAverage(), unsigned(i.thinned.max_us),
+           i.solver.GetFullSolveCount(),
+           i.solver.GetIncrementalSolveCount(),
+           (double)i.solver.GetBestResult().distance / 1000.);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv, "DRIVER FILE");
+
+  DebugReplay *replay = CreateDebugReplay(args);
+  if (replay == NULL)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  Run(*replay);
+  delete replay;
+  return EXIT_SUCCESS;
+}
@@ -30,9 +30,15 @@ Copyright_License {
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Input/InputEvents.hpp"
 #include "OS/PathName.hpp"
+#include "OS/Clock.hpp"
 #include "Profile/DeviceConfig.hpp"
 
+#include <string>
+#include <vector>
+#include <algorithm>
+
 #include <stdio.h>
+#include <stdlib.h>
 
 const struct DeviceRegister *driver;
 
@@ -176,16 +182,43 @@ Dump(const NMEAInfo &basic)
   Dump(basic.settings);
 }
 
+/**
+ * Parse all lines the specified number of times, and print the
+ * throughput to stderr.
+ */
+static void
+Benchmark(Device *device, NMEAParser &parser, NMEAInfo &data,
+          const std::vector<std::string> &lines, unsigned repeat)
+{
+  const uint64_t start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < repeat; ++i) {
+    for (const auto &line : lines) {
+      if (device == NULL || !device->ParseNMEA(line.c_str(), data))
+        parser.ParseLine(line.c_str(), data);
+    }
+  }
+
+  const uint64_t duration = std::max(MonotonicClockUS() - start, uint64_t(1));
+  const uint64_t n = uint64_t(lines.size()) * repeat;
+
+  fprintf(stderr, "%llu lines in %llu ms: %llu lines/s\n",
+          (unsigned long long)n, (unsigned long long)(duration / 1000),
+          (unsigned long long)(n * 1000000 / duration));
+}
+
 int main(int argc, char **argv)
 {
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s DRIVER\n"
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "Usage: %s DRIVER [REPEAT]\n"
             "Where DRIVER is one of:\n", argv[0]);
 
     const struct DeviceRegister *driver;
     for (unsigned i = 0; (driver = GetDriverByIndex(i)) != NULL; ++i)
       _ftprintf(stderr, _T("\t%s\n"), driver->name);
 
+    fprintf(stderr, "With REPEAT, the input is parsed that many times, "
+            "and the throughput is printed.\n");
     return 1;
   }
 
@@ -196,6 +229,8 @@ int main(int argc, char **argv)
     return 1;
   }
 
+  const unsigned repeat = argc > 2 ? atoi(argv[2]) : 0;
+
   DeviceConfig config;
   config.Clear();
 
@@ -209,14 +244,21 @@ int main(int argc, char **argv)
   NMEAInfo data;
   data.Reset();
 
+  std::vector<std::string> lines;
+
   char buffer[1024];
   while (fgets(buffer, sizeof(buffer), stdin) != NULL) {
     TrimRight(buffer);
 
-    if (device == NULL || !device->ParseNMEA(buffer, data))
+    if (repeat > 0)
+      lines.push_back(buffer);
+    else if (device == NULL || !device->ParseNMEA(buffer, data))
       parser.ParseLine(buffer, data);
   }
 
+  if (repeat > 0)
+    Benchmark(device, parser, data, lines, repeat);
+
   Dump(data);
 
   return EXIT_SUCCESS;
@@ -28,16 +28,79 @@ Copyright_License {
 #include "OS/PathName.hpp"
 #include "Compatibility/path.h"
 #include "Operation/Operation.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "OS/Clock.hpp"
 
 #include <stdio.h>
+#include <string.h>
 #include <tchar.h>
 
 unsigned Layout::scale_1024 = 1024;
 
+static void
+Fill(HeightMatrix &matrix, const RasterMap &map,
+     const WindowProjection &projection)
+{
+#ifdef ENABLE_OPENGL
+  matrix.Fill(map, projection.GetScreenBounds(),
+              projection.GetScreenWidth(), projection.GetScreenHeight(),
+              false);
+#else
+  matrix.Fill(map, projection, 1, false);
+#endif
+}
+
+static bool
+IsEqual(const HeightMatrix &a, const HeightMatrix &b)
+{
+  return a.GetWidth() == b.GetWidth() && a.GetHeight() == b.GetHeight() &&
+    memcmp(a.GetData(), b.GetData(),
+           (a.GetDataEnd() - a.GetData()) * sizeof(*a.GetData())) == 0;
+}
+
+/**
+ * Fill the matrix repeatedly with 1, 2 and 4 workers, and print the
+ * number of rows per second.
+ */
+static bool
+RunTiming(const RasterMap &map, const WindowProjection &projection)
+{
+  static constexpr unsigned ITERATIONS = 50;
+
+  HeightMatrix reference;
+  Fill(reference, map, projection);
+
+  static constexpr unsigned concurrency[] = { 1, 2, 4 };
+  for (unsigned n : concurrency) {
+    WorkerPool pool(n);
+    HeightMatrix matrix;
+    matrix.SetWorkerPool(&pool);
+
+    const uint64_t start = MonotonicClockUS();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+      Fill(matrix, map, projection);
+    const uint64_t duration_us = MonotonicClockUS() - start;
+
+    const unsigned rows = ITERATIONS * matrix.GetHeight();
+    printf("%u workers: %u rows in %u ms, %.0f rows/s\n",
+           pool.GetConcurrency(), rows, unsigned(duration_us / 1000),
+           rows * 1000000. / (duration_us > 0 ? duration_us : 1));
+
+    if (!IsEqual(matrix, reference)) {
+      fprintf(stderr, "result with %u workers differs\n",
+              pool.GetConcurrency());
+      return false;
+    }
+  }
+
+  return true;
+}
+
 int main(int argc, char **argv)
 {
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s PATH\n", argv[0]);
+  const bool timing = argc == 3 && strcmp(argv[2], "timing") == 0;
+  if (argc != 2 && !timing) {
+    fprintf(stderr, "Usage: %s PATH [timing]\n", argv[0]);
     return 1;
   }
 
@@ -70,14 +133,11 @@ int main(int argc, char **argv)
   projection.SetScreenOrigin(320, 240);
   projection.UpdateScreenBounds();
 
+  if (timing)
+    return RunTiming(map, projection) ? EXIT_SUCCESS : EXIT_FAILURE;
+
   HeightMatrix matrix;
-#ifdef ENABLE_OPENGL
-  matrix.Fill(map, projection.GetScreenBounds(),
-              projection.GetScreenWidth(), projection.GetScreenHeight(),
-              false);
-#else
-  matrix.Fill(map, projection, 1, false);
-#endif
+  Fill(matrix, map, projection);
 
   return EXIT_SUCCESS;
 }
@@ -22,12 +22,17 @@
 
 #include "Engine/Trace/Trace.hpp"
 #include "Contest/ContestManager.hpp"
+#include "Contest/Solvers/Contests.hpp"
+#include "Computer/ContestExecutor.hpp"
 #include "Printing.hpp"
 #include "OS/Args.hpp"
+#include "OS/Clock.hpp"
 #include "DebugReplay.hpp"
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
+#include <tchar.h>
 
 // Uncomment the following line to use the same trace size as LK8000.
 //#define BENCHMARK_LK8000
@@ -55,8 +60,75 @@ static ContestManager sis_at(Contest::SIS_AT, full_trace, sprint_trace);
 static ContestManager olc_netcoupe(Contest::NET_COUPE,
                                    full_trace, sprint_trace);
 
+static constexpr Contest timed_contests[] = {
+  Contest::OLC_CLASSIC, Contest::OLC_FAI, Contest::OLC_SPRINT,
+  Contest::OLC_LEAGUE, Contest::OLC_PLUS, Contest::DMST,
+  Contest::XCONTEST, Contest::DHV_XC, Contest::SIS_AT, Contest::NET_COUPE,
+};
+
+gcc_pure
+static bool
+IsSameStats(const ContestStatistics &a, const ContestStatistics &b)
+{
+  for (unsigned i = 0; i < 3; ++i)
+    if (a.GetResult(i).score != b.GetResult(i).score ||
+        a.GetResult(i).distance != b.GetResult(i).distance)
+      return false;
+
+  return true;
+}
+
+static uint64_t
+TimeSolveExhaustive(ContestManager &manager)
+{
+  const uint64_t start = MonotonicClockUS();
+  manager.SolveExhaustive();
+  return MonotonicClockUS() - start;
+}
+
+/**
+ * Solve all contests with fresh solvers, first serially and then
+ * with independent solvers running in parallel, and print the times.
+ */
+static bool
+TimeSolvers()
+{
+  ContestExecutor executor(2);
+  uint64_t serial_total = 0, parallel_total = 0;
+  bool success = true;
+
+  printf("%-12s %11s %11s\n", "contest", "serial", "parallel");
+
+  for (const Contest contest : timed_contests) {
+    ContestManager serial(contest, full_trace, sprint_trace);
+    const uint64_t serial_us = TimeSolveExhaustive(serial);
+
+    ContestManager parallel(contest, full_trace, sprint_trace);
+    parallel.SetExecutor(&executor);
+    const uint64_t parallel_us = TimeSolveExhaustive(parallel);
+
+    _tprintf(_T("%-12s %8u ms %8u ms\n"), ContestToString(contest),
+             unsigned(serial_us / 1000), unsigned(parallel_us / 1000));
+
+    serial_total += serial_us;
+    parallel_total += parallel_us;
+
+    if (!IsSameStats(parallel.GetStats(), serial.GetStats())) {
+      _ftprintf(stderr, _T("%s: parallel result differs\n"),
+                ContestToString(contest));
+      success = false;
+    }
+  }
+
+  printf("%-12s %8u ms %8u ms (%u threads)\n", "total",
+         unsigned(serial_total / 1000), unsigned(parallel_total / 1000),
+         executor.GetConcurrency());
+
+  return success;
+}
+
 static int
-TestOLC(DebugReplay &replay)
+TestOLC(DebugReplay &replay, bool timing)
 {
   bool released = false;
 
@@ -86,6 +158,11 @@ TestOLC(DebugReplay &replay)
     olc_league.UpdateIdle();
   }
 
+  putchar('\n');
+
+  if (timing && !TimeSolvers())
+    return EXIT_FAILURE;
+
   olc_classic.SolveExhaustive();
   olc_fai.SolveExhaustive();
   olc_league.SolveExhaustive();
@@ -95,8 +172,6 @@ TestOLC(DebugReplay &replay)
   sis_at.SolveExhaustive();
   olc_netcoupe.SolveExhaustive();
 
-  putchar('\n');
-
   std::cout << "classic\n";
   PrintHelper::print(olc_classic.GetStats().GetResult());
   std::cout << "league\n";
@@ -147,14 +222,22 @@ TestOLC(DebugReplay &replay)
 
 int main(int argc, char **argv)
 {
-  Args args(argc, argv, "DRIVER FILE");
+  Args args(argc, argv, "[--timing] DRIVER FILE");
+
+  bool timing = false;
+  const char *arg = args.PeekNext();
+  if (arg != NULL && strcmp(arg, "--timing") == 0) {
+    timing = true;
+    args.Skip();
+  }
+
   DebugReplay *replay = CreateDebugReplay(args);
   if (replay == NULL)
     return EXIT_FAILURE;
 
   args.ExpectEnd();
 
-  int result = TestOLC(*replay);
+  int result = TestOLC(*replay, timing);
   delete replay;
   return result;
 }
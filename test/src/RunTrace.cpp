@@ -21,10 +21,41 @@ Copyright_License {
 }
 */
 
+/*
+ * Replay a flight into a #Trace with the settings of the full and
+ * the sprint trace of TraceComputer, and print the append
+ * throughput.
+ */
+
 #include "OS/Args.hpp"
+#include "OS/Clock.hpp"
 #include "DebugReplay.hpp"
 #include "Engine/Trace/Trace.hpp"
 
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+
+/**
+ * Append all points to a new #Trace and print how long it took.
+ */
+static void
+Append(const char *name, const std::vector<TracePoint> &points,
+       unsigned no_thin_time, unsigned max_time, unsigned max_size)
+{
+  Trace trace(no_thin_time, max_time, max_size);
+
+  const uint64_t start = MonotonicClockUS();
+  for (const TracePoint &point : points)
+    trace.push_back(point);
+  const uint64_t duration_us = std::max(MonotonicClockUS() - start,
+                                        uint64_t(1));
+
+  printf("%-8s %6u points in %7u us (%u points/s), %u kept\n", name,
+         unsigned(points.size()), unsigned(duration_us),
+         unsigned(points.size() * 1000000 / duration_us), trace.size());
+}
+
 int main(int argc, char **argv)
 {
   Args args(argc, argv, "DRIVER FILE");
@@ -34,14 +65,18 @@ int main(int argc, char **argv)
 
   args.ExpectEnd();
 
-  Trace trace;
+  std::vector<TracePoint> points;
 
   while (replay->Next()) {
     const MoreData &basic = replay->Basic();
     if (basic.time_available && basic.location_available &&
         basic.NavAltitudeAvailable())
-      trace.push_back(TracePoint(basic));
+      points.push_back(TracePoint(basic));
   }
 
   delete replay;
+
+  Append("full", points, 120, Trace::null_time, 1024);
+  Append("sprint", points, 0, 9000, 128);
+  return EXIT_SUCCESS;
 }
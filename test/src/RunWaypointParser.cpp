@@ -22,11 +22,17 @@ Copyright_License {
 */
 
 #include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/WaypointCache.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "Engine/Waypoint/WaypointVisitor.hpp"
 #include "OS/PathName.hpp"
 #include "OS/Args.hpp"
 #include "Operation/Operation.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/Clock.hpp"
+
+#include <algorithm>
+#include <vector>
 
 #include <stdio.h>
 #include <tchar.h>
@@ -41,11 +47,55 @@ public:
   }
 };
 
+static bool
+CompareId(const Waypoint *a, const Waypoint *b)
+{
+  return a->id < b->id;
+}
+
+/**
+ * Save the waypoints to the cache, clear them and load them again
+ * from the cache.
+ */
+static bool
+RoundTrip(Waypoints &way_points, const TCHAR *cache_path, const TCHAR *path)
+{
+  FileCache cache(cache_path);
+
+  std::vector<const Waypoint *> parsed;
+  for (const auto &i : way_points)
+    parsed.push_back(&i);
+  std::sort(parsed.begin(), parsed.end(), CompareId);
+
+  uint64_t start = MonotonicClockUS();
+  if (!SaveWaypointCache(cache, _T("waypoints"), path,
+                         parsed.data(), parsed.data() + parsed.size())) {
+    fprintf(stderr, "SaveWaypointCache() has failed\n");
+    return false;
+  }
+
+  fprintf(stderr, "save cache: %u us\n",
+          unsigned(MonotonicClockUS() - start));
+
+  way_points.Clear();
+
+  start = MonotonicClockUS();
+  if (!LoadWaypointCache(way_points, cache, _T("waypoints"), path)) {
+    fprintf(stderr, "LoadWaypointCache() has failed\n");
+    return false;
+  }
+
+  fprintf(stderr, "load cache: %u us\n",
+          unsigned(MonotonicClockUS() - start));
+  return true;
+}
+
 int main(int argc, char **argv)
 {
-  Args args(argc, argv, "PATH\n");
+  Args args(argc, argv, "PATH [CACHE_DIR]\n");
 
   const char *path_arg = args.ExpectNext();
+  const char *cache_arg = args.IsEmpty() ? NULL : args.GetNext();
   args.ExpectEnd();
 
   Waypoints way_points;
@@ -58,12 +108,22 @@ int main(int argc, char **argv)
   }
 
   NullOperationEnvironment operation;
+  uint64_t start = MonotonicClockUS();
   if (!parser.Parse(way_points, operation)) {
     fprintf(stderr, "WayPointParser::Parse() has failed\n");
     return EXIT_FAILURE;
   }
 
+  fprintf(stderr, "parse: %u us\n", unsigned(MonotonicClockUS() - start));
+
+  if (cache_arg != NULL &&
+      !RoundTrip(way_points, PathName(cache_arg), path))
+    return EXIT_FAILURE;
+
+  start = MonotonicClockUS();
   way_points.Optimise();
+  fprintf(stderr, "optimise: %u us\n", unsigned(MonotonicClockUS() - start));
+
   printf("Size %d\n", way_points.size());
 
   DumpVisitor visitor;
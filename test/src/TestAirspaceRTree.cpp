@@ -0,0 +1,250 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Airspace/AirspaceRTree.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <stdlib.h>
+
+typedef std::vector<Airspace> AirspaceVector;
+
+static GeoPoint
+RandomLocation()
+{
+  return GeoPoint(Angle::Degrees(fixed(rand() % 10000) / 1000),
+                  Angle::Degrees(fixed(45 + rand() % 10000 / 1000.)));
+}
+
+/**
+ * Generate a bounding box like the airspaces in an OpenAir file:
+ * mostly small ones, some long and thin airways, and a few huge FIR
+ * polygons.
+ */
+static Airspace
+RandomAirspace(const TaskProjection &projection)
+{
+  const GeoPoint ll = RandomLocation();
+
+  double width, height;
+  switch (rand() % 10) {
+  case 0:
+    /* airway */
+    width = (rand() % 4000) / 1000.;
+    height = 0.05;
+    break;
+
+  case 1:
+    if (rand() % 5 == 0) {
+      /* FIR */
+      width = 4 + (rand() % 4000) / 1000.;
+      height = 4 + (rand() % 4000) / 1000.;
+      break;
+    }
+
+    /* fall through */
+
+  default:
+    width = (rand() % 300) / 1000.;
+    height = (rand() % 300) / 1000.;
+  }
+
+  const GeoPoint ur(ll.longitude + Angle::Degrees(fixed(width)),
+                    ll.latitude + Angle::Degrees(fixed(height)));
+  return Airspace(ll, ur, projection);
+}
+
+static bool
+CompareBoxes(const FlatBoundingBox &a, const FlatBoundingBox &b)
+{
+  if (a.GetLowerLeft().longitude != b.GetLowerLeft().longitude)
+    return a.GetLowerLeft().longitude < b.GetLowerLeft().longitude;
+  if (a.GetLowerLeft().latitude != b.GetLowerLeft().latitude)
+    return a.GetLowerLeft().latitude < b.GetLowerLeft().latitude;
+  if (a.GetUpperRight().longitude != b.GetUpperRight().longitude)
+    return a.GetUpperRight().longitude < b.GetUpperRight().longitude;
+  return a.GetUpperRight().latitude < b.GetUpperRight().latitude;
+}
+
+static bool
+IsSameBox(const FlatBoundingBox &a, const FlatBoundingBox &b)
+{
+  return !CompareBoxes(a, b) && !CompareBoxes(b, a);
+}
+
+static bool
+IsSameBoxes(AirspaceVector a, AirspaceVector b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  std::sort(a.begin(), a.end(), CompareBoxes);
+  std::sort(b.begin(), b.end(), CompareBoxes);
+  return std::equal(a.begin(), a.end(), b.begin(), IsSameBox);
+}
+
+/**
+ * Find all airspaces within range with a linear scan.
+ */
+static AirspaceVector
+FindWithinRange(const AirspaceVector &all, const FlatBoundingBox &target,
+                int range)
+{
+  const FlatBoundingBox box(FlatGeoPoint(target.GetLowerLeft().longitude - range,
+                                         target.GetLowerLeft().latitude - range),
+                            FlatGeoPoint(target.GetUpperRight().longitude + range,
+                                         target.GetUpperRight().latitude + range));
+
+  AirspaceVector result;
+  for (const auto &i : all)
+    if (i.Overlaps(box))
+      result.push_back(i);
+  return result;
+}
+
+static bool
+TestWithinRange(const AirspaceRTree &tree, const AirspaceVector &all,
+                const TaskProjection &projection)
+{
+  for (unsigned i = 0; i < 200; ++i) {
+    const GeoPoint location = RandomLocation();
+    const Airspace target(location, projection);
+    const int range = (i % 4) == 0
+      ? 0
+      : projection.ProjectRangeInteger(location, fixed(rand() % 50000));
+
+    AirspaceVector found;
+    tree.find_within_range(target, -range, std::back_inserter(found));
+    if (!IsSameBoxes(found, FindWithinRange(all, target, range)))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * The squared distance between the boxes, the metric of
+ * AirspaceRTree::find_nearest_if().
+ */
+static unsigned
+SquaredDistance(const FlatBoundingBox &a, const FlatBoundingBox &b)
+{
+  const int dx = std::max({a.GetLowerLeft().longitude -
+                           b.GetUpperRight().longitude,
+                           b.GetLowerLeft().longitude -
+                           a.GetUpperRight().longitude, 0});
+  const int dy = std::max({a.GetLowerLeft().latitude -
+                           b.GetUpperRight().latitude,
+                           b.GetLowerLeft().latitude -
+                           a.GetUpperRight().latitude, 0});
+  return dx * dx + dy * dy;
+}
+
+/**
+ * Accept only half of the airspaces, to check the predicate of
+ * AirspaceRTree::find_nearest_if().
+ */
+struct EvenLongitude {
+  bool operator()(const Airspace &airspace) const {
+    return (airspace.GetLowerLeft().longitude & 1) == 0;
+  }
+};
+
+static bool
+TestNearest(const AirspaceRTree &tree, const AirspaceVector &all,
+            const TaskProjection &projection)
+{
+  const EvenLongitude predicate;
+
+  for (unsigned i = 0; i < 200; ++i) {
+    const GeoPoint location = RandomLocation();
+    const Airspace target(location, projection);
+    const unsigned max =
+      projection.ProjectRangeInteger(location, fixed(30000));
+
+    const auto found = tree.find_nearest_if(target, BBDist(0, max),
+                                            predicate);
+
+    /* find the nearest distance with a linear scan */
+    unsigned best = max * max + 1;
+    for (const auto &j : all)
+      if (predicate(j))
+        best = std::min(best, SquaredDistance(j, target));
+
+    if (best > max * max) {
+      if (found.first != tree.end())
+        return false;
+    } else {
+      if (found.first == tree.end() ||
+          !predicate(*found.first) ||
+          SquaredDistance(*found.first, target) != best)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(6);
+
+  srand(42);
+
+  TaskProjection projection;
+  projection.Reset(GeoPoint(Angle::Degrees(5), Angle::Degrees(50)));
+  projection.Scan(GeoPoint(Angle::Degrees(0), Angle::Degrees(45)));
+  projection.Scan(GeoPoint(Angle::Degrees(18), Angle::Degrees(59)));
+  projection.Update();
+
+  AirspaceVector all;
+  AirspaceRTree tree;
+  for (unsigned i = 0; i < 3000; ++i) {
+    const Airspace airspace = RandomAirspace(projection);
+    all.push_back(airspace);
+    tree.insert(airspace);
+  }
+
+  /* not yet optimised: linear scan */
+  ok1(TestWithinRange(tree, all, projection));
+
+  tree.optimise();
+  ok1(tree.size() == all.size());
+  ok1(TestWithinRange(tree, all, projection));
+  ok1(TestNearest(tree, all, projection));
+
+  /* remove some airspaces */
+  for (unsigned i = 0; i < 500; ++i) {
+    const unsigned j = rand() % all.size();
+    tree.erase_exact(all[j]);
+    all.erase(all.begin() + j);
+  }
+
+  tree.optimise();
+  ok1(TestWithinRange(tree, all, projection));
+  ok1(TestNearest(tree, all, projection));
+
+  return exit_status();
+}
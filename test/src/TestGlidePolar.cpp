@@ -22,6 +22,8 @@
 
 #include "TestUtil.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/GlideResult.hpp"
+#include "Navigation/Aircraft.hpp"
 #include "Units/System.hpp"
 
 #include <cstdio>
@@ -39,6 +41,11 @@ private:
   void TestBallast();
   void TestBugs();
   void TestMC();
+  void TestSpeedToFly();
+  void TestGlideSpeed();
+
+  fixed FindGlideSpeed(fixed head_wind, fixed cross_wind) const;
+  bool CheckGlideSpeed() const;
 };
 
 void
@@ -58,6 +65,8 @@ GlidePolarTest::Init()
   polar.ballast = fixed(0);
   polar.bugs = fixed(1);
 
+  polar.cruise_efficiency = fixed(1);
+
   // MC zero
   polar.mc = fixed(0);
 
@@ -163,6 +172,160 @@ GlidePolarTest::TestMC()
   ok1(equals(polar.GetVBestLD(), 25.830434162));
 }
 
+/**
+ * Find the speed to fly by scanning the whole speed range.
+ */
+gcc_pure
+static fixed
+ScanSpeedToFly(const GlidePolar &polar, fixed head_wind, fixed sink_rate)
+{
+  fixed best_v = polar.GetVMin(), best_ratio = fixed(1000000);
+  for (fixed v = polar.GetVMin(); v <= polar.GetVMax(); v += fixed(0.001)) {
+    if (!positive(v - head_wind))
+      continue;
+
+    const fixed ratio = (polar.MSinkRate(v) + sink_rate) / (v - head_wind);
+    if (ratio < best_ratio) {
+      best_ratio = ratio;
+      best_v = v;
+    }
+  }
+
+  return best_v;
+}
+
+void
+GlidePolarTest::TestSpeedToFly()
+{
+  AircraftState state;
+  state.Reset();
+  state.g_load = fixed(1);
+
+  GlideResult solution;
+  solution.Reset();
+
+  static constexpr double mcs[] = { 0, 1, 3 };
+  static constexpr double nettos[] = { -3, -1, 0, 0.5 };
+
+  for (double mc : mcs) {
+    polar.SetMC(fixed(mc));
+
+    /* the speed ring: no head wind */
+    for (double netto : nettos) {
+      state.netto_vario = fixed(netto);
+      ok1(fabs(polar.SpeedToFly(state, solution, false) -
+               ScanSpeedToFly(polar, fixed(0), fixed(-netto)))
+          < fixed(0.002));
+    }
+
+    ok1(fabs(polar.SpeedToFly(state, solution, true) -
+             ScanSpeedToFly(polar, fixed(0), fixed(0))) < fixed(0.002));
+  }
+
+  /* the head wind is only considered at MC=0 */
+  polar.SetMC(fixed(0));
+  solution.validity = GlideResult::Validity::OK;
+  state.netto_vario = fixed(-1);
+
+  for (solution.head_wind = fixed(-10); solution.head_wind <= fixed(10);
+       solution.head_wind += fixed(5))
+    ok1(fabs(polar.SpeedToFly(state, solution, false) -
+             ScanSpeedToFly(polar, solution.head_wind, fixed(1)))
+        < fixed(0.002));
+}
+
+/**
+ * Find the airspeed with the best glide ratio over ground by
+ * scanning the whole speed range.
+ *
+ * @return the inverse glide ratio over ground, or a negative value
+ * if there is no positive ground speed
+ */
+fixed
+GlidePolarTest::FindGlideSpeed(fixed head_wind, fixed cross_wind) const
+{
+  fixed best = fixed(-1);
+  for (fixed v = polar.GetVMin(); v <= polar.GetVMax(); v += fixed(0.001)) {
+    const fixed va = v * polar.GetCruiseEfficiency();
+    if (va <= cross_wind)
+      continue;
+
+    const fixed ground_speed = sqrt(sqr(va) - sqr(cross_wind)) - head_wind;
+    if (!positive(ground_speed))
+      continue;
+
+    const fixed ratio = polar.SinkRate(v) / ground_speed;
+    if (negative(best) || ratio < best)
+      best = ratio;
+  }
+
+  return best;
+}
+
+/**
+ * Compare the inverse glide ratio over ground at the speed from the
+ * lookup table with the optimum.  The documented error bound is
+ * 0.01%.
+ */
+bool
+GlidePolarTest::CheckGlideSpeed() const
+{
+  for (fixed head_wind = fixed(-19.5); head_wind < fixed(20);
+       head_wind += fixed(1.3)) {
+    for (fixed cross_wind = fixed(0); cross_wind < fixed(20);
+         cross_wind += fixed(1.7)) {
+      const fixed v = polar.GetBestGlideSpeed(head_wind, cross_wind);
+      if (!positive(v)) {
+        /* moderate wind must always be covered */
+        if (fabs(head_wind) < fixed(10) && cross_wind < fixed(10))
+          return false;
+
+        continue;
+      }
+
+      const fixed va = v * polar.GetCruiseEfficiency();
+      const fixed ground_speed = sqrt(sqr(va) - sqr(cross_wind)) - head_wind;
+      const fixed ratio = polar.SinkRate(v) / ground_speed;
+      const fixed best = FindGlideSpeed(head_wind, cross_wind);
+      if (!positive(best) || ratio > best * fixed(1.0001))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+void
+GlidePolarTest::TestGlideSpeed()
+{
+  polar.SetMC(fixed(0));
+  ok1(CheckGlideSpeed());
+
+  /* the wind is beyond the table */
+  ok1(negative(polar.GetBestGlideSpeed(fixed(25), fixed(0))));
+  ok1(negative(polar.GetBestGlideSpeed(fixed(0), fixed(25))));
+
+  /* the table must follow changes of the polar */
+  polar.SetBallast(fixed(1));
+  ok1(CheckGlideSpeed());
+
+  polar.SetBugs(fixed(0.7));
+  ok1(CheckGlideSpeed());
+
+  polar.SetCruiseEfficiency(fixed(0.9));
+  ok1(CheckGlideSpeed());
+
+  /* Vmax limits the table's speeds */
+  const fixed v_max = polar.GetVMax();
+  polar.SetVMax(fixed(30));
+  ok1(CheckGlideSpeed());
+  polar.SetVMax(v_max);
+
+  polar.SetCruiseEfficiency(fixed(1));
+  polar.SetBugs(fixed(1));
+  polar.SetBallast(fixed(0));
+}
+
 void
 GlidePolarTest::Run()
 {
@@ -171,11 +334,13 @@ GlidePolarTest::Run()
   TestBallast();
   TestBugs();
   TestMC();
+  TestSpeedToFly();
+  TestGlideSpeed();
 }
 
 int main(int argc, char **argv)
 {
-  plan_tests(46);
+  plan_tests(46 + 20 + 7);
 
   GlidePolarTest test;
   test.Run();
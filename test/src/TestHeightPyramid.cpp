@@ -0,0 +1,170 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/HeightPyramid.hpp"
+#include "Terrain/RasterBuffer.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+
+#include <stdlib.h>
+
+static constexpr unsigned WIDTH = 200, HEIGHT = 150;
+
+/**
+ * The map of the test: two tiles, split at column #SPLIT, and the
+ * overview, whose pixels cover 16x16 map pixels.
+ */
+static constexpr unsigned SPLIT = 120;
+static constexpr unsigned OVERVIEW_WIDTH = (WIDTH + 15) / 16;
+static constexpr unsigned OVERVIEW_HEIGHT = (HEIGHT + 15) / 16;
+
+static void
+Fill(RasterBuffer &buffer)
+{
+  short *data = buffer.GetData();
+  for (unsigned i = 0, n = buffer.GetWidth() * buffer.GetHeight(); i < n; ++i)
+    data[i] = (rand() % 3000) - 100;
+}
+
+/**
+ * Determine the exact bounds of a rectangle, including the overview
+ * pixels covering it.
+ */
+static HeightPyramid::Bounds
+GetExactBounds(const RasterBuffer &left, const RasterBuffer &right,
+               const RasterBuffer &overview,
+               unsigned x0, unsigned y0, unsigned x1, unsigned y1)
+{
+  HeightPyramid::Bounds bounds;
+  bounds.minimum = 32767;
+  bounds.maximum = -32768;
+
+  for (unsigned y = y0; y <= y1; ++y) {
+    for (unsigned x = x0; x <= x1; ++x) {
+      const short h = x < SPLIT
+        ? left.Get(x, y)
+        : right.Get(x - SPLIT, y);
+      const short o = overview.Get(x / 16, y / 16);
+      bounds.minimum = std::min(bounds.minimum, std::min(h, o));
+      bounds.maximum = std::max(bounds.maximum, std::max(h, o));
+    }
+  }
+
+  return bounds;
+}
+
+static void
+RandomRectangle(unsigned &x0, unsigned &y0, unsigned &x1, unsigned &y1)
+{
+  x0 = rand() % WIDTH;
+  y0 = rand() % HEIGHT;
+  x1 = x0 + rand() % (WIDTH - x0);
+  y1 = y0 + rand() % (HEIGHT - y0);
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(5);
+
+  RasterBuffer left(SPLIT, HEIGHT), right(WIDTH - SPLIT, HEIGHT);
+  RasterBuffer overview(OVERVIEW_WIDTH, OVERVIEW_HEIGHT);
+  Fill(left);
+  Fill(right);
+  Fill(overview);
+
+  HeightPyramid pyramid;
+  pyramid.Resize(WIDTH, HEIGHT);
+  ok1(pyramid.GetBlockWidth() == OVERVIEW_WIDTH &&
+      pyramid.GetBlockHeight() == OVERVIEW_HEIGHT);
+
+  pyramid.IncludeOverview(overview);
+  pyramid.Include(left, 0, 0);
+  pyramid.Include(right, SPLIT, 0);
+
+  /* the bounds of any rectangle must include all of its heights */
+  bool valid = true;
+  for (unsigned i = 0; i < 10000; ++i) {
+    unsigned x0, y0, x1, y1;
+    RandomRectangle(x0, y0, x1, y1);
+
+    const HeightPyramid::Bounds bounds = pyramid.GetBounds(x0, y0, x1, y1);
+    const HeightPyramid::Bounds exact =
+      GetExactBounds(left, right, overview, x0, y0, x1, y1);
+    if (bounds.minimum > exact.minimum || bounds.maximum < exact.maximum)
+      valid = false;
+  }
+
+  ok1(valid);
+
+  /* the bounds of a single block are exact */
+  bool exact_blocks = true;
+  for (unsigned y = 0; y < OVERVIEW_HEIGHT; ++y) {
+    for (unsigned x = 0; x < OVERVIEW_WIDTH; ++x) {
+      const unsigned x0 = x * 16, y0 = y * 16;
+      const unsigned x1 = std::min(x0 + 15, WIDTH - 1);
+      const unsigned y1 = std::min(y0 + 15, HEIGHT - 1);
+
+      const HeightPyramid::Bounds bounds = pyramid.GetBounds(x0, y0, x1, y1);
+      const HeightPyramid::Bounds exact =
+        GetExactBounds(left, right, overview, x0, y0, x1, y1);
+      if (bounds.minimum != exact.minimum || bounds.maximum != exact.maximum)
+        exact_blocks = false;
+    }
+  }
+
+  ok1(exact_blocks);
+
+  /* a pyramid loaded from the saved blocks yields the same bounds */
+  AllocatedArray<short> blocks(2 * OVERVIEW_WIDTH * OVERVIEW_HEIGHT);
+  pyramid.SaveBlocks(blocks.begin());
+
+  HeightPyramid loaded;
+  loaded.Resize(WIDTH, HEIGHT);
+  loaded.LoadBlocks(blocks.begin());
+
+  bool same = true;
+  for (unsigned i = 0; i < 1000; ++i) {
+    unsigned x0, y0, x1, y1;
+    RandomRectangle(x0, y0, x1, y1);
+
+    const HeightPyramid::Bounds a = pyramid.GetBounds(x0, y0, x1, y1);
+    const HeightPyramid::Bounds b = loaded.GetBounds(x0, y0, x1, y1);
+    if (a.minimum != b.minimum || a.maximum != b.maximum)
+      same = false;
+  }
+
+  ok1(same);
+
+  /* bounds never narrow: including lower terrain changes nothing */
+  const HeightPyramid::Bounds before = pyramid.GetBounds(0, 0, 15, 15);
+  RasterBuffer flat(16, 16);
+  std::fill(flat.GetData(), flat.GetData() + 16 * 16, before.minimum);
+  pyramid.Include(flat, 0, 0);
+  const HeightPyramid::Bounds after = pyramid.GetBounds(0, 0, 15, 15);
+  ok1(after.minimum == before.minimum && after.maximum == before.maximum);
+
+  return exit_status();
+}
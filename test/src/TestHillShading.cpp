@@ -0,0 +1,276 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/HillShading.hpp"
+#include "Terrain/RasterBuffer.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+
+#include <stdlib.h>
+
+using namespace HillShading;
+
+enum class Pattern {
+  /** a smooth hill */
+  HILL,
+
+  /** random heights, including steep slopes */
+  NOISE,
+
+  /** random heights with water and invalid cells */
+  SPECIAL,
+};
+
+static short
+RandomHeight(Pattern pattern)
+{
+  switch (pattern) {
+  case Pattern::HILL:
+    break;
+
+  case Pattern::NOISE:
+    return (rand() % 4000) - 200;
+
+  case Pattern::SPECIAL:
+    switch (rand() % 16) {
+    case 0:
+      return RasterBuffer::TERRAIN_INVALID;
+
+    case 1:
+      return RasterBuffer::TERRAIN_WATER_THRESHOLD;
+
+    case 2:
+      return RasterBuffer::TERRAIN_WATER_THRESHOLD - 1;
+
+    default:
+      return (rand() % 3000) - 100;
+    }
+  }
+
+  return 0;
+}
+
+static void
+FillMatrix(short *matrix, unsigned width, unsigned height, Pattern pattern)
+{
+  for (unsigned y = 0; y < height; ++y) {
+    for (unsigned x = 0; x < width; ++x) {
+      short h;
+      if (pattern == Pattern::HILL) {
+        const int dx = (int)x - (int)width / 3, dy = (int)y - (int)height / 2;
+        h = std::max(0, 2000 - (dx * dx + dy * dy) / 4);
+      } else
+        h = RandomHeight(pattern);
+
+      matrix[y * width + x] = h;
+    }
+  }
+}
+
+/**
+ * Compare the vectorized implementation with the scalar one.
+ *
+ * @return the number of differing pixels
+ */
+static unsigned
+CompareShaded(const short *matrix, unsigned width, unsigned height,
+              Parameters parameters)
+{
+  AllocatedArray<uint16_t> a(width), b(width);
+
+  unsigned n = 0;
+  for (unsigned y = 0; y < height; ++y) {
+    parameters.simd = true;
+    ShadedRow(matrix, width, height, y, parameters, a.begin());
+    parameters.simd = false;
+    ShadedRow(matrix, width, height, y, parameters, b.begin());
+
+    for (unsigned x = 0; x < width; ++x)
+      if (a[x] != b[x])
+        ++n;
+  }
+
+  return n;
+}
+
+static bool
+IsValidIndex(unsigned index)
+{
+  return index < BACKGROUND
+    ? (index & 0xff) <= WATER
+    : index == BACKGROUND;
+}
+
+static void
+TestShaded(Pattern pattern, unsigned width, unsigned height)
+{
+  AllocatedArray<short> matrix(width * height);
+  FillMatrix(matrix.begin(), width, height, pattern);
+
+  static constexpr int suns[][3] = {
+    { 0, -132, 217 },
+    { -93, 54, 235 },
+    { 188, 0, 171 },
+  };
+
+  unsigned mismatches = 0;
+  for (auto &sun : suns) {
+    for (unsigned q = 1; q <= 9; q += 4) {
+      for (unsigned height_scale = 0; height_scale <= 4; height_scale += 4) {
+        Parameters parameters;
+        parameters.sx = sun[0];
+        parameters.sy = sun[1];
+        parameters.sz = sun[2];
+        parameters.contrast = 96;
+        parameters.height_scale = height_scale;
+        parameters.height_slope_factor = 1 + q * 10;
+        parameters.quantisation = q;
+        parameters.simd = true;
+
+        mismatches += CompareShaded(matrix.begin(), width, height, parameters);
+      }
+    }
+  }
+
+  ok1(mismatches == 0);
+}
+
+static void
+TestShadedRange()
+{
+  /* all indices must be within the color table */
+  static constexpr unsigned width = 37, height = 5;
+  short matrix[width * height];
+  FillMatrix(matrix, width, height, Pattern::SPECIAL);
+
+  Parameters parameters;
+  parameters.sx = 0;
+  parameters.sy = -132;
+  parameters.sz = 217;
+  parameters.contrast = 255;
+  parameters.height_scale = 2;
+  parameters.height_slope_factor = 30;
+  parameters.quantisation = 2;
+  parameters.simd = true;
+
+  uint16_t row[width];
+  bool valid = true;
+  for (unsigned y = 0; y < height; ++y) {
+    ShadedRow(matrix, width, height, y, parameters, row);
+    for (unsigned x = 0; x < width; ++x)
+      if (!IsValidIndex(row[x]))
+        valid = false;
+  }
+
+  ok1(valid);
+}
+
+static void
+TestPartialRow()
+{
+  /* a row calculated in pieces must be the same as the whole row */
+  static constexpr unsigned width = 101, height = 7;
+  short matrix[width * height];
+  FillMatrix(matrix, width, height, Pattern::NOISE);
+
+  Parameters parameters;
+  parameters.sx = -93;
+  parameters.sy = 54;
+  parameters.sz = 235;
+  parameters.contrast = 96;
+  parameters.height_scale = 4;
+  parameters.height_slope_factor = 30;
+  parameters.quantisation = 3;
+  parameters.simd = true;
+
+  static constexpr unsigned splits[] = { 1, 2, 3, 4, 11, 50, 97, 99, 100 };
+
+  uint16_t whole[width], pieces[width];
+  bool equal = true;
+  for (unsigned y = 0; y < height; ++y) {
+    ShadedRow(matrix, width, height, y, parameters, whole);
+
+    for (unsigned split : splits) {
+      ShadedRow(matrix, width, height, y, 0, split, parameters, pieces);
+      ShadedRow(matrix, width, height, y, split, width, parameters, pieces);
+      if (!std::equal(whole, whole + width, pieces))
+        equal = false;
+    }
+  }
+
+  ok1(equal);
+}
+
+static void
+TestUnshaded()
+{
+  static constexpr short src[] = {
+    0, -100, 10, 1000, 32767,
+    RasterBuffer::TERRAIN_WATER_THRESHOLD,
+    RasterBuffer::TERRAIN_INVALID,
+    512, 513, 1020, 1024, -29999,
+    RasterBuffer::TERRAIN_WATER_THRESHOLD - 1,
+  };
+  static constexpr unsigned n = sizeof(src) / sizeof(src[0]);
+
+  uint16_t dest[n];
+  UnshadedRow(src, n, 2, dest);
+
+  ok1(dest[0] == FLAT * 256);
+  ok1(dest[1] == FLAT * 256);
+  ok1(dest[2] == FLAT * 256 + 2);
+  ok1(dest[3] == FLAT * 256 + 250);
+  ok1(dest[4] == FLAT * 256 + 254);
+  ok1(dest[5] == FLAT * 256 + WATER);
+  ok1(dest[6] == BACKGROUND);
+  ok1(dest[7] == FLAT * 256 + 128);
+  ok1(dest[8] == FLAT * 256 + 128);
+  ok1(dest[9] == FLAT * 256 + 254);
+  ok1(dest[10] == FLAT * 256 + 254);
+  ok1(dest[11] == FLAT * 256);
+  ok1(dest[12] == FLAT * 256 + WATER);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(13 + 1 + 1 + 7);
+
+  TestUnshaded();
+  TestShadedRange();
+
+  srand(1);
+  TestPartialRow();
+
+  srand(42);
+  TestShaded(Pattern::HILL, 320, 240);
+  TestShaded(Pattern::NOISE, 320, 240);
+  TestShaded(Pattern::SPECIAL, 320, 240);
+  TestShaded(Pattern::NOISE, 61, 17);
+  TestShaded(Pattern::NOISE, 9, 9);
+  TestShaded(Pattern::NOISE, 3, 40);
+  TestShaded(Pattern::SPECIAL, 19, 2);
+
+  return exit_status();
+}
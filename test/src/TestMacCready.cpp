@@ -24,6 +24,7 @@
 #include "Engine/GlideSolvers/GlideSettings.hpp"
 #include "Engine/GlideSolvers/GlidePolar.hpp"
 #include "Engine/GlideSolvers/GlideState.hpp"
+#include "Engine/GlideSolvers/GlideBatch.hpp"
 #include "Engine/GlideSolvers/GlideResult.hpp"
 #include "Engine/GlideSolvers/MacCready.hpp"
 
@@ -33,6 +34,8 @@
 
 #include "TestUtil.hpp"
 
+#include <vector>
+
 static GlideSettings glide_settings;
 static GlidePolar glide_polar(fixed(0));
 
@@ -132,6 +135,129 @@ TestWind(const SpeedVector &wind)
   Test(fixed(100000), fixed(4000), wind);
 }
 
+/**
+ * Compare the pure glide at MC=0 with cross wind to a scan of the
+ * whole speed range.  The glide speed comes from a lookup table in
+ * #GlidePolar, and the height loss must be within 0.01% of the
+ * optimum.
+ */
+static void
+TestCrossWind(const SpeedVector wind)
+{
+  const GeoVector vector(fixed(10000), Angle::Zero());
+  const GlideState state(vector, fixed(2000), fixed(4000), wind);
+  const GlideResult result =
+    MacCready::Solve(glide_settings, glide_polar, state);
+
+  const MacCready mac_cready(glide_settings, glide_polar);
+  fixed best = fixed(-1);
+  for (fixed v = glide_polar.GetVMin(); v <= glide_polar.GetVMax();
+       v += fixed(0.001)) {
+    const GlideResult r = mac_cready.SolveGlide(state, v);
+    if (r.IsOk() && (negative(best) || r.height_glide < best))
+      best = r.height_glide;
+  }
+
+  ok1(result.IsOk() && positive(best) &&
+      result.height_glide <= best * fixed(1.0001));
+}
+
+static void
+TestCrossWinds()
+{
+  for (unsigned angle = 30; angle <= 150; angle += 30) {
+    TestCrossWind(SpeedVector(Angle::Degrees(angle), fixed(5)));
+    TestCrossWind(SpeedVector(Angle::Degrees(angle), fixed(10)));
+    TestCrossWind(SpeedVector(Angle::Degrees(angle), fixed(15)));
+  }
+}
+
+gcc_pure
+static bool
+IsSameResult(const GlideResult &a, const GlideResult &b)
+{
+  if (a.validity != b.validity)
+    return false;
+
+  if (!a.IsOk())
+    return true;
+
+  return equals(a.vector.distance, b.vector.distance) &&
+    equals(a.head_wind, b.head_wind) &&
+    equals(a.v_opt, b.v_opt) &&
+    equals(a.height_climb, b.height_climb) &&
+    equals(a.height_glide, b.height_glide) &&
+    equals(a.time_elapsed, b.time_elapsed) &&
+    /* SolveVertical() doesn't calculate time_virtual */
+    (!positive(a.vector.distance) ||
+     equals(a.time_virtual, b.time_virtual)) &&
+    equals(a.altitude_difference, b.altitude_difference) &&
+    equals(a.min_arrival_altitude, b.min_arrival_altitude) &&
+    equals(a.pure_glide_altitude_difference,
+           b.pure_glide_altitude_difference) &&
+    equals(a.effective_wind_speed, b.effective_wind_speed);
+}
+
+/**
+ * Verify that MacCready::SolveBatch() gives the same results as
+ * solving each destination on its own.
+ */
+static bool
+TestBatch(const SpeedVector wind, bool straight)
+{
+  const fixed altitude(1500);
+
+  GlideBatch batch;
+  batch.Reset(altitude, wind);
+
+  for (unsigned i = 0; i < 200; ++i) {
+    /* a spiral of destinations at various elevations, including
+       one straight below the aircraft */
+    const GeoVector vector(fixed(int(i * i)) * 5,
+                           Angle::Degrees(int(i * 37 % 360)));
+    batch.Add(vector, fixed(int(i * 53 % 1200)));
+  }
+
+  std::vector<GlideResult> results(batch.size());
+  const MacCready mac_cready(glide_settings, glide_polar);
+  mac_cready.SolveBatch(batch, results.data(), straight);
+
+  for (unsigned i = 0; i < batch.size(); ++i) {
+    const GlideState state = batch.GetState(i);
+    const GlideResult expected = straight
+      ? mac_cready.SolveStraight(state)
+      : mac_cready.Solve(state);
+
+    if (!IsSameResult(results[i], expected))
+      return false;
+  }
+
+  return true;
+}
+
+static void
+TestBatches()
+{
+  static constexpr double mcs[] = { 0, 1, 4 };
+  static const SpeedVector winds[] = {
+    SpeedVector(Angle::Zero(), fixed(0)),
+    SpeedVector(Angle::Degrees(60), fixed(5)),
+    SpeedVector(Angle::Degrees(200), fixed(15)),
+    SpeedVector(Angle::Degrees(330), fixed(30)),
+  };
+
+  for (double mc : mcs) {
+    glide_polar.SetMC(fixed(mc));
+
+    for (const SpeedVector &wind : winds) {
+      ok1(TestBatch(wind, false));
+      ok1(TestBatch(wind, true));
+    }
+  }
+
+  glide_polar.SetMC(fixed(0));
+}
+
 static void
 TestAll()
 {
@@ -145,11 +271,13 @@ TestAll()
 
 int main(int argc, char **argv)
 {
-  plan_tests(2095);
+  plan_tests(2095 + 15 + 24);
 
   glide_settings.SetDefaults();
 
   TestAll();
+  TestCrossWinds();
+  TestBatches();
 
   glide_polar.SetMC(fixed(0.1));
   TestAll();
@@ -0,0 +1,234 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+/*
+ * Compare the branch-and-bound search of #OLCTriangle with a brute
+ * force search over all triangles of the trace, using the same
+ * rules.
+ */
+
+#include "Contest/Solvers/OLCTriangle.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdio.h>
+
+/**
+ * Maximum allowed distance between start and finish, see
+ * OLCTriangle.cpp.
+ */
+static constexpr fixed max_distance(5000);
+
+/**
+ * May the specified point be the finish of a triangle which was
+ * started at the other one?
+ */
+gcc_pure
+static bool
+IsClosed(const Trace &trace, const TracePoint &start,
+         const TracePoint &finish)
+{
+  const unsigned max_range =
+    trace.ProjectRange(start.GetLocation(), max_distance);
+
+  return start.FlatDistanceTo(finish) <= max_range &&
+    start.GetLocation().Distance(finish.GetLocation()) < max_distance;
+}
+
+/**
+ * Check all triangles of the trace.
+ *
+ * @return the flat perimeter of the largest valid triangle
+ */
+gcc_pure
+static unsigned
+BruteForce(const Trace &trace, const std::vector<TracePoint> &points,
+           bool is_fai)
+{
+  const unsigned n = points.size();
+
+  /* the start may be any point at or before the first turn point,
+     and the finish any later point close to it */
+  std::vector<unsigned> last_finish(n);
+  unsigned reach = 0;
+  for (unsigned start = 0; start < n; ++start) {
+    for (unsigned f = n - 1; f > start; --f) {
+      if (IsClosed(trace, points[start], points[f])) {
+        reach = std::max(reach, f);
+        break;
+      }
+    }
+
+    last_finish[start] = std::max(reach, start);
+  }
+
+  std::vector<unsigned> distances(n * n);
+  for (unsigned a = 0; a < n; ++a)
+    for (unsigned b = 0; b < n; ++b)
+      distances[a * n + b] = points[a].FlatDistanceTo(points[b]);
+
+  const unsigned *const d = distances.data();
+
+  unsigned best = 0;
+  for (unsigned a = 0; a < n; ++a) {
+    for (unsigned b = a + 1; b < n; ++b) {
+      const unsigned d_ab = d[a * n + b];
+      if (is_fai && 4 * d_ab <= best)
+        /* the shortest leg must have at least 25% */
+        continue;
+
+      for (unsigned c = b + 1; c <= last_finish[a]; ++c) {
+        const unsigned d_bc = d[b * n + c], d_ca = d[c * n + a];
+        if (d_ab + d_bc + d_ca <= best)
+          continue;
+
+        const unsigned total =
+          OLCTriangle::CheckTriangle(is_fai, points[a], points[b], points[c],
+                                     d_ab, d_bc, d_ca);
+        if (total > best)
+          best = total;
+      }
+    }
+  }
+
+  return best;
+}
+
+gcc_pure
+static const TracePoint *
+FindPoint(const std::vector<TracePoint> &points,
+          const ContestTracePoint &point)
+{
+  for (const TracePoint &i : points)
+    if (i.GetTime() == point.GetTime())
+      return &i;
+
+  return NULL;
+}
+
+/**
+ * @return the flat perimeter of the solution
+ */
+gcc_pure
+static unsigned
+GetPerimeter(const std::vector<TracePoint> &points,
+             const ContestTraceVector &solution)
+{
+  if (solution.size() != 5)
+    return 0;
+
+  const TracePoint *const a = FindPoint(points, solution[1]);
+  const TracePoint *const b = FindPoint(points, solution[2]);
+  const TracePoint *const c = FindPoint(points, solution[3]);
+  if (a == NULL || b == NULL || c == NULL)
+    return 0;
+
+  return a->FlatDistanceTo(*b) + b->FlatDistanceTo(*c) +
+    c->FlatDistanceTo(*a);
+}
+
+static bool
+LoadTrace(const char *filename, Trace &trace)
+{
+  FileLineReaderA reader(filename);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open %s\n", filename);
+    return false;
+  }
+
+  char *line;
+  while ((line = reader.ReadLine()) != NULL) {
+    IGCFix fix;
+    if (!IGCParseFix(line, fix) || !fix.gps_valid)
+      continue;
+
+    const unsigned time = fix.time.GetSecondOfDay();
+    if (time <= 1)
+      continue;
+
+    trace.push_back(TracePoint(fix.location, time, fixed(fix.gps_altitude),
+                               fixed(0), 0));
+  }
+
+  return true;
+}
+
+static bool
+TestTriangle(const Trace &trace, bool is_fai)
+{
+  std::vector<TracePoint> points;
+  for (const TracePoint &point : trace)
+    points.push_back(point);
+
+  OLCTriangle solver(trace, is_fai, false);
+  solver.Reset();
+  solver.Solve(true);
+
+  const unsigned found = GetPerimeter(points, solver.GetBestSolution());
+  const unsigned expected = BruteForce(trace, points, is_fai);
+  if (found != expected || found == 0) {
+    fprintf(stderr, "%s: found %u, expected %u\n",
+            is_fai ? "fai" : "free", found, expected);
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  static const char *const default_files[] = {
+    "test/data/01lz1hq1.igc",
+    "test/data/0asljd01.igc",
+    "test/data/9crx3101.igc",
+    "test/data/apf-bug554.igc",
+  };
+
+  const char *const *files = default_files;
+  unsigned n_files = ARRAY_SIZE(default_files);
+  if (argc > 1) {
+    files = argv + 1;
+    n_files = argc - 1;
+  }
+
+  plan_tests(n_files * 2);
+
+  for (unsigned i = 0; i < n_files; ++i) {
+    /* the settings of TraceComputer's full trace, which is used by
+       the triangle contests */
+    Trace trace(120, Trace::null_time, 1024);
+    const bool loaded = LoadTrace(files[i], trace);
+
+    ok(loaded && TestTriangle(trace, true), "%s fai", files[i]);
+    ok(loaded && TestTriangle(trace, false), "%s free", files[i]);
+  }
+
+  return exit_status();
+}
@@ -0,0 +1,261 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Util/PackedPointTree.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <stdlib.h>
+
+struct Item {
+  int x, y;
+  unsigned id;
+
+  bool operator==(const Item &other) const {
+    return id == other.id;
+  }
+};
+
+struct ItemAccessor {
+  int GetX(const Item &item) const {
+    return item.x;
+  }
+
+  int GetY(const Item &item) const {
+    return item.y;
+  }
+};
+
+typedef PackedPointTree<Item, ItemAccessor> ItemTree;
+
+/**
+ * The reference data: items indexed by their id, with the erased
+ * ones marked.
+ */
+struct Reference {
+  std::vector<Item> items;
+  std::vector<bool> erased;
+};
+
+static int
+RandomCoordinate()
+{
+  /* a narrow range, so there are duplicate positions */
+  return rand() % 20000 - 10000;
+}
+
+static ItemTree::distance_type
+SquareDistance(const Item &item, int x, int y)
+{
+  return ItemTree::Square(item.x - x) + ItemTree::Square(item.y - y);
+}
+
+struct RangeCounter {
+  unsigned count, id_sum;
+
+  RangeCounter():count(0), id_sum(0) {}
+
+  void operator()(const Item &item) {
+    ++count;
+    id_sum += item.id;
+  }
+};
+
+static bool
+TestWithinRange(const ItemTree &tree, const Reference &reference)
+{
+  for (unsigned i = 0; i < 200; ++i) {
+    const int x = RandomCoordinate(), y = RandomCoordinate();
+    const unsigned range = rand() % 3000;
+
+    RangeCounter counter;
+    tree.VisitWithinRange(x, y, range, counter);
+
+    RangeCounter expected;
+    for (const auto &j : reference.items)
+      if (!reference.erased[j.id] &&
+          SquareDistance(j, x, y) <= ItemTree::Square(range))
+        expected(j);
+
+    if (counter.count != expected.count || counter.id_sum != expected.id_sum)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Accept only half of the items, to check the predicate of
+ * PackedPointTree::FindNearestIf().
+ */
+struct EvenId {
+  bool operator()(const Item &item) const {
+    return (item.id & 1) == 0;
+  }
+};
+
+static bool
+TestNearest(const ItemTree &tree, const Reference &reference)
+{
+  const EvenId predicate;
+
+  for (unsigned i = 0; i < 200; ++i) {
+    const int x = RandomCoordinate(), y = RandomCoordinate();
+    const unsigned range = rand() % 1000;
+
+    const auto found = tree.FindNearestIf(x, y, range, predicate);
+
+    /* find the nearest distance with a linear scan */
+    const ItemTree::distance_type max = ItemTree::Square(range);
+    ItemTree::distance_type best = max + 1;
+    for (const auto &j : reference.items)
+      if (!reference.erased[j.id] && predicate(j))
+        best = std::min(best, SquareDistance(j, x, y));
+
+    if (best > max) {
+      if (found.first != nullptr)
+        return false;
+    } else {
+      if (found.first == nullptr ||
+          reference.erased[found.first->id] ||
+          !predicate(*found.first) ||
+          found.second != best ||
+          SquareDistance(*found.first, x, y) != best)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+static bool
+TestIterator(const ItemTree &tree, const Reference &reference)
+{
+  std::vector<bool> seen(reference.items.size(), false);
+  unsigned count = 0;
+  for (const auto &i : tree) {
+    if (reference.erased[i.id] || seen[i.id])
+      return false;
+
+    seen[i.id] = true;
+    ++count;
+  }
+
+  return count == tree.size();
+}
+
+static void
+TestTree(unsigned n)
+{
+  Reference reference;
+  std::vector<Item> items;
+  for (unsigned i = 0; i < n; ++i) {
+    const Item item = { RandomCoordinate(), RandomCoordinate(), i };
+    items.push_back(item);
+  }
+
+  reference.items = items;
+  reference.erased.assign(n, false);
+
+  ItemTree tree;
+  tree.Build(items.begin(), items.end());
+  ok1(tree.IsBuilt());
+  ok1(tree.size() == n);
+  ok1(TestWithinRange(tree, reference));
+  ok1(TestNearest(tree, reference));
+  ok1(TestIterator(tree, reference));
+
+  /* erase some items */
+  bool found = true;
+  for (unsigned i = 0; i < n / 10; ++i) {
+    const unsigned id = rand() % n;
+    if (!reference.erased[id]) {
+      const unsigned position = tree.Find(reference.items[id]);
+      if (position == ItemTree::NOT_FOUND) {
+        found = false;
+        break;
+      }
+
+      tree.Erase(position);
+      reference.erased[id] = true;
+
+      if (tree.Find(reference.items[id]) != ItemTree::NOT_FOUND)
+        found = false;
+    }
+  }
+
+  /* move some items */
+  for (unsigned i = 0; i < n / 10; ++i) {
+    const unsigned id = rand() % n;
+    if (!reference.erased[id]) {
+      const unsigned position = tree.Find(reference.items[id]);
+      if (position == ItemTree::NOT_FOUND) {
+        found = false;
+        break;
+      }
+
+      Item &item = reference.items[id];
+      item.x = RandomCoordinate();
+      item.y = RandomCoordinate();
+      tree.Replace(position, item);
+    }
+  }
+
+  ok1(found);
+
+  unsigned n_alive = 0;
+  for (unsigned i = 0; i < n; ++i)
+    if (!reference.erased[i])
+      ++n_alive;
+
+  ok1(tree.size() == n_alive);
+  ok1(TestWithinRange(tree, reference));
+  ok1(TestNearest(tree, reference));
+  ok1(TestIterator(tree, reference));
+
+  tree.Clear();
+  ok1(!tree.IsBuilt());
+  ok1(tree.IsEmpty());
+}
+
+int main(int argc, char **argv)
+{
+  static constexpr unsigned sizes[] = { 1, 17, 300, 5000 };
+
+  plan_tests(3 + 12 * ARRAY_SIZE(sizes));
+
+  srand(42);
+
+  /* an empty tree */
+  ItemTree tree;
+  std::vector<Item> items;
+  tree.Build(items.begin(), items.end());
+  ok1(!tree.IsBuilt());
+  ok1(tree.FindNearest(0, 0, 100000).first == nullptr);
+  ok1(tree.begin() == tree.end());
+
+  for (const unsigned n : sizes)
+    TestTree(n);
+
+  return exit_status();
+}
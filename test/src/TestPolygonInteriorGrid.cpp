@@ -0,0 +1,112 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/ConvexHull/PolygonInteriorGrid.hpp"
+#include "Geo/ConvexHull/PolygonInterior.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "TestUtil.hpp"
+
+#include <stdlib.h>
+
+static fixed
+RandomFraction()
+{
+  return fixed(rand() % 10001) / 10000;
+}
+
+/**
+ * Generate a closed star-shaped polygon with a jagged border, like
+ * the TMAs in OpenAir files.
+ */
+static SearchPointVector
+MakeStar(unsigned n, bool self_intersecting)
+{
+  const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+
+  SearchPointVector polygon;
+  for (unsigned i = 0; i < n; ++i) {
+    /* a self-intersecting polygon visits the angles twice */
+    const unsigned turns = self_intersecting ? 2 : 1;
+    const Angle angle = Angle::FullCircle() * (fixed(i * turns) / n);
+    const fixed radius = fixed(0.2) + fixed(0.3) * RandomFraction();
+
+    polygon.emplace_back(GeoPoint(center.longitude +
+                                  Angle::Degrees(radius * angle.cos()),
+                                  center.latitude +
+                                  Angle::Degrees(radius * angle.sin())));
+  }
+
+  polygon.push_back(polygon.front());
+  return polygon;
+}
+
+static bool
+IsSame(const PolygonInteriorGrid &grid, const SearchPointVector &polygon,
+       const GeoPoint &p)
+{
+  const SearchPoint *begin = polygon.data(),
+    *end = polygon.data() + polygon.size();
+  return grid.IsInside(p, begin) == PolygonInterior(p, begin, end);
+}
+
+static bool
+TestPolygon(const SearchPointVector &polygon)
+{
+  const PolygonInteriorGrid grid(polygon.data(),
+                                 polygon.data() + polygon.size());
+
+  /* the vertices and points on the edges */
+  for (unsigned i = 0; i + 1 < polygon.size(); ++i) {
+    const GeoPoint &a = polygon[i].GetLocation();
+    const GeoPoint &b = polygon[i + 1].GetLocation();
+    if (!IsSame(grid, polygon, a) ||
+        !IsSame(grid, polygon, a.Interpolate(b, fixed(0.5))) ||
+        !IsSame(grid, polygon, a.Interpolate(b, RandomFraction())))
+      return false;
+  }
+
+  /* random points in and around the bounding box */
+  for (unsigned i = 0; i < 20000; ++i) {
+    const GeoPoint p(Angle::Degrees(fixed(6.4) + fixed(1.2) * RandomFraction()),
+                     Angle::Degrees(fixed(50.4) + fixed(1.2) * RandomFraction()));
+    if (!IsSame(grid, polygon, p))
+      return false;
+  }
+
+  return grid.GetMemoryUsage() > 0;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(6);
+
+  srand(1);
+
+  ok1(TestPolygon(MakeStar(PolygonInteriorGrid::MIN_VERTICES, false)));
+  ok1(TestPolygon(MakeStar(100, false)));
+  ok1(TestPolygon(MakeStar(500, false)));
+  ok1(TestPolygon(MakeStar(5000, false)));
+  ok1(TestPolygon(MakeStar(100, true)));
+  ok1(TestPolygon(MakeStar(1000, true)));
+
+  return exit_status();
+}
@@ -24,31 +24,149 @@
 #include "IGC/IGCFix.hpp"
 #include "IO/FileLineReader.hpp"
 #include "Engine/Trace/Trace.hpp"
-#include "Engine/Trace/Vector.hpp"
-#include "Printing.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "Util/Macros.hpp"
 #include "TestUtil.hpp"
 
-#include <windef.h>
-#include <assert.h>
-#include <cstdio>
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
 
-static void
-OnAdvance(Trace &trace, const GeoPoint &loc, const fixed alt, const fixed t)
-{
-  if (t>fixed(1)) {
-    const TracePoint point(loc, unsigned(t), alt, fixed(0), 0);
-    trace.push_back(point);
+/**
+ * A naive implementation of the thinning rules of #Trace.  It
+ * calculates the metrics of all points from scratch and searches
+ * the whole trace for each point to be removed.
+ */
+class ReferenceTrace {
+  const unsigned no_thin_time, max_time, max_size, opt_size;
+
+  TaskProjection projection;
+
+  std::vector<TracePoint> points;
+
+public:
+  ReferenceTrace(unsigned _no_thin_time, unsigned _max_time,
+                 unsigned _max_size)
+    :no_thin_time(_no_thin_time), max_time(_max_time),
+     max_size(_max_size), opt_size((3 * _max_size) / 4) {}
+
+  const std::vector<TracePoint> &GetPoints() const {
+    return points;
   }
-// get the trace, just so it's included in timing
-  TracePointVector v;
-  trace.GetPoints(v);
-  if (trace.size()>1) {
-//    assert(abs(v.size()-trace.size())<2);
+
+  void push_back(TracePoint point) {
+    if (points.empty()) {
+      projection.Reset(point.GetLocation());
+      projection.Update();
+    } else if (point.GetTime() < points.back().GetTime()) {
+      if (point.GetTime() + 180 < points.back().GetTime()) {
+        points.clear();
+        return;
+      }
+
+      while (!points.empty() &&
+             points.back().GetTime() > point.GetTime() - 10)
+        points.pop_back();
+    } else if (point.GetTime() - points.back().GetTime() < 2)
+      return;
+
+    if (max_time != Trace::null_time && point.GetTime() > max_time) {
+      const unsigned min_time = point.GetTime() - max_time;
+      while (!points.empty() && points.front().GetTime() < min_time)
+        points.erase(points.begin());
+    }
+
+    if (points.size() >= max_size) {
+      EraseDelta(opt_size, no_thin_time);
+      if (points.size() > opt_size && no_thin_time > 0)
+        EraseDelta(opt_size, 0);
+    }
+
+    point.Project(projection);
+    points.push_back(point);
   }
+
+private:
+  struct Rank {
+    unsigned distance, time, index;
+
+    bool operator<(const Rank &other) const {
+      if (distance != other.distance)
+        return distance < other.distance;
+
+      if (time != other.time)
+        return time < other.time;
+
+      return index < other.index;
+    }
+  };
+
+  gcc_pure
+  Rank GetRank(unsigned i) const {
+    const TracePoint &previous = points[i - 1], &next = points[i + 1];
+
+    const int d = previous.FlatDistanceTo(points[i]) +
+      points[i].FlatDistanceTo(next) - previous.FlatDistanceTo(next);
+    const unsigned t = next.DeltaTime(previous) -
+      std::min(next.DeltaTime(points[i]), points[i].DeltaTime(previous));
+
+    return Rank{ unsigned(abs(d)), t, i };
+  }
+
+  void EraseDelta(unsigned target_size, unsigned recent) {
+    if (points.size() < 2)
+      return;
+
+    const unsigned last_time = points.back().GetTime();
+    const unsigned recent_time = last_time > recent ? last_time - recent : 0;
+
+    while (points.size() > target_size) {
+      Rank best{ 0, 0, 0 };
+      for (unsigned i = 1; i + 1 < points.size(); ++i) {
+        if (points[i].GetTime() >= recent_time)
+          continue;
+
+        const Rank rank = GetRank(i);
+        if (best.index == 0 || rank < best)
+          best = rank;
+      }
+
+      if (best.index == 0)
+        /* no candidate left */
+        return;
+
+      points.erase(points.begin() + best.index);
+    }
+  }
+};
+
+gcc_pure
+static bool
+IsSame(const Trace &trace, const ReferenceTrace &reference)
+{
+  const std::vector<TracePoint> &points = reference.GetPoints();
+  if (trace.size() != points.size())
+    return false;
+
+  auto i = points.begin();
+  for (const TracePoint &point : trace) {
+    if (point.GetTime() != i->GetTime())
+      return false;
+
+    ++i;
+  }
+
+  return true;
 }
 
+/**
+ * Feed all fixes of the IGC file into a #Trace and a
+ * #ReferenceTrace, and verify that both keep the same points.
+ */
 static bool
-TestTrace(const char *filename, unsigned ntrace, bool output=false)
+TestTrace(const char *filename, unsigned no_thin_time, unsigned max_time,
+          unsigned max_size)
 {
   FileLineReaderA reader(filename);
   if (reader.error()) {
@@ -56,51 +174,67 @@ TestTrace(const char *filename, unsigned ntrace, bool output=false)
     return false;
   }
 
-  printf("# %d", ntrace);  
-  Trace trace(1000, ntrace);
+  Trace trace(no_thin_time, max_time, max_size);
+  ReferenceTrace reference(no_thin_time, max_time, max_size);
 
   char *line;
-  int i = 0;
-  for (; (line = reader.ReadLine()) != NULL; i++) {
-    if (output && (i % 500 == 0)) {
-      putchar('.');
-      fflush(stdout);
-    }
-
+  while ((line = reader.ReadLine()) != NULL) {
     IGCFix fix;
     if (!IGCParseFix(line, fix) || !fix.gps_valid)
       continue;
 
-    OnAdvance(trace,
-               fix.location,
-               fixed(fix.gps_altitude),
-               fixed(fix.time.GetSecondOfDay()));
+    const unsigned time = fix.time.GetSecondOfDay();
+    if (time <= 1)
+      continue;
+
+    const TracePoint point(fix.location, time, fixed(fix.gps_altitude),
+                           fixed(0), 0);
+    trace.push_back(point);
+    reference.push_back(point);
+
+    if (!IsSame(trace, reference))
+      return false;
   }
-  putchar('\n');
-  printf("# samples %d\n", i);
+
   return true;
 }
 
+struct TraceConfig {
+  const char *name;
+  unsigned no_thin_time, max_time, max_size;
+};
+
+/* the settings of TraceComputer */
+static constexpr TraceConfig configs[] = {
+  { "full", 120, Trace::null_time, 1024 },
+  { "contest", 0, Trace::null_time, 512 },
+  { "sprint", 0, 9000, 128 },
+  { "small", 60, Trace::null_time, 16 },
+};
 
 int main(int argc, char **argv)
 {
-  if (argc < 3) {
-    unsigned n = 100;
-    if (argc > 1) {
-      n = atoi(argv[1]);
-    }
-    TestTrace("test/data/09kc3ov3.igc", n);
-  } else {
-    assert(argc >= 3);
-    unsigned n = atoi(argv[2]);
-    plan_tests(n);
-    
-    for (unsigned i=2; i<2+n; i++) {
-      unsigned nt = pow(2,i);
-      char buf[100];
-      sprintf(buf," trace size %d", nt);
-      ok(TestTrace(argv[1], nt),buf, 0);
+  static const char *const default_files[] = {
+    "test/data/01lz1hq1.igc",
+  };
+
+  const char *const *files = default_files;
+  unsigned n_files = ARRAY_SIZE(default_files);
+  if (argc > 1) {
+    files = argv + 1;
+    n_files = argc - 1;
+  }
+
+  plan_tests(n_files * ARRAY_SIZE(configs));
+
+  for (unsigned i = 0; i < n_files; ++i) {
+    for (const TraceConfig &config : configs) {
+      char buffer[256];
+      snprintf(buffer, sizeof(buffer), "%s %s", files[i], config.name);
+      ok(TestTrace(files[i], config.no_thin_time, config.max_time,
+                   config.max_size), buffer, 0);
     }
   }
-  return 0;
+
+  return exit_status();
 }
@@ -22,13 +22,16 @@
 
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
+#include "Waypoint/WaypointCache.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Units/System.hpp"
 #include "TestUtil.hpp"
 #include "Util/tstring.hpp"
 #include "Operation/Operation.hpp"
+#include "IO/FileCache.hpp"
 
+#include <algorithm>
 #include <vector>
 
 static void
@@ -291,6 +294,68 @@ TestSeeYou(wp_vector org_wp)
   }
 }
 
+static bool
+CompareId(const Waypoint *a, const Waypoint *b)
+{
+  return a->id < b->id;
+}
+
+static void
+TestSeeYouCache(wp_vector org_wp)
+{
+  const TCHAR *path = _T("test/data/waypoints.cup");
+
+  Waypoints parsed;
+  WaypointReader reader(path, 0);
+  NullOperationEnvironment operation;
+  if (!ok1(!reader.Error() && reader.Parse(parsed, operation))) {
+    skip(6 + 10 * org_wp.size(), 0, "parsing waypoint file failed");
+    return;
+  }
+
+  ok1(!reader.IsTerrainDependent());
+
+  std::vector<const Waypoint *> ordered;
+  for (const auto &i : parsed)
+    ordered.push_back(&i);
+  std::sort(ordered.begin(), ordered.end(), CompareId);
+
+  FileCache cache(_T("output/test/cache"));
+  ok1(SaveWaypointCache(cache, _T("waypoints"), path,
+                        ordered.data(), ordered.data() + ordered.size()));
+
+  Waypoints way_points;
+  if (!ok1(LoadWaypointCache(way_points, cache, _T("waypoints"), path))) {
+    skip(3 + 10 * org_wp.size(), 0, "loading waypoint cache failed");
+    return;
+  }
+
+  way_points.Optimise();
+  ok1(way_points.size() == parsed.size());
+
+  /* the cache preserves the order, and thus the ids */
+  bool same_ids = true;
+  for (const auto &i : parsed) {
+    const Waypoint *wp = way_points.LookupId(i.id);
+    same_ids &= wp != NULL && wp->name == i.name &&
+      wp->original_id == i.original_id && wp->details == i.details &&
+      wp->radio_frequency.IsDefined() == i.radio_frequency.IsDefined();
+  }
+  ok1(same_ids);
+
+  wp_vector::iterator it;
+  for (it = org_wp.begin(); it < org_wp.end(); it++) {
+    const Waypoint *wp = GetWaypoint(*it, way_points);
+    TestSeeYouWaypoint(*it, wp);
+  }
+
+  /* a cache file is never used for a different file */
+  Waypoints other;
+  ok1(!LoadWaypointCache(other, cache, _T("waypoints"),
+                         _T("test/data/waypoints.dat")) &&
+      other.IsEmpty());
+}
+
 static void
 TestZanderWaypoint(const Waypoint org_wp, const Waypoint *wp)
 {
@@ -529,12 +594,13 @@ int main(int argc, char **argv)
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(315);
+  plan_tests(372);
 
   TestExtractParameters();
 
   TestWinPilot(org_wp);
   TestSeeYou(org_wp);
+  TestSeeYouCache(org_wp);
   TestZander(org_wp);
   TestFS(org_wp);
   TestFS_UTM(org_wp);
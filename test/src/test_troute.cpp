@@ -34,6 +34,20 @@
 #include "Geo/GeoVector.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/FileUtil.hpp"
+#include "Thread/WorkerPool.hpp"
+
+static bool
+IsSameRoute(const Route &a, const Route &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (unsigned i = 0; i < a.size(); ++i)
+    if (!(a[i] == b[i]) || a[i].altitude != b[i].altitude)
+      return false;
+
+  return true;
+}
 
 static void
 test_troute(const RasterMap& map, fixed mwind, fixed mc, RoughAltitude ceiling)
@@ -46,6 +60,14 @@ test_troute(const RasterMap& map, fixed mwind, fixed mc, RoughAltitude ceiling)
   route.UpdatePolar(settings, polar, polar, wind);
   route.SetTerrain(&map);
 
+  /* checks the candidate links in parallel; the solutions must be
+     the same */
+  WorkerPool pool(4);
+  TerrainRoute parallel_route;
+  parallel_route.UpdatePolar(settings, polar, polar, wind);
+  parallel_route.SetTerrain(&map);
+  parallel_route.SetWorkerPool(&pool);
+
   GeoPoint origin(map.GetMapCenter());
 
   fixed pd = map.PixelDistance(origin, 1);
@@ -75,25 +97,30 @@ test_troute(const RasterMap& map, fixed mwind, fixed mc, RoughAltitude ceiling)
   RoutePlannerConfig config;
   config.mode = RoutePlannerConfig::Mode::BOTH;
 
-  unsigned i=0;
-  for (fixed ang = fixed(0); ang < fixed_two_pi; ang += fixed(M_PI / 8)) {
+  /* count the directions, because summing up the angle may yield a
+     17th one just below 2 pi */
+  for (unsigned i = 0; i < 16; ++i) {
+    const fixed ang = fixed(M_PI / 8) * i;
     GeoPoint dest = GeoVector(fixed(40000.0), Angle::Radians(ang)).EndPoint(origin);
 
     short hdest = map.GetHeight(dest)+100;
 
-    retval = route.Solve(AGeoPoint(origin,
-                                   RoughAltitude(map.GetHeight(origin) + 100)),
-                         AGeoPoint(dest,
-                                   RoughAltitude(positive(mc)
-                                                 ? hdest
-                                                 : std::max(hdest, (short)3200))),
-                         config, ceiling);
+    const AGeoPoint start(origin,
+                          RoughAltitude(map.GetHeight(origin) + 100));
+    const AGeoPoint finish(dest,
+                           RoughAltitude(positive(mc)
+                                         ? hdest
+                                         : std::max(hdest, (short)3200)));
+    retval = route.Solve(start, finish, config, ceiling);
     char buffer[80];
     sprintf(buffer,"terrain route solve, dir=%g, wind=%g, mc=%g ceiling=%d",
             (double)ang, (double)mwind, (double)mc, (int)ceiling);
     ok(retval, buffer, 0);
     PrintHelper::print_route(route);
-    i++;
+
+    parallel_route.Solve(start, finish, config, ceiling);
+    ok(IsSameRoute(route.GetSolution(), parallel_route.GetSolution()),
+       "parallel terrain route solve", 0);
   }
 
   // polar.SetMC(fixed(0));
@@ -124,7 +151,7 @@ int main(int argc, char** argv) {
     map.SetViewCenter(map.GetMapCenter(), fixed(100000));
   } while (map.IsDirty());
 
-  plan_tests(16*3);
+  plan_tests(16*3*2);
   test_troute(map, fixed(0), fixed(0.1), RoughAltitude(10000));
   test_troute(map, fixed(0), fixed(0), RoughAltitude(10000));
   test_troute(map, fixed(5.0), fixed(1), RoughAltitude(10000));